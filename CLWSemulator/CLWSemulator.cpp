@@ -22,8 +22,13 @@
 #include "..\Useful\fOutputDebugString.h"
 #include "..\Grip\DexAnalogMixin.h"
 #include "..\Grip\GripPackets.h"
+#include "..\Grip\GripTrace.h"
 #include "..\GripMMI\GripMMIGlobals.h"
 #include "..\GripMMIVersionControl\GripMMIVersionControl.h"
+#include "CLWSemulatorTiming.h"
+#include "CLWSemulatorReplay.h"
+#include "CLWSemulatorLoad.h"
+#include "..\Grip\GripSynthetic.h"
 
 // Need to link with Ws2_32.lib
 #pragma comment (lib, "Ws2_32.lib")
@@ -68,114 +73,10 @@ void setPacketTime( EPMTelemetryHeaderInfo *header ) {
 
 }
 
-// This is the routine that sends out packets that were pre-recorded.
-// Takes as its input the socket for outputing packets, the path to the file
-// containing the recorded packets.
-int sendRecordedPackets ( SOCKET socket, const char *PacketSourceFile, int skip_packets = 0 ) {
-
-	// Count the total numbe of packets sent on the socket.
-	static int packetCount = 0;
-
-	int	fid;
-	int return_code;
-	int bytes_read;
-    int iSendResult;
-			
-	EPMTelemetryHeaderInfo epmPacketHeaderInfo;
-	EPMTelemetryPacket recordedPacket;
-
-	while ( 1 ) {
-
-		printf( "Sending out recorded packets:\n\n  %s\n\n", PacketSourceFile );
-
-		// Open the file where the packets are stored.
-		return_code = _sopen_s( &fid, PacketSourceFile, _O_RDONLY | _O_BINARY, _SH_DENYNO, _S_IWRITE | _S_IREAD  );
-		if ( return_code ) {
-			fMessageBox( MB_OK, "CLWSemulator", "Error opening %s for binary read.", PacketSourceFile );
-			exit( -1 );
-		}
-		// Read the first one, and exit with an error if there is not at least one packet.
-		bytes_read = _read( fid, recordedPacket.buffer, sizeof( recordedPacket.buffer ) );
-		if ( bytes_read < 0 ) {
-			fMessageBox( MB_OK, "CLWSemulator", "Error reading from %s.", PacketSourceFile );
-			exit( -1 );
-		}
-		// Skip over a number of packets.
-		while ( skip_packets > 0 ) {
-			bytes_read = _read( fid, recordedPacket.buffer, sizeof( recordedPacket.buffer ) );
-			if ( bytes_read < 0 ) break;
-			skip_packets--;
-		}
-
-		// Extract the EPM header info into a usable form from the packet that is stored in ESA-required byte order.
-		// Here we use it to initialize the record of the time of the previous packet, which is used
-		// later to compute the time between recorded packets and to sleep accordingly.
-		ExtractEPMTelemetryHeaderInfo( &epmPacketHeaderInfo, &recordedPacket );
-		unsigned int previous_coarse_time = epmPacketHeaderInfo.coarseTime;
-		unsigned int previous_fine_time = epmPacketHeaderInfo.fineTime;
-		
-		// Loop to read all of the packets in the file.
-		do {
-
-			// Extract the EPM header info into a usable form from the packet that is stored in ESA-required byte order.
-			ExtractEPMTelemetryHeaderInfo( &epmPacketHeaderInfo, &recordedPacket );
-			// Check what type of packet it is.
-			if ( epmPacketHeaderInfo.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE ) {
-				// If it's not an EPM packet we don't send it out.
-				if ( verbose ) printf( "Bytes: %4d (non EPM).\n", bytes_read ); 
-			}
-			else {
-				if ( verbose ) printf( "Bytes: %4d EPM.\n", bytes_read );
-				// If it is not a GRIP packet, just show that we are progressing through the packets.
-				if ( epmPacketHeaderInfo.subsystemID != GRIP_SUBSYSTEM_ID ) printf( "." );
-				// If it is a GRIP packet, modify the pre-recorded packet too make it look like it was generated just now.
-				else {
-					// Compute the number of milliseconds between this packet and the previous one.
-					// This will be used further down to sleep the appropriate time to space out the packets.
-					int delta_milliseconds = ((int) epmPacketHeaderInfo.fineTime - (int) previous_fine_time ) / 10;
-					int delta_time = (epmPacketHeaderInfo.coarseTime - previous_coarse_time) * 1000 + delta_milliseconds;
-					// Store the current time as a reference for the next cycle.
-					previous_coarse_time = epmPacketHeaderInfo.coarseTime;
-					previous_fine_time = epmPacketHeaderInfo.fineTime;
-					// Set the timestamp of the packet to be output to the current time.
-					setPacketTime( &epmPacketHeaderInfo );
-					// Set the packet counter based on a local count.
-					epmPacketHeaderInfo.TMCounter = packetCount++;
-					// Put the new header info back into the packet.
-					InsertEPMTelemetryHeaderInfo( &recordedPacket, &epmPacketHeaderInfo );
-					// Send it out on the socket.
-					iSendResult = send( socket, recordedPacket.buffer, EPM_BUFFER_LENGTH - 1, 0 );
-					// If we get a socket error it is probably because the client has closed the connection.
-					// So we break out of the loop.
-					if (iSendResult == SOCKET_ERROR) {
-						printf( "Recorded packet send() failed with error: %3d\n", WSAGetLastError());
-						return( packetCount );
-					}
-					// Sleep based on the difference in time between the previousrecorded packet and this one.
-					// If there has been a long real delay, limit it to 30 seconds.
-					delta_time %= 30000;
-					printf( "G%d", delta_time );
-					Sleep( delta_time );
-
-				}
-			}
-			
-		// Loop until there are no more bytes to read.
-		} while ( bytes_read = _read( fid, recordedPacket.buffer, sizeof( recordedPacket.buffer ) ) );
-
-		// Try to gracefully close the file.
-		return_code = _close( fid );
-		if ( return_code ) {
-			fMessageBox( MB_OK, "CLWSemulator", "Error closing %s after binary read.\nError code: %s", PacketSourceFile, return_code );
-			exit( return_code );
-		}
-
-		// Sleep to simulate a pause in the experiment execution, then start over again.
-		printf( "Playback completed. Will restart in 10 seconds.\n" );
-		Sleep( 10000 );
-
-	}
-
+// Set the time of an EPM telemetry packet to a time given in EPM seconds.
+void setPacketTimeFromSeconds( EPMTelemetryHeaderInfo *header, double seconds ) {
+	header->coarseTime = (unsigned long) seconds;
+	header->fineTime = (unsigned short) ( ( seconds - floor( seconds ) ) * 10000.0 );
 }
 
 // This is the routine that sends out packets that are constructed here to simulate data.
@@ -363,6 +264,7 @@ int sendConstructedPackets ( SOCKET socket ) {
 			printf( "RT packet send() failed with error: %3d\n", WSAGetLastError());
 			return ( packet_count );
 		}
+		GripTrace( TRACE_SEND, rtHeaderInfo.TMCounter );
 		printf( "  RT packet %3d Bytes sent: %3d\n", packet_count, iSendResult);
 
 		// One HK packet gets sent out for every two real-time data packets. 
@@ -401,6 +303,7 @@ int sendConstructedPackets ( SOCKET socket ) {
 				printf( "HK send() failed with error: %3d\n", WSAGetLastError());
 				return ( packet_count );
 			}
+			GripTrace( TRACE_SEND, hkHeaderInfo.TMCounter );
 			printf( "  HK packet %3d Bytes sent: %3d\n", packet_count, iSendResult);
 		}
 		send_hk = !send_hk; // Toggle enable flag so that we do one out of two cycles.
@@ -439,7 +342,6 @@ int sendGraspPackets ( SOCKET socket ) {
 	static int state = 20000;
 	static int snapshots = 17;
 
-	static int trials = 7;
 	static int status = 321;
 
 	static int packet_count = 0;
@@ -520,10 +422,136 @@ int sendGraspPackets ( SOCKET socket ) {
 			printf( "HK send() failed with error: %3d\n", WSAGetLastError());
 			return ( packet_count );
 		}
+		GripTrace( TRACE_SEND, hkHeaderInfo.TMCounter );
 		printf( "  HK packet %3d Bytes sent: %3d\n", packet_count, iSendResult);
 	}
 }
 
+// Send out RT packets generated by a synthetic session, plus one HK packet for every two RT packets.
+// The session is described by the scenario file (the built-in default if NULL) and the seed,
+//  so the same command line always produces the same data. Time 0 of the session is when the
+//  client connects. The packets go out at speed times real time, or as fast as possible if
+//  speed is 0, and the gaps that the session inserts in the packet stream are waited out.
+// The session ends after duration seconds of session time, or never if duration is 0.
+int sendSyntheticPackets( SOCKET socket, const char *scenario, unsigned long seed, double speed, double duration ) {
+
+	EPMTelemetryPacket hkPacket, rtPacket;
+	EPMTelemetryHeaderInfo hkHeaderInfo, rtHeaderInfo;
+	GripHealthAndStatusInfo hkInfo;
+	GripRealtimeDataInfo rtInfo;
+	GripSyntheticSession session;
+
+	int packet_count = 0;
+	int send_hk = 1;
+	int iSendResult;
+
+	if ( scenario && !session.LoadScenario( scenario ) ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Error loading synthetic session.\n%s", session.scenarioError );
+		exit( -1 );
+	}
+	session.Reset( seed );
+
+	memcpy( &hkHeaderInfo, &hkHeader, sizeof( hkHeaderInfo ) );
+	memcpy( &rtHeaderInfo, &rtHeader, sizeof( rtHeaderInfo ) );
+	memset( &hkInfo, 0, sizeof( hkInfo ) );
+	hkInfo.user = 11;
+	hkInfo.protocol = 201;
+	hkInfo.task = 210;
+	hkInfo.step = 10;
+	hkInfo.motionTrackerStatusEnum = 2;
+	hkInfo.crewCameraStatusEnum = 2;
+
+	// The session starts now.
+	setPacketTime( &rtHeaderInfo );
+	double origin = EPMtoSeconds( &rtHeaderInfo );
+	__int64 start_ticks = PerformanceTicks();
+
+	while ( 1 ) {
+
+		double gap;
+		double t = session.NextPacket( &rtInfo, &gap );
+		if ( duration > 0.0 && t > duration ) {
+			printf( "Synthetic session completed after %.1f s.\n", duration );
+			return( packet_count );
+		}
+		if ( gap > 0.0 ) printf( "\nSimulating a %.1f s break in the packet stream.\n\n", gap );
+		if ( speed > 0.0 ) WaitUntil( start_ticks + SecondsToTicks( t / speed ) );
+
+		rtHeaderInfo.TMCounter = packet_count++;
+		setPacketTimeFromSeconds( &rtHeaderInfo, origin + t );
+		rtInfo.packetTimestamp = EPMtoSeconds( &rtHeaderInfo );
+		InsertEPMTelemetryHeaderInfo( &rtPacket, &rtHeaderInfo );
+		InsertGripRealtimeDataInfo( &rtPacket, &rtInfo );
+		iSendResult = send( socket, rtPacket.buffer, rtPacketLengthInBytes, 0 );
+		if (iSendResult == SOCKET_ERROR) {
+			printf( "RT packet send() failed with error: %3d\n", WSAGetLastError());
+			return ( packet_count );
+		}
+		GripTrace( TRACE_SEND, rtHeaderInfo.TMCounter );
+		if ( verbose ) printf( "  RT packet %3d Bytes sent: %3d\n", packet_count, iSendResult);
+
+		if ( send_hk ) {
+			hkHeaderInfo.TMCounter = packet_count++;
+			setPacketTimeFromSeconds( &hkHeaderInfo, origin + t );
+			InsertEPMTelemetryHeaderInfo( &hkPacket, &hkHeaderInfo );
+			InsertGripHealthAndStatusInfo( &hkPacket, &hkInfo );
+			iSendResult = send( socket, hkPacket.buffer, hkPacketLengthInBytes, 0 );
+			if (iSendResult == SOCKET_ERROR) {
+				printf( "HK send() failed with error: %3d\n", WSAGetLastError());
+				return ( packet_count );
+			}
+			GripTrace( TRACE_SEND, hkHeaderInfo.TMCounter );
+			if ( verbose ) printf( "  HK packet %3d Bytes sent: %3d\n", packet_count, iSendResult);
+		}
+		send_hk = !send_hk;
+		if ( ( packet_count % 100 ) < 2 ) printf( "  Session time %8.1f s  Packets sent: %6d\n", t, packet_count );
+
+	}
+}
+
+// Wait for a 'Connect' command from a client before starting to send packets.
+// Returns false if the connection was lost before the command arrived.
+bool waitForConnectCommand( SOCKET ClientSocket ) {
+
+	int iResult;
+
+	// A place to store raw command packets received from the client.
+	EPMTelemetryPacket inputPacket;
+	// A place to store the pertinent information from a client packet in usable form.
+	EPMTransferFrameHeaderInfo transferFrameInfo;
+
+	printf( "Waiting for a Connect command ... " );
+	do {
+
+		iResult = recv(ClientSocket, inputPacket.buffer, sizeof( inputPacket.buffer ), 0);
+
+		if ( iResult == EPM_BUFFER_LENGTH ) {
+			// If we get a full buffer of data, it probably means that we have fallen behind.
+			// No packets that we expect from GRIP should use the full EPM buffer length.
+			// So just skip this packet and move on to the next.
+			printf("Bytes received: %4d - flushing (overrun).\n", iResult);
+		}
+		else if ( iResult == connectPacketLengthInBytes ) {
+			ExtractEPMTransferFrameHeaderInfo( &transferFrameInfo, &inputPacket );
+			if ( transferFrameInfo.packetType == TRANSFER_FRAME_CONNECT ) {
+				printf("start packet received from ");
+				if ( transferFrameInfo.softwareUnitID == GRIP_MMI_SOFTWARE_UNIT_ID ) printf( "PRIMARY" );
+				else if ( transferFrameInfo.softwareUnitID == GRIP_MMI_SOFTWARE_ALT_UNIT_ID ) printf( "ALTERNATE" );
+				else printf( "UNRECOGNIZED" );
+				printf( " (%d) software unit ID.\n", transferFrameInfo.softwareUnitID );
+				break;
+			}
+			else {
+				printf( "unexpected packet type (%x) ... ", transferFrameInfo.packetType );
+			}
+		}
+		else printf( "unexpected packet size (%d) ... ", iResult );
+
+	}while ( iResult > 0 );
+
+	return( iResult > 0 );
+}
+
 // This is the main routine of the executable.
 // It parses the command line, initializes a socket to create a CLWS-like server 
 // and calls the routine to output packets according to the command line options.
@@ -539,19 +567,19 @@ int _tmain( int argc, char **argv )
 	struct addrinfo *result = NULL;
 	struct addrinfo hints;
 
-	// Two possible sources of packets.
-	enum { RECORDED_PACKETS, CONSTRUCTED_PACKETS, CONSTRUCTED_GRASP } packet_source = RECORDED_PACKETS;
+	// Possible sources of packets.
+	enum { RECORDED_PACKETS, CONSTRUCTED_PACKETS, CONSTRUCTED_GRASP, LOAD_GENERATOR, SYNTHETIC_SESSION } packet_source = RECORDED_PACKETS;
 	// Path to file containing pre-recorded packets. Not used in 'constructed' mode.
 	const char *packet_source_filename = DefaultPacketSourceFile;
 	// Keep track of how many packets get sent out.
 	int packet_count;
-	// Skip over some initial recorded packets.
-	int skip_packets = 0;
-
-	// A place to store raw command packets received from the client.
-	EPMTelemetryPacket inputPacket;
-	// A place to store the pertinent information from a client packet in usable form.
-	EPMTransferFrameHeaderInfo transferFrameInfo;
+	// Where to start in the recorded packets, how fast to replay them, etc.
+	ReplayOptions replay_options = REPLAY_DEFAULT_OPTIONS;
+	// Rate, bursts and number of clients for the load generator.
+	LoadGeneratorOptions load_options = LOAD_GENERATOR_DEFAULT_OPTIONS;
+	// Scenario file and seed for synthetic sessions. NULL means the built-in scenario.
+	const char *synthetic_scenario = NULL;
+	unsigned long synthetic_seed = SYNTHETIC_DEFAULT_SEED;
 
 	printf( "CLWS Emulator started.\n%s\n%s\n\n", GripMMIVersion, GripMMIBuildInfo );
 	printf( "This is the EPM/GRIP packet server emulator.\n" );
@@ -569,13 +597,26 @@ int _tmain( int argc, char **argv )
 		printf( "Command Line Argument #%d: %s\n", arg, argv[arg] );
 		if ( !strcmp( argv[arg], "-grasp" ) ) packet_source = CONSTRUCTED_GRASP;
 		if ( !strcmp( argv[arg], "-constructed" ) ) packet_source = CONSTRUCTED_PACKETS;
+		// Send constructed packets as fast as asked for to one or more clients.
+		else if ( !strcmp( argv[arg], "-load" ) ) packet_source = LOAD_GENERATOR;
+		else if ( parseLoadGeneratorOption( &load_options, argv[arg] ) ) continue;
+		// Generate a synthetic session, from the built-in scenario or from a scenario file.
+		else if ( !strcmp( argv[arg], "-synthetic" ) ) packet_source = SYNTHETIC_SESSION;
+		else if ( !strncmp( argv[arg], "-synthetic=", strlen( "-synthetic=" ) ) ) {
+			packet_source = SYNTHETIC_SESSION;
+			synthetic_scenario = argv[arg] + strlen( "-synthetic=" );
+		}
+		else if ( !strncmp( argv[arg], "-seed=", strlen( "-seed=" ) ) ) sscanf( argv[arg], "-seed=%lu", &synthetic_seed );
 		// Playback previously recorded packets.
 		else if ( !strcmp( argv[arg], "-recorded" ) ) packet_source = RECORDED_PACKETS;
 		// Construct simulated packets.
 		else if ( !strncmp( argv[arg], "-port=", strlen( "-port=" ) ) ) EPMport = argv[arg] + strlen( "-port=" );
-		else if ( !strncmp( argv[arg], "-skip=", strlen( "-skip=" ) ) ) sscanf( argv[arg], "-skip=%d", &skip_packets );
+		else if ( parseReplayOption( &replay_options, argv[arg] ) ) continue;
 		else packet_source_filename = argv[arg];
 	}	
+	// Record the time at which each packet is sent, if tracing is enabled. See GripTrace.h.
+	GripTraceOpen( "CLWSemulator" );
+
 	if ( packet_source == RECORDED_PACKETS ) {
 		printf( "\nSending pre-recorded packets.\n" );
 		printf( "Packet source file: %s\n\n", packet_source_filename );
@@ -583,6 +624,13 @@ int _tmain( int argc, char **argv )
 	else if ( packet_source == CONSTRUCTED_PACKETS ) {
 		printf( "Constructing simulated packets.\n\n" );
 	}
+	else if ( packet_source == LOAD_GENERATOR ) {
+		printf( "Generating load for %d client(s).\n\n", load_options.clients );
+	}
+	else if ( packet_source == SYNTHETIC_SESSION ) {
+		printf( "Generating a synthetic session from %s with seed %lu.\n\n", 
+			( synthetic_scenario ? synthetic_scenario : "the default scenario" ), synthetic_seed );
+	}
 
 	// Initialize Winsock
 	iResult = WSAStartup(MAKEWORD(2,2), &wsaData);
@@ -610,7 +658,7 @@ int _tmain( int argc, char **argv )
 	// Create a SOCKET for connecting to client
 	ListenSocket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
 	if (ListenSocket == INVALID_SOCKET) {
-		printf("socket() failed with error: %ld\n", WSAGetLastError());
+		printf("socket() failed with error: %ld\n", (long) WSAGetLastError());
 		freeaddrinfo(result);
 		WSACleanup();
 		return 3;
@@ -651,6 +699,13 @@ int _tmain( int argc, char **argv )
 		}
 		else if ( _debug ) printf( "listen() OK ... " );
 
+		// The load generator accepts its own clients, as there may be more than one.
+		if ( packet_source == LOAD_GENERATOR ) {
+			packet_count = runLoadGenerator( ListenSocket, &load_options );
+			printf( "  Total packets sent: %d\n\n", packet_count );
+			continue;
+		}
+
 		// Accept a client socket
 		ClientSocket = accept(ListenSocket, NULL, NULL);
 		if (ClientSocket == INVALID_SOCKET) {
@@ -663,41 +718,14 @@ int _tmain( int argc, char **argv )
 		printf( "connected.\n" );
 
 		// Wait for a 'Connect' command to start sending packets.
-		printf( "Waiting for a Connect command ... " );
-		do {
-
-			iResult = recv(ClientSocket, inputPacket.buffer, sizeof( inputPacket.buffer ), 0);
-
-			if ( iResult == EPM_BUFFER_LENGTH ) {
-				// If we get a full buffer of data, it probably means that we have fallen behind.
-				// No packets that we expect from GRIP should use the full EPM buffer length.
-				// So just skip this packet and move on to the next.
-				printf("Bytes received: %4d - flushing (overrun).\n", iResult);
-			}
-			else if ( iResult == connectPacketLengthInBytes ) {
-				ExtractEPMTransferFrameHeaderInfo( &transferFrameInfo, &inputPacket );
-				if ( transferFrameInfo.packetType == TRANSFER_FRAME_CONNECT ) {
-					printf("start packet received from ", iResult);
-					if ( transferFrameInfo.softwareUnitID == GRIP_MMI_SOFTWARE_UNIT_ID ) printf( "PRIMARY" );
-					else if ( transferFrameInfo.softwareUnitID == GRIP_MMI_SOFTWARE_ALT_UNIT_ID ) printf( "ALTERNATE" );
-					else printf( "UNRECOGNIZED" );
-					printf( " (%d) software unit ID.\n", transferFrameInfo.softwareUnitID );
-					break;
-				}
-				else {
-					printf( "unexpected packet type (%x) ... ", transferFrameInfo.packetType );
-				}
-			}
-			else printf( "unexpected packet size (%d) ... ", iResult );
-
-		}while ( iResult > 0 );
+		waitForConnectCommand( ClientSocket );
 
 		// Send out recorded or artifically constructed packets, depending on a flag set by the command line.
 		// The total number of packets sent so far is stored in local variable packetCount.
 		switch ( packet_source ) {
 
 		case RECORDED_PACKETS:
-			packet_count = sendRecordedPackets( ClientSocket, packet_source_filename, skip_packets );
+			packet_count = sendRecordedPackets( ClientSocket, packet_source_filename, &replay_options );
 			break;
 
 		case CONSTRUCTED_PACKETS:
@@ -708,6 +736,14 @@ int _tmain( int argc, char **argv )
 			packet_count = sendGraspPackets( ClientSocket );
 			break;
 
+		case SYNTHETIC_SESSION:
+			packet_count = sendSyntheticPackets( ClientSocket, synthetic_scenario, synthetic_seed, replay_options.speed, load_options.duration );
+			break;
+
+		default:
+			packet_count = 0;
+			break;
+
 		}
 
 		// shutdown the connection since we're done
@@ -0,0 +1,407 @@
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Load generator mode of the CLWS emulator.
+/// See CLWSemulatorLoad.h for a description.
+
+#include "stdafx.h"
+#include <process.h>
+#include <math.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\Grip\GripPackets.h"
+#include "CLWSemulatorTiming.h"
+#include "CLWSemulatorLoad.h"
+
+///
+/// Statistics.
+///
+
+// Send latencies are accumulated in a histogram in nanoseconds.
+// Below LATENCY_SUB_BINS ns each nanosecond has its own bin. Above that, each power of two is
+//  divided into LATENCY_SUB_BINS bins, so the percentiles are good to about 6%
+//  whatever the order of magnitude, from microseconds to minutes.
+#define LATENCY_SUB_BINS	16
+#define LATENCY_OCTAVES		40
+#define LATENCY_BINS		( ( LATENCY_OCTAVES + 1 ) * LATENCY_SUB_BINS )
+
+typedef struct {
+	unsigned __int64	packets;
+	unsigned __int64	bytes;
+	unsigned __int64	late;		// Number of times we fell more than a second behind the requested rate.
+	unsigned __int64	max_latency;
+	unsigned long		latency[LATENCY_BINS];
+} LoadStatistics;
+
+static int LatencyBin( unsigned __int64 nanoseconds ) {
+	int octave = 0;
+	if ( nanoseconds < LATENCY_SUB_BINS ) return( (int) nanoseconds );
+	while ( nanoseconds >= 2 * LATENCY_SUB_BINS ) {
+		nanoseconds >>= 1;
+		octave++;
+	}
+	if ( octave >= LATENCY_OCTAVES ) return( LATENCY_BINS - 1 );
+	return( ( octave + 1 ) * LATENCY_SUB_BINS + (int) ( nanoseconds - LATENCY_SUB_BINS ) );
+}
+
+// The smallest latency that falls in a given bin.
+static unsigned __int64 LatencyBinValue( int bin ) {
+	if ( bin < LATENCY_SUB_BINS ) return( bin );
+	int octave = bin / LATENCY_SUB_BINS - 1;
+	return( (unsigned __int64) ( bin % LATENCY_SUB_BINS + LATENCY_SUB_BINS ) << octave );
+}
+
+static void ClearStatistics( LoadStatistics *stats ) {
+	memset( stats, 0, sizeof( *stats ) );
+}
+
+static void AddStatistics( LoadStatistics *total, const LoadStatistics *stats ) {
+	total->packets += stats->packets;
+	total->bytes += stats->bytes;
+	total->late += stats->late;
+	if ( stats->max_latency > total->max_latency ) total->max_latency = stats->max_latency;
+	for ( int bin = 0; bin < LATENCY_BINS; bin++ ) total->latency[bin] += stats->latency[bin];
+}
+
+// Latency in microseconds below which lie the given fraction of the sends.
+static double LatencyPercentile( const LoadStatistics *stats, double fraction ) {
+	unsigned __int64 count = 0;
+	unsigned __int64 target = (unsigned __int64) ceil( fraction * (double) stats->packets );
+	if ( target < 1 ) target = 1;
+	for ( int bin = 0; bin < LATENCY_BINS; bin++ ) {
+		count += stats->latency[bin];
+		if ( count >= target ) return( LatencyBinValue( bin ) / 1000.0 );
+	}
+	return( stats->max_latency / 1000.0 );
+}
+
+static void PrintStatistics( const char *label, const LoadStatistics *stats, double seconds ) {
+	if ( seconds <= 0.0 ) seconds = 1.0;
+	printf( "%s %8.0f pkt/s %7.2f MB/s", label, stats->packets / seconds, stats->bytes / seconds / ( 1024.0 * 1024.0 ) );
+	if ( stats->packets > 0 ) {
+		printf( "  send() us p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f",
+			LatencyPercentile( stats, 0.50 ), LatencyPercentile( stats, 0.90 ),
+			LatencyPercentile( stats, 0.99 ), LatencyPercentile( stats, 0.999 ),
+			stats->max_latency / 1000.0 );
+	}
+	if ( stats->late > 0 ) printf( "  behind %" PRIu64, (uint64_t) stats->late );
+	printf( "\n" );
+}
+
+///
+/// The threads that send packets, one per client.
+///
+
+typedef struct {
+	SOCKET						socket;
+	int							id;
+	const LoadGeneratorOptions	*options;
+	HANDLE						thread;
+	// Each thread accumulates its statistics locally and hands them over to the main thread
+	//  a few times a second, so that the lock is not taken for each packet.
+	CRITICAL_SECTION			lock;
+	LoadStatistics				pending;
+	volatile bool				finished;
+} LoadClient;
+
+// Set by the main thread to tell the sending threads to stop.
+static volatile bool stopLoad = false;
+
+// How often, in seconds, each thread hands its statistics over to the main thread.
+#define LOAD_HANDOVER_INTERVAL	0.1
+
+// Fill in the RT data for one packet, using the oscillating left-right movement of sendConstructedPackets().
+// The data are constructed once, in advance. Only the counters and times change as the packets go out.
+static void ConstructRealtimeData( GripRealtimeDataInfo *rtInfo, double packet_time ) {
+	memset( rtInfo, 0, sizeof( *rtInfo ) );
+	for ( int slice = 0; slice < RT_SLICES_PER_PACKET; slice++ ) {
+		double t = packet_time + slice * RT_DEFAULT_SECONDS_PER_SLICE;
+		double s = sin( t * Pi * 2.0 );
+		double c = cos( t * Pi * 2.0 );
+		rtInfo->dataSlice[slice].quaternion[M] = 1.0;
+		rtInfo->dataSlice[slice].position[X] = 300.0 + 300.0 * c;
+		rtInfo->dataSlice[slice].acceleration[X] = - 300.0 * c * RT_DEFAULT_SECONDS_PER_SLICE * RT_DEFAULT_SECONDS_PER_SLICE;
+		rtInfo->dataSlice[slice].ft[0].force[X] = - 14.0 + 8.5 * s;
+		rtInfo->dataSlice[slice].ft[1].force[X] =  - rtInfo->dataSlice[slice].ft[0].force[X];
+		rtInfo->dataSlice[slice].markerVisibility[0] = 0x000ff;
+		rtInfo->dataSlice[slice].markerVisibility[1] = 0xf0fff;
+		rtInfo->dataSlice[slice].manipulandumVisibility = true;
+	}
+}
+
+// Give the statistics accumulated by a thread to the main thread and start over.
+static void HandOverStatistics( LoadClient *client, LoadStatistics *stats ) {
+	EnterCriticalSection( &client->lock );
+	AddStatistics( &client->pending, stats );
+	LeaveCriticalSection( &client->lock );
+	ClearStatistics( stats );
+}
+
+static unsigned __stdcall LoadClientThread( void *parameter ) {
+
+	LoadClient *client = (LoadClient *) parameter;
+	const LoadGeneratorOptions *options = client->options;
+
+	EPMTelemetryPacket hkPacket, rtPacket;
+	EPMTelemetryHeaderInfo hkHeaderInfo, rtHeaderInfo;
+	GripHealthAndStatusInfo hkInfo;
+	// The movement is a 1 Hz sinusoid and RT packets are 0.5 s apart, so two different packets suffice.
+	GripRealtimeDataInfo rtInfo[2];
+
+	LoadStatistics stats;
+	unsigned long packet_count = 0;
+	unsigned long rt_packet_count = 0;
+	int iSendResult;
+
+	// Prepare the packets.
+	memcpy( &hkHeaderInfo, &hkHeader, sizeof( hkHeaderInfo ) );
+	memcpy( &rtHeaderInfo, &rtHeader, sizeof( rtHeaderInfo ) );
+	memset( &hkInfo, 0, sizeof( hkInfo ) );
+	hkInfo.user = 11;
+	hkInfo.protocol = 201;
+	hkInfo.task = 210;
+	hkInfo.step = 10;
+	hkInfo.motionTrackerStatusEnum = 2;
+	hkInfo.crewCameraStatusEnum = 2;
+	InsertGripHealthAndStatusInfo( &hkPacket, &hkInfo );
+
+	// The packet times start from now and advance at the on-board rate.
+	setPacketTime( &rtHeaderInfo );
+	double start_time = (double) EPMtoSeconds( &rtHeaderInfo );
+	ConstructRealtimeData( &rtInfo[0], start_time );
+	ConstructRealtimeData( &rtInfo[1], start_time + 0.5 );
+
+	// Pacing.
+	int burst = ( options->burst > 0 ? options->burst : 1 );
+	__int64 burst_interval = ( options->rate > 0.0 ? SecondsToTicks( burst / options->rate ) : 0 );
+	__int64 on_ticks = SecondsToTicks( options->on_seconds );
+	__int64 cycle_ticks = SecondsToTicks( options->on_seconds + options->off_seconds );
+	__int64 start = PerformanceTicks();
+	__int64 next_burst = start;
+	__int64 next_handover = start + SecondsToTicks( LOAD_HANDOVER_INTERVAL );
+	__int64 one_second = SecondsToTicks( 1.0 );
+
+	ClearStatistics( &stats );
+
+	while ( !stopLoad ) {
+
+		// Respect the on/off cycle.
+		if ( options->off_seconds > 0.0 ) {
+			__int64 phase = ( PerformanceTicks() - start ) % cycle_ticks;
+			if ( phase >= on_ticks ) {
+				WaitUntil( PerformanceTicks() + cycle_ticks - phase );
+				next_burst = PerformanceTicks();
+			}
+		}
+		if ( burst_interval > 0 ) WaitUntil( next_burst );
+
+		for ( int i = 0; i < burst; i++ ) {
+
+			// Two RT packets for each HK packet, as GRIP does.
+			EPMTelemetryPacket *packet;
+			int length;
+			if ( packet_count % 3 != 2 ) {
+				// Every RT packet advances the time by RT_SLICES_PER_PACKET slices.
+				rtHeaderInfo.TMCounter = packet_count;
+				setPacketTimeFromSeconds( &rtHeaderInfo, start_time + rt_packet_count * RT_SLICES_PER_PACKET * RT_DEFAULT_SECONDS_PER_SLICE );
+				rtInfo[rt_packet_count % 2].rtPacketCount = rt_packet_count;
+				InsertEPMTelemetryHeaderInfo( &rtPacket, &rtHeaderInfo );
+				InsertGripRealtimeDataInfo( &rtPacket, &rtInfo[rt_packet_count % 2] );
+				rt_packet_count++;
+				packet = &rtPacket;
+				length = rtPacketLengthInBytes;
+			}
+			else {
+				hkHeaderInfo.TMCounter = packet_count;
+				hkHeaderInfo.coarseTime = rtHeaderInfo.coarseTime;
+				hkHeaderInfo.fineTime = rtHeaderInfo.fineTime;
+				InsertEPMTelemetryHeaderInfo( &hkPacket, &hkHeaderInfo );
+				packet = &hkPacket;
+				length = hkPacketLengthInBytes;
+			}
+			packet_count++;
+
+			// Time only the send itself.
+			__int64 before = PerformanceTicks();
+			iSendResult = send( client->socket, packet->buffer, length, 0 );
+			__int64 after = PerformanceTicks();
+			// If we get a socket error it is probably because the client has closed the connection.
+			if ( iSendResult == SOCKET_ERROR ) {
+				printf( "Client %d: send() failed with error: %3d\n", client->id, WSAGetLastError() );
+				HandOverStatistics( client, &stats );
+				client->finished = true;
+				return( 0 );
+			}
+			unsigned __int64 nanoseconds = (unsigned __int64) ( TicksToSeconds( after - before ) * 1.0e9 );
+			stats.latency[LatencyBin( nanoseconds )]++;
+			if ( nanoseconds > stats.max_latency ) stats.max_latency = nanoseconds;
+			stats.packets++;
+			stats.bytes += iSendResult;
+		}
+
+		// Schedule the next burst. If we cannot keep up, don't try to catch up
+		//  more than a second's worth of packets; start again from now instead.
+		if ( burst_interval > 0 ) {
+			__int64 now = PerformanceTicks();
+			next_burst += burst_interval;
+			if ( now - next_burst > one_second ) {
+				next_burst = now;
+				stats.late++;
+			}
+		}
+
+		// Hand over the statistics to the main thread from time to time.
+		if ( PerformanceTicks() >= next_handover ) {
+			HandOverStatistics( client, &stats );
+			next_handover += SecondsToTicks( LOAD_HANDOVER_INTERVAL );
+		}
+	}
+
+	HandOverStatistics( client, &stats );
+	client->finished = true;
+	return( 0 );
+}
+
+// Close the connection to a client once the packets have all gone out.
+// The Alive commands that the client sends are never read, and closing a socket that has
+//  unread data resets the connection, which throws away the packets that are still on
+//  their way to the client. So we read until the client closes its end, which it does once
+//  it has received everything, or until it has been silent for LOAD_CLOSE_TIMEOUT seconds.
+#define LOAD_CLOSE_TIMEOUT	10
+static void CloseClientSocket( SOCKET socket ) {
+	char discard[EPM_BUFFER_LENGTH];
+	DWORD timeout_milliseconds = LOAD_CLOSE_TIMEOUT * 1000;
+	shutdown( socket, SD_SEND );
+	setsockopt( socket, SOL_SOCKET, SO_RCVTIMEO, (const char *) &timeout_milliseconds, sizeof( timeout_milliseconds ) );
+	while ( recv( socket, discard, sizeof( discard ), 0 ) > 0 );
+	closesocket( socket );
+}
+
+///
+/// Main routine of the load generator.
+///
+
+int runLoadGenerator( SOCKET listen_socket, const LoadGeneratorOptions *options ) {
+
+	LoadClient *client;
+	LoadStatistics report, total;
+	int n_clients = 0;
+	int i;
+
+	client = (LoadClient *) calloc( options->clients, sizeof( LoadClient ) );
+	if ( !client ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Error allocating memory for %d clients.", options->clients );
+		exit( -1 );
+	}
+
+	// Wait for all the clients to connect before starting, so that they all get the same load.
+	while ( n_clients < options->clients ) {
+		SOCKET socket = accept( listen_socket, NULL, NULL );
+		if ( socket == INVALID_SOCKET ) {
+			printf( "accept() failed with error: %d\n", WSAGetLastError() );
+			break;
+		}
+		printf( "Client %d connected. ", n_clients );
+		if ( !waitForConnectCommand( socket ) ) {
+			closesocket( socket );
+			continue;
+		}
+		client[n_clients].socket = socket;
+		client[n_clients].id = n_clients;
+		client[n_clients].options = options;
+		n_clients++;
+	}
+
+	printf( "\nLoad generator: %d client(s), ", n_clients );
+	if ( options->rate > 0.0 ) printf( "%.0f packets/s in bursts of %d", options->rate, options->burst );
+	else printf( "as fast as possible" );
+	if ( options->off_seconds > 0.0 ) printf( ", %.1f s on / %.1f s off", options->on_seconds, options->off_seconds );
+	printf( ".\n\n" );
+
+	// Start one thread per client.
+	stopLoad = false;
+	for ( i = 0; i < n_clients; i++ ) {
+		InitializeCriticalSection( &client[i].lock );
+		ClearStatistics( &client[i].pending );
+		client[i].finished = false;
+		client[i].thread = (HANDLE) _beginthreadex( NULL, 0, LoadClientThread, &client[i], 0, NULL );
+		if ( !client[i].thread ) {
+			fMessageBox( MB_OK, "CLWSemulator", "Error starting the load generator thread for client %d.", i );
+			exit( -1 );
+		}
+	}
+
+	// Report periodically until all the clients are gone or the time is up.
+	ClearStatistics( &total );
+	__int64 start = PerformanceTicks();
+	__int64 previous = start;
+	bool running = ( n_clients > 0 );
+	while ( running ) {
+
+		Sleep( (DWORD) ( options->report_interval * 1000.0 ) );
+		__int64 now = PerformanceTicks();
+
+		running = false;
+		ClearStatistics( &report );
+		for ( i = 0; i < n_clients; i++ ) {
+			EnterCriticalSection( &client[i].lock );
+			AddStatistics( &report, &client[i].pending );
+			ClearStatistics( &client[i].pending );
+			LeaveCriticalSection( &client[i].lock );
+			if ( !client[i].finished ) running = true;
+		}
+		AddStatistics( &total, &report );
+
+		char label[64];
+		sprintf( label, "%8.1f s", TicksToSeconds( now - start ) );
+		PrintStatistics( label, &report, TicksToSeconds( now - previous ) );
+		previous = now;
+
+		if ( options->duration > 0.0 && TicksToSeconds( now - start ) >= options->duration ) break;
+	}
+
+	// Stop the threads and collect what they did since the last report.
+	stopLoad = true;
+	for ( i = 0; i < n_clients; i++ ) {
+		WaitForSingleObject( client[i].thread, INFINITE );
+		CloseHandle( client[i].thread );
+		AddStatistics( &total, &client[i].pending );
+		DeleteCriticalSection( &client[i].lock );
+	}
+	double seconds = TicksToSeconds( PerformanceTicks() - start );
+	for ( i = 0; i < n_clients; i++ ) CloseClientSocket( client[i].socket );
+
+	printf( "\nLoad generator summary for %d client(s) over %.1f s:\n", n_clients, seconds );
+	PrintStatistics( "   Total ", &total, seconds );
+	printf( "\n" );
+
+	free( client );
+	return( (int) total.packets );
+
+}
+
+bool parseLoadGeneratorOption( LoadGeneratorOptions *options, const char *arg ) {
+	if ( !strncmp( arg, "-rate=", strlen( "-rate=" ) ) ) sscanf( arg, "-rate=%lf", &options->rate );
+	else if ( !strncmp( arg, "-burst=", strlen( "-burst=" ) ) ) sscanf( arg, "-burst=%d", &options->burst );
+	else if ( !strncmp( arg, "-on=", strlen( "-on=" ) ) ) sscanf( arg, "-on=%lf", &options->on_seconds );
+	else if ( !strncmp( arg, "-off=", strlen( "-off=" ) ) ) sscanf( arg, "-off=%lf", &options->off_seconds );
+	else if ( !strncmp( arg, "-clients=", strlen( "-clients=" ) ) ) sscanf( arg, "-clients=%d", &options->clients );
+	else if ( !strncmp( arg, "-duration=", strlen( "-duration=" ) ) ) sscanf( arg, "-duration=%lf", &options->duration );
+	else if ( !strncmp( arg, "-report=", strlen( "-report=" ) ) ) sscanf( arg, "-report=%lf", &options->report_interval );
+	else return( false );
+	// Keep the values within reason.
+	if ( options->burst < 1 ) options->burst = 1;
+	if ( options->clients < 1 ) options->clients = 1;
+	if ( options->report_interval < 0.1 ) options->report_interval = 0.1;
+	if ( options->off_seconds > 0.0 && options->on_seconds <= 0.0 ) options->on_seconds = 1.0;
+	return( true );
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Load generator mode of the CLWS emulator.
+
+// In the normal modes the emulator sends packets at the rate that GRIP does (2 RT and 1 HK per second).
+// The load generator sends constructed packets as fast as asked for, or as fast as the socket
+//  will take them, to one or more clients at the same time, so as to find out how much
+//  DexGroundMonitorClient and GripMMI can ingest.
+// The time in the packet headers advances by 0.5 s per RT packet, as it would on board,
+//  independent of how fast the packets actually go out. So a client sees a coherent,
+//  if accelerated, stream of data.
+// Each call to send() is timed. Throughput and percentiles of the time spent in send() are
+//  reported periodically and for the session as a whole.
+
+typedef struct {
+	// Packets per second to each client, counting both RT and HK packets. 0 means as fast as possible.
+	double	rate;
+	// Packets are sent back to back in bursts of this many. The bursts are spaced to give the requested rate.
+	int		burst;
+	// Send for on_seconds, then pause for off_seconds, e.g. to mimic the backlog that follows LOS.
+	// If off_seconds is 0 the packets go out continuously.
+	double	on_seconds;
+	double	off_seconds;
+	// Number of clients that must connect before the packets start to go out.
+	int		clients;
+	// Stop after this many seconds. 0 means go on until all the clients have disconnected.
+	// A synthetic session (-synthetic) also ends after this many seconds of session time.
+	double	duration;
+	// Seconds between reports to the console.
+	double	report_interval;
+} LoadGeneratorOptions;
+
+#define LOAD_GENERATOR_DEFAULT_OPTIONS { 0.0, 1, 0.0, 0.0, 1, 0.0, 1.0 }
+
+// Accept options.clients connections on the listening socket, wait for a Connect command from
+//  each one, then send packets to all of them in parallel until they disconnect or the
+//  duration has elapsed. Returns the total number of packets sent.
+int runLoadGenerator( SOCKET listen_socket, const LoadGeneratorOptions *options );
+
+// Parse one of the load generator command line options. Returns false if the argument is not one of them.
+bool parseLoadGeneratorOption( LoadGeneratorOptions *options, const char *arg );
+
+// Wait for a Connect transfer frame from a newly accepted client.
+// Returns false if the client disconnected first. Implemented in CLWSemulator.cpp.
+bool waitForConnectCommand( SOCKET client_socket );
@@ -0,0 +1,471 @@
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Replay of pre-recorded packets.
+/// See CLWSemulatorReplay.h for a description.
+
+#include "stdafx.h"
+#include <stdint.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\GripTrace.h"
+#include "CLWSemulatorTiming.h"
+#include "CLWSemulatorReplay.h"
+
+// Defined in CLWSemulator.cpp.
+extern bool verbose;
+
+///
+/// The index of the packets in a file.
+///
+
+// One entry in the index of the packets in a recorded packet file.
+// Packets that are not EPM packets have a time of 0.
+// The entries are written to the index file as they are, so the fields have the same size
+//  in the Windows and the portable builds and there is no padding left to the compiler.
+typedef struct {
+	uint64_t		offset;
+	uint32_t		length;			// Length of the packet, which may be less than the distance to the next one.
+	uint32_t		subsystemID;
+	double			time;
+} ReplayIndexEntry;
+
+// The index file starts with this header. If the size or the modification time of the
+//  packet file does not match, the index is out of date and gets rebuilt.
+#define REPLAY_INDEX_MAGIC	"GPKIDX3"
+typedef struct {
+	char			magic[8];
+	uint64_t		source_size;
+	uint64_t		source_mtime;
+	uint32_t		entries;
+	uint32_t		padding;		// Always 0.
+} ReplayIndexHeader;
+
+static ReplayIndexEntry	*replayIndex = NULL;
+static unsigned long	replayIndexEntries = 0;
+
+static void AddIndexEntry( unsigned long *allocated, __int64 offset, unsigned long length, const EPMTelemetryPacket *packet ) {
+
+	EPMTelemetryHeaderInfo header;
+
+	if ( replayIndexEntries >= *allocated ) {
+		*allocated = ( *allocated ? 2 * *allocated : 4096 );
+		replayIndex = (ReplayIndexEntry *) realloc( replayIndex, *allocated * sizeof( ReplayIndexEntry ) );
+		if ( !replayIndex ) {
+			fMessageBox( MB_OK, "CLWSemulator", "Error allocating memory for the packet index." );
+			exit( -1 );
+		}
+	}
+	ReplayIndexEntry *entry = &replayIndex[replayIndexEntries++];
+	entry->offset = (uint64_t) offset;
+	entry->length = length;
+	if ( packet ) ExtractEPMTelemetryHeaderInfo( &header, packet );
+	if ( packet && header.epmSyncMarker == EPM_TELEMETRY_SYNC_VALUE ) {
+		entry->subsystemID = header.subsystemID;
+		entry->time = (double) EPMtoSeconds( &header );
+	}
+	else {
+		entry->subsystemID = 0;
+		entry->time = 0.0;
+	}
+}
+
+///
+/// The packet file is mapped into memory, so that packets can be sent straight
+///  from the file without copying them, or copied just once when they are restamped.
+///
+
+static HANDLE				replayFile = INVALID_HANDLE_VALUE;
+static HANDLE				replayMapping = NULL;
+static const unsigned char	*replayData = NULL;
+static __int64				replaySize = 0;
+
+static void UnmapPacketFile( void ) {
+	if ( replayData ) UnmapViewOfFile( replayData );
+	if ( replayMapping ) CloseHandle( replayMapping );
+	if ( replayFile != INVALID_HANDLE_VALUE ) CloseHandle( replayFile );
+	replayData = NULL;
+	replayMapping = NULL;
+	replayFile = INVALID_HANDLE_VALUE;
+	replaySize = 0;
+}
+
+static void MapPacketFile( const char *PacketSourceFile ) {
+
+	LARGE_INTEGER size;
+
+	UnmapPacketFile();
+	replayFile = CreateFileA( PacketSourceFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if ( replayFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( replayFile, &size ) ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Error opening %s for binary read.", PacketSourceFile );
+		exit( -1 );
+	}
+	replaySize = size.QuadPart;
+	if ( replaySize == 0 ) {
+		fMessageBox( MB_OK, "CLWSemulator", "%s does not contain any packets.", PacketSourceFile );
+		exit( -1 );
+	}
+	replayMapping = CreateFileMappingA( replayFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( replayMapping ) replayData = (const unsigned char *) MapViewOfFile( replayMapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( !replayData ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Error mapping %s into memory.\nError code: %d", PacketSourceFile, GetLastError() );
+		exit( -1 );
+	}
+
+}
+
+///
+/// Framing.
+///
+
+// Check for the transfer frame sync marker, which is stored most significant byte first.
+static bool IsTransferFrame( const unsigned char *data, __int64 remaining ) {
+	return( remaining >= EPM_TRANSFER_FRAME_HEADER_LENGTH &&
+		( ( (unsigned long) data[0] << 24 ) | ( (unsigned long) data[1] << 16 ) | ( (unsigned long) data[2] << 8 ) | data[3] ) == EPM_TRANSFER_FRAME_SYNC_VALUE );
+}
+
+// Work out the length of the packet that starts at data and the distance to the next one.
+// The files written by DexGroundMonitorClient hold either packets of the length given
+//  in their header (.rt.gpk, .hk.gpk) or packets padded out to a full EPM buffer (.any.gpk),
+//  so we check that another packet (or the end of the file) follows before accepting a length.
+// If neither works, we have lost sync and skip ahead to the next sync marker.
+static unsigned long FramePacket( const unsigned char *data, __int64 remaining, unsigned long *packet_length ) {
+
+	unsigned long length;
+	unsigned long record;
+
+	if ( IsTransferFrame( data, remaining ) ) {
+		// The length is worked out as DexGroundMonitorClient does it. See EPMPacketLength() in GripPackets.c.
+		length = EPMPacketLength( data, ( remaining < EPM_BUFFER_LENGTH ? (int) remaining : EPM_BUFFER_LENGTH ) );
+		// The packet is cut short by the end of the file.
+		if ( length == 0 ) length = (unsigned long) remaining;
+
+		if ( (__int64) length >= remaining || IsTransferFrame( data + length, remaining - length ) ) {
+			*packet_length = ( (__int64) length < remaining ? length : (unsigned long) remaining );
+			return( *packet_length );
+		}
+		if ( EPM_BUFFER_LENGTH >= remaining || IsTransferFrame( data + EPM_BUFFER_LENGTH, remaining - EPM_BUFFER_LENGTH ) ) {
+			*packet_length = ( (__int64) length < remaining ? length : (unsigned long) remaining );
+			return( EPM_BUFFER_LENGTH < remaining ? EPM_BUFFER_LENGTH : (unsigned long) remaining );
+		}
+	}
+
+	// Resynchronize.
+	for ( record = 1; (__int64) record < remaining && !IsTransferFrame( data + record, remaining - record ); record++ );
+	*packet_length = ( record < EPM_BUFFER_LENGTH ? record : EPM_BUFFER_LENGTH );
+	return( record );
+
+}
+
+// Go through the packet file to find where each packet is.
+static void BuildReplayIndex( void ) {
+
+	__int64 offset = 0;
+	unsigned long allocated = 0;
+	unsigned long length;
+	unsigned long resyncs = 0;
+
+	while ( offset < replaySize ) {
+		const unsigned char *data = replayData + offset;
+		unsigned long record = FramePacket( data, replaySize - offset, &length );
+		// Only packets that are long enough to have a telemetry header can be EPM packets.
+		// A packet cut short by the end of the file is not sent, because the client would
+		//  take the start of the next packet on the stream to complete it.
+		if ( length >= EPM_TRANSFER_FRAME_HEADER_LENGTH + EPM_TELEMETRY_HEADER_LENGTH
+			&& (int) length == EPMPacketLength( data, (int) length ) ) {
+			AddIndexEntry( &allocated, offset, length, (const EPMTelemetryPacket *) data );
+		}
+		else {
+			if ( !IsTransferFrame( data, replaySize - offset ) ) resyncs++;
+			AddIndexEntry( &allocated, offset, length, NULL );
+		}
+		offset += record;
+	}
+	if ( resyncs ) printf( "(%lu stretches of unrecognized data) ", resyncs );
+
+}
+
+// Check that each entry of an index read from file lies within the packet file
+//  and is no longer than the buffer that a packet is copied into.
+static bool ReplayIndexIsValid( void ) {
+	for ( unsigned long i = 0; i < replayIndexEntries; i++ ) {
+		const ReplayIndexEntry *entry = &replayIndex[i];
+		if ( entry->offset >= (uint64_t) replaySize ) return( false );
+		if ( entry->length > EPM_BUFFER_LENGTH ) return( false );
+		if ( entry->length > (uint64_t) replaySize - entry->offset ) return( false );
+	}
+	return( true );
+}
+
+// Load the index from the index file if it is up to date, otherwise rebuild it and save it.
+static void LoadReplayIndex( const char *PacketSourceFile ) {
+
+	char index_filename[1024];
+	struct _stat64 source_stat;
+	ReplayIndexHeader header;
+	FILE *fp;
+
+	free( replayIndex );
+	replayIndex = NULL;
+	replayIndexEntries = 0;
+
+	if ( _stat64( PacketSourceFile, &source_stat ) ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Error opening %s for binary read.", PacketSourceFile );
+		exit( -1 );
+	}
+	sprintf_s( index_filename, sizeof( index_filename ), "%s.idx", PacketSourceFile );
+
+	fp = fopen( index_filename, "rb" );
+	if ( fp ) {
+		if ( fread( &header, sizeof( header ), 1, fp ) == 1
+			&& !strncmp( header.magic, REPLAY_INDEX_MAGIC, sizeof( header.magic ) )
+			&& header.source_size == (uint64_t) source_stat.st_size
+			&& header.source_mtime == (uint64_t) source_stat.st_mtime
+			// Each packet takes at least one byte of the file, and the allocation must not overflow.
+			&& header.entries <= header.source_size
+			&& header.entries < SIZE_MAX / sizeof( ReplayIndexEntry ) ) {
+			replayIndex = (ReplayIndexEntry *) malloc( ( (size_t) header.entries + 1 ) * sizeof( ReplayIndexEntry ) );
+			if ( replayIndex && fread( replayIndex, sizeof( ReplayIndexEntry ), header.entries, fp ) == header.entries ) {
+				replayIndexEntries = header.entries;
+			}
+			if ( replayIndexEntries == 0 || !ReplayIndexIsValid() ) {
+				printf( "Packet index %s does not match %s.\n", index_filename, PacketSourceFile );
+				replayIndexEntries = 0;
+				free( replayIndex );
+				replayIndex = NULL;
+			}
+		}
+		fclose( fp );
+	}
+	if ( replayIndex ) {
+		printf( "Using packet index %s (%lu packets).\n", index_filename, replayIndexEntries );
+		return;
+	}
+
+	printf( "Indexing %s ... ", PacketSourceFile );
+	BuildReplayIndex();
+	printf( "%lu packets.\n", replayIndexEntries );
+
+	// Save the index for next time. If it cannot be written, we just rebuild it next time.
+	fp = fopen( index_filename, "wb" );
+	if ( fp ) {
+		memset( &header, 0, sizeof( header ) );
+		strncpy( header.magic, REPLAY_INDEX_MAGIC, sizeof( header.magic ) );
+		header.source_size = (uint64_t) source_stat.st_size;
+		header.source_mtime = (uint64_t) source_stat.st_mtime;
+		header.entries = (uint32_t) replayIndexEntries;
+		fwrite( &header, sizeof( header ), 1, fp );
+		fwrite( replayIndex, sizeof( ReplayIndexEntry ), replayIndexEntries, fp );
+		fclose( fp );
+	}
+
+}
+
+// Find the first packet at or after the specified EPM time.
+// Packets that are not EPM packets have no time, so they are treated as having
+//  the time of the EPM packet that precedes them.
+static unsigned long FindPacketAtTime( double time ) {
+
+	unsigned long low = 0;
+	unsigned long high = replayIndexEntries;
+
+	// Times are relative to the first packet in the recording if small enough.
+	if ( time < REPLAY_RELATIVE_SEEK_LIMIT ) {
+		for ( unsigned long i = 0; i < replayIndexEntries; i++ ) {
+			if ( replayIndex[i].time != 0.0 ) {
+				time += replayIndex[i].time;
+				break;
+			}
+		}
+	}
+	// Binary search, on the assumption that the packets were recorded in time order.
+	while ( low < high ) {
+		unsigned long mid = ( low + high ) / 2;
+		unsigned long epm = mid;
+		while ( epm > 0 && replayIndex[epm].time == 0.0 ) epm--;
+		if ( replayIndex[epm].time < time ) low = mid + 1;
+		else high = mid;
+	}
+	return( low );
+}
+
+///
+/// Replay.
+///
+
+// When the packets are due faster than we can send them one at a time (high speed factors
+//  or unthrottled replay), up to this many are gathered and handed to the socket in a
+//  single call to WSASend().
+#define REPLAY_BATCH_PACKETS	32
+
+// Send the batch of packets. Returns false if the socket failed.
+static bool SendPacketBatch( SOCKET socket, WSABUF *batch, int n_batch ) {
+	DWORD bytes_sent;
+	if ( n_batch == 0 ) return( true );
+	if ( WSASend( socket, batch, n_batch, &bytes_sent, 0, NULL, NULL ) == SOCKET_ERROR ) {
+		printf( "Recorded packet WSASend() failed with error: %3d\n", WSAGetLastError());
+		return( false );
+	}
+	if ( GripTraceEnabled() ) {
+		EPMTelemetryHeaderInfo header;
+		for ( int i = 0; i < n_batch; i++ ) {
+			ExtractEPMTelemetryHeaderInfo( &header, (EPMTelemetryPacket *) batch[i].buf );
+			if ( header.epmSyncMarker == EPM_TELEMETRY_SYNC_VALUE ) GripTrace( TRACE_SEND, header.TMCounter );
+		}
+	}
+	return( true );
+}
+
+int sendRecordedPackets( SOCKET socket, const char *PacketSourceFile, const ReplayOptions *options ) {
+
+	// Count the total number of packets sent on the socket.
+	static int packetCount = 0;
+
+	unsigned long first, i;
+
+	EPMTelemetryHeaderInfo epmPacketHeaderInfo;
+	// Packets that are restamped are copied here. Otherwise they are sent straight from the file mapping.
+	static EPMTelemetryPacket restampedPacket[REPLAY_BATCH_PACKETS];
+	WSABUF batch[REPLAY_BATCH_PACKETS];
+	int n_batch;
+
+	MapPacketFile( PacketSourceFile );
+	LoadReplayIndex( PacketSourceFile );
+
+	// Find where to start.
+	if ( options->start_time != 0.0 ) first = FindPacketAtTime( options->start_time );
+	else first = ( options->start_packet > 0 ? options->start_packet : 0 );
+	if ( first >= replayIndexEntries ) {
+		fMessageBox( MB_OK, "CLWSemulator", "Start point is beyond the end of %s (%lu packets).", PacketSourceFile, replayIndexEntries );
+		exit( -1 );
+	}
+
+	while ( 1 ) {
+
+		printf( "Sending out recorded packets:\n\n  %s\n\n", PacketSourceFile );
+		printf( "Starting at packet %lu", first );
+		if ( replayIndex[first].time != 0.0 ) printf( " (EPM time %.3f)", replayIndex[first].time );
+		if ( options->speed > 0.0 ) printf( " at %.1fx real time.\n\n", options->speed );
+		else printf( " as fast as possible.\n\n" );
+
+		// The schedule is computed from the start of the replay, so errors in the timing of
+		//  individual packets do not accumulate.
+		__int64 start_ticks = PerformanceTicks();
+		// Time since the start of the replay, in recorded seconds, after shortening the gaps.
+		double replay_time = 0.0;
+		double previous_time = 0.0;
+		bool scheduled = false;
+		// Restamped packets are given the current time, advancing with the recorded time.
+		EPMTelemetryHeaderInfo now;
+		setPacketTime( &now );
+		double restamp_origin = (double) EPMtoSeconds( &now );
+
+		// Loop through all of the packets in the file.
+		n_batch = 0;
+		i = first;
+		while ( i < replayIndexEntries ) {
+
+			const ReplayIndexEntry *entry = &replayIndex[i];
+
+			// If it's not an EPM packet we don't send it out.
+			if ( entry->time == 0.0 ) {
+				if ( verbose ) printf( "Bytes: %4u (non EPM).\n", entry->length );
+				i++;
+				continue;
+			}
+
+			// Advance the schedule by the recorded time between this packet and the previous one.
+			// This is done only once per packet, even if the packet has to wait for the next batch.
+			if ( !scheduled ) {
+				if ( verbose ) printf( "Bytes: %4u EPM.\n", entry->length );
+				if ( previous_time != 0.0 ) {
+					double delta_time = entry->time - previous_time;
+					if ( delta_time < 0.0 ) delta_time = 0.0;
+					if ( delta_time > options->max_gap ) delta_time = options->max_gap;
+					replay_time += delta_time;
+				}
+				previous_time = entry->time;
+				scheduled = true;
+			}
+
+			// If it is not a GRIP packet, just show that we are progressing through the packets.
+			if ( entry->subsystemID != GRIP_SUBSYSTEM_ID ) {
+				printf( "." );
+				scheduled = false;
+				i++;
+				continue;
+			}
+
+			// If this packet is not yet due, or the batch is full, send what we have so far.
+			__int64 due = start_ticks + ( options->speed > 0.0 ? SecondsToTicks( replay_time / options->speed ) : 0 );
+			if ( n_batch > 0 && ( n_batch == REPLAY_BATCH_PACKETS || due > PerformanceTicks() ) ) {
+				if ( !SendPacketBatch( socket, batch, n_batch ) ) return( packetCount );
+				n_batch = 0;
+			}
+
+			// Wait until it is time to send the packet.
+			if ( n_batch == 0 && options->speed > 0.0 ) WaitUntil( due );
+
+			// Modify the pre-recorded packet to make it look like it was generated just now,
+			//  unless we were asked to keep the recorded timestamps.
+			if ( options->preserve_time ) {
+				batch[n_batch].buf = (char *) replayData + entry->offset;
+			}
+			else {
+				EPMTelemetryPacket *packet = &restampedPacket[n_batch];
+				memcpy( packet->buffer, replayData + entry->offset, entry->length );
+				ExtractEPMTelemetryHeaderInfo( &epmPacketHeaderInfo, packet );
+				setPacketTimeFromSeconds( &epmPacketHeaderInfo, restamp_origin + replay_time );
+				// Set the packet counter based on a local count.
+				epmPacketHeaderInfo.TMCounter = packetCount;
+				// Put the new header info back into the packet.
+				InsertEPMTelemetryHeaderInfo( packet, &epmPacketHeaderInfo );
+				batch[n_batch].buf = packet->buffer;
+			}
+			batch[n_batch].len = entry->length;
+			n_batch++;
+			packetCount++;
+			if ( verbose ) printf( "G%.3f", replay_time );
+
+			scheduled = false;
+			i++;
+
+		}
+		// If we get a socket error it is probably because the client has closed the connection.
+		if ( !SendPacketBatch( socket, batch, n_batch ) ) return( packetCount );
+
+		printf( "\nPlayback completed: %lu packets in %.1f s.\n", i - first, TicksToSeconds( PerformanceTicks() - start_ticks ) );
+		if ( options->once ) return( packetCount );
+
+		// Sleep to simulate a pause in the experiment execution, then start over again.
+		printf( "Will restart in 10 seconds.\n" );
+		Sleep( 10000 );
+
+	}
+
+}
+
+bool parseReplayOption( ReplayOptions *options, const char *arg ) {
+	if ( !strncmp( arg, "-speed=", strlen( "-speed=" ) ) ) {
+		if ( !strcmp( arg, "-speed=max" ) ) options->speed = 0.0;
+		else sscanf( arg, "-speed=%lf", &options->speed );
+		if ( options->speed > 0.0 && options->speed < REPLAY_MIN_SPEED ) options->speed = REPLAY_MIN_SPEED;
+		if ( options->speed > REPLAY_MAX_SPEED ) options->speed = REPLAY_MAX_SPEED;
+		if ( options->speed < 0.0 ) options->speed = 0.0;
+	}
+	else if ( !strncmp( arg, "-skip=", strlen( "-skip=" ) ) ) sscanf( arg, "-skip=%ld", &options->start_packet );
+	else if ( !strncmp( arg, "-seek=", strlen( "-seek=" ) ) ) sscanf( arg, "-seek=%lf", &options->start_time );
+	else if ( !strncmp( arg, "-maxgap=", strlen( "-maxgap=" ) ) ) sscanf( arg, "-maxgap=%lf", &options->max_gap );
+	else if ( !strcmp( arg, "-keeptime" ) ) options->preserve_time = true;
+	else if ( !strcmp( arg, "-once" ) ) options->once = true;
+	else return( false );
+	return( true );
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Replay of pre-recorded packets.
+
+// The packets are replayed on a schedule computed from their recorded timestamps, scaled by
+//  a speed factor and measured from the start of the replay, so the spacing of the packets
+//  does not drift and two replays of the same file send the same packets in the same order.
+// Long gaps in the recording (LOS, breaks between sessions) are shortened to max_gap seconds.
+// An index of the packets in the file (offset, length and EPM time) is kept next to the file,
+//  in <file>.idx, so that one can start anywhere in the recording without reading through it.
+// The file is mapped into memory and each packet is framed by the length in its header,
+//  so files that mix packets of different lengths replay correctly, and only the bytes
+//  of the packet itself are sent. When packets fall due faster than they can be sent
+//  one by one, they are sent several at a time with a single WSASend().
+
+typedef struct {
+	// Replay speed relative to real time, from 0.1 to 1000. 0 sends as fast as possible.
+	double	speed;
+	// Gaps longer than this, in recorded seconds, are shortened to this value.
+	double	max_gap;
+	// Start at this packet index ...
+	long	start_packet;
+	// ... or at the first packet at or after this EPM time, if not 0.
+	// Values less than REPLAY_RELATIVE_SEEK_LIMIT are seconds from the start of the recording.
+	double	start_time;
+	// Send the packets with their recorded timestamps rather than restamping them with the current time.
+	bool	preserve_time;
+	// Stop after one pass through the file rather than starting over.
+	bool	once;
+} ReplayOptions;
+
+#define REPLAY_DEFAULT_OPTIONS { 1.0, 30.0, 0, 0.0, false, false }
+#define REPLAY_MIN_SPEED	0.1
+#define REPLAY_MAX_SPEED	1000.0
+#define REPLAY_RELATIVE_SEEK_LIMIT	100000000.0
+
+// Send out the packets from the file on the socket. Returns the number of packets sent.
+int sendRecordedPackets( SOCKET socket, const char *PacketSourceFile, const ReplayOptions *options );
+
+// Parse one of the replay command line options. Returns false if the argument is not one of them.
+bool parseReplayOption( ReplayOptions *options, const char *arg );
@@ -0,0 +1,48 @@
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Timing routines shared by the different modes of the CLWS emulator.
+
+#include "stdafx.h"
+
+#include "..\Grip\GripPackets.h"
+#include "CLWSemulatorTiming.h"
+
+// Ticks per second of the performance counter, read the first time that it is needed.
+static LARGE_INTEGER performanceFrequency = { 0 };
+
+static double PerformanceFrequency( void ) {
+	if ( performanceFrequency.QuadPart == 0 ) QueryPerformanceFrequency( &performanceFrequency );
+	return( (double) performanceFrequency.QuadPart );
+}
+
+__int64 PerformanceTicks( void ) {
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter( &ticks );
+	return( ticks.QuadPart );
+}
+
+double TicksToSeconds( __int64 ticks ) {
+	return( (double) ticks / PerformanceFrequency() );
+}
+
+__int64 SecondsToTicks( double seconds ) {
+	return( (__int64) ( seconds * PerformanceFrequency() ) );
+}
+
+// Sleep() for the bulk of the wait, then yield until the exact moment.
+void WaitUntil( __int64 ticks ) {
+	__int64 remaining;
+	while ( ( remaining = ticks - PerformanceTicks() ) > 0 ) {
+		double milliseconds = TicksToSeconds( remaining ) * 1000.0;
+		if ( milliseconds > 2.0 ) Sleep( (DWORD) milliseconds - 1 );
+		else Sleep( 0 );
+	}
+}
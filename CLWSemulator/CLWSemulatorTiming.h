@@ -0,0 +1,26 @@
+#pragma once
+
+///
+/// Module:	CLWSemulator (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Timing routines shared by the different modes of the CLWS emulator.
+
+// The load generator and the time-scaled replay pace the packets with the performance counter,
+//  because Sleep() and _ftime() only have millisecond resolution at best.
+__int64 PerformanceTicks( void );
+double TicksToSeconds( __int64 ticks );
+__int64 SecondsToTicks( double seconds );
+// Wait until the performance counter reaches the specified value.
+void WaitUntil( __int64 ticks );
+
+// Set the time of an EPM telemetry packet to the current time, or to a given time in EPM seconds.
+// Defined in CLWSemulator.cpp.
+void setPacketTime( EPMTelemetryHeaderInfo *header );
+void setPacketTimeFromSeconds( EPMTelemetryHeaderInfo *header, double seconds );
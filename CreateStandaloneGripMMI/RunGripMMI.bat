@@ -101,6 +101,12 @@ set TIMEBASE_CORRECTION=-16
 REM Uncomment the next line if you want to display times aligned with GPS time.
 REM set TIMEBASE_CORRECTION=0
 
+REM Number of hours of data that GripMMI keeps in memory.
+REM With 0, GripMMI reads the whole cache and stops following new data after 12 hours.
+REM For unattended operation over several days, set this to a number of hours (e.g. 6).
+REM Older data is then dropped from memory, but stays in the packet cache in the cache directory.
+set LIVE_TAIL_HOURS=0
+
 REM **************************************************************************
 
 REM Create a common timestamp in the form YYYY.MM.DD to be used in various file names.
@@ -159,7 +165,7 @@ REM start GripGroundMonitor.exe %CacheDir%\%CacheRoot% %ScriptDir%
 REM Start the actual graphical GripMMI.
 REM First parameter is the path to the packet caches that serve as inputs.
 REM Second paramter is the path to the scripts that are installed on board.
-start .\GripMMI.exe %CacheDir%\%CacheRoot% %ScriptDir% %TIMEBASE_CORRECTION%
+start .\GripMMI.exe %CacheDir%\%CacheRoot% %ScriptDir% %TIMEBASE_CORRECTION% %LIVE_TAIL_HOURS%
 
 REM Now create a batch file that will make it easier to restart the graphical
 REM GripMMI.exe interface without restarting GripGroundMonitorClient.exe
@@ -177,4 +183,4 @@ echo REM This batch file can also be used to review previously recorded data >>
 echo REM using the GripMMI graphical interface. >> %restart_file%
 echo REM >> %restart_file%
 echo CD %CD% >> %restart_file%
-echo start .\GripMMI.exe %CacheDir%\%CacheRoot% %ScriptDir% %TIMEBASE_CORRECTION% >> %restart_file%
+echo start .\GripMMI.exe %CacheDir%\%CacheRoot% %ScriptDir% %TIMEBASE_CORRECTION% %LIVE_TAIL_HOURS% >> %restart_file%
@@ -16,6 +16,7 @@
 
 #include "stdafx.h"
 #include "..\Grip\GripPackets.h"
+#include "..\Grip\GripTrace.h"
 #include "..\Useful\fMessageBox.h"
 #include "..\Useful\fOutputDebugString.h"
 #include "..\GripMMIVersionControl\GripMMIVersionControl.h"
@@ -28,6 +29,13 @@ PCSTR EPMport = EPM_DEFAULT_PORT;
 EPMTelemetryPacket epmPacket;
 EPMTelemetryHeaderInfo epmPacketHeaderInfo;
 
+// TCP does not keep the boundaries between the packets sent by the server. A recv() may 
+//  return several packets, or only part of one, so the bytes are gathered here and cut 
+//  into packets according to the length in each transfer frame header.
+#define STREAM_BUFFER_LENGTH	(32 * EPM_BUFFER_LENGTH)
+char streamBuffer[STREAM_BUFFER_LENGTH];
+int  streamBytes = 0;
+
 // Buffers to hold the paths to the various packet caches.
 // These will be initialized according to today's date, etc.
 char rtPacketCacheFilePath[1024];
@@ -63,7 +71,7 @@ void outputPacket( const EPMTelemetryPacket *packet, const int n_bytes, const ch
 		exit( return_code );
 	}
 	bytes_written = _write( fid, packet, n_bytes );
-	if ( bytes_written != n_bytes ) {
+	if ( bytes_written != (size_t) n_bytes ) {
 		fMessageBox( MB_OK, "GripGroundMonitorClient", "Error writing to %s.", filename  );
 		exit( -1 );
 	}
@@ -97,6 +105,123 @@ void outputANY ( EPMTelemetryPacket *packet ) {
 	anyCount++;
 }
 
+// Process one complete packet that has been copied into epmPacket.
+void processPacket( int n_bytes, bool cache_all ) {
+
+	// Get the EPM header info, so as to trace the arrival of GRIP packets before any time
+	//  is spent writing them to the cache files.
+	ExtractEPMTelemetryHeaderInfo( &epmPacketHeaderInfo, &epmPacket );
+	if ( epmPacketHeaderInfo.epmSyncMarker == EPM_TELEMETRY_SYNC_VALUE && epmPacketHeaderInfo.subsystemID == GRIP_SUBSYSTEM_ID ) {
+		GripTrace( TRACE_RECEIVE, epmPacketHeaderInfo.TMCounter );
+	}
+
+	// Unless inhibited by the -only command line flag, write all packets 
+	//  to the .any.gpk cache file, regardless of type.
+	if ( cache_all ) outputANY( &epmPacket );
+	
+	// Now process the packet according to the type.
+	// First check for the EPM sync words and discard if not valid.
+	if ( epmPacketHeaderInfo.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE ) {
+		if ( verbose ) printf( "Bytes: %4d (non EPM).\n", n_bytes ); 
+	}
+	else {
+		// Check that the packet came from GRIP.
+		if ( epmPacketHeaderInfo.subsystemID != GRIP_SUBSYSTEM_ID ) {
+			if ( verbose ) printf( "Bytes: %4d %4d %4d %02x:%02x:%02x TM: 0x%04x %06d (non GRIP).\n",
+
+				n_bytes, 
+				epmPacketHeaderInfo.transferFrameInfo.numberOfWords * 2, 
+				epmPacketHeaderInfo.numberOfWords * 2, 
+
+				epmPacketHeaderInfo.transferFrameInfo.softwareUnitID,
+				epmPacketHeaderInfo.subsystemID, 
+				epmPacketHeaderInfo.subsystemUnitID, 
+
+				epmPacketHeaderInfo.TMIdentifier, 
+				epmPacketHeaderInfo.TMCounter
+				);
+		}
+		else {
+			printf( "Bytes: %4d %4d %4d %02x:%02x:%02x TM: 0x%04x %06d",
+				
+				n_bytes,													// Actual # bytes in the packet, as cut from the stream.
+				epmPacketHeaderInfo.transferFrameInfo.numberOfWords * 2,	// Bytes supposedly received according to transfer frame header.
+				epmPacketHeaderInfo.numberOfWords * 2,						// Bytes supposedly recieved according to the EPM Telemetry packet, excluding transfer frame info.  
+				
+				epmPacketHeaderInfo.transferFrameInfo.softwareUnitID,
+				epmPacketHeaderInfo.subsystemID, 
+				epmPacketHeaderInfo.subsystemUnitID, 
+				
+				epmPacketHeaderInfo.TMIdentifier,
+				epmPacketHeaderInfo.TMCounter
+			);
+			// Then check the type of EPM packet and sort into appropriate cache files.
+			// We are only concerned with two packet types: 
+			//   0x0301 for housekeeping data and 0x1001 for realtime science data.
+			switch ( epmPacketHeaderInfo.TMIdentifier ) {
+
+			case GRIP_HK_ID:
+				printf( " HK   \n" );
+				outputHK( &epmPacket );
+				GripTrace( TRACE_CACHE_WRITE, epmPacketHeaderInfo.TMCounter );
+				break;
+
+			case GRIP_RT_ID:
+				printf( "    RT\n" );
+				outputRT( &epmPacket );
+				GripTrace( TRACE_CACHE_WRITE, epmPacketHeaderInfo.TMCounter );
+				break;
+
+			default:
+				// It would be surprising to get here as it would
+				//  mean that GRIP sent an unexpected packet type.
+				printf( " ??????\n" );
+				break;
+
+			}
+		}
+	}
+
+}
+
+// Check for the transfer frame sync marker, which is sent most significant byte first.
+#define SYNC_MARKER_BYTES	4
+static bool isTransferFrame( const unsigned char *data ) {
+	return( ( ( (unsigned long) data[0] << 24 ) | ( (unsigned long) data[1] << 16 ) | ( (unsigned long) data[2] << 8 ) | data[3] ) == EPM_TRANSFER_FRAME_SYNC_VALUE );
+}
+
+// Cut the bytes gathered in streamBuffer into packets and process each one.
+// The bytes of a packet that is not yet complete are moved to the start of the buffer
+//  so that the next recv() can complete it.
+void processStream( bool cache_all ) {
+
+	int used = 0;
+	int available;
+	int length;
+	int skip;
+
+	while ( ( available = streamBytes - used ) >= SYNC_MARKER_BYTES ) {
+		const unsigned char *data = (const unsigned char *) streamBuffer + used;
+		// If we have lost sync, skip ahead to the next sync marker. The last few bytes
+		//  are kept, as they may be the start of a marker that is not yet complete.
+		if ( !isTransferFrame( data ) ) {
+			for ( skip = 1; skip + SYNC_MARKER_BYTES <= available && !isTransferFrame( data + skip ); skip++ );
+			if ( verbose ) printf( "Bytes: %4d (non EPM).\n", skip );
+			used += skip;
+			continue;
+		}
+		length = EPMPacketLength( data, available );
+		if ( length == 0 || length > available ) break;
+		memcpy( epmPacket.buffer, data, length );
+		memset( epmPacket.buffer + length, 0, EPM_BUFFER_LENGTH - length );
+		processPacket( length, cache_all );
+		used += length;
+	}
+	memmove( streamBuffer, streamBuffer + used, streamBytes - used );
+	streamBytes -= used;
+
+}
+
 // The main routine, taking arguments from the command line.
 int __cdecl main(int argc, const char **argv) 
 {
@@ -116,6 +241,9 @@ int __cdecl main(int argc, const char **argv)
 	bool	cache_all = true;
 	bool	use_alt_id = false;
 	int		software_unit_id = GRIP_MMI_SOFTWARE_UNIT_ID;
+	// The connect and alive packets of GripPackets.h, with the Software Unit ID that we use.
+	EPMTransferFrameHeaderInfo connect_header = connectPacket;
+	EPMTransferFrameHeaderInfo alive_header = alivePacket;
 
 	const char *packetCacheFilenameRoot = NULL;
 	const char *server_name = NULL;
@@ -178,8 +306,11 @@ int __cdecl main(int argc, const char **argv)
 		printf( "Using alternate Software Unit ID.\n" );
 	}
 	printf( "Software Unit ID: %d\n", software_unit_id );
-	connectPacket.softwareUnitID = software_unit_id;
-	alivePacket.softwareUnitID = software_unit_id;
+	connect_header.softwareUnitID = software_unit_id;
+	alive_header.softwareUnitID = software_unit_id;
+
+	// Record the arrival of each packet and when it is cached, if tracing is enabled. See GripTrace.h.
+	GripTraceOpen( "DexGroundMonitorClient" );
 
 	printf( "\n" );
 
@@ -213,7 +344,7 @@ int __cdecl main(int argc, const char **argv)
 			// Create a SOCKET for connecting to server
 			ConnectSocket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
 			if (ConnectSocket == INVALID_SOCKET) {
-				printf("socket failed with error: %ld\n", WSAGetLastError());
+				printf("socket failed with error: %ld\n", (long) WSAGetLastError());
 				WSACleanup();
  				printf( "Unrecoverable error. Press <Return> to exit.\n" );
 				getchar();
@@ -240,10 +371,10 @@ int __cdecl main(int argc, const char **argv)
 	}
 
 	// We have a connection. Send the EPM 'connect' command to start flow of packets.
-	// The packet connectPacket is a global define by GripPackets.h.
+	// The packet connectPacket is a global define by GripPackets.h. We send a copy with our Software Unit ID.
 	printf( "\nConnection established with server.\n" );
 	printf( "Sending EPM Connect command.\n" );
-	InsertEPMTransferFrameHeaderInfo( &epmPacket, &connectPacket );
+	InsertEPMTransferFrameHeaderInfo( &epmPacket, &connect_header );
 	iResult = send( ConnectSocket, epmPacket.buffer, connectPacketLengthInBytes, 0 );
 	// If we get a socket error it is probably because the client has closed the connection.
 	// So we break out of the loop.
@@ -287,83 +418,12 @@ int __cdecl main(int argc, const char **argv)
 
 		if ( _debug ) printf( "Entering recv() #%03d ... ", recv_counter++ );
 		fflush( stdout );
-        iResult = recv(ConnectSocket, epmPacket.buffer, EPM_BUFFER_LENGTH, 0);
+        iResult = recv(ConnectSocket, streamBuffer + streamBytes, STREAM_BUFFER_LENGTH - streamBytes, 0);
 		if ( _debug) printf( "returned.\n" );
 
-		if ( iResult == EPM_BUFFER_LENGTH ) {
-
-			// If we get a full buffer of data, it probably means that we have fallen behind.
-			// No packets that we expect from GRIP should use the full EPM buffer length.
-			// So just skip this packet and move on to the next.
-            printf("Bytes: %4d - flushing (overrun).\n", iResult);
-		}
-        else if ( iResult > 0 ) {
-
-			// Unless inhibited by the -only command line flag, write all packets 
-			//  to the .any.gpk cache file, regardless of type.
-			if ( cache_all ) outputANY( &epmPacket );
-			
-			// Now get the EPM header info and process the packet according to the type.
-			// First check for the EPM sync words and discard if not valid.
-			ExtractEPMTelemetryHeaderInfo( &epmPacketHeaderInfo, &epmPacket );
-			if ( epmPacketHeaderInfo.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE ) {
-				if ( verbose ) printf( "Bytes: %4d (non EPM).\n", iResult ); 
-			}
-			else {
-				// Check that the packet came from GRIP.
-				if ( epmPacketHeaderInfo.subsystemID != GRIP_SUBSYSTEM_ID ) {
-					if ( verbose ) printf( "Bytes: %4d %4d %4d %02x:%02x:%02x TM: 0x%04x %06d (non GRIP).\n",
-
-						iResult, 
-						epmPacketHeaderInfo.transferFrameInfo.numberOfWords * 2, 
-						epmPacketHeaderInfo.numberOfWords * 2, 
-
-						epmPacketHeaderInfo.transferFrameInfo.softwareUnitID,
-						epmPacketHeaderInfo.subsystemID, 
-						epmPacketHeaderInfo.subsystemUnitID, 
-
-						epmPacketHeaderInfo.TMIdentifier, 
-						epmPacketHeaderInfo.TMCounter
-						);
-				}
-				else {
-					printf( "Bytes: %4d %4d %4d %02x:%02x:%02x TM: 0x%04x %06d",
-						
-						iResult,													// Actual # bytes received.
-						epmPacketHeaderInfo.transferFrameInfo.numberOfWords * 2,	// Bytes supposedly received according to transfer frame header.
-						epmPacketHeaderInfo.numberOfWords * 2,						// Bytes supposedly recieved according to the EPM Telemetry packet, excluding transfer frame info.  
-						
-						epmPacketHeaderInfo.transferFrameInfo.softwareUnitID,
-						epmPacketHeaderInfo.subsystemID, 
-						epmPacketHeaderInfo.subsystemUnitID, 
-						
-						epmPacketHeaderInfo.TMIdentifier,
-						epmPacketHeaderInfo.TMCounter
-					);
-					// Then check the type of EPM packet and sort into appropriate cache files.
-					// We are only concerned with two packet types: 
-					//   0x0301 for housekeeping data and 0x1001 for realtime science data.
-					switch ( epmPacketHeaderInfo.TMIdentifier ) {
-
-					case GRIP_HK_ID:
-						printf( " HK   \n" );
-						outputHK( &epmPacket );
-						break;
-
-					case GRIP_RT_ID:
-						printf( "    RT\n" );
-						outputRT( &epmPacket );
-						break;
-
-					default:
-						// It would be surprising to get here as it would
-						//  mean that GRIP sent an unexpected packet type.
-						printf( " ??????\n" );
-						break;
-
-					}
-				}
-			}
+		if ( iResult > 0 ) {
+			streamBytes += iResult;
+			processStream( cache_all );
 		}
 		else if ( iResult == 0 ) printf( "Socket closed.\n" );
 		else printf( "Socket error.\n" );
@@ -376,7 +436,7 @@ int __cdecl main(int argc, const char **argv)
 				static int alive_counter = 0;
 				previous_alive_time = utctime.time;
 				// printf( "Sending Alive command.\n" );
-				InsertEPMTransferFrameHeaderInfo( &epmPacket, &alivePacket );
+				InsertEPMTransferFrameHeaderInfo( &epmPacket, &alive_header );
 				if ( _debug ) printf( "Entering send() #%03d ... ", alive_counter++ );
 				iResult2 = send( ConnectSocket, epmPacket.buffer, alivePacketLengthInBytes, 0 );
 				if ( _debug ) printf( "returned.\n" );
@@ -57,6 +57,7 @@ DexAnalogMixin::DexAnalogMixin( void ) {
 	CopyVector( filteredAcceleration, zeroVector );
 	for (int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) CopyVector( filteredCoP[ati], zeroVector );
 	filteredGripForce = 0.0;
+	for (int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) filteredNormalForce[ati] = 0.0;
 
 }
 
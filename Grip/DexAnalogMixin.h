@@ -8,6 +8,7 @@
 #pragma once
 
 #include "..\Useful\VectorsMixin.h"
+#include "DexFilters.h"
 
 #define N_FORCE_TRANSDUCERS		2
 #define DEFAULT_COP_THRESHOLD	0.25
@@ -72,4 +73,9 @@ public:
 	double FilterNormalForce( double normal_force, int ati );
 	double FilterAcceleration( Vector3 acceleration );
 
+	// Block filtering of whole columns of data, as opposed to the recursive filters above.
+	// This is used to filter the history plots with zero-phase filters.
+	// By default no block filtering is performed.
+	DexFilter	historyFilter;
+
 };
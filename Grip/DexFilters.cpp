@@ -0,0 +1,394 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                 DexFilters.cpp                                */
+/*                                                                               */
+/*********************************************************************************/
+
+// Block filtering of columns of Dex (Grip) data.
+// Copyright (c) 2015 PsyPhy Consulting. All rights reserved.
+
+// These filters complement the recursive, sample-by-sample filters in DexAnalogMixin.
+// They operate on a block of samples at a time, which means that they can look ahead
+//  as well as behind and so can be made zero-phase. That is what one wants when looking
+//  at the timing of grip force with respect to load force in the history plots.
+
+#include <windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\Useful.h"
+
+#include "DexFilters.h"
+
+/***************************************************************************/
+
+DexFilter::DexFilter( void ) {
+	filterType = DEX_FILTER_NONE;
+	sampleRate = DEFAULT_FILTER_SAMPLE_RATE;
+	cutoffFrequency = DEFAULT_BUTTERWORTH_CUTOFF;
+	butterworthOrder = DEFAULT_BUTTERWORTH_ORDER;
+	window = DEFAULT_FILTER_WINDOW;
+	polynomialOrder = DEFAULT_SAVITZKY_GOLAY_ORDER;
+	zeroPhase = true;
+	coefficientsValid = false;
+	nSections = 0;
+	scratch = NULL;
+	scratchLength = 0;
+}
+
+DexFilter::~DexFilter( void ) {
+	if ( scratch ) free( scratch );
+}
+
+/***************************************************************************/
+
+// Setting the parameters just records the new values.
+// The coefficients get recomputed the next time that the filter is applied.
+
+void DexFilter::SetNone( void ) {
+	filterType = DEX_FILTER_NONE;
+	coefficientsValid = false;
+}
+
+void DexFilter::SetButterworth( double cutoff, int order ) {
+	filterType = DEX_FILTER_BUTTERWORTH;
+	cutoffFrequency = cutoff;
+	// The filter is built from second order sections, so the order must be even.
+	if ( order < 2 ) order = 2;
+	if ( order > MAX_BUTTERWORTH_ORDER ) order = MAX_BUTTERWORTH_ORDER;
+	butterworthOrder = order + ( order % 2 );
+	coefficientsValid = false;
+}
+
+void DexFilter::SetMovingAverage( int samples ) {
+	filterType = DEX_FILTER_MOVING_AVERAGE;
+	// A centered window has to have an odd number of samples.
+	if ( samples < 1 ) samples = 1;
+	if ( samples > MAX_FILTER_WINDOW ) samples = MAX_FILTER_WINDOW;
+	window = samples | 0x01;
+	coefficientsValid = false;
+}
+
+void DexFilter::SetSavitzkyGolay( int samples, int order ) {
+	filterType = DEX_FILTER_SAVITZKY_GOLAY;
+	if ( samples < 3 ) samples = 3;
+	if ( samples > MAX_FILTER_WINDOW ) samples = MAX_FILTER_WINDOW;
+	window = samples | 0x01;
+	// The polynomial has to have fewer coefficients than there are points in the window.
+	if ( order < 0 ) order = 0;
+	if ( order > MAX_SAVITZKY_GOLAY_ORDER ) order = MAX_SAVITZKY_GOLAY_ORDER;
+	if ( order > window - 1 ) order = window - 1;
+	polynomialOrder = order;
+	coefficientsValid = false;
+}
+
+void DexFilter::SetSampleRate( double rate ) {
+	sampleRate = rate;
+	coefficientsValid = false;
+}
+
+void DexFilter::SetZeroPhase( bool zero_phase ) {
+	zeroPhase = zero_phase;
+	coefficientsValid = false;
+}
+
+bool DexFilter::Enabled( void ) {
+	return( filterType != DEX_FILTER_NONE );
+}
+
+DexFilterType DexFilter::GetType( void ) {
+	return( filterType );
+}
+
+/***************************************************************************/
+
+// Parse a filter specification of the form type[:param[:param]][:causal].
+//  "none"				no block filtering
+//  "butter:4:2"		Butterworth low-pass, cutoff in Hz and order
+//  "avg:9"				moving average, window in samples
+//  "sg:11:3"			Savitzky-Golay, window in samples and polynomial order
+// Omitted parameters take the default values.
+
+bool DexFilter::Configure( const char *specification ) {
+
+	char	name[32];
+	double	p1 = 0.0, p2 = 0.0;
+	int		n;
+	bool	causal = false;
+
+	// Strip off the causal flag, if present.
+	const char *flag = strstr( specification, ":causal" );
+	if ( flag ) causal = true;
+
+	n = sscanf( specification, " %31[^:]:%lf:%lf", name, &p1, &p2 );
+	if ( n < 1 ) return( false );
+
+	if ( !_stricmp( name, "none" ) ) SetNone();
+	else if ( !_stricmp( name, "butter" ) ) SetButterworth( n > 1 ? p1 : DEFAULT_BUTTERWORTH_CUTOFF, n > 2 ? (int) p2 : DEFAULT_BUTTERWORTH_ORDER );
+	else if ( !_stricmp( name, "avg" ) ) SetMovingAverage( n > 1 ? (int) p1 : DEFAULT_FILTER_WINDOW );
+	else if ( !_stricmp( name, "sg" ) ) SetSavitzkyGolay( n > 1 ? (int) p1 : DEFAULT_FILTER_WINDOW, n > 2 ? (int) p2 : DEFAULT_SAVITZKY_GOLAY_ORDER );
+	else return( false );
+
+	// A cutoff at or above the Nyquist frequency makes no sense.
+	if ( filterType == DEX_FILTER_BUTTERWORTH && ( cutoffFrequency <= 0.0 || cutoffFrequency >= sampleRate / 2.0 ) ) {
+		SetNone();
+		return( false );
+	}
+
+	SetZeroPhase( !causal );
+	return( true );
+
+}
+
+/***************************************************************************/
+
+void DexFilter::ComputeCoefficients( void ) {
+	if ( filterType == DEX_FILTER_BUTTERWORTH ) ComputeButterworth();
+	else if ( filterType == DEX_FILTER_SAVITZKY_GOLAY ) ComputeSavitzkyGolay();
+	coefficientsValid = true;
+}
+
+// Butterworth low-pass as a cascade of biquads, computed with the bilinear transform.
+// Each section corresponds to a pair of conjugate poles of the analog prototype.
+// Note that when run forward and backward, the order is doubled and the
+//  attenuation at the cutoff frequency is -6 dB rather than -3 dB.
+void DexFilter::ComputeButterworth( void ) {
+
+	double w0 = 2.0 * Pi * cutoffFrequency / sampleRate;
+	double cs = cos( w0 );
+	double sn = sin( w0 );
+
+	nSections = butterworthOrder / 2;
+	for ( int k = 0; k < nSections; k++ ) {
+		double q = 1.0 / ( 2.0 * cos( Pi * ( 2.0 * k + 1.0 ) / ( 2.0 * butterworthOrder ) ) );
+		double alpha = sn / ( 2.0 * q );
+		double a0 = 1.0 + alpha;
+		section[k].b0 = ( 1.0 - cs ) / 2.0 / a0;
+		section[k].b1 = ( 1.0 - cs ) / a0;
+		section[k].b2 = section[k].b0;
+		section[k].a1 = -2.0 * cs / a0;
+		section[k].a2 = ( 1.0 - alpha ) / a0;
+	}
+}
+
+// Savitzky-Golay weights for a least-squares polynomial fit over the window.
+// Row t of the table gives the weights that evaluate the fitted polynomial at
+//  sample t of the window. Abscissas are normalized to [-1, 1] to keep the
+//  normal equations well conditioned for the larger windows.
+void DexFilter::ComputeSavitzkyGolay( void ) {
+
+	double	normal[MAX_SAVITZKY_GOLAY_ORDER + 1][2 * ( MAX_SAVITZKY_GOLAY_ORDER + 1 )];
+	double	power[MAX_SAVITZKY_GOLAY_ORDER + 1];
+	int		m = window / 2;
+	int		terms = polynomialOrder + 1;
+	int		r, c, j, t;
+
+	// Build the normal equations ( J'J ), augmented with the identity matrix.
+	for ( r = 0; r < terms; r++ ) {
+		for ( c = 0; c < terms; c++ ) {
+			normal[r][c] = 0.0;
+			for ( j = 0; j < window; j++ ) normal[r][c] += pow( (double) ( j - m ) / m, r + c );
+			normal[r][terms + c] = ( r == c ? 1.0 : 0.0 );
+		}
+	}
+
+	// Invert by Gauss-Jordan elimination with partial pivoting.
+	for ( c = 0; c < terms; c++ ) {
+		int pivot = c;
+		for ( r = c + 1; r < terms; r++ ) if ( fabs( normal[r][c] ) > fabs( normal[pivot][c] ) ) pivot = r;
+		if ( pivot != c ) {
+			for ( j = 0; j < 2 * terms; j++ ) {
+				double tmp = normal[c][j];
+				normal[c][j] = normal[pivot][j];
+				normal[pivot][j] = tmp;
+			}
+		}
+		double diagonal = normal[c][c];
+		for ( j = 0; j < 2 * terms; j++ ) normal[c][j] /= diagonal;
+		for ( r = 0; r < terms; r++ ) {
+			if ( r == c ) continue;
+			double factor = normal[r][c];
+			for ( j = 0; j < 2 * terms; j++ ) normal[r][j] -= factor * normal[c][j];
+		}
+	}
+
+	// Weight of sample j when evaluating at position t is e(t)' inv( J'J ) J(j)'.
+	for ( t = 0; t < window; t++ ) {
+		double u = (double) ( t - m ) / m;
+		for ( r = 0; r < terms; r++ ) power[r] = pow( u, r );
+		for ( j = 0; j < window; j++ ) {
+			double x = (double) ( j - m ) / m;
+			double weight = 0.0;
+			for ( r = 0; r < terms; r++ ) {
+				for ( c = 0; c < terms; c++ ) weight += power[r] * normal[r][terms + c] * pow( x, c );
+			}
+			savitzkyGolay[t][j] = weight;
+		}
+	}
+}
+
+/***************************************************************************/
+
+// Make sure that there is enough scratch space and return a pointer to it.
+double *DexFilter::Scratch( int length ) {
+	if ( length > scratchLength ) {
+		double *buffer = (double *) realloc( scratch, length * sizeof( *scratch ) );
+		if ( !buffer ) {
+			fMessageBox( MB_OK, "Grip", "Error allocating %d samples for DexFilter.", length );
+			exit( -1 );
+		}
+		scratch = buffer;
+		scratchLength = length;
+	}
+	return( scratch );
+}
+
+// Run the cascade of biquads over a contiguous run of samples, in place.
+// The state of each section is initialized to the steady state for the first
+//  sample, so that the output does not ring at the start of each run.
+void DexFilter::ButterworthRun( double *data, int n ) {
+
+	int i, k;
+	double y, z1, z2;
+
+	for ( k = 0; k < nSections; k++ ) {
+		DexBiquad *s = &section[k];
+		z2 = data[0] * ( s->b2 - s->a2 );
+		z1 = data[0] * ( s->b1 - s->a1 ) + z2;
+		for ( i = 0; i < n; i++ ) {
+			y = s->b0 * data[i] + z1;
+			z1 = s->b1 * data[i] - s->a1 * y + z2;
+			z2 = s->b2 * data[i] - s->a2 * y;
+			data[i] = y;
+		}
+	}
+	if ( !zeroPhase ) return;
+
+	// Same thing in reverse to cancel the phase lag.
+	for ( k = 0; k < nSections; k++ ) {
+		DexBiquad *s = &section[k];
+		z2 = data[n-1] * ( s->b2 - s->a2 );
+		z1 = data[n-1] * ( s->b1 - s->a1 ) + z2;
+		for ( i = n - 1; i >= 0; i-- ) {
+			y = s->b0 * data[i] + z1;
+			z1 = s->b1 * data[i] - s->a1 * y + z2;
+			z2 = s->b2 * data[i] - s->a2 * y;
+			data[i] = y;
+		}
+	}
+}
+
+// Moving average with a running sum. The window shrinks at the ends of a run
+//  rather than reaching into missing data.
+void DexFilter::MovingAverageRun( double *result, const double *data, int n ) {
+
+	int half = window / 2;
+	int lo = 0, hi = -1;
+	double sum = 0.0;
+
+	for ( int i = 0; i < n; i++ ) {
+		int new_lo, new_hi;
+		if ( zeroPhase ) {
+			new_lo = i - half;
+			new_hi = i + half;
+		}
+		else {
+			new_lo = i - window + 1;
+			new_hi = i;
+		}
+		if ( new_lo < 0 ) new_lo = 0;
+		if ( new_hi > n - 1 ) new_hi = n - 1;
+		while ( hi < new_hi ) sum += data[++hi];
+		while ( lo < new_lo ) sum -= data[lo++];
+		result[i] = sum / ( hi - lo + 1 );
+	}
+}
+
+// Savitzky-Golay smoothing. Near the ends of a run the window is held against
+//  the end and the polynomial is evaluated off-center, using the appropriate
+//  row of the table of weights.
+void DexFilter::SavitzkyGolayRun( double *result, const double *data, int n ) {
+
+	int m = window / 2;
+	int first, t;
+
+	// Not enough samples to fit the polynomial. Fall back on a simple average.
+	if ( n < window ) {
+		MovingAverageRun( result, data, n );
+		return;
+	}
+
+	for ( int i = 0; i < n; i++ ) {
+		if ( zeroPhase ) {
+			if ( i < m ) first = 0;
+			else if ( i > n - 1 - m ) first = n - window;
+			else first = i - m;
+		}
+		else {
+			if ( i < window - 1 ) first = 0;
+			else first = i - window + 1;
+		}
+		t = i - first;
+		double sum = 0.0;
+		const double *weight = savitzkyGolay[t];
+		const double *sample = data + first;
+		for ( int j = 0; j < window; j++ ) sum += weight[j] * sample[j];
+		result[i] = sum;
+	}
+}
+
+/***************************************************************************/
+
+void DexFilter::Apply( double *output, unsigned output_size,
+					   const double *input, unsigned input_size,
+					   int start, int end, double na ) {
+
+	int i, j, n, first;
+	double *run, *result;
+
+	if ( !coefficientsValid ) ComputeCoefficients();
+
+	i = start;
+	while ( i <= end ) {
+
+		// Missing samples are passed through.
+		const double *pt = (const double *)(((const char *) input) + i * input_size);
+		if ( *pt == na || filterType == DEX_FILTER_NONE ) {
+			*(double *)(((char *) output) + i * output_size) = *pt;
+			i++;
+			continue;
+		}
+
+		// Find the extent of the run of valid samples.
+		first = i;
+		while ( i <= end && *(const double *)(((const char *) input) + i * input_size) != na ) i++;
+		n = i - first;
+
+		// Gather the run into contiguous memory, filter it and scatter the result.
+		run = Scratch( 2 * n );
+		result = run + n;
+		for ( j = 0; j < n; j++ ) run[j] = *(const double *)(((const char *) input) + ( first + j ) * input_size);
+
+		switch ( filterType ) {
+		case DEX_FILTER_BUTTERWORTH:
+			ButterworthRun( run, n );
+			result = run;
+			break;
+		case DEX_FILTER_MOVING_AVERAGE:
+			MovingAverageRun( result, run, n );
+			break;
+		case DEX_FILTER_SAVITZKY_GOLAY:
+			SavitzkyGolayRun( result, run, n );
+			break;
+		default:
+			result = run;
+			break;
+		}
+
+		for ( j = 0; j < n; j++ ) *(double *)(((char *) output) + ( first + j ) * output_size) = result[j];
+	}
+}
@@ -0,0 +1,110 @@
+/********************************************************************************/
+
+//
+// DexFilters.h
+// Block filtering of columns of Dex (Grip) data.
+//
+
+// The recursive filters in DexAnalogMixin are applied one sample at a time as the data
+//  comes in. They are cheap, but they introduce a phase lag that delays peaks in the
+//  filtered signals. The filters defined here are applied to a whole block of samples
+//  at once, typically the frames that are about to be plotted. This allows one to run
+//  the filter forward and then backward over the data to cancel the phase lag.
+
+#pragma once
+
+#include "..\Useful\Useful.h"
+
+// The GRIP realtime data comes in at 20 Hz.
+#define DEFAULT_FILTER_SAMPLE_RATE	20.0
+
+#define DEFAULT_BUTTERWORTH_CUTOFF	4.0
+#define DEFAULT_BUTTERWORTH_ORDER	2
+#define MAX_BUTTERWORTH_ORDER		8
+#define MAX_BIQUAD_SECTIONS			(MAX_BUTTERWORTH_ORDER / 2)
+
+#define DEFAULT_FILTER_WINDOW		9
+#define MAX_FILTER_WINDOW			63
+#define DEFAULT_SAVITZKY_GOLAY_ORDER	2
+#define MAX_SAVITZKY_GOLAY_ORDER	6
+
+typedef enum {
+	DEX_FILTER_NONE = 0,
+	DEX_FILTER_BUTTERWORTH,
+	DEX_FILTER_MOVING_AVERAGE,
+	DEX_FILTER_SAVITZKY_GOLAY
+} DexFilterType;
+
+// Coefficients of one second-order section, in transposed direct form II.
+typedef struct {
+	double b0, b1, b2;
+	double a1, a2;
+} DexBiquad;
+
+class DexFilter {
+
+private:
+
+	DexFilterType	filterType;
+	double			sampleRate;
+	double			cutoffFrequency;
+	int				butterworthOrder;
+	int				window;
+	int				polynomialOrder;
+	bool			zeroPhase;
+
+	// Coefficients are computed only when the parameters change,
+	//  so that the filter can be applied on every repaint.
+	bool			coefficientsValid;
+	int				nSections;
+	DexBiquad		section[MAX_BIQUAD_SECTIONS];
+	// One row of Savitzky-Golay weights for each position within the window.
+	// Row m (the center) is used in the body of the data. The other rows
+	//  allow the polynomial fit to be evaluated near the ends of a run.
+	double			savitzkyGolay[MAX_FILTER_WINDOW][MAX_FILTER_WINDOW];
+
+	// Scratch space used to hold a contiguous copy of each run of valid samples.
+	double			*scratch;
+	int				scratchLength;
+
+	void ComputeCoefficients( void );
+	void ComputeButterworth( void );
+	void ComputeSavitzkyGolay( void );
+	double *Scratch( int length );
+
+	void ButterworthRun( double *data, int n );
+	void MovingAverageRun( double *result, const double *data, int n );
+	void SavitzkyGolayRun( double *result, const double *data, int n );
+
+public:
+
+	DexFilter( void );
+	~DexFilter( void );
+
+	void SetNone( void );
+	void SetButterworth( double cutoff = DEFAULT_BUTTERWORTH_CUTOFF, int order = DEFAULT_BUTTERWORTH_ORDER );
+	void SetMovingAverage( int samples = DEFAULT_FILTER_WINDOW );
+	void SetSavitzkyGolay( int samples = DEFAULT_FILTER_WINDOW, int order = DEFAULT_SAVITZKY_GOLAY_ORDER );
+	void SetSampleRate( double rate = DEFAULT_FILTER_SAMPLE_RATE );
+	// When zero-phase is selected (the default) the IIR filters are run forward
+	//  and then backward, and the FIR filters use a centered window. Otherwise
+	//  the filters are causal, like the recursive filters in DexAnalogMixin.
+	void SetZeroPhase( bool zero_phase = true );
+
+	// Configure from a short text specification, e.g. "butter:4", "butter:4:4",
+	//  "avg:9" or "sg:11:3". Append ":causal" to turn off zero-phase filtering.
+	// Returns false if the specification is not recognized.
+	bool Configure( const char *specification );
+	bool Enabled( void );
+	DexFilterType GetType( void );
+
+	// Filter the samples start through end (inclusive) of a column of doubles.
+	// As for the plotting routines, size is the number of bytes between
+	//  successive samples, so that components of vector arrays can be filtered directly.
+	// Samples equal to na are left as is and break the data into separate runs
+	//  that are filtered independently. Input and output may be the same column.
+	void Apply( double *output, unsigned output_size,
+				const double *input, unsigned input_size,
+				int start, int end, double na = MISSING_DOUBLE );
+
+};
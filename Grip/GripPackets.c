@@ -30,6 +30,10 @@
 // because the packets are encoded in ESA-specified byte order, while
 // Windows / Intel use a different byte order.
 
+// The longs in the packets are 4 bytes. A long is 4 bytes with Visual C++, but 8 bytes
+//  with gcc on 64-bit Linux, so the byte-level routines work with ints, which are 4 bytes on both.
+#define PACKET_LONG_BYTES	4
+
 unsigned short swapbytes_short( unsigned short input ) {
 	union {
 		unsigned short value;
@@ -43,10 +47,10 @@ unsigned short swapbytes_short( unsigned short input ) {
 
 unsigned long swapbytes_long( unsigned long input ) {
 	union {
-		unsigned long value;
+		unsigned int value;
 		unsigned char  byte[4];
 	} in, out;
-	in.value = input;
+	in.value = (unsigned int) input;
 	out.byte[0] = in.byte[3];
 	out.byte[1] = in.byte[2];
 	out.byte[2] = in.byte[1];
@@ -80,7 +84,20 @@ short extract_reversed_short( const unsigned char bytes[2] ) {
 
 long extract_reversed_long( const unsigned char bytes[4] ) {
 	union {
-		long			value;
+		int				value;
+		unsigned char	byte[4];
+	} out;
+	out.byte[0] = bytes[3];
+	out.byte[1] = bytes[2];
+	out.byte[2] = bytes[1];
+	out.byte[3] = bytes[0];
+	return( out.value );
+}
+
+// Unsigned longs must not be sign extended when a long is more than 4 bytes.
+unsigned long extract_reversed_ulong( const unsigned char bytes[4] ) {
+	union {
+		unsigned int	value;
 		unsigned char	byte[4];
 	} out;
 	out.byte[0] = bytes[3];
@@ -109,14 +126,15 @@ float extract_reversed_float( const unsigned char bytes[4] ) {
 // 'if' or 'for' statement, i.e. "for ( i = X; i <= Z; i++ ) position[i] = ExtractShort( ptr );"
 #define ExtractShort( ptr ) extract_short( ptr ), ptr += sizeof( short ) 
 #define ExtractReversedShort( ptr ) extract_reversed_short( ptr ), ptr += sizeof( short ) 
-#define ExtractReversedLong( ptr ) extract_reversed_long( ptr ), ptr += sizeof( long ) 
+#define ExtractReversedLong( ptr ) extract_reversed_long( ptr ), ptr += PACKET_LONG_BYTES 
+#define ExtractReversedULong( ptr ) extract_reversed_ulong( ptr ), ptr += PACKET_LONG_BYTES 
 #define ExtractReversedFloat( ptr ) extract_reversed_float( ptr ), ptr += sizeof( float ) 
 #define ExtractChar( ptr ) (*ptr++)
 
 union {
 	float	float_value;
-	long	long_value;
-	unsigned long	ulong_value;
+	int		long_value;
+	unsigned int	ulong_value;
 	short	short_value;
 	unsigned short	ushort_value;
 	char  bytes[16]; // More bytes than we need.
@@ -133,21 +151,21 @@ int insert_float( char *ptr, float value ) {
 }
 int insert_long( char *ptr, long value ) {
 	int i;
-	__item.long_value = value;
-	for (i = sizeof( long ) - 1; i >= 0; i-- ) {
+	__item.long_value = (int) value;
+	for (i = PACKET_LONG_BYTES - 1; i >= 0; i-- ) {
 		*ptr = __item.bytes[i]; 
 		ptr++;
 	}
-	return( sizeof( long ) );
+	return( PACKET_LONG_BYTES );
 }
 int insert_ulong( char *ptr, unsigned long value ) {
 	int i;
-	__item.ulong_value = value;
-	for (i = sizeof( unsigned long ) - 1; i >= 0; i-- ) {
+	__item.ulong_value = (unsigned int) value;
+	for (i = PACKET_LONG_BYTES - 1; i >= 0; i-- ) {
 		*ptr = __item.bytes[i]; 
 		ptr++;
 	}
-	return( sizeof( unsigned long ) );
+	return( PACKET_LONG_BYTES );
 }
 int insert_short( char *ptr, short value ) {
 	int i;
@@ -173,7 +191,7 @@ long double EPMtoSeconds( EPMTelemetryHeaderInfo *header ) {
 // The bytes are in ESA/EPM order in the packet, and need to be reversed to be used by Intel/Windows.
 void ExtractEPMTransferFrameHeaderInfo ( EPMTransferFrameHeaderInfo *header, const EPMTelemetryPacket *epm_packet  ) {
 	unsigned char *ptr = ((unsigned char *) epm_packet); 
-	header->epmLanSyncMarker = ExtractReversedLong( ptr );
+	header->epmLanSyncMarker = ExtractReversedULong( ptr );
 	header->spare1 = ExtractChar( ptr );
 	header->softwareUnitID = ExtractChar( ptr );
 	header->packetType = ExtractReversedShort( ptr );
@@ -186,7 +204,7 @@ void ExtractEPMTransferFrameHeaderInfo ( EPMTransferFrameHeaderInfo *header, con
 int InsertEPMTransferFrameHeaderInfo ( EPMTelemetryPacket *epm_packet, const EPMTransferFrameHeaderInfo *header  ) {
 	unsigned char *ptr = ((unsigned char *) epm_packet); 
 	unsigned int  bytes_inserted = 0;
-	*((long *)ptr)= swapbytes_long( header->epmLanSyncMarker ); ptr += sizeof( unsigned long ); bytes_inserted += sizeof( unsigned long);
+	*((unsigned int *)ptr)= swapbytes_long( header->epmLanSyncMarker ); ptr += PACKET_LONG_BYTES; bytes_inserted += PACKET_LONG_BYTES;
 	*ptr =  header->spare1; ptr++; bytes_inserted++;
 	*ptr = header->softwareUnitID; ptr++; bytes_inserted++;
 	*((unsigned short *)ptr) = swapbytes_short( header->packetType ); ptr += sizeof( unsigned short ); bytes_inserted += sizeof( unsigned short);
@@ -207,7 +225,7 @@ int InsertEPMTelemetryHeaderInfo ( EPMTelemetryPacket *epm_packet, const EPMTele
 	bytes_inserted = InsertEPMTransferFrameHeaderInfo ( epm_packet, &header->transferFrameInfo );
 	ptr += bytes_inserted;
 
-	*((long *)ptr)= swapbytes_long( header->epmSyncMarker ); ptr += sizeof( unsigned long ); bytes_inserted += sizeof( unsigned long );
+	*((unsigned int *)ptr)= swapbytes_long( header->epmSyncMarker ); ptr += PACKET_LONG_BYTES; bytes_inserted += PACKET_LONG_BYTES;
 	*ptr = header->subsystemMode; ptr++; bytes_inserted++;
 	*ptr = header->subsystemID; ptr++; bytes_inserted++;
 	*ptr = header->destination; ptr++; bytes_inserted++;
@@ -217,7 +235,7 @@ int InsertEPMTelemetryHeaderInfo ( EPMTelemetryPacket *epm_packet, const EPMTele
 	*ptr = header->model; ptr++; bytes_inserted++;
 	*ptr = header->taskID; ptr++; bytes_inserted++;
 	*((unsigned short *)ptr) = swapbytes_short( header->subsystemUnitVersion ); ptr += sizeof( unsigned short ); bytes_inserted += sizeof( unsigned short );
-	*((unsigned long  *)ptr) = swapbytes_long( header->coarseTime ); ptr += sizeof( unsigned long ); bytes_inserted += sizeof( unsigned long );
+	*((unsigned int *)ptr) = swapbytes_long( header->coarseTime ); ptr += PACKET_LONG_BYTES; bytes_inserted += PACKET_LONG_BYTES;
 	*((unsigned short *)ptr) = swapbytes_short( header->fineTime ); ptr += sizeof( unsigned short ); bytes_inserted += sizeof( unsigned short );
 	*ptr = header->timerStatus; ptr++; bytes_inserted++;
 	*ptr = header->experimentMode; ptr++; bytes_inserted++;
@@ -234,14 +252,14 @@ void ExtractEPMTelemetryHeaderInfo ( EPMTelemetryHeaderInfo *header, const EPMTe
 	// The bytes are in ESA/EPM order in the TCP packet, and need to be reversed for Windows.
 	unsigned char *ptr = ((unsigned char *) epm_packet); 
 
-	header->transferFrameInfo.epmLanSyncMarker = ExtractReversedLong( ptr );
+	header->transferFrameInfo.epmLanSyncMarker = ExtractReversedULong( ptr );
 	header->transferFrameInfo.spare1 = ExtractChar( ptr );
 	header->transferFrameInfo.softwareUnitID = ExtractChar( ptr );
 	header->transferFrameInfo.packetType = ExtractReversedShort( ptr );
 	header->transferFrameInfo.spare2 = ExtractReversedShort( ptr );
 	header->transferFrameInfo.numberOfWords = ExtractReversedShort( ptr );
 
-	header->epmSyncMarker = ExtractReversedLong( ptr );
+	header->epmSyncMarker = ExtractReversedULong( ptr );
 	header->subsystemMode = ExtractChar( ptr );
 	header->subsystemID = ExtractChar( ptr );
 	header->destination= ExtractChar( ptr );
@@ -251,7 +269,7 @@ void ExtractEPMTelemetryHeaderInfo ( EPMTelemetryHeaderInfo *header, const EPMTe
 	header->model = ExtractChar( ptr );
 	header->taskID = ExtractChar( ptr );
 	header->subsystemUnitVersion = ExtractReversedShort( ptr );
-	header->coarseTime = ExtractReversedLong( ptr );
+	header->coarseTime = ExtractReversedULong( ptr );
 	header->fineTime = ExtractReversedShort( ptr );
 	header->timerStatus = ExtractChar( ptr );
 	header->experimentMode = *ptr; ptr++;
@@ -261,9 +279,31 @@ void ExtractEPMTelemetryHeaderInfo ( EPMTelemetryHeaderInfo *header, const EPMTe
 	header->numberOfWords = ExtractReversedShort( ptr ); 
 }
 
+// Work out the length in bytes of the EPM packet at the start of data, given the number of bytes available.
+// Per EPM-OHB-SP-0005 the transfer frame gives the length of the whole packet in 16-bit words.
+// The telemetry headers constructed by CLWSemulator (see hkHeader and rtHeader in GripPackets.h) put
+//  the length in bytes there instead and leave the telemetry word count at 0, so the length of a 
+//  telemetry frame is known only once its telemetry header is available.
+// Returns 0 if more bytes are needed. The length is limited to EPM_BUFFER_LENGTH.
+int EPMPacketLength( const unsigned char *data, int available ) {
+	EPMTelemetryHeaderInfo header;
+	int length;
+	if ( available < EPM_TRANSFER_FRAME_HEADER_LENGTH ) return( 0 );
+	ExtractEPMTransferFrameHeaderInfo( &header.transferFrameInfo, (const EPMTelemetryPacket *) data );
+	length = 2 * header.transferFrameInfo.numberOfWords;
+	if ( header.transferFrameInfo.packetType == TRANSFER_FRAME_TELEMETRY ) {
+		if ( available < EPM_TRANSFER_FRAME_HEADER_LENGTH + EPM_TELEMETRY_HEADER_LENGTH ) return( 0 );
+		ExtractEPMTelemetryHeaderInfo( &header, (const EPMTelemetryPacket *) data );
+		if ( header.numberOfWords == 0 ) length = header.transferFrameInfo.numberOfWords;
+	}
+	if ( length < EPM_TRANSFER_FRAME_HEADER_LENGTH ) length = EPM_TRANSFER_FRAME_HEADER_LENGTH;
+	if ( length > EPM_BUFFER_LENGTH ) length = EPM_BUFFER_LENGTH;
+	return( length );
+}
+
 // Extract a real-time science data packet from an EPM packet.
 void ExtractGripRealtimeDataInfo( GripRealtimeDataInfo *realtime_packet, const EPMTelemetryPacket *epm_packet ) {
-	const char *ptr;
+	const unsigned char *ptr;
 	int slice;
 	int sensor;
 	int i;
@@ -275,17 +315,17 @@ void ExtractGripRealtimeDataInfo( GripRealtimeDataInfo *realtime_packet, const E
 	// Point to the actual data in the packet.
 	ptr = epm_packet->sections.rawData;
 	// Get the acquisition ID and packet count for that acquisition.
-	realtime_packet->acquisitionID = (unsigned long) ExtractReversedLong( ptr );
-	realtime_packet->rtPacketCount = ExtractReversedLong( ptr );
+	realtime_packet->acquisitionID = ExtractReversedULong( ptr );
+	realtime_packet->rtPacketCount = ExtractReversedULong( ptr );
 	for ( slice = 0; slice < RT_SLICES_PER_PACKET; slice++ ) {
 		// Get the manipulandum pose data. 
-		realtime_packet->dataSlice[slice].poseTick = ExtractReversedLong( ptr );
+		realtime_packet->dataSlice[slice].poseTick = ExtractReversedULong( ptr );
 		for ( i = X; i <= Z; i++ ) realtime_packet->dataSlice[slice].position[i] = (double) ExtractReversedShort( ptr );
 		for ( i = X; i <= M; i++ ) realtime_packet->dataSlice[slice].quaternion[i] = ExtractReversedFloat( ptr );
-		for ( i = 0; i < 2; i++ ) realtime_packet->dataSlice[slice].markerVisibility[i] = ExtractReversedLong( ptr );
+		for ( i = 0; i < 2; i++ ) realtime_packet->dataSlice[slice].markerVisibility[i] = ExtractReversedULong( ptr );
 		realtime_packet->dataSlice[slice].manipulandumVisibility = ExtractChar( ptr );
 		// Get the analog data.
-		realtime_packet->dataSlice[slice].analogTick = ExtractReversedLong( ptr );
+		realtime_packet->dataSlice[slice].analogTick = ExtractReversedULong( ptr );
 		for ( sensor = 0; sensor < 2; sensor++ ) {
 			for ( i = X; i <=Z; i++ ) {
 				value = ExtractReversedShort( ptr );
@@ -367,7 +407,7 @@ void InsertGripRealtimeDataInfo( EPMTelemetryPacket *epm_packet, const GripRealt
 	int i;
 
 	// Point to the actual data in the packet.
-	ptr = epm_packet->sections.rawData;
+	ptr = (char *) epm_packet->sections.rawData;
 
 	// Set the acquisition ID and packet count for that acquisition.
 	ptr += insert_ulong( ptr, realtime_packet->acquisitionID );
@@ -393,7 +433,7 @@ void InsertGripRealtimeDataInfo( EPMTelemetryPacket *epm_packet, const GripRealt
 // Careful! It is not complete. Not all values are filled.
 void ExtractGripHealthAndStatusInfo( GripHealthAndStatusInfo *health_packet, const EPMTelemetryPacket *epm_packet ) {
 
-	const char *ptr;
+	const unsigned char *ptr;
 
 	// Point to the actual data in the packet.
 	ptr = epm_packet->sections.rawData;
@@ -427,9 +467,9 @@ void ExtractGripHealthAndStatusInfo( GripHealthAndStatusInfo *health_packet, con
 	health_packet->cpuUsage = ExtractReversedShort( ptr );
 	health_packet->memoryUsage = ExtractReversedShort( ptr );
 
-	health_packet->freeDiskSpaceC = ExtractReversedLong( ptr );
-	health_packet->freeDiskSpaceD = ExtractReversedLong( ptr );
-	health_packet->freeDiskSpaceE = ExtractReversedLong( ptr );
+	health_packet->freeDiskSpaceC = ExtractReversedULong( ptr );
+	health_packet->freeDiskSpaceD = ExtractReversedULong( ptr );
+	health_packet->freeDiskSpaceE = ExtractReversedULong( ptr );
 
 	health_packet->crc = ExtractReversedShort( ptr );
 	
@@ -442,7 +482,7 @@ void InsertGripHealthAndStatusInfo( EPMTelemetryPacket *epm_packet, const GripHe
 	char *ptr;
 
 	// Point to the actual data in the packet.
-	ptr = epm_packet->sections.rawData;
+	ptr = (char *) epm_packet->sections.rawData;
 
 	// Skip to the values of interest to us.
 	// DEX-ICD-00383-QS Section 5.2.4.58 says that these items should be at an offset of 68 bytes.
@@ -473,9 +513,9 @@ void InsertGripHealthAndStatusInfo( EPMTelemetryPacket *epm_packet, const GripHe
 	*((unsigned short *)ptr) = swapbytes_short( health_packet->cpuUsage ); ptr += sizeof( unsigned short );
 	*((unsigned short *)ptr) = swapbytes_short( health_packet->memoryUsage ); ptr += sizeof( unsigned short );
 
-	*((unsigned long *)ptr) = swapbytes_long( health_packet->freeDiskSpaceC ); ptr += sizeof( unsigned long );
-	*((unsigned long *)ptr) = swapbytes_long( health_packet->freeDiskSpaceD ); ptr += sizeof( unsigned long );
-	*((unsigned long *)ptr) = swapbytes_long( health_packet->freeDiskSpaceE ); ptr += sizeof( unsigned long );
+	*((unsigned int *)ptr) = swapbytes_long( health_packet->freeDiskSpaceC ); ptr += PACKET_LONG_BYTES;
+	*((unsigned int *)ptr) = swapbytes_long( health_packet->freeDiskSpaceD ); ptr += PACKET_LONG_BYTES;
+	*((unsigned int *)ptr) = swapbytes_long( health_packet->freeDiskSpaceE ); ptr += PACKET_LONG_BYTES;
 
 	*((unsigned short *)ptr) = swapbytes_short( health_packet->crc ); ptr += sizeof( unsigned short );
 	
@@ -519,14 +559,11 @@ void CreateGripPacketCacheFilename( char *filename, int max_characters, const Gr
 /// The contents of the latest HK packet are returned in the structure pointed to by parameter 'hk'.
 int GetLastPacketHK( EPMTelemetryHeaderInfo *epmHeader, GripHealthAndStatusInfo *hk, char *filename_root ) {
 
-	static int count = 0;
-
 	int  fid;
 	int packets_read = 0;
 	int bytes_read;
 	int return_code;
 	static unsigned short previousTMCounter = 0;
-	unsigned long bit = 0;
 	int retry_count;
 
 	EPMTelemetryPacket packet;
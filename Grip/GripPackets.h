@@ -195,13 +195,15 @@ typedef union {
 } EPMTelemetryPacket; 
 
 // Define a static lan packet for sending a connect command from the GRIP-MMI to EPM.
-static EPMTransferFrameHeaderInfo connectPacket = { EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_CONNECT, SPARE, 6 };
-static int connectPacketLengthInBytes = 12;
-static int connectPacketLengthInWords = 6;
+// These are all const, so that the files that include this header but do not use them get no warnings.
+// To send them with a different Software Unit ID, modify a copy.
+static const EPMTransferFrameHeaderInfo connectPacket = { EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_CONNECT, SPARE, 6 };
+static const int connectPacketLengthInBytes = 12;
+static const int connectPacketLengthInWords = 6;
 
-static EPMTransferFrameHeaderInfo alivePacket = { EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_ALIVE, SPARE, 6 };
-static int alivePacketLengthInBytes = 12;
-static int alivePacketLengthInWords = 6;
+static const EPMTransferFrameHeaderInfo alivePacket = { EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_ALIVE, SPARE, 6 };
+static const int alivePacketLengthInBytes = 12;
+static const int alivePacketLengthInWords = 6;
 
 // Define a static packet header that is representative of a housekeeping packet.
 // We don't try to simulate all the details, so most of the parameters are set to zero.
@@ -212,10 +214,10 @@ static int alivePacketLengthInWords = 6;
 //  end of the packet, but since that was not given in the documentation provided by Qinetiq/OHB/CADMOS, I am 
 //  not going to try to reverse engineer the details. The size of 158 works fine for the GripMMI.
 #define BULK_HK_BYTES	158
-static EPMTelemetryHeaderInfo hkHeader = { 
-	EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_TELEMETRY, SPARE, BULK_HK_BYTES,
+static const EPMTelemetryHeaderInfo hkHeader = { 
+	{ EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_TELEMETRY, SPARE, BULK_HK_BYTES },
 	EPM_TELEMETRY_SYNC_VALUE, 0, GRIP_SUBSYSTEM_ID, 0, 0, GRIP_HK_ID, UNKNOWN, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-static int hkPacketLengthInBytes = BULK_HK_BYTES;
+static const int hkPacketLengthInBytes = BULK_HK_BYTES;
 
 // Define a static packet header that is representative of a realtime data packet.
 // Not all of the members are properly filled. Just the ones important for the GripMMI.
@@ -223,10 +225,10 @@ static int hkPacketLengthInBytes = BULK_HK_BYTES;
 // The total number of words is 758 / 2 = 379 for the GRIP packet, 6 for the Transfer Frame header,
 //  15 for the EPM header and 1 for the checksum = 401 words = 802 bytes.
 #define RT_SCIENCE_BYTES	802
-static EPMTelemetryHeaderInfo rtHeader = { 
-	EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_TELEMETRY, SPARE, RT_SCIENCE_BYTES,
+static const EPMTelemetryHeaderInfo rtHeader = { 
+	{ EPM_TRANSFER_FRAME_SYNC_VALUE, SPARE, GRIP_MMI_SOFTWARE_UNIT_ID, TRANSFER_FRAME_TELEMETRY, SPARE, RT_SCIENCE_BYTES },
 	EPM_TELEMETRY_SYNC_VALUE, 0, GRIP_SUBSYSTEM_ID, 0, 0, GRIP_RT_ID, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-static int rtPacketLengthInBytes = RT_SCIENCE_BYTES;
+static const int rtPacketLengthInBytes = RT_SCIENCE_BYTES;
 
 
 typedef enum { GRIP_RT_SCIENCE_PACKET, GRIP_HK_BULK_PACKET, GRIP_UNKNOWN_PACKET } GripPacketType;
@@ -240,6 +242,7 @@ int  InsertEPMTransferFrameHeaderInfo ( EPMTelemetryPacket *epm_packet, const EP
 void ExtractEPMTransferFrameHeaderInfo ( EPMTransferFrameHeaderInfo *header, const EPMTelemetryPacket *epm_packet );
 void ExtractEPMTelemetryHeaderInfo ( EPMTelemetryHeaderInfo *header, const EPMTelemetryPacket *epm_packet  );
 int  InsertEPMTelemetryHeaderInfo ( EPMTelemetryPacket *epm_packet,  const EPMTelemetryHeaderInfo *header  );
+int  EPMPacketLength( const unsigned char *data, int available );
 void ExtractGripRealtimeDataInfo( GripRealtimeDataInfo *realtime_packet, const EPMTelemetryPacket *epm_packet );
 void InsertGripRealtimeDataInfo( EPMTelemetryPacket *epm_packet, const GripRealtimeDataInfo *realtime_packet );
 void ExtractGripHealthAndStatusInfo( GripHealthAndStatusInfo *health_packet, const EPMTelemetryPacket *epm_packet );
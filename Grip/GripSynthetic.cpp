@@ -0,0 +1,395 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                GripSynthetic.cpp                              */
+/*                                                                               */
+/*********************************************************************************/
+
+// Synthetic Grip sessions, for testing without flight recordings.
+// Copyright (c) 2015 PsyPhy Consulting. All rights reserved.
+
+// See GripSynthetic.h for the scenario file format.
+// The data are generated in the units that InsertGripRealtimeDataInfo() expects:
+//  positions in mm, forces in N, torques in Nm and accelerations in g.
+
+#include <windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+
+#include "GripSynthetic.h"
+
+#define STANDARD_GRAVITY	9.81
+// Time constants, in seconds, of the drift of the CoP and of the grip force response.
+#define COP_TIME_CONSTANT	2.0
+#define GRIP_TIME_CONSTANT	0.05
+// Point-to-point movements take this fraction of each period. The rest is a hold.
+#define DISCRETE_MOVEMENT_FRACTION	0.6
+// Markers are 0-7 on the manipulandum, 8-11 on the frame and 12-19 on the wrist.
+#define ALL_MARKERS			0xfffff
+
+/***************************************************************************/
+
+GripSyntheticSession::GripSyntheticSession( void ) {
+	SetDefaults();
+	Reset();
+}
+
+void GripSyntheticSession::SetDefaults( void ) {
+
+	mass = 0.4;
+	gravity = 0.0;
+	origin[X] = 0.0;
+	origin[Y] = 200.0;
+	origin[Z] = -300.0;
+	gripBaseline = 2.0;
+	gripLoadRatio = 1.6;
+	gripLead = 0.03;
+	copWander = 2.0;
+	copShift = 0.5;
+	noiseForce = 0.05;
+	noisePosition = 0.2;
+	occlusionRate = 0.05;
+	occlusionDuration = 0.8;
+	gapRate = 0.002;
+	gapDuration = 20.0;
+
+	// A little of everything, for when there is no scenario file.
+	static const GripSyntheticEpoch default_epochs[] = {
+		{ SYNTHETIC_REST,			10.0,	0.0,	0.0,	X },
+		{ SYNTHETIC_OSCILLATION,	30.0,	200.0,	1.0,	Z },
+		{ SYNTHETIC_REST,			5.0,	0.0,	0.0,	X },
+		{ SYNTHETIC_DISCRETE,		30.0,	150.0,	0.5,	Y },
+		{ SYNTHETIC_RELEASE,		10.0,	0.0,	0.0,	X },
+		{ SYNTHETIC_ROTATION,		20.0,	40.0,	0.5,	X },
+		{ SYNTHETIC_OSCILLATION,	20.0,	150.0,	1.5,	X }
+	};
+	nEpochs = sizeof( default_epochs ) / sizeof( default_epochs[0] );
+	memcpy( epoch, default_epochs, sizeof( default_epochs ) );
+
+}
+
+/***************************************************************************/
+
+// Random numbers from a 64-bit xorshift* generator, so that a seed gives
+//  the same session whatever the compiler and C library.
+
+double GripSyntheticSession::Uniform( void ) {
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+	unsigned __int64 r = randomState * 2685821657736338717ULL;
+	// Use the top 53 bits to get a double in [0,1).
+	return( (double) ( r >> 11 ) * ( 1.0 / 9007199254740992.0 ) );
+}
+
+double GripSyntheticSession::Gaussian( void ) {
+	// Box-Muller. 1 - Uniform() is in (0,1] so the log is finite.
+	double u1 = 1.0 - Uniform();
+	double u2 = Uniform();
+	return( sqrt( -2.0 * log( u1 ) ) * cos( 2.0 * Pi * u2 ) );
+}
+
+double GripSyntheticSession::Exponential( double mean ) {
+	return( - mean * log( 1.0 - Uniform() ) );
+}
+
+void GripSyntheticSession::Reset( unsigned long seed ) {
+
+	// Spread the bits of the seed so that small seeds give unrelated sessions.
+	randomState = ( (unsigned __int64) seed + 1 ) * 0x9E3779B97F4A7C15ULL;
+	randomState ^= randomState >> 31;
+	if ( randomState == 0 ) randomState = 0x9E3779B97F4A7C15ULL;
+
+	sessionTime = 0.0;
+	sliceCount = 0;
+	packetCount = 0;
+	currentEpoch = 0;
+	epochStart = 0.0;
+	occlusionEnd = 0.0;
+	occlusionMask[0] = occlusionMask[1] = 0;
+	for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) copOffset[ati][0] = copOffset[ati][1] = 0.0;
+	smoothedGrip = 0.0;
+
+}
+
+/***************************************************************************/
+
+bool GripSyntheticSession::LoadScenario( const char *filename ) {
+
+	FILE *fp;
+	char line[1024];
+	char keyword[64];
+	int line_number = 0;
+	bool have_epochs = false;
+
+	strcpy( scenarioError, "" );
+	fp = fopen( filename, "r" );
+	if ( !fp ) {
+		sprintf( scenarioError, "Cannot open scenario file %s.", filename );
+		return( false );
+	}
+	SetDefaults();
+
+	while ( fgets( line, sizeof( line ), fp ) ) {
+
+		line_number++;
+		char *comment = strchr( line, '#' );
+		if ( comment ) *comment = 0;
+		if ( sscanf( line, "%63s", keyword ) != 1 ) continue;
+		char *values = strstr( line, keyword ) + strlen( keyword );
+
+		int n = 0;
+		if ( !strcmp( keyword, "mass" ) ) n = sscanf( values, "%lf", &mass );
+		else if ( !strcmp( keyword, "gravity" ) ) n = sscanf( values, "%lf", &gravity );
+		else if ( !strcmp( keyword, "origin" ) ) n = ( sscanf( values, "%lf %lf %lf", &origin[X], &origin[Y], &origin[Z] ) == 3 );
+		else if ( !strcmp( keyword, "grip_baseline" ) ) n = sscanf( values, "%lf", &gripBaseline );
+		else if ( !strcmp( keyword, "grip_load_ratio" ) ) n = sscanf( values, "%lf", &gripLoadRatio );
+		else if ( !strcmp( keyword, "grip_lead" ) ) n = sscanf( values, "%lf", &gripLead );
+		else if ( !strcmp( keyword, "cop_wander" ) ) n = sscanf( values, "%lf", &copWander );
+		else if ( !strcmp( keyword, "cop_shift" ) ) n = sscanf( values, "%lf", &copShift );
+		else if ( !strcmp( keyword, "noise_force" ) ) n = sscanf( values, "%lf", &noiseForce );
+		else if ( !strcmp( keyword, "noise_position" ) ) n = sscanf( values, "%lf", &noisePosition );
+		else if ( !strcmp( keyword, "occlusion_rate" ) ) n = sscanf( values, "%lf", &occlusionRate );
+		else if ( !strcmp( keyword, "occlusion_duration" ) ) n = sscanf( values, "%lf", &occlusionDuration );
+		else if ( !strcmp( keyword, "gap_rate" ) ) n = sscanf( values, "%lf", &gapRate );
+		else if ( !strcmp( keyword, "gap_duration" ) ) n = sscanf( values, "%lf", &gapDuration );
+		else if ( !strcmp( keyword, "epoch" ) ) {
+			char type[32], axis[8];
+			GripSyntheticEpoch e = { SYNTHETIC_REST, 0.0, 0.0, 0.0, X };
+			strcpy( axis, "X" );
+			int fields = sscanf( values, "%31s %lf %lf %lf %7s", type, &e.duration, &e.amplitude, &e.frequency, axis );
+			if ( !have_epochs ) nEpochs = 0;
+			have_epochs = true;
+			if ( !_stricmp( type, "rest" ) ) e.type = SYNTHETIC_REST;
+			else if ( !_stricmp( type, "release" ) ) e.type = SYNTHETIC_RELEASE;
+			else if ( !_stricmp( type, "oscillation" ) ) e.type = SYNTHETIC_OSCILLATION;
+			else if ( !_stricmp( type, "discrete" ) ) e.type = SYNTHETIC_DISCRETE;
+			else if ( !_stricmp( type, "rotation" ) ) e.type = SYNTHETIC_ROTATION;
+			else fields = 0;
+			if ( !_stricmp( axis, "X" ) ) e.axis = X;
+			else if ( !_stricmp( axis, "Y" ) ) e.axis = Y;
+			else if ( !_stricmp( axis, "Z" ) ) e.axis = Z;
+			else fields = 0;
+			// Movements need an amplitude and a frequency. Rest and release only need a duration.
+			if ( fields < ( e.type == SYNTHETIC_REST || e.type == SYNTHETIC_RELEASE ? 2 : 4 ) || e.duration <= 0.0 ) n = 0;
+			else if ( nEpochs >= SYNTHETIC_MAX_EPOCHS ) {
+				sprintf( scenarioError, "%s line %d: too many epochs (max %d).", filename, line_number, SYNTHETIC_MAX_EPOCHS );
+				fclose( fp );
+				return( false );
+			}
+			else {
+				epoch[nEpochs++] = e;
+				n = 1;
+			}
+		}
+		else {
+			sprintf( scenarioError, "%s line %d: unknown keyword '%s'.", filename, line_number, keyword );
+			fclose( fp );
+			return( false );
+		}
+		if ( n < 1 ) {
+			sprintf( scenarioError, "%s line %d: bad or missing values for '%s'.", filename, line_number, keyword );
+			fclose( fp );
+			return( false );
+		}
+	}
+	fclose( fp );
+
+	if ( nEpochs == 0 ) {
+		sprintf( scenarioError, "%s does not define any epochs.", filename );
+		return( false );
+	}
+	Reset();
+	return( true );
+
+}
+
+/***************************************************************************/
+
+void GripSyntheticSession::Kinematics( const GripSyntheticEpoch *e, double t, Vector3 position, Vector3 acceleration, Quaternion orientation ) {
+
+	double displacement = 0.0;
+	double accel = 0.0;
+
+	CopyVector( position, origin );
+	CopyVector( acceleration, zeroVector );
+	CopyQuaternion( orientation, nullQuaternion );
+
+	switch ( e->type ) {
+
+	case SYNTHETIC_OSCILLATION: {
+		double w = 2.0 * Pi * e->frequency;
+		displacement = e->amplitude / 2.0 * sin( w * t );
+		accel = - e->amplitude / 2.0 * w * w * sin( w * t );
+		break;
+		}
+
+	case SYNTHETIC_DISCRETE: {
+		// Alternate between the origin and a target along the axis, with a minimum-jerk
+		//  profile for each movement followed by a hold.
+		double period = 1.0 / e->frequency;
+		double movement = DISCRETE_MOVEMENT_FRACTION * period;
+		int k = (int) floor( t / period );
+		double tau = ( t - k * period ) / movement;
+		double from = ( k % 2 ? e->amplitude : 0.0 );
+		double distance = ( k % 2 ? - e->amplitude : e->amplitude );
+		if ( tau >= 1.0 ) {
+			displacement = from + distance;
+		}
+		else {
+			double tau2 = tau * tau;
+			double tau3 = tau2 * tau;
+			displacement = from + distance * ( 10.0 * tau3 - 15.0 * tau3 * tau + 6.0 * tau3 * tau2 );
+			accel = distance / ( movement * movement ) * ( 60.0 * tau - 180.0 * tau2 + 120.0 * tau3 );
+		}
+		break;
+		}
+
+	case SYNTHETIC_ROTATION: {
+		static const Vector3 *axis_vector[3] = { &iVector, &jVector, &kVector };
+		double angle = e->amplitude / 2.0 * sin( 2.0 * Pi * e->frequency * t );
+		SetQuaterniond( orientation, angle, *axis_vector[e->axis] );
+		break;
+		}
+
+	default:
+		break;
+
+	}
+
+	position[e->axis] += displacement;
+	// Positions are in mm, accelerations in m/s^2.
+	acceleration[e->axis] = accel / 1000.0;
+
+}
+
+// Generate one slice of data at time t.
+void GripSyntheticSession::Slice( ManipulandumPacket *slice, double t ) {
+
+	const double dt = RT_DEFAULT_SECONDS_PER_SLICE;
+	Vector3 position, acceleration, ahead_position, ahead_acceleration;
+	Quaternion orientation, ahead_orientation;
+	Vector3 load, ahead_load;
+	int i, ati;
+
+	// Move on to the next epoch when the time comes. After a long gap we may skip several.
+	while ( t - epochStart >= epoch[currentEpoch].duration ) {
+		epochStart += epoch[currentEpoch].duration;
+		currentEpoch = ( currentEpoch + 1 ) % nEpochs;
+	}
+	const GripSyntheticEpoch *e = &epoch[currentEpoch];
+	bool held = ( e->type != SYNTHETIC_RELEASE );
+
+	Kinematics( e, t - epochStart, position, acceleration, orientation );
+	// The grip force anticipates the load, so look ahead at what the load will be.
+	Kinematics( e, t - epochStart + gripLead, ahead_position, ahead_acceleration, ahead_orientation );
+
+	// The net force on the manipulandum accelerates it and, on the ground, holds it up against gravity.
+	for ( i = X; i <= Z; i++ ) {
+		load[i] = mass * acceleration[i];
+		ahead_load[i] = mass * ahead_acceleration[i];
+	}
+	load[Z] += mass * gravity * STANDARD_GRAVITY;
+	ahead_load[Z] += mass * gravity * STANDARD_GRAVITY;
+	if ( !held ) {
+		CopyVector( load, zeroVector );
+		CopyVector( ahead_load, zeroVector );
+	}
+
+	// Grip force rises with the tangential load (Y and Z, since X is the pinch axis).
+	double tangential = sqrt( ahead_load[Y] * ahead_load[Y] + ahead_load[Z] * ahead_load[Z] );
+	double grip = ( held ? gripBaseline + gripLoadRatio * tangential : 0.0 );
+	smoothedGrip += ( grip - smoothedGrip ) * dt / ( GRIP_TIME_CONSTANT + dt );
+
+	// Each sensor takes half of the load. The left sensor (0) measures the grip along -X.
+	// See DexAnalogMixin::ComputeGripForce() and ComputeLoadForce().
+	for ( ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+		double normal = ( ati == LEFT_ATI ? - smoothedGrip : smoothedGrip );
+		slice->ft[ati].force[X] = normal + load[X] / 2.0 + noiseForce * Gaussian();
+		slice->ft[ati].force[Y] = load[Y] / 2.0 + noiseForce * Gaussian();
+		slice->ft[ati].force[Z] = load[Z] / 2.0 + noiseForce * Gaussian();
+
+		// The CoP wanders slowly around the center of the sensor and is pushed by the tangential load.
+		for ( i = 0; i < 2; i++ ) {
+			copOffset[ati][i] += - copOffset[ati][i] * dt / COP_TIME_CONSTANT + copWander * sqrt( 2.0 * dt / COP_TIME_CONSTANT ) * Gaussian();
+		}
+		double cop_y = ( copOffset[ati][0] + copShift * load[Y] / 2.0 ) / 1000.0;
+		double cop_z = ( copOffset[ati][1] + copShift * load[Z] / 2.0 ) / 1000.0;
+		// Inverse of DexAnalogMixin::ComputeCoP().
+		slice->ft[ati].torque[X] = 0.0;
+		slice->ft[ati].torque[Y] = - cop_z * slice->ft[ati].force[X];
+		slice->ft[ati].torque[Z] = - cop_y * slice->ft[ati].force[X];
+	}
+
+	// The accelerometer measures in g, including gravity on the ground.
+	for ( i = X; i <= Z; i++ ) slice->acceleration[i] = acceleration[i] / STANDARD_GRAVITY;
+	slice->acceleration[Z] += gravity;
+
+	for ( i = X; i <= Z; i++ ) slice->position[i] = position[i] + noisePosition * Gaussian();
+	for ( i = X; i <= M; i++ ) slice->quaternion[i] = orientation[i];
+
+	// Start a new occlusion episode now and then. Each hides a different group of markers.
+	if ( t >= occlusionEnd ) {
+		occlusionMask[0] = occlusionMask[1] = 0;
+		if ( Uniform() < occlusionRate * dt ) {
+			occlusionEnd = t + Exponential( occlusionDuration );
+			switch ( (int) ( Uniform() * 5.0 ) ) {
+			case 0: // Most of the manipulandum, e.g. hidden by the hand.
+				occlusionMask[0] = occlusionMask[1] = 0x0000fc;
+				break;
+			case 1: // A couple of manipulandum markers. It is still visible.
+				occlusionMask[0] = occlusionMask[1] = 0x000003;
+				break;
+			case 2: // Part of the wrist.
+				occlusionMask[0] = occlusionMask[1] = 0x0f8000;
+				break;
+			case 3: // One of the frame markers.
+				occlusionMask[0] = occlusionMask[1] = 0x000100;
+				break;
+			default: // Everything, but only for one of the codas.
+				occlusionMask[ Uniform() < 0.5 ? 0 : 1 ] = ALL_MARKERS;
+				break;
+			}
+		}
+	}
+	slice->markerVisibility[0] = ALL_MARKERS & ~occlusionMask[0];
+	slice->markerVisibility[1] = ALL_MARKERS & ~occlusionMask[1];
+	unsigned long seen = slice->markerVisibility[0] | slice->markerVisibility[1];
+	int manipulandum_markers = 0;
+	for ( i = 0; i < 8; i++ ) if ( seen & ( 0x01 << i ) ) manipulandum_markers++;
+	slice->manipulandumVisibility = ( manipulandum_markers >= 3 );
+
+	slice->poseTick = slice->analogTick = (unsigned long) ( t * 1000.0 );
+	slice->bestGuessPoseTimestamp = slice->bestGuessAnalogTimestamp = t;
+
+}
+
+double GripSyntheticSession::NextPacket( GripRealtimeDataInfo *rt, double *gap ) {
+
+	double interruption = 0.0;
+
+	// Interrupt the packet stream now and then. Any break must be long enough to be seen as such.
+	// The movements go on during the gap, as they would during LOS.
+	if ( packetCount > 0 && Uniform() < gapRate * RT_SLICES_PER_PACKET * RT_DEFAULT_SECONDS_PER_SLICE ) {
+		interruption = PACKET_STREAM_BREAK_THRESHOLD + Exponential( gapDuration );
+		sessionTime += interruption;
+	}
+	if ( gap ) *gap = interruption;
+
+	rt->acquisitionID = 0;
+	rt->rtPacketCount = packetCount++;
+	for ( int slice = 0; slice < RT_SLICES_PER_PACKET; slice++ ) {
+		Slice( &rt->dataSlice[slice], sessionTime );
+		sessionTime += RT_DEFAULT_SECONDS_PER_SLICE;
+		sliceCount++;
+	}
+	rt->packetTimestamp = rt->dataSlice[RT_SLICES_PER_PACKET - 1].bestGuessPoseTimestamp;
+	return( (double) rt->packetTimestamp );
+
+}
@@ -0,0 +1,127 @@
+/********************************************************************************/
+
+//
+// GripSynthetic.h
+// Synthetic Grip sessions, for testing without flight recordings.
+//
+
+// A synthetic session is a sequence of epochs (movements, holds, releases) described
+//  by a scenario file. From it we generate the contents of GRIP realtime science packets:
+//  manipulandum trajectories that obey minimum-jerk kinematics, load forces that follow
+//  from the accelerations, grip forces that anticipate the load, center-of-pressure paths,
+//  episodes of marker occlusion and gaps in the packet stream.
+// The same seed and scenario always give the same session, independent of the platform,
+//  because the random numbers come from our own generator rather than rand().
+
+// A scenario file has one keyword per line, followed by its values. '#' starts a comment.
+//
+//   mass 0.4                  kg, mass of the manipulandum
+//   gravity 0.0               g, 0 on orbit, 1 for ground sessions (along -Z)
+//   origin 0 200 -300         mm, where the manipulandum is held at rest
+//   grip_baseline 2.0         N, grip force when holding the manipulandum still
+//   grip_load_ratio 1.6       N of grip per N of tangential load
+//   grip_lead 0.03            s, how much grip anticipates load
+//   cop_wander 2.0            mm, amplitude of the random drift of the CoP
+//   cop_shift 0.5             mm per N, displacement of the CoP by tangential load
+//   noise_force 0.05          N, rms noise on each force component
+//   noise_position 0.2        mm, rms noise on each position component
+//   occlusion_rate 0.05       per second, how often an occlusion episode starts
+//   occlusion_duration 0.8    s, mean duration of an occlusion episode
+//   gap_rate 0.002            per second, how often the packet stream is interrupted
+//   gap_duration 20.0         s, mean duration of a gap in the packet stream
+//   epoch <type> <seconds> [amplitude] [frequency] [axis]
+//
+// Epoch types are 'rest' (held still), 'release' (not held, no grip), 'oscillation'
+//  (sinusoidal movement, amplitude in mm peak to peak, frequency in Hz), 'discrete'
+//  (minimum-jerk point-to-point movements, amplitude in mm, frequency in movements
+//  per second) and 'rotation' (sinusoidal rotation, amplitude in degrees peak to peak).
+// The axis is X, Y or Z. The epochs are repeated in order for as long as one asks for packets.
+
+#pragma once
+
+#include "..\Useful\VectorsMixin.h"
+#include "DexAnalogMixin.h"
+#include "GripPackets.h"
+
+#define SYNTHETIC_MAX_EPOCHS	64
+#define SYNTHETIC_DEFAULT_SEED	1
+
+typedef enum {
+	SYNTHETIC_REST = 0,
+	SYNTHETIC_RELEASE,
+	SYNTHETIC_OSCILLATION,
+	SYNTHETIC_DISCRETE,
+	SYNTHETIC_ROTATION
+} GripSyntheticEpochType;
+
+typedef struct {
+	GripSyntheticEpochType	type;
+	double					duration;
+	double					amplitude;
+	double					frequency;
+	int						axis;
+} GripSyntheticEpoch;
+
+class GripSyntheticSession : public VectorsMixin {
+
+private:
+
+	// Scenario parameters.
+	double				mass;
+	double				gravity;
+	Vector3				origin;
+	double				gripBaseline;
+	double				gripLoadRatio;
+	double				gripLead;
+	double				copWander;
+	double				copShift;
+	double				noiseForce;
+	double				noisePosition;
+	double				occlusionRate;
+	double				occlusionDuration;
+	double				gapRate;
+	double				gapDuration;
+	GripSyntheticEpoch	epoch[SYNTHETIC_MAX_EPOCHS];
+	int					nEpochs;
+
+	// State of the session.
+	unsigned __int64	randomState;
+	double				sessionTime;		// Time of the next slice, in seconds, including gaps.
+	unsigned long		sliceCount;
+	unsigned long		packetCount;
+	int					currentEpoch;
+	double				epochStart;
+	double				occlusionEnd;
+	unsigned long		occlusionMask[2];
+	double				copOffset[N_FORCE_TRANSDUCERS][2];
+	double				smoothedGrip;
+
+	double Uniform( void );
+	double Gaussian( void );
+	double Exponential( double mean );
+
+	void SetDefaults( void );
+	// Kinematics of the current epoch at time t from its start.
+	// Position in mm, acceleration in m/s^2 and orientation as a quaternion.
+	void Kinematics( const GripSyntheticEpoch *e, double t, Vector3 position, Vector3 acceleration, Quaternion orientation );
+	void Slice( ManipulandumPacket *slice, double t );
+
+public:
+
+	GripSyntheticSession( void );
+
+	// Read a scenario file. Returns false, with a description in scenarioError,
+	//  if the file cannot be read or contains something that we do not understand.
+	bool LoadScenario( const char *filename );
+	char scenarioError[256];
+
+	// Start the session over, with the given seed.
+	void Reset( unsigned long seed = SYNTHETIC_DEFAULT_SEED );
+
+	// Fill in the next realtime data packet.
+	// Returns the time of the packet (that of its last slice) in seconds from the start
+	//  of the session, including any gaps. If the packet stream was interrupted just before
+	//  this packet, the duration of the interruption is returned in gap.
+	double NextPacket( GripRealtimeDataInfo *rt, double *gap = NULL );
+
+};
@@ -0,0 +1,180 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                  GripTrace.c                                  */
+/*                                                                               */
+/*********************************************************************************/
+//
+// Lightweight tracing of the latency of telemetry packets across the GripMMI processes.
+// See GripTrace.h.
+//
+
+// Disable warnings about unsafe functions.
+// We use the 'unsafe' versions to maintain source-code compatibility with Visual C++ 6
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <Windows.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\fOutputDebugString.h"
+
+#include "GripTrace.h"
+
+const char *GripTraceStageName[TRACE_STAGES] = { "send", "receive", "cache write", "read", "display" };
+
+// Each slot holds a record and its sequence number (index + 1). The sequence number is cleared
+//  before the record is filled in and set again last, so a slot whose sequence number does not
+//  match is either still being filled in or has been overwritten by a later record.
+typedef struct {
+	GripTraceRecord	record;
+	volatile LONG	sequence;
+} GripTraceSlot;
+
+static GripTraceSlot traceBuffer[GRIP_TRACE_BUFFER_RECORDS];
+// Number of slots claimed by GripTrace() and number of records written to the file so far.
+static volatile LONG traceClaimed = 0;
+static LONG traceWritten = 0;
+// Set while one of the callers is writing records to the file.
+static volatile LONG traceFlushing = 0;
+// Records that were overwritten before they could be written to the file.
+static unsigned long traceDropped = 0;
+
+static __int64 traceFrequency = 0;
+static __int64 traceLastFlush = 0;
+static FILE *traceFile = NULL;
+
+void GripTraceOpen( const char *process ) {
+
+	char *directory = getenv( GRIP_TRACE_ENV_VARIABLE );
+	char filename[MAX_PATH];
+	int length;
+	GripTraceFileHeader header;
+	LARGE_INTEGER frequency, now;
+	FILE *fp;
+
+	// Tracing is off unless the environment variable says where to put the trace.
+	if ( !directory || !*directory || traceFile ) return;
+
+	// Windows accepts '/' as well as a backslash as the separator, so the same path works everywhere.
+	length = _snprintf( filename, sizeof( filename ), "%s/%s.%lu.trc", directory, process, (unsigned long) GetCurrentProcessId() );
+	if ( length < 0 || length >= (int) sizeof( filename ) ) {
+		fMessageBox( MB_OK, "GripMMI", "Path to the trace file is too long:\n%s\n\nTracing is disabled.", directory );
+		return;
+	}
+	fp = fopen( filename, "wb" );
+	if ( !fp ) {
+		fMessageBox( MB_OK, "GripMMI", "Error opening trace file %s.\n\nTracing is disabled.", filename );
+		return;
+	}
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &now );
+	traceFrequency = frequency.QuadPart;
+	traceLastFlush = now.QuadPart;
+
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, GRIP_TRACE_MAGIC, sizeof( header.magic ) );
+	strncpy( header.process, process, sizeof( header.process ) - 1 );
+	header.pid = GetCurrentProcessId();
+	header.frequency = traceFrequency;
+	fwrite( &header, sizeof( header ), 1, fp );
+	fflush( fp );
+
+	// From here on, GripTrace() records.
+	traceFile = fp;
+	atexit( GripTraceClose );
+	fOutputDebugString( "Tracing to %s.\n", filename );
+
+}
+
+int GripTraceEnabled( void ) {
+	return( traceFile != NULL );
+}
+
+void GripTrace( GripTraceStage stage, unsigned long counter ) {
+
+	LARGE_INTEGER now;
+	LONG index;
+	GripTraceSlot *slot;
+
+	if ( !traceFile ) return;
+
+	QueryPerformanceCounter( &now );
+	index = InterlockedIncrement( &traceClaimed ) - 1;
+	slot = &traceBuffer[index & ( GRIP_TRACE_BUFFER_RECORDS - 1 )];
+	// Mark the slot as being filled in, so that GripTraceFlush() does not take the record that
+	//  was there before for this one, nor write a mixture of the two.
+	InterlockedExchange( &slot->sequence, 0 );
+	slot->record.ticks = now.QuadPart;
+	slot->record.counter = counter;
+	slot->record.stage = stage;
+	// The interlocked exchange is also a memory barrier, so the record is complete
+	//  before it is marked as such.
+	InterlockedExchange( &slot->sequence, index + 1 );
+
+	if ( now.QuadPart - traceLastFlush > traceFrequency ) GripTraceFlush();
+
+}
+
+void GripTraceFlush( void ) {
+
+	LARGE_INTEGER now;
+	LONG claimed;
+
+	if ( !traceFile ) return;
+	// Only one caller writes at a time. The others just go on, as their records will be written next time.
+	if ( InterlockedCompareExchange( &traceFlushing, 1, 0 ) != 0 ) return;
+
+	claimed = traceClaimed;
+	// If the ring buffer has wrapped around since the last time, the oldest records are lost.
+	if ( claimed - traceWritten > GRIP_TRACE_BUFFER_RECORDS ) {
+		traceDropped += claimed - traceWritten - GRIP_TRACE_BUFFER_RECORDS;
+		traceWritten = claimed - GRIP_TRACE_BUFFER_RECORDS;
+	}
+	while ( traceWritten < claimed ) {
+		GripTraceSlot *slot = &traceBuffer[traceWritten & ( GRIP_TRACE_BUFFER_RECORDS - 1 )];
+		GripTraceRecord record;
+		LONG sequence = slot->sequence;
+		// A later record has already taken the slot, so this one is lost.
+		if ( sequence - ( traceWritten + 1 ) > 0 ) {
+			traceDropped++;
+			traceWritten++;
+			continue;
+		}
+		// Stop at a record that is still being filled in. It will be written next time.
+		if ( sequence != traceWritten + 1 ) break;
+		MemoryBarrier();
+		memcpy( &record, &slot->record, sizeof( record ) );
+		MemoryBarrier();
+		// If the slot was taken by a later record while we were copying, the copy may be a mixture
+		//  of the two. Drop it rather than write a record that never happened.
+		if ( slot->sequence != sequence ) {
+			traceDropped++;
+			traceWritten++;
+			continue;
+		}
+		fwrite( &record, sizeof( record ), 1, traceFile );
+		traceWritten++;
+	}
+	fflush( traceFile );
+
+	QueryPerformanceCounter( &now );
+	traceLastFlush = now.QuadPart;
+	InterlockedExchange( &traceFlushing, 0 );
+
+}
+
+void GripTraceClose( void ) {
+
+	FILE *fp;
+
+	if ( !traceFile ) return;
+	GripTraceFlush();
+	if ( traceDropped ) fOutputDebugString( "GripTrace: %lu records were dropped.\n", traceDropped );
+	fp = traceFile;
+	traceFile = NULL;
+	fclose( fp );
+
+}
@@ -0,0 +1,71 @@
+//
+// Tracing of the path of each telemetry packet from CLWSemulator to the GripMMI display.
+//
+
+// Each process calls GripTrace() as a packet passes through one of the stages below.
+// The record holds the stage, the TMCounter of the packet and a timestamp from the
+//  performance counter, which is monotonic and common to all processes on the same machine.
+// Records go into a per-process ring buffer. A slot is claimed with an interlocked increment,
+//  so tracing never blocks and never takes a lock. A record that is overwritten while it is
+//  being written to the file is dropped rather than written half old and half new. About once per second the records are
+//  appended to a trace file, by whichever caller finds that it is time to do so.
+//
+// Tracing is off unless the environment variable GRIPTRACE is set to the directory where
+//  the trace files should go. Each process then writes <GRIPTRACE>/<process>.<pid>.trc.
+// GripTraceMerge.exe reads the trace files of a run and produces latency histograms
+//  for each stage and a trace that can be loaded into chrome://tracing.
+
+#pragma once
+
+#define GRIP_TRACE_ENV_VARIABLE	"GRIPTRACE"
+#define GRIP_TRACE_MAGIC		"GRIPTRC1"
+// Must be a power of 2.
+#define GRIP_TRACE_BUFFER_RECORDS	65536
+// Used as the counter of events that do not concern a specific packet.
+#define GRIP_TRACE_NO_COUNTER	0xffffffff
+
+typedef enum {
+	TRACE_SEND = 0,		// CLWSemulator has sent the packet.
+	TRACE_RECEIVE,		// DexGroundMonitorClient has received it ...
+	TRACE_CACHE_WRITE,	// ... and written it to the cache file.
+	TRACE_READ,			// GripMMI has read it from the cache file in GetGripRT().
+	TRACE_DISPLAY,		// GripMMI has swapped the buffers of the displays (not specific to a packet).
+	TRACE_STAGES
+} GripTraceStage;
+
+// Header at the start of each trace file.
+typedef struct {
+	char			magic[8];
+	char			process[32];
+	unsigned long	pid;
+	unsigned long	unused;
+	__int64			frequency;	// Ticks per second of the performance counter.
+} GripTraceFileHeader;
+
+// One trace record. The file header is followed by as many of these as were traced.
+typedef struct {
+	__int64			ticks;
+	unsigned long	counter;
+	unsigned long	stage;
+} GripTraceRecord;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start tracing for this process, if GRIPTRACE is set. The name identifies the process in the reports.
+void GripTraceOpen( const char *process );
+// Non-zero if tracing is on. Lets callers skip the work of finding out the TMCounter when it is not.
+int GripTraceEnabled( void );
+// Record that the packet with the given TMCounter has reached the given stage.
+void GripTrace( GripTraceStage stage, unsigned long counter );
+// Write out the records that are still in the buffer.
+void GripTraceFlush( void );
+// Flush and close the trace file. Called automatically at exit.
+void GripTraceClose( void );
+
+extern const char *GripTraceStageName[TRACE_STAGES];
+
+#ifdef __cplusplus
+}
+#endif
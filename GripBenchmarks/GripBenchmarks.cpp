@@ -0,0 +1,586 @@
+///
+/// Module:	GripBenchmarks (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that times the routines of the Grip and
+///  Useful libraries that GripMMI runs once per packet or once per sample: decoding of
+///  the packets, the force computations and the recursive filters of DexAnalogMixin,
+///  the conversion of quaternions to rotations, the rigid body pose and the parsing of
+///  script lines. The script lines are made up, or read from a task file with -script.
+///  The tokenizer is also timed as it was before it was rewritten, for comparison.
+///
+/// The routines run on a fixed corpus of packets generated by GripSyntheticSession, so
+///  the same seed and number of packets always give the same work, on any machine.
+///  Each benchmark is run a number of times and the median, minimum and maximum time per
+///  operation are reported, along with a checksum of the results, so that an optimization
+///  that changes the results can be spotted.
+///
+/// Usage: GripBenchmarks [-packets=n] [-repetitions=n] [-seed=n] [-only=name] [-output=results.csv]
+///                       [-compare=baseline.csv] [-threshold=percent] [-script=task file]
+///
+/// The results are written as comma-delimited lines. With -compare the results are compared
+///  to those of an earlier run, and the program exits with a non-zero status if any benchmark
+///  got slower by more than the threshold.
+///
+/// See the Makefile to build and run it on Linux.
+
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\VectorsBatch.h"
+#include "..\Useful\ParseCommaDelimitedLine.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\Grip\GripSynthetic.h"
+
+#define DEFAULT_PACKETS		1000
+#define DEFAULT_REPETITIONS	15
+#define DEFAULT_THRESHOLD	10.0
+#define MAX_BENCHMARKS		16
+#define MAX_BASELINE		64
+#define RIGID_BODY_MARKERS	8
+#define SCRIPT_LINES		64
+// The longest line that the original tokenizer took.
+#define ORIGINAL_LINE_LENGTH	1024
+
+// Same threshold as GripMMI uses for the center of pressure.
+#define COP_MIN_GRIP		0.5
+
+/***********************************************************************************/
+
+// The corpus: the encoded packets and, for the routines that work on decoded data,
+//  the decoded slices, the marker positions and the script lines.
+static int nPackets = DEFAULT_PACKETS;
+static int nSlices = 0;
+static EPMTelemetryPacket *encoded = NULL;
+static ManipulandumPacket *slices = NULL;
+static Vector3 *markers = NULL;
+static char **scriptLine = NULL;
+static int nScriptLines = 0;
+static char *scriptWork = NULL;
+
+// Columns for the batch conversion of quaternions.
+static double *quaternionColumn[4];
+static double *rotationColumn[3];
+
+// The marker positions on the manipulandum, in mm from its center.
+static Vector3 markerModel[RIGID_BODY_MARKERS] = {
+	{  30.0,  30.0,  20.0 }, { -30.0,  30.0,  20.0 }, { -30.0, -30.0,  20.0 }, {  30.0, -30.0,  20.0 },
+	{  40.0,   0.0, -10.0 }, {   0.0,  40.0, -10.0 }, { -40.0,   0.0, -10.0 }, {   0.0, -40.0, -10.0 }
+};
+
+// Lines in the form of the DEX scripts that GripMMI parses.
+static const char *scriptTemplate[] = {
+	"CMD_LOG_MESSAGE,usermsg,Hold the manipulandum still in front of you. Trial %d.",
+	"CMD_SET_PICTURE,GripHoldStill%d.bmp",
+	"CMD_WAIT_SUBJ_READY,Press OK when ready.,ready%d.bmp,60",
+	"CMD_WAIT_MANIP_ATTARGET,0,0,0,0,0,0,0,0,0,0,0,0,%d,Move to the target.,target.bmp",
+	"CMD_CHK_MOVEMENTS_AMPL,100,200,%d,0,1,0,Movements too small.,small.bmp",
+	"CMD_ACQ_START,%d",
+	"  CMD_CTRL_TONE_BEEP , 1000 , 0.2 , %d  ",
+	"CMD_LOG_MESSAGE,logmsg,\"Quoted, with a comma\",%d"
+};
+#define SCRIPT_TEMPLATES	( sizeof( scriptTemplate ) / sizeof( scriptTemplate[0] ) )
+
+static VectorsMixin vm;
+
+static void CreateCorpus( unsigned long seed ) {
+
+	GripSyntheticSession session;
+	EPMTelemetryHeaderInfo header;
+	GripRealtimeDataInfo rt;
+
+	encoded = (EPMTelemetryPacket *) malloc( nPackets * sizeof( *encoded ) );
+	nSlices = nPackets * RT_SLICES_PER_PACKET;
+	slices = (ManipulandumPacket *) malloc( nSlices * sizeof( *slices ) );
+	markers = (Vector3 *) malloc( nSlices * RIGID_BODY_MARKERS * sizeof( *markers ) );
+	for ( int i = 0; i < 4; i++ ) quaternionColumn[i] = (double *) malloc( nSlices * sizeof( double ) );
+	for ( int i = 0; i < 3; i++ ) rotationColumn[i] = (double *) malloc( nSlices * sizeof( double ) );
+	if ( !encoded || !slices || !markers || !quaternionColumn[3] || !rotationColumn[2] ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "Error allocating memory for %d packets.", nPackets );
+		exit( -1 );
+	}
+
+	// Encode the packets as CLWSemulator does.
+	session.Reset( seed );
+	memcpy( &header, &rtHeader, sizeof( header ) );
+	for ( int p = 0; p < nPackets; p++ ) {
+		session.NextPacket( &rt );
+		header.TMCounter = p;
+		memset( &encoded[p], 0, sizeof( encoded[p] ) );
+		InsertEPMTelemetryHeaderInfo( &encoded[p], &header );
+		InsertGripRealtimeDataInfo( &encoded[p], &rt );
+	}
+
+	// The other routines work on the packets as GripMMI sees them, i.e. after decoding.
+	for ( int p = 0; p < nPackets; p++ ) {
+		ExtractGripRealtimeDataInfo( &rt, &encoded[p] );
+		memcpy( &slices[p * RT_SLICES_PER_PACKET], rt.dataSlice, sizeof( rt.dataSlice ) );
+	}
+
+	// Place the model markers according to the pose of each slice.
+	for ( int s = 0; s < nSlices; s++ ) {
+		Quaternion q;
+		vm.CopyQuaternion( q, slices[s].quaternion );
+		vm.NormalizeQuaternion( q );
+		for ( int m = 0; m < RIGID_BODY_MARKERS; m++ ) {
+			Vector3 *marker = &markers[s * RIGID_BODY_MARKERS + m];
+			vm.RotateVector( *marker, q, markerModel[m] );
+			vm.AddVectors( *marker, *marker, slices[s].position );
+		}
+		quaternionColumn[X][s] = slices[s].quaternion[X];
+		quaternionColumn[Y][s] = slices[s].quaternion[Y];
+		quaternionColumn[Z][s] = slices[s].quaternion[Z];
+		quaternionColumn[M][s] = slices[s].quaternion[M];
+	}
+
+}
+
+// The script lines, from the templates or from a task file.
+// Lines that the original tokenizer could not take are left out.
+static void CreateScriptCorpus( const char *filename ) {
+
+	char line[ORIGINAL_LINE_LENGTH];
+	size_t longest = 0;
+	int allocated = SCRIPT_LINES;
+
+	scriptLine = (char **) malloc( allocated * sizeof( char * ) );
+	if ( !filename ) {
+		for ( nScriptLines = 0; scriptLine && nScriptLines < SCRIPT_LINES; nScriptLines++ ) {
+			_snprintf( line, sizeof( line ), scriptTemplate[nScriptLines % SCRIPT_TEMPLATES], nScriptLines );
+			line[sizeof( line ) - 1] = 0;
+			scriptLine[nScriptLines] = _strdup( line );
+		}
+	}
+	else {
+		FILE *fp = fopen( filename, "r" );
+		if ( !fp ) {
+			fMessageBox( MB_OK, "GripBenchmarks", "Error opening script file %s.", filename );
+			exit( -1 );
+		}
+		while ( scriptLine && fgets( line, sizeof( line ), fp ) ) {
+			size_t length = strlen( line );
+			if ( length > 0 && line[length - 1] != '\n' && !feof( fp ) ) {
+				// Too long. Skip the rest of it.
+				int c;
+				while ( ( c = fgetc( fp ) ) != EOF && c != '\n' );
+				continue;
+			}
+			while ( length > 0 && ( line[length - 1] == '\n' || line[length - 1] == '\r' ) ) line[--length] = 0;
+			if ( nScriptLines == allocated ) {
+				allocated *= 2;
+				scriptLine = (char **) realloc( scriptLine, allocated * sizeof( char * ) );
+				if ( !scriptLine ) break;
+			}
+			scriptLine[nScriptLines++] = _strdup( line );
+		}
+		fclose( fp );
+		if ( scriptLine && nScriptLines == 0 ) {
+			fMessageBox( MB_OK, "GripBenchmarks", "No lines in script file %s.", filename );
+			exit( -1 );
+		}
+	}
+	for ( int i = 0; scriptLine && i < nScriptLines; i++ ) if ( strlen( scriptLine[i] ) > longest ) longest = strlen( scriptLine[i] );
+	scriptWork = (char *) malloc( longest + 1 );
+	if ( !scriptLine || !scriptWork ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "Error allocating memory for the script lines." );
+		exit( -1 );
+	}
+
+}
+
+/***********************************************************************************/
+
+// Each benchmark does one pass over the corpus and returns a checksum of what it computed.
+// The number of operations in a pass is used to compute the time per operation.
+
+static double BenchExtractTelemetryHeader( void ) {
+	EPMTelemetryHeaderInfo header;
+	double sum = 0.0;
+	for ( int p = 0; p < nPackets; p++ ) {
+		ExtractEPMTelemetryHeaderInfo( &header, &encoded[p] );
+		sum += header.TMCounter + header.numberOfWords + ( header.epmSyncMarker == EPM_TELEMETRY_SYNC_VALUE );
+	}
+	return( sum );
+}
+
+static double BenchExtractRealtimeData( void ) {
+	GripRealtimeDataInfo rt;
+	double sum = 0.0;
+	for ( int p = 0; p < nPackets; p++ ) {
+		ExtractGripRealtimeDataInfo( &rt, &encoded[p] );
+		sum += rt.rtPacketCount + rt.dataSlice[0].position[X] + rt.dataSlice[RT_SLICES_PER_PACKET - 1].ft[1].force[Z];
+	}
+	return( sum );
+}
+
+static double BenchComputeForces( void ) {
+	DexAnalogMixin dex;
+	Vector3 load, cop;
+	double sum = 0.0;
+	for ( int s = 0; s < nSlices; s++ ) {
+		sum += dex.ComputeGripForce( slices[s].ft[LEFT_ATI].force, slices[s].ft[RIGHT_ATI].force );
+		sum += dex.ComputeLoadForce( load, slices[s].ft[LEFT_ATI].force, slices[s].ft[RIGHT_ATI].force );
+		for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+			if ( dex.ComputeCoP( cop, slices[s].ft[ati].force, slices[s].ft[ati].torque, COP_MIN_GRIP ) >= 0.0 ) sum += cop[Y] + cop[Z];
+		}
+	}
+	return( sum );
+}
+
+// The recursive filters, applied to each slice as in GripMMI's GetGripRT().
+static double BenchFilters( void ) {
+	DexAnalogMixin dex;
+	Vector3 position, rotations, load, acceleration, cop;
+	double sum = 0.0;
+	dex.SetFilterConstant( 2.0 );
+	for ( int s = 0; s < nSlices; s++ ) {
+		vm.ScaleVector( position, slices[s].position, 0.1 );
+		sum += dex.FilterManipulandumPosition( position );
+		vm.CopyVector( rotations, slices[s].quaternion );
+		sum += dex.FilterManipulandumRotations( rotations );
+		sum += dex.FilterGripForce( slices[s].ft[RIGHT_ATI].force[X] - slices[s].ft[LEFT_ATI].force[X] );
+		sum += dex.FilterNormalForce( - slices[s].ft[LEFT_ATI].force[X], LEFT_ATI );
+		sum += dex.FilterNormalForce( slices[s].ft[RIGHT_ATI].force[X], RIGHT_ATI );
+		vm.AddVectors( load, slices[s].ft[LEFT_ATI].force, slices[s].ft[RIGHT_ATI].force );
+		sum += dex.FilterLoadForce( load );
+		for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+			vm.CopyVector( cop, slices[s].ft[ati].torque );
+			sum += dex.FilterCoP( ati, cop );
+		}
+		vm.CopyVector( acceleration, slices[s].acceleration );
+		sum += dex.FilterAcceleration( acceleration );
+	}
+	return( sum );
+}
+
+static double BenchQuaternionToRotations( void ) {
+	Vector3 rotations;
+	double sum = 0.0;
+	for ( int s = 0; s < nSlices; s++ ) {
+		vm.QuaternionToCannonicalRotations( rotations, slices[s].quaternion );
+		sum += rotations[ROLL] + rotations[PITCH] + rotations[YAW];
+	}
+	return( sum );
+}
+
+static double BenchBatchQuaternionToRotations( void ) {
+	VectorColumns<double> r = { rotationColumn[X], rotationColumn[Y], rotationColumn[Z] };
+	QuaternionColumns<double> q = { quaternionColumn[X], quaternionColumn[Y], quaternionColumn[Z], quaternionColumn[M] };
+	double sum = 0.0;
+	BatchQuaternionToCannonicalRotations( r, q, nSlices );
+	for ( int s = 0; s < nSlices; s++ ) sum += rotationColumn[ROLL][s] + rotationColumn[PITCH][s] + rotationColumn[YAW][s];
+	return( sum );
+}
+
+static double BenchRigidBodyPose( void ) {
+	Vector3 position;
+	Quaternion orientation;
+	double sum = 0.0;
+	for ( int s = 0; s < nSlices; s++ ) {
+		if ( vm.ComputeRigidBodyPose( position, orientation, markerModel, &markers[s * RIGID_BODY_MARKERS], RIGID_BODY_MARKERS, NULL ) ) {
+			sum += position[X] + position[Y] + position[Z] + orientation[M];
+		}
+	}
+	return( sum );
+}
+
+// ParseCommaDelimitedLine() as it was, with a strtok() pass, a strlen() per character
+//  and a pass to turn the semicolons that stood for escaped commas back into commas.
+static char original_tokens[PARSER_BUFFERS][ORIGINAL_LINE_LENGTH];
+static int original_circular = 0;
+
+static int OriginalParseCommaDelimitedLine ( char *tokens[MAX_TOKENS], const char *line ) {
+
+	char *tkn, *chr;
+	unsigned int	 n = 0, i, j;
+
+	if ( strlen( line ) > sizeof( original_tokens[original_circular] ) ) {
+		fprintf( stderr, "Line too long.\n%s\n", line );
+		exit( -1 );
+	}
+
+	// Copy and replace escapted commas with semicolons. 
+	for ( i = 0, chr = original_tokens[original_circular]; i < strlen( line ); i++ ) {
+		if ( line[i] == '\\' && line[i+1] == ',' ) {
+			*chr++ = ';';
+			i++;
+		}
+		else  *chr++ = line[i];
+	}
+	*chr = 0;
+	
+	tkn = strtok( original_tokens[original_circular], "," );
+	while ( tkn && n < MAX_TOKENS - 1 ) {
+		while ( iswhite( *tkn ) && *tkn ) tkn++;
+		chr = tkn + strlen( tkn );
+		while ( iswhite( *chr ) && chr >= tkn ) *chr-- = 0;
+		if ( *tkn == '#' || *tkn == 0 ) break;
+		tokens[n++] = tkn;
+		tkn = strtok( NULL, "," );
+	}
+
+	tokens[n] = NULL;
+	for ( i = 0; i < n; i++ ) {
+		for ( j = 0; j < strlen( tokens[i] ); j++ ) if ( tokens[i][j] == ';' ) tokens[i][j] = ',';
+	}
+
+	original_circular = ( original_circular + 1 ) % PARSER_BUFFERS;
+
+	return( n );
+}
+
+// What the parsing benchmarks sum up. It is the same for all the tokenizers, unless a line has semicolons of its own,
+//  which the original turned into commas.
+static double SumTokens( char *token[MAX_TOKENS], int tokens ) {
+	double sum = tokens;
+	if ( tokens > 1 ) sum += strlen( token[tokens - 1] );
+	return( sum );
+}
+
+// Each parses as many lines as there are packets, so that a pass takes a comparable time.
+static double BenchParseLineOriginal( void ) {
+	char *token[MAX_TOKENS];
+	double sum = 0.0;
+	for ( int i = 0; i < nPackets; i++ ) sum += SumTokens( token, OriginalParseCommaDelimitedLine( token, scriptLine[i % nScriptLines] ) );
+	return( sum );
+}
+
+static double BenchParseLine( void ) {
+	char *token[MAX_TOKENS];
+	double sum = 0.0;
+	for ( int i = 0; i < nPackets; i++ ) sum += SumTokens( token, ParseCommaDelimitedLine( token, scriptLine[i % nScriptLines] ) );
+	return( sum );
+}
+
+// This includes copying the line into the buffer. Parsing in place is the same without the copy.
+static double BenchParseLineBuffer( void ) {
+	char *token[MAX_TOKENS];
+	double sum = 0.0;
+	for ( int i = 0; i < nPackets; i++ ) {
+		const char *line = scriptLine[i % nScriptLines];
+		sum += SumTokens( token, ParseCommaDelimitedLineBuffer( token, line, scriptWork, strlen( line ) + 1 ) );
+	}
+	return( sum );
+}
+
+typedef struct {
+	const char	*name;
+	double		(*pass)( void );
+	int			*operations;	// Number of operations per pass.
+} Benchmark;
+
+static Benchmark benchmark[] = {
+	{ "ExtractEPMTelemetryHeaderInfo",			BenchExtractTelemetryHeader,		&nPackets },
+	{ "ExtractGripRealtimeDataInfo",			BenchExtractRealtimeData,			&nPackets },
+	{ "DexAnalogMixin::Compute",				BenchComputeForces,					&nSlices },
+	{ "DexAnalogMixin::Filter",					BenchFilters,						&nSlices },
+	{ "QuaternionToCannonicalRotations",		BenchQuaternionToRotations,			&nSlices },
+	{ "BatchQuaternionToCannonicalRotations",	BenchBatchQuaternionToRotations,	&nSlices },
+	{ "ComputeRigidBodyPose",					BenchRigidBodyPose,					&nSlices },
+	{ "ParseCommaDelimitedLineOriginal",		BenchParseLineOriginal,				&nPackets },
+	{ "ParseCommaDelimitedLine",				BenchParseLine,						&nPackets },
+	{ "ParseCommaDelimitedLineBuffer",			BenchParseLineBuffer,				&nPackets }
+};
+#define N_BENCHMARKS	( (int) ( sizeof( benchmark ) / sizeof( benchmark[0] ) ) )
+
+/***********************************************************************************/
+
+typedef struct {
+	char	name[64];
+	int		operations;
+	int		repetitions;
+	double	median;			// ns per operation
+	double	minimum;
+	double	maximum;
+	double	checksum;
+} BenchmarkResult;
+
+static int CompareDoubles( const void *a, const void *b ) {
+	double d = *((const double *) a) - *((const double *) b);
+	return( d < 0.0 ? -1 : ( d > 0.0 ? 1 : 0 ) );
+}
+
+static void RunBenchmark( BenchmarkResult *result, const Benchmark *b, int repetitions ) {
+
+	LARGE_INTEGER frequency, start, stop;
+	double *ns = (double *) malloc( repetitions * sizeof( double ) );
+	if ( !ns ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "Error allocating memory for %d repetitions.", repetitions );
+		exit( -1 );
+	}
+	QueryPerformanceFrequency( &frequency );
+
+	// One pass to warm the caches. It also gives the checksum, which must be the same on every pass.
+	result->checksum = b->pass();
+	for ( int r = 0; r < repetitions; r++ ) {
+		QueryPerformanceCounter( &start );
+		double checksum = b->pass();
+		QueryPerformanceCounter( &stop );
+		if ( checksum != result->checksum ) {
+			fMessageBox( MB_OK, "GripBenchmarks", "%s gave different results on different passes.", b->name );
+			exit( -1 );
+		}
+		ns[r] = 1.0e9 * (double) ( stop.QuadPart - start.QuadPart ) / (double) frequency.QuadPart / (double) *b->operations;
+	}
+	qsort( ns, repetitions, sizeof( double ), CompareDoubles );
+
+	_snprintf( result->name, sizeof( result->name ), "%s", b->name );
+	result->name[sizeof( result->name ) - 1] = 0;
+	result->operations = *b->operations;
+	result->repetitions = repetitions;
+	result->median = ( repetitions % 2 ? ns[repetitions / 2] : 0.5 * ( ns[repetitions / 2 - 1] + ns[repetitions / 2] ) );
+	result->minimum = ns[0];
+	result->maximum = ns[repetitions - 1];
+	free( ns );
+
+}
+
+#define RESULTS_HEADER	"benchmark,operations,repetitions,median_ns,min_ns,max_ns,checksum"
+
+static void WriteResults( FILE *fp, const BenchmarkResult result[], int n ) {
+	fprintf( fp, "%s\n", RESULTS_HEADER );
+	for ( int i = 0; i < n; i++ ) {
+		fprintf( fp, "%s,%d,%d,%.3f,%.3f,%.3f,%.17g\n", result[i].name, result[i].operations, result[i].repetitions,
+			result[i].median, result[i].minimum, result[i].maximum, result[i].checksum );
+	}
+}
+
+// Read results written by WriteResults(). Returns the number of benchmarks read.
+static int ReadResults( BenchmarkResult result[], int max, const char *filename ) {
+
+	char line[2048];
+	char *token[MAX_TOKENS];
+	int n = 0;
+
+	FILE *fp = fopen( filename, "r" );
+	if ( !fp ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "Error opening baseline file %s.", filename );
+		exit( -1 );
+	}
+	if ( !fgets( line, sizeof( line ), fp ) || strncmp( line, RESULTS_HEADER, strlen( RESULTS_HEADER ) ) ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "%s is not a GripBenchmarks results file.", filename );
+		exit( -1 );
+	}
+	while ( fgets( line, sizeof( line ), fp ) && n < max ) {
+		if ( ParseCommaDelimitedLine( token, line ) < 7 ) continue;
+		_snprintf( result[n].name, sizeof( result[n].name ), "%s", token[0] );
+		result[n].name[sizeof( result[n].name ) - 1] = 0;
+		result[n].operations = atoi( token[1] );
+		result[n].repetitions = atoi( token[2] );
+		result[n].median = atof( token[3] );
+		result[n].minimum = atof( token[4] );
+		result[n].maximum = atof( token[5] );
+		result[n].checksum = atof( token[6] );
+		n++;
+	}
+	fclose( fp );
+	return( n );
+
+}
+
+// Compare the medians to those of the baseline. Returns the number of regressions.
+static int CompareResults( const BenchmarkResult result[], int n, const BenchmarkResult baseline[], int nBaseline, double threshold ) {
+
+	int regressions = 0;
+
+	printf( "\n%-38s %12s %12s %9s\n", "benchmark", "baseline ns", "median ns", "change" );
+	for ( int i = 0; i < n; i++ ) {
+		const BenchmarkResult *base = NULL;
+		for ( int j = 0; j < nBaseline; j++ ) if ( !strcmp( baseline[j].name, result[i].name ) ) base = &baseline[j];
+		if ( !base || base->median <= 0.0 ) {
+			printf( "%-38s %12s %12.1f %9s  not in baseline\n", result[i].name, "", result[i].median, "" );
+			continue;
+		}
+		double change = 100.0 * ( result[i].median - base->median ) / base->median;
+		printf( "%-38s %12.1f %12.1f %+8.1f%%", result[i].name, base->median, result[i].median, change );
+		if ( change > threshold ) {
+			printf( "  REGRESSION" );
+			regressions++;
+		}
+		else if ( change < - threshold ) printf( "  IMPROVED" );
+		// The checksum only means something if the corpus was the same.
+		if ( base->operations == result[i].operations && fabs( base->checksum - result[i].checksum ) > 1.0e-9 * fabs( base->checksum ) ) printf( "  results differ from baseline" );
+		printf( "\n" );
+	}
+	printf( "\n%d regression%s beyond %.1f%%.\n", regressions, ( regressions == 1 ? "" : "s" ), threshold );
+	return( regressions );
+
+}
+
+/***********************************************************************************/
+
+int main( int argc, char **argv )
+{
+	int repetitions = DEFAULT_REPETITIONS;
+	unsigned long seed = SYNTHETIC_DEFAULT_SEED;
+	double threshold = DEFAULT_THRESHOLD;
+	char *only = NULL;
+	char *output = NULL;
+	char *compare = NULL;
+	char *script = NULL;
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strncmp( argv[arg], "-packets=", strlen( "-packets=" ) ) ) nPackets = atoi( argv[arg] + strlen( "-packets=" ) );
+		else if ( !strncmp( argv[arg], "-repetitions=", strlen( "-repetitions=" ) ) ) repetitions = atoi( argv[arg] + strlen( "-repetitions=" ) );
+		else if ( !strncmp( argv[arg], "-seed=", strlen( "-seed=" ) ) ) seed = strtoul( argv[arg] + strlen( "-seed=" ), NULL, 10 );
+		else if ( !strncmp( argv[arg], "-only=", strlen( "-only=" ) ) ) only = argv[arg] + strlen( "-only=" );
+		else if ( !strncmp( argv[arg], "-output=", strlen( "-output=" ) ) ) output = argv[arg] + strlen( "-output=" );
+		else if ( !strncmp( argv[arg], "-compare=", strlen( "-compare=" ) ) ) compare = argv[arg] + strlen( "-compare=" );
+		else if ( !strncmp( argv[arg], "-threshold=", strlen( "-threshold=" ) ) ) threshold = atof( argv[arg] + strlen( "-threshold=" ) );
+		else if ( !strncmp( argv[arg], "-script=", strlen( "-script=" ) ) ) script = argv[arg] + strlen( "-script=" );
+		else {
+			printf( "Usage: GripBenchmarks [-packets=n] [-repetitions=n] [-seed=n] [-only=name] [-output=results.csv]\n" );
+			printf( "                      [-compare=baseline.csv] [-threshold=percent] [-script=task file]\n" );
+			return( -1 );
+		}
+	}
+	if ( nPackets <= 0 || repetitions <= 0 || threshold < 0.0 ) {
+		fMessageBox( MB_OK, "GripBenchmarks", "The number of packets and of repetitions must be positive, and the threshold not negative." );
+		exit( -1 );
+	}
+
+	CreateCorpus( seed );
+	CreateScriptCorpus( script );
+	fprintf( stderr, "Corpus of %d packets (%d slices), seed %lu, %d script lines%s%s, %d repetitions.\n",
+		nPackets, nSlices, seed, nScriptLines, ( script ? " from " : "" ), ( script ? script : "" ), repetitions );
+
+	BenchmarkResult result[MAX_BENCHMARKS];
+	int n = 0;
+	for ( int i = 0; i < N_BENCHMARKS; i++ ) {
+		if ( only && !strstr( benchmark[i].name, only ) ) continue;
+		fprintf( stderr, "  %s\n", benchmark[i].name );
+		RunBenchmark( &result[n++], &benchmark[i], repetitions );
+	}
+
+	WriteResults( stdout, result, n );
+	if ( output ) {
+		FILE *fp = fopen( output, "w" );
+		if ( !fp ) {
+			fMessageBox( MB_OK, "GripBenchmarks", "Error opening %s for writing.", output );
+			exit( -1 );
+		}
+		WriteResults( fp, result, n );
+		fclose( fp );
+	}
+
+	if ( compare ) {
+		BenchmarkResult baseline[MAX_BASELINE];
+		int nBaseline = ReadResults( baseline, MAX_BASELINE, compare );
+		if ( CompareResults( result, n, baseline, nBaseline, threshold ) > 0 ) return( 1 );
+	}
+	return( 0 );
+}
@@ -21,6 +21,9 @@
 #include "GripMMIStartup.h"
 #include "GripMMIFullStep.h"
 #include "GripMMIDesktop.h"
+#include "GripMMIFrameStore.h"
+#include "..\Grip\GripTrace.h"
+#include "GripMMICounters.h"
 
 using namespace GripMMI;
 
@@ -41,6 +44,9 @@ int main(array<System::String ^> ^args)
 	if ( args->Length > 0 ) packetRoot = args[0];	// Where to look for packets written by GripGroundMonitorClient.exe
 	if ( args->Length > 1 ) scriptRoot = args[1];	// Where to find the script library.
 	if ( args->Length > 2 ) TimebaseOffset = Convert::ToInt32(args[2]); // Correct the time base. Default is 16 to correct to UTC. 0 is GPS time.
+	if ( args->Length > 3 ) liveTailHours = Convert::ToDouble(args[3]); // Hours of data to keep in memory for unattended operation. Default 0 keeps everything.
+	// In live tail mode, only the memory for the frames that are kept is allocated.
+	AllocateFrameBuffers( liveTailHours > 0.0 ? LiveTailCapacity() : MAX_FRAMES );
 	
 	// First, a lot of code to convert the Strings that we get from the command line
 	// to the (char *) values that the legacy script crawler code needs.
@@ -84,6 +90,10 @@ int main(array<System::String ^> ^args)
 	GripMMIStartup^ startupForm = gcnew GripMMIStartup( GripMMIVersion );
 	System::Windows::Forms::DialogResult result = startupForm->ShowDialog();
 	if ( result != System::Windows::Forms::DialogResult::Cancel ) {
+		// Record when packets are read and displayed, if tracing is enabled. See GripTrace.h.
+		GripTraceOpen( "GripMMI" );
+		// Publish the performance counters next to the packet cache. See GripMMICounters.h.
+		GripMMICountersOpen( packetBufferPathRoot );
 		// Create the main window and run it
 		Application::Run(gcnew GripMMIDesktop());
 	}
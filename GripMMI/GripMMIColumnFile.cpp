@@ -0,0 +1,653 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Files of tables stored column by column, compressed. See GripMMIColumnFile.h.
+
+// The chunks are deflated the way RasterWritePNG() deflates images: one block with the fixed
+//  Huffman codes and only matches at a distance of 1, that is runs of the same byte. That is
+//  what the shuffled columns are mostly made of, and it needs neither zlib nor much time.
+// A chunk that would come out bigger than it is goes into stored blocks instead.
+// The reader inflates only what the writer writes: stored and fixed Huffman blocks.
+
+#include "stdafx.h"
+#include <Windows.h>
+#include <process.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "..\Useful\fMessageBox.h"
+
+#include "GripMMIColumnFile.h"
+
+// No more threads than this, whatever the number of processors.
+#define MAX_COLUMN_THREADS	64
+
+#define DEFLATE_MAX_MATCH	258
+#define DEFLATE_MAX_STORED	65535
+#define ADLER_BLOCK			5552
+
+static void *ColumnAllocate( void *memory, size_t size ) {
+	memory = realloc( memory, size ? size : 1 );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for a column file." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+int GripColumnSize( GripColumnType type ) {
+	switch ( type ) {
+	case COLUMN_FLOAT64: return( 8 );
+	case COLUMN_UINT32: return( 4 );
+	case COLUMN_UINT8: return( 1 );
+	default: return( 0 );
+	}
+}
+
+static unsigned long Adler32( const unsigned char *data, size_t length ) {
+	unsigned long a = 1, b = 0;
+	// The sums cannot overflow within ADLER_BLOCK bytes, so the modulo is taken only once per block.
+	for ( size_t i = 0; i < length; ) {
+		size_t n = ( length - i < ADLER_BLOCK ? length - i : ADLER_BLOCK );
+		for ( size_t end = i + n; i < end; i++ ) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return( b << 16 | a );
+}
+
+///
+/// Deflate.
+///
+
+static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+									  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// The fixed Huffman codes, bit-reversed, since deflate packs the bits starting from the least
+//  significant but the codes starting from the most significant.
+static unsigned long symbolCode[288];
+static int symbolBits[288];
+// The match length symbol, and extra bits, for each length.
+static unsigned short lengthSymbol[DEFLATE_MAX_MATCH + 1];
+
+// Called before any thread can use the tables.
+static void PrepareDeflateTables( void ) {
+	static bool ready = false;
+	if ( ready ) return;
+	for ( int s = 0; s < 288; s++ ) {
+		unsigned long code;
+		int n;
+		if ( s < 144 ) { code = 0x30 + s; n = 8; }
+		else if ( s < 256 ) { code = 0x190 + s - 144; n = 9; }
+		else if ( s < 280 ) { code = s - 256; n = 7; }
+		else { code = 0xc0 + s - 280; n = 8; }
+		symbolCode[s] = 0;
+		for ( int i = 0; i < n; i++ ) symbolCode[s] |= ( ( code >> i ) & 0x01 ) << ( n - 1 - i );
+		symbolBits[s] = n;
+	}
+	for ( int length = 3, i = 0; length <= DEFLATE_MAX_MATCH; length++ ) {
+		while ( i < 28 && lengthBase[i + 1] <= length ) i++;
+		lengthSymbol[length] = (unsigned short) i;
+	}
+	ready = true;
+}
+
+// A compressed chunk, as it is built.
+typedef struct {
+	unsigned char	*data;
+	int				length;
+	int				capacity;
+	unsigned long	bits;
+	int				nbits;
+} ColumnStream;
+
+static void StreamBits( ColumnStream *stream, unsigned long value, int n ) {
+	stream->bits |= value << stream->nbits;
+	stream->nbits += n;
+	while ( stream->nbits >= 8 ) {
+		stream->data[stream->length++] = (unsigned char) ( stream->bits & 0xff );
+		stream->bits >>= 8;
+		stream->nbits -= 8;
+	}
+}
+
+static void StreamAlign( ColumnStream *stream ) {
+	if ( stream->nbits > 0 ) StreamBits( stream, 0, 8 - stream->nbits );
+}
+
+static void StreamSymbol( ColumnStream *stream, int symbol ) {
+	StreamBits( stream, symbolCode[symbol], symbolBits[symbol] );
+}
+
+// A run of length bytes that repeat the one before. Distance 1 has the code 0 and no extra bits.
+static void StreamRun( ColumnStream *stream, int length ) {
+	int i = lengthSymbol[length];
+	StreamSymbol( stream, 257 + i );
+	if ( lengthExtra[i] ) StreamBits( stream, length - lengthBase[i], lengthExtra[i] );
+	StreamBits( stream, 0, 5 );
+}
+
+static void StreamAdler( ColumnStream *stream, unsigned long adler ) {
+	for ( int shift = 24; shift >= 0; shift -= 8 ) stream->data[stream->length++] = (unsigned char) ( adler >> shift );
+}
+
+static int StoredSize( int length ) {
+	return( 2 + length + 5 * ( length / DEFLATE_MAX_STORED + 1 ) + 4 );
+}
+
+// Deflate length bytes into a zlib stream. The stream must have room for StoredSize( length ) bytes.
+static void Deflate( ColumnStream *stream, const unsigned char *data, int length ) {
+
+	int limit = StoredSize( length );
+
+	stream->length = 0;
+	stream->bits = 0;
+	stream->nbits = 0;
+	stream->data[stream->length++] = 0x78;
+	stream->data[stream->length++] = 0x01;
+
+	// One final block with the fixed codes, given up as soon as it is bigger than stored blocks would be.
+	// Each symbol takes at most 3 bytes, so the stream does not overflow before that is seen.
+	StreamBits( stream, 1, 1 );
+	StreamBits( stream, 1, 2 );
+	int i = 0;
+	while ( i < length && stream->length < limit - 8 ) {
+		int n = 0;
+		if ( i > 0 ) for ( ; n < DEFLATE_MAX_MATCH && i + n < length && data[i + n] == data[i - 1]; n++ );
+		if ( n >= 3 ) {
+			StreamRun( stream, n );
+			i += n;
+		}
+		else StreamSymbol( stream, data[i++] );
+	}
+	StreamSymbol( stream, 256 );
+	StreamAlign( stream );
+
+	if ( i < length || stream->length + 4 > limit ) {
+		stream->length = 2;
+		stream->bits = 0;
+		stream->nbits = 0;
+		i = 0;
+		do {
+			int n = ( length - i < DEFLATE_MAX_STORED ? length - i : DEFLATE_MAX_STORED );
+			StreamBits( stream, i + n == length ? 1 : 0, 1 );
+			StreamBits( stream, 0, 2 );
+			StreamAlign( stream );
+			StreamBits( stream, n, 16 );
+			StreamBits( stream, ~n & 0xffff, 16 );
+			memcpy( stream->data + stream->length, data + i, n );
+			stream->length += n;
+			i += n;
+		} while ( i < length );
+	}
+	StreamAdler( stream, Adler32( data, length ) );
+
+}
+
+///
+/// Inflate.
+///
+
+typedef struct {
+	const unsigned char	*data;
+	int					length;
+	int					next;
+	unsigned long		bits;
+	int					nbits;
+	bool				overrun;
+} BitReader;
+
+static unsigned long ReadBits( BitReader *reader, int n ) {
+	while ( reader->nbits < n ) {
+		if ( reader->next >= reader->length ) {
+			reader->overrun = true;
+			return( 0 );
+		}
+		reader->bits |= (unsigned long) reader->data[reader->next++] << reader->nbits;
+		reader->nbits += 8;
+	}
+	unsigned long value = reader->bits & ( ( 1UL << n ) - 1 );
+	reader->bits >>= n;
+	reader->nbits -= n;
+	return( value );
+}
+
+// The Huffman codes are read one bit at a time, starting from the most significant.
+static int ReadFixedSymbol( BitReader *reader ) {
+	int code = 0;
+	for ( int i = 0; i < 7; i++ ) code = code << 1 | (int) ReadBits( reader, 1 );
+	if ( code <= 0x17 ) return( 256 + code );
+	code = code << 1 | (int) ReadBits( reader, 1 );
+	if ( code >= 0x30 && code <= 0xbf ) return( code - 0x30 );
+	if ( code >= 0xc0 && code <= 0xc7 ) return( 280 + code - 0xc0 );
+	code = code << 1 | (int) ReadBits( reader, 1 );
+	return( 144 + code - 0x190 );
+}
+
+// Inflate a zlib stream into exactly length bytes.
+static bool Inflate( const unsigned char *data, int bytes, unsigned char *output, int length ) {
+
+	BitReader reader = { data, bytes, 2, 0, 0, false };
+	int out = 0;
+	bool final = false;
+
+	if ( bytes < 6 || ( data[0] & 0x0f ) != 8 || ( data[0] << 8 | data[1] ) % 31 || ( data[1] & 0x20 ) ) return( false );
+
+	while ( !final ) {
+		final = ( ReadBits( &reader, 1 ) != 0 );
+		int type = (int) ReadBits( &reader, 2 );
+		if ( type == 0 ) {
+			reader.bits = 0;
+			reader.nbits = 0;
+			if ( reader.next + 4 > bytes ) return( false );
+			int n = data[reader.next] | data[reader.next + 1] << 8;
+			int check = data[reader.next + 2] | data[reader.next + 3] << 8;
+			reader.next += 4;
+			if ( ( n ^ 0xffff ) != check || reader.next + n > bytes || out + n > length ) return( false );
+			memcpy( output + out, data + reader.next, n );
+			reader.next += n;
+			out += n;
+		}
+		else if ( type == 1 ) {
+			while ( true ) {
+				int symbol = ReadFixedSymbol( &reader );
+				if ( reader.overrun ) return( false );
+				if ( symbol < 256 ) {
+					if ( out >= length ) return( false );
+					output[out++] = (unsigned char) symbol;
+					continue;
+				}
+				if ( symbol == 256 ) break;
+				symbol -= 257;
+				if ( symbol >= 29 ) return( false );
+				int n = lengthBase[symbol] + (int) ReadBits( &reader, lengthExtra[symbol] );
+				int code = 0;
+				for ( int i = 0; i < 5; i++ ) code = code << 1 | (int) ReadBits( &reader, 1 );
+				if ( code >= 30 ) return( false );
+				int distance = distanceBase[code] + (int) ReadBits( &reader, distanceExtra[code] );
+				if ( reader.overrun || distance > out || out + n > length ) return( false );
+				for ( int i = 0; i < n; i++, out++ ) output[out] = output[out - distance];
+			}
+		}
+		// Dynamic Huffman codes are never written by Deflate() above.
+		else return( false );
+		if ( reader.overrun ) return( false );
+	}
+
+	// The Adler-32 checksum follows the last block, on a byte boundary.
+	int next = reader.next - reader.nbits / 8;
+	if ( out != length || next + 4 > bytes ) return( false );
+	unsigned long adler = (unsigned long) data[next] << 24 | (unsigned long) data[next + 1] << 16 | (unsigned long) data[next + 2] << 8 | data[next + 3];
+	return( adler == Adler32( output, length ) );
+
+}
+
+///
+/// Transforms.
+///
+
+// XOR each value with the one before, then group the bytes by significance.
+static void ShuffleColumn( unsigned char *planes, const unsigned char *values, int rows, int size ) {
+	for ( int b = 0; b < size; b++ ) {
+		unsigned char *plane = planes + (size_t) b * rows;
+		const unsigned char *value = values + b;
+		unsigned char previous = 0;
+		for ( int r = 0; r < rows; r++, value += size ) {
+			plane[r] = *value ^ previous;
+			previous = *value;
+		}
+	}
+}
+
+static void UnshuffleColumn( unsigned char *values, const unsigned char *planes, int rows, int size ) {
+	for ( int b = 0; b < size; b++ ) {
+		const unsigned char *plane = planes + (size_t) b * rows;
+		unsigned char *value = values + b;
+		unsigned char previous = 0;
+		for ( int r = 0; r < rows; r++, value += size ) {
+			previous ^= plane[r];
+			*value = previous;
+		}
+	}
+}
+
+///
+/// Writing.
+///
+
+// Work space of one column of the current table.
+typedef struct {
+	int				type;
+	int				encoding;
+	unsigned char	*planes;
+	ColumnStream	stream;
+	int				capacity;	// In rows.
+} ColumnBuffer;
+
+struct GripColumnWriter {
+
+	FILE					*fp;
+	bool					error;
+	__int64					offset;
+
+	// The directory, as it grows.
+	int						nTables;
+	GripColumnFileTable		*table;
+	int						nColumns;
+	GripColumnFileColumn	*column;
+	int						nChunks;
+	int						maxChunks;
+	GripColumnFileChunk		*chunk;
+
+	// The current table.
+	ColumnBuffer			*buffer;
+	int						nBuffers;
+
+	// The row group that is being compressed.
+	const void * const		*values;
+	int						rows;
+	volatile LONG			next;
+
+};
+
+static void Write( GripColumnWriter *writer, const void *data, size_t bytes ) {
+	if ( bytes > 0 && fwrite( data, 1, bytes, writer->fp ) != bytes ) writer->error = true;
+	writer->offset += bytes;
+}
+
+GripColumnWriter *CreateGripColumnFile( const char *filename ) {
+	PrepareDeflateTables();
+	FILE *fp = fopen( filename, "wb" );
+	if ( !fp ) return( NULL );
+	GripColumnWriter *writer = (GripColumnWriter *) ColumnAllocate( NULL, sizeof( GripColumnWriter ) );
+	memset( writer, 0, sizeof( *writer ) );
+	writer->fp = fp;
+	char magic[8] = GRIP_COLUMN_FILE_MAGIC;
+	Write( writer, magic, sizeof( magic ) );
+	return( writer );
+}
+
+static void FreeColumnBuffers( GripColumnWriter *writer ) {
+	for ( int c = 0; c < writer->nBuffers; c++ ) {
+		free( writer->buffer[c].planes );
+		free( writer->buffer[c].stream.data );
+	}
+	free( writer->buffer );
+	writer->buffer = NULL;
+	writer->nBuffers = 0;
+}
+
+void StartGripColumnTable( GripColumnWriter *writer, const char *name, const char * const *column, const GripColumnType *type, int nColumns ) {
+
+	FreeColumnBuffers( writer );
+	writer->table = (GripColumnFileTable *) ColumnAllocate( writer->table, ( writer->nTables + 1 ) * sizeof( GripColumnFileTable ) );
+	GripColumnFileTable *table = &writer->table[writer->nTables++];
+	memset( table, 0, sizeof( *table ) );
+	strncpy( table->name, name, GRIP_COLUMN_NAME_LENGTH - 1 );
+	table->nColumns = nColumns;
+
+	writer->column = (GripColumnFileColumn *) ColumnAllocate( writer->column, ( writer->nColumns + nColumns ) * sizeof( GripColumnFileColumn ) );
+	writer->buffer = (ColumnBuffer *) ColumnAllocate( NULL, nColumns * sizeof( ColumnBuffer ) );
+	memset( writer->buffer, 0, nColumns * sizeof( ColumnBuffer ) );
+	writer->nBuffers = nColumns;
+	for ( int c = 0; c < nColumns; c++ ) {
+		GripColumnFileColumn *entry = &writer->column[writer->nColumns + c];
+		memset( entry, 0, sizeof( *entry ) );
+		strncpy( entry->name, column[c], GRIP_COLUMN_NAME_LENGTH - 1 );
+		entry->type = type[c];
+		entry->encoding = ( type[c] == COLUMN_UINT8 ? COLUMN_PLAIN : COLUMN_XOR_SHUFFLE );
+		writer->buffer[c].type = entry->type;
+		writer->buffer[c].encoding = entry->encoding;
+	}
+	writer->nColumns += nColumns;
+
+}
+
+static unsigned __stdcall CompressColumnThread( void *parameter ) {
+	GripColumnWriter *writer = (GripColumnWriter *) parameter;
+	int rows = writer->rows;
+	for ( int c = InterlockedIncrement( &writer->next ) - 1; c < writer->nBuffers; c = InterlockedIncrement( &writer->next ) - 1 ) {
+		ColumnBuffer *buffer = &writer->buffer[c];
+		int size = GripColumnSize( (GripColumnType) buffer->type );
+		const unsigned char *data = (const unsigned char *) writer->values[c];
+		if ( buffer->encoding == COLUMN_XOR_SHUFFLE ) {
+			ShuffleColumn( buffer->planes, data, rows, size );
+			data = buffer->planes;
+		}
+		Deflate( &buffer->stream, data, rows * size );
+	}
+	return( 0 );
+}
+
+void WriteGripRowGroup( GripColumnWriter *writer, const void * const *values, int rows ) {
+
+	HANDLE thread[MAX_COLUMN_THREADS];
+	SYSTEM_INFO system;
+	int threads, max_threads;
+	GripColumnFileTable *table = &writer->table[writer->nTables - 1];
+
+	if ( rows <= 0 ) return;
+	for ( int c = 0; c < writer->nBuffers; c++ ) {
+		ColumnBuffer *buffer = &writer->buffer[c];
+		if ( buffer->capacity >= rows ) continue;
+		int size = GripColumnSize( (GripColumnType) buffer->type );
+		buffer->planes = (unsigned char *) ColumnAllocate( buffer->planes, (size_t) rows * size );
+		buffer->stream.capacity = StoredSize( rows * size );
+		buffer->stream.data = (unsigned char *) ColumnAllocate( buffer->stream.data, buffer->stream.capacity );
+		buffer->capacity = rows;
+	}
+
+	// One thread per processor, this one included, each taking the next column.
+	writer->values = values;
+	writer->rows = rows;
+	writer->next = 0;
+	GetSystemInfo( &system );
+	max_threads = (int) system.dwNumberOfProcessors;
+	if ( max_threads > MAX_COLUMN_THREADS ) max_threads = MAX_COLUMN_THREADS;
+	for ( threads = 0; threads < max_threads - 1 && threads < writer->nBuffers - 1; threads++ ) {
+		thread[threads] = (HANDLE) _beginthreadex( NULL, 0, CompressColumnThread, writer, 0, NULL );
+		if ( !thread[threads] ) break;
+	}
+	CompressColumnThread( writer );
+	for ( int i = 0; i < threads; i++ ) {
+		WaitForSingleObject( thread[i], INFINITE );
+		CloseHandle( thread[i] );
+	}
+
+	// The chunks are written in column order, whichever thread compressed them.
+	if ( writer->nChunks + writer->nBuffers > writer->maxChunks ) {
+		writer->maxChunks = ( writer->maxChunks ? 2 * writer->maxChunks : 1024 ) + writer->nBuffers;
+		writer->chunk = (GripColumnFileChunk *) ColumnAllocate( writer->chunk, writer->maxChunks * sizeof( GripColumnFileChunk ) );
+	}
+	for ( int c = 0; c < writer->nBuffers; c++ ) {
+		GripColumnFileChunk *chunk = &writer->chunk[writer->nChunks++];
+		chunk->offset = writer->offset;
+		chunk->bytes = writer->buffer[c].stream.length;
+		chunk->rows = rows;
+		Write( writer, writer->buffer[c].stream.data, chunk->bytes );
+	}
+	if ( rows > table->rowsPerGroup ) table->rowsPerGroup = rows;
+	table->rows += rows;
+	table->nGroups++;
+
+}
+
+bool CloseGripColumnFile( GripColumnWriter *writer, __int64 *size ) {
+
+	GripColumnFileTrailer trailer;
+	memset( &trailer, 0, sizeof( trailer ) );
+	trailer.directory = writer->offset;
+	trailer.nTables = writer->nTables;
+	trailer.version = GRIP_COLUMN_FILE_VERSION;
+	strcpy( trailer.magic, GRIP_COLUMN_FILE_MAGIC );
+
+	Write( writer, writer->table, writer->nTables * sizeof( GripColumnFileTable ) );
+	Write( writer, writer->column, writer->nColumns * sizeof( GripColumnFileColumn ) );
+	Write( writer, writer->chunk, writer->nChunks * sizeof( GripColumnFileChunk ) );
+	Write( writer, &trailer, sizeof( trailer ) );
+	if ( fclose( writer->fp ) ) writer->error = true;
+
+	bool ok = !writer->error;
+	if ( size ) *size = writer->offset;
+	FreeColumnBuffers( writer );
+	free( writer->table );
+	free( writer->column );
+	free( writer->chunk );
+	free( writer );
+	return( ok );
+
+}
+
+///
+/// Reading.
+///
+
+static bool ReadAt( FILE *fp, __int64 offset, void *data, size_t bytes ) {
+	if ( _fseeki64( fp, offset, SEEK_SET ) ) return( false );
+	return( bytes == 0 || fread( data, 1, bytes, fp ) == bytes );
+}
+
+// Everything that is read from the directory is checked before it is used.
+static GripColumnFile *DamagedColumnFile( GripColumnFile *file ) {
+	FreeGripColumnFile( file );
+	return( NULL );
+}
+
+GripColumnFile *OpenGripColumnFile( const char *filename ) {
+
+	GripColumnFileTrailer trailer;
+	char magic[8];
+	__int64 size;
+
+	PrepareDeflateTables();
+	FILE *fp = fopen( filename, "rb" );
+	if ( !fp ) return( NULL );
+	GripColumnFile *file = (GripColumnFile *) ColumnAllocate( NULL, sizeof( GripColumnFile ) );
+	memset( file, 0, sizeof( *file ) );
+	file->fp = fp;
+
+	if ( _fseeki64( fp, 0, SEEK_END ) ) return( DamagedColumnFile( file ) );
+	size = _ftelli64( fp );
+	if ( size < (__int64) ( sizeof( magic ) + sizeof( trailer ) ) ) return( DamagedColumnFile( file ) );
+	if ( !ReadAt( fp, 0, magic, sizeof( magic ) ) || memcmp( magic, GRIP_COLUMN_FILE_MAGIC, sizeof( magic ) ) ) return( DamagedColumnFile( file ) );
+	if ( !ReadAt( fp, size - sizeof( trailer ), &trailer, sizeof( trailer ) ) ) return( DamagedColumnFile( file ) );
+	if ( memcmp( trailer.magic, GRIP_COLUMN_FILE_MAGIC, sizeof( trailer.magic ) ) || trailer.version != GRIP_COLUMN_FILE_VERSION ) return( DamagedColumnFile( file ) );
+	__int64 end = size - sizeof( trailer );
+	if ( trailer.directory < (__int64) sizeof( magic ) || trailer.directory > end || trailer.nTables < 0 ) return( DamagedColumnFile( file ) );
+	if ( trailer.nTables > ( end - trailer.directory ) / (__int64) sizeof( GripColumnFileTable ) ) return( DamagedColumnFile( file ) );
+
+	file->table = (GripColumnFileTable *) ColumnAllocate( NULL, trailer.nTables * sizeof( GripColumnFileTable ) );
+	file->column = (GripColumnFileColumn **) ColumnAllocate( NULL, trailer.nTables * sizeof( GripColumnFileColumn * ) );
+	file->chunk = (GripColumnFileChunk **) ColumnAllocate( NULL, trailer.nTables * sizeof( GripColumnFileChunk * ) );
+	memset( file->column, 0, trailer.nTables * sizeof( GripColumnFileColumn * ) );
+	memset( file->chunk, 0, trailer.nTables * sizeof( GripColumnFileChunk * ) );
+	file->nTables = trailer.nTables;
+
+	__int64 offset = trailer.directory;
+	if ( !ReadAt( fp, offset, file->table, trailer.nTables * sizeof( GripColumnFileTable ) ) ) return( DamagedColumnFile( file ) );
+	offset += trailer.nTables * sizeof( GripColumnFileTable );
+	for ( int t = 0; t < file->nTables; t++ ) {
+		GripColumnFileTable *table = &file->table[t];
+		table->name[GRIP_COLUMN_NAME_LENGTH - 1] = 0;
+		if ( table->nColumns < 0 || table->nColumns > ( end - offset ) / (__int64) sizeof( GripColumnFileColumn ) ) return( DamagedColumnFile( file ) );
+		file->column[t] = (GripColumnFileColumn *) ColumnAllocate( NULL, table->nColumns * sizeof( GripColumnFileColumn ) );
+		if ( !ReadAt( fp, offset, file->column[t], table->nColumns * sizeof( GripColumnFileColumn ) ) ) return( DamagedColumnFile( file ) );
+		offset += table->nColumns * sizeof( GripColumnFileColumn );
+		for ( int c = 0; c < table->nColumns; c++ ) {
+			GripColumnFileColumn *column = &file->column[t][c];
+			column->name[GRIP_COLUMN_NAME_LENGTH - 1] = 0;
+			if ( !GripColumnSize( (GripColumnType) column->type ) || ( column->encoding != COLUMN_PLAIN && column->encoding != COLUMN_XOR_SHUFFLE ) ) return( DamagedColumnFile( file ) );
+		}
+	}
+	for ( int t = 0; t < file->nTables; t++ ) {
+		GripColumnFileTable *table = &file->table[t];
+		__int64 chunks = (__int64) table->nGroups * table->nColumns;
+		if ( table->nGroups < 0 || ( table->nColumns > 0 && chunks / table->nColumns != table->nGroups ) ) return( DamagedColumnFile( file ) );
+		if ( chunks > ( end - offset ) / (__int64) sizeof( GripColumnFileChunk ) ) return( DamagedColumnFile( file ) );
+		file->chunk[t] = (GripColumnFileChunk *) ColumnAllocate( NULL, (size_t) chunks * sizeof( GripColumnFileChunk ) );
+		if ( !ReadAt( fp, offset, file->chunk[t], (size_t) chunks * sizeof( GripColumnFileChunk ) ) ) return( DamagedColumnFile( file ) );
+		offset += chunks * sizeof( GripColumnFileChunk );
+		// Every column has the rows of the table, in chunks that lie before the directory.
+		for ( int c = 0; c < table->nColumns; c++ ) {
+			__int64 rows = 0;
+			for ( int g = 0; g < table->nGroups; g++ ) {
+				const GripColumnFileChunk *chunk = &file->chunk[t][(size_t) g * table->nColumns + c];
+				if ( chunk->offset < (__int64) sizeof( magic ) || chunk->bytes < 0 || chunk->offset + chunk->bytes > trailer.directory ) return( DamagedColumnFile( file ) );
+				if ( chunk->rows < 0 || chunk->rows > table->rowsPerGroup ) return( DamagedColumnFile( file ) );
+				rows += chunk->rows;
+			}
+			if ( rows != table->rows ) return( DamagedColumnFile( file ) );
+		}
+	}
+	if ( offset != end ) return( DamagedColumnFile( file ) );
+	return( file );
+
+}
+
+void FreeGripColumnFile( GripColumnFile *file ) {
+	if ( !file ) return;
+	for ( int t = 0; t < file->nTables; t++ ) {
+		if ( file->column ) free( file->column[t] );
+		if ( file->chunk ) free( file->chunk[t] );
+	}
+	free( file->table );
+	free( file->column );
+	free( file->chunk );
+	fclose( file->fp );
+	free( file );
+}
+
+int FindGripColumnTable( const GripColumnFile *file, const char *name ) {
+	for ( int t = 0; t < file->nTables; t++ ) if ( !strcmp( file->table[t].name, name ) ) return( t );
+	return( -1 );
+}
+
+int FindGripColumn( const GripColumnFile *file, int table, const char *name ) {
+	if ( table < 0 || table >= file->nTables ) return( -1 );
+	for ( int c = 0; c < file->table[table].nColumns; c++ ) if ( !strcmp( file->column[table][c].name, name ) ) return( c );
+	return( -1 );
+}
+
+bool ReadGripColumn( GripColumnFile *file, int table, int column, void *values ) {
+
+	if ( table < 0 || table >= file->nTables || column < 0 || column >= file->table[table].nColumns ) return( false );
+	const GripColumnFileTable *entry = &file->table[table];
+	const GripColumnFileColumn *spec = &file->column[table][column];
+	int size = GripColumnSize( (GripColumnType) spec->type );
+	unsigned char *output = (unsigned char *) values;
+	unsigned char *compressed = NULL, *planes = NULL;
+	int max_bytes = 0;
+	bool ok = true;
+
+	if ( spec->encoding == COLUMN_XOR_SHUFFLE ) planes = (unsigned char *) ColumnAllocate( NULL, (size_t) entry->rowsPerGroup * size );
+	for ( int g = 0; g < entry->nGroups && ok; g++ ) {
+		const GripColumnFileChunk *chunk = &file->chunk[table][(size_t) g * entry->nColumns + column];
+		if ( chunk->bytes > max_bytes ) {
+			max_bytes = chunk->bytes;
+			compressed = (unsigned char *) ColumnAllocate( compressed, max_bytes );
+		}
+		ok = ReadAt( file->fp, chunk->offset, compressed, chunk->bytes )
+			&& Inflate( compressed, chunk->bytes, planes ? planes : output, chunk->rows * size );
+		if ( ok && planes ) UnshuffleColumn( output, planes, chunk->rows, size );
+		output += (size_t) chunk->rows * size;
+	}
+	free( compressed );
+	free( planes );
+	return( ok );
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Files of tables stored column by column, compressed.
+
+// A column file holds one or more tables. Each table has named columns of the same number of rows
+//  and is written in row groups, so that the writer never holds more than one row group of each
+//  column. Each column of each row group is a chunk, compressed on its own, and the directory of
+//  the chunks is at the end of the file, so one column is read without touching the others.
+// The columns of a row group are compressed in parallel, shared out among the processors, and
+//  then written in column order.
+//
+// The layout, in the byte order of the machine that writes it (little-endian):
+//   "GRIPCOL" and a 0 byte
+//   the chunks, one after another
+//   the directory:
+//     GripColumnFileTable  for each table
+//     GripColumnFileColumn for each column of each table, table by table
+//     GripColumnFileChunk  for each chunk, table by table, then row group by row group, then column by column
+//   the trailer (GripColumnFileTrailer), which says where the directory starts.
+// A chunk is a zlib stream (RFC 1950) that inflates to the values of the column for the rows of the
+//  row group, transformed according to the encoding of the column:
+//   COLUMN_PLAIN       the values as they are;
+//   COLUMN_XOR_SHUFFLE each value is first XORed with the one before it in the row group (the first
+//                      with 0), and then the bytes are grouped by significance: the least significant
+//                      byte of every value, then the next, and so on.
+// Doubles and integers that change little from one frame to the next then give long runs of zeros.
+// To read a chunk elsewhere (MATLAB, Python), inflate it with zlib, undo the shuffle, and take the
+//  cumulative XOR.
+
+#include <stdio.h>
+
+#define GRIP_COLUMN_FILE_MAGIC		"GRIPCOL"
+#define GRIP_COLUMN_FILE_VERSION	1
+#define GRIP_COLUMN_NAME_LENGTH		32
+
+typedef enum { COLUMN_FLOAT64 = 1, COLUMN_UINT32 = 2, COLUMN_UINT8 = 3 } GripColumnType;
+typedef enum { COLUMN_PLAIN = 0, COLUMN_XOR_SHUFFLE = 1 } GripColumnEncoding;
+
+typedef struct {
+	char			name[GRIP_COLUMN_NAME_LENGTH];
+	__int64			rows;
+	int				nColumns;
+	int				nGroups;
+	int				rowsPerGroup;	// Of all the row groups but the last.
+	int				spare;
+} GripColumnFileTable;
+
+typedef struct {
+	char			name[GRIP_COLUMN_NAME_LENGTH];
+	int				type;			// GripColumnType
+	int				encoding;		// GripColumnEncoding
+} GripColumnFileColumn;
+
+typedef struct {
+	__int64			offset;			// From the start of the file.
+	int				bytes;			// Compressed.
+	int				rows;
+} GripColumnFileChunk;
+
+typedef struct {
+	__int64			directory;		// Offset of the directory.
+	int				nTables;
+	int				version;
+	char			magic[8];
+} GripColumnFileTrailer;
+
+// Bytes per value.
+int GripColumnSize( GripColumnType type );
+
+///
+/// Writing.
+///
+
+typedef struct GripColumnWriter GripColumnWriter;
+
+// NULL if the file cannot be created.
+GripColumnWriter *CreateGripColumnFile( const char *filename );
+
+// Start a table. Any table that was started before is finished.
+// The columns are given as names and types. The encoding follows from the type.
+void StartGripColumnTable( GripColumnWriter *writer, const char *name, const char * const *column, const GripColumnType *type, int nColumns );
+
+// Write one row group of the current table. values[c] points to the rows values of column c.
+// All the row groups of a table but the last should have the same number of rows.
+void WriteGripRowGroup( GripColumnWriter *writer, const void * const *values, int rows );
+
+// Write the directory and close the file. Returns false if anything could not be written.
+// Returns the size of the file in bytes if size is not NULL.
+bool CloseGripColumnFile( GripColumnWriter *writer, __int64 *size );
+
+///
+/// Reading.
+///
+
+typedef struct {
+	FILE					*fp;
+	int						nTables;
+	GripColumnFileTable		*table;
+	GripColumnFileColumn	**column;	// Per table.
+	GripColumnFileChunk		**chunk;	// Per table, nGroups * nColumns.
+} GripColumnFile;
+
+// Read the directory only. NULL if it is not a column file or it is damaged.
+GripColumnFile *OpenGripColumnFile( const char *filename );
+void FreeGripColumnFile( GripColumnFile *file );
+
+// Indexes by name, or -1.
+int FindGripColumnTable( const GripColumnFile *file, const char *name );
+int FindGripColumn( const GripColumnFile *file, int table, const char *name );
+
+// Read all the rows of one column into values, which has room for file->table[table].rows values.
+// Only the chunks of that column are read. Returns false if a chunk does not decode.
+bool ReadGripColumn( GripColumnFile *file, int table, int column, void *values );
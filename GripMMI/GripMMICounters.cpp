@@ -0,0 +1,138 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Performance counters for the GripMMI refresh cycle. See GripMMICounters.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\fOutputDebugString.h"
+
+#include "GripMMICounters.h"
+
+GripMMICounterBlock gripMMICounters;
+
+// The view of the stats file, or NULL if it could not be created.
+static GripMMICounterBlock *published = NULL;
+
+// Names, units and kinds, in the order of GripMMICounterID.
+static const struct {
+	GripMMICounterID	id;
+	const char			*name;
+	const char			*unit;
+	GripMMICounterKind	kind;
+} counterDefinitions[GRIPMMI_COUNTERS] = {
+	{ CTR_REFRESH_CYCLES,				"refresh cycles",			"",			COUNTER_TOTAL },
+	{ CTR_REFRESH_LATENESS,				"refresh timer lateness",	"",			COUNTER_TIMER },
+	{ CTR_PACKETS_READ,					"packets read",				"",			COUNTER_TOTAL },
+	{ CTR_PACKETS_LAST_CYCLE,			"packets last cycle",		"",			COUNTER_GAUGE },
+	{ CTR_BYTES_SCANNED,				"bytes scanned",			"bytes",	COUNTER_TOTAL },
+	{ CTR_DECODE_TIME,					"decode packet",			"",			COUNTER_TIMER },
+	{ CTR_FILTER_TIME,					"compute and filter",		"",			COUNTER_TIMER },
+	{ CTR_FRAMES,						"frames in memory",			"",			COUNTER_GAUGE },
+	{ CTR_FRAME_STORE_BYTES,			"frame store memory",		"bytes",	COUNTER_GAUGE },
+	{ CTR_REFRESH_GRAPHICS,				"refresh graphics",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_POSITION,				"graph position",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_POSITION_COMPONENT,		"graph position xyz",		"",			COUNTER_TIMER },
+	{ CTR_GRAPH_ACCELERATION,			"graph acceleration",		"",			COUNTER_TIMER },
+	{ CTR_GRAPH_ACCELERATION_COMPONENT,	"graph acceleration xyz",	"",			COUNTER_TIMER },
+	{ CTR_GRAPH_ROTATIONS,				"graph rotations",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_GRIP,					"graph grip force",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_LOAD,					"graph load force",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_COP,					"graph cop",				"",			COUNTER_TIMER },
+	{ CTR_GRAPH_VISIBILITY,				"graph visibility",			"",			COUNTER_TIMER },
+	{ CTR_GRAPH_VISIBILITY_DETAILS,		"graph marker visibility",	"",			COUNTER_TIMER },
+	{ CTR_PLOT_POSITION,				"plot position xy zy",		"",			COUNTER_TIMER },
+	{ CTR_PLOT_COP,						"plot cop",					"",			COUNTER_TIMER },
+	{ CTR_VERTICES,						"vertices drawn",			"",			COUNTER_TOTAL },
+	{ CTR_AUTOSCALE_PASSES,				"autoscale passes",			"",			COUNTER_TOTAL },
+	{ CTR_UPDATE_STATUS,				"update status",			"",			COUNTER_TIMER },
+	{ CTR_PICTURE_HITS,					"picture cache hits",		"",			COUNTER_TOTAL },
+	{ CTR_PICTURE_MISSES,				"picture cache misses",		"",			COUNTER_TOTAL },
+	{ CTR_PICTURES_PREFETCHED,			"pictures read ahead",		"",			COUNTER_TOTAL },
+	{ CTR_PICTURES_EVICTED,				"pictures dropped",			"",			COUNTER_TOTAL },
+	{ CTR_PICTURES,						"pictures cached",			"",			COUNTER_GAUGE },
+	{ CTR_PICTURE_BYTES,				"picture cache memory",		"bytes",	COUNTER_GAUGE }
+};
+
+void GripMMICountersOpen( const char *path_root ) {
+
+	char filename[MAX_PATHLENGTH];
+	LARGE_INTEGER frequency;
+	HANDLE file, mapping;
+
+	// Fill in the header and the counter descriptions, whether or not the file can be created.
+	memset( &gripMMICounters, 0, sizeof( gripMMICounters ) );
+	memcpy( gripMMICounters.magic, GRIPMMI_COUNTERS_MAGIC, sizeof( gripMMICounters.magic ) );
+	gripMMICounters.pid = GetCurrentProcessId();
+	gripMMICounters.nCounters = GRIPMMI_COUNTERS;
+	QueryPerformanceFrequency( &frequency );
+	gripMMICounters.frequency = frequency.QuadPart;
+	for ( int i = 0; i < GRIPMMI_COUNTERS; i++ ) {
+		GripMMICounter *c = &gripMMICounters.counter[counterDefinitions[i].id];
+		strncpy( c->name, counterDefinitions[i].name, sizeof( c->name ) - 1 );
+		strncpy( c->unit, counterDefinitions[i].unit, sizeof( c->unit ) - 1 );
+		c->kind = counterDefinitions[i].kind;
+	}
+
+	// The counters are a diagnostic aid. If the file cannot be created, just say so and go on.
+	if ( _snprintf( filename, sizeof( filename ), "%s%s", path_root, GRIPMMI_COUNTERS_FILE_EXTENSION ) < 0 ) {
+		fOutputDebugString( "Path to the stats file is too long. Counters will not be published.\n" );
+		return;
+	}
+	// GripMMIStats may have the file mapped from a previous run, in which case it cannot be truncated.
+	// So open it as it is. The whole block is written below and GripMMIStats sees that the pid has changed.
+	file = CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		fOutputDebugString( "Error creating stats file %s (%lu). Counters will not be published.\n", filename, GetLastError() );
+		return;
+	}
+	mapping = CreateFileMappingA( file, NULL, PAGE_READWRITE, 0, sizeof( GripMMICounterBlock ), NULL );
+	// The mapping keeps the file open, so we no longer need the handle.
+	CloseHandle( file );
+	if ( !mapping ) {
+		fOutputDebugString( "Error mapping stats file %s (%lu). Counters will not be published.\n", filename, GetLastError() );
+		return;
+	}
+	published = (GripMMICounterBlock *) MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, sizeof( GripMMICounterBlock ) );
+	CloseHandle( mapping );
+	if ( !published ) {
+		fOutputDebugString( "Error mapping stats file %s (%lu). Counters will not be published.\n", filename, GetLastError() );
+		return;
+	}
+	GripMMICountersPublish();
+	fOutputDebugString( "Publishing counters to %s.\n", filename );
+
+}
+
+void GripMMICountersPublish( void ) {
+
+	LARGE_INTEGER now;
+	long sequence;
+
+	if ( !published ) return;
+
+	QueryPerformanceCounter( &now );
+	gripMMICounters.published = now.QuadPart;
+
+	// The sequence number is odd while the copy is in progress. The interlocked
+	//  operations are memory barriers, so the reader sees it change before and after the copy.
+	sequence = ( published->sequence | 0x01 ) + 2;
+	InterlockedExchange( &published->sequence, sequence );
+	gripMMICounters.sequence = sequence;
+	memcpy( published, &gripMMICounters, sizeof( gripMMICounters ) );
+	InterlockedExchange( &published->sequence, sequence + 1 );
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Performance counters for the GripMMI refresh cycle.
+
+// GripMMI keeps a fixed set of counters on what it does in each refresh cycle: how many packets
+//  and bytes it reads, how long it takes to decode and filter them and to draw each graph,
+//  how many vertices it draws, etc. The counters are updated in memory with plain additions
+//  and a read of the performance counter for the timers, so they are always on.
+// At the end of each refresh cycle the counters are copied to a memory-mapped file next to the
+//  packet cache, <packetBufferPathRoot>.stats, where GripMMIStats.exe can read them while GripMMI runs.
+// The file starts with a GripMMICounterBlock. GripMMIStats uses this header to interpret it,
+//  so the layout must only change along with GRIPMMI_COUNTERS_MAGIC.
+
+#define GRIPMMI_COUNTERS_MAGIC	"GRIPCTR2"
+#define GRIPMMI_COUNTERS_FILE_EXTENSION	".stats"
+
+typedef enum {
+	COUNTER_TOTAL = 0,	// Running total since GripMMI started.
+	COUNTER_GAUGE,		// Value at the last update.
+	COUNTER_TIMER		// Number of samples and the total, max and last duration in performance counter ticks.
+} GripMMICounterKind;
+
+typedef enum {
+	CTR_REFRESH_CYCLES = 0,
+	CTR_REFRESH_LATENESS,
+	CTR_PACKETS_READ,
+	CTR_PACKETS_LAST_CYCLE,
+	CTR_BYTES_SCANNED,
+	CTR_DECODE_TIME,
+	CTR_FILTER_TIME,
+	CTR_FRAMES,
+	CTR_FRAME_STORE_BYTES,
+	CTR_REFRESH_GRAPHICS,
+	CTR_GRAPH_POSITION,
+	CTR_GRAPH_POSITION_COMPONENT,
+	CTR_GRAPH_ACCELERATION,
+	CTR_GRAPH_ACCELERATION_COMPONENT,
+	CTR_GRAPH_ROTATIONS,
+	CTR_GRAPH_GRIP,
+	CTR_GRAPH_LOAD,
+	CTR_GRAPH_COP,
+	CTR_GRAPH_VISIBILITY,
+	CTR_GRAPH_VISIBILITY_DETAILS,
+	CTR_PLOT_POSITION,
+	CTR_PLOT_COP,
+	CTR_VERTICES,
+	CTR_AUTOSCALE_PASSES,
+	CTR_UPDATE_STATUS,
+	CTR_PICTURE_HITS,
+	CTR_PICTURE_MISSES,
+	CTR_PICTURES_PREFETCHED,
+	CTR_PICTURES_EVICTED,
+	CTR_PICTURES,
+	CTR_PICTURE_BYTES,
+	GRIPMMI_COUNTERS
+} GripMMICounterID;
+
+typedef struct {
+	char			name[32];
+	char			unit[8];
+	unsigned long	kind;
+	unsigned long	unused;
+	__int64			count;		// The value for totals and gauges, the number of samples for timers.
+	__int64			total;
+	__int64			max;
+	__int64			last;
+} GripMMICounter;
+
+typedef struct {
+	char			magic[8];
+	unsigned long	pid;
+	unsigned long	nCounters;
+	__int64			frequency;	// Performance counter ticks per second, to convert the timers.
+	// Odd while the block is being copied to the file. A reader that sees it odd, or sees it
+	//  change while it copies the block, should try again.
+	volatile long	sequence;
+	unsigned long	unused;
+	__int64			published;	// Performance counter at the last copy to the file.
+	GripMMICounter	counter[GRIPMMI_COUNTERS];
+} GripMMICounterBlock;
+
+// The counters of this process.
+extern GripMMICounterBlock gripMMICounters;
+
+// Create the stats file. If it cannot be created the counters are still kept, but not published.
+void GripMMICountersOpen( const char *path_root );
+// Copy the counters to the stats file. Called once per refresh cycle.
+void GripMMICountersPublish( void );
+
+inline void CounterAdd( GripMMICounterID id, __int64 n ) {
+	gripMMICounters.counter[id].count += n;
+}
+inline void CounterSet( GripMMICounterID id, __int64 value ) {
+	gripMMICounters.counter[id].count = value;
+}
+inline __int64 CounterStart( void ) {
+	LARGE_INTEGER now;
+	QueryPerformanceCounter( &now );
+	return( now.QuadPart );
+}
+inline void CounterSample( GripMMICounterID id, __int64 ticks ) {
+	GripMMICounter *c = &gripMMICounters.counter[id];
+	c->count++;
+	c->total += ticks;
+	c->last = ticks;
+	if ( ticks > c->max ) c->max = ticks;
+}
+inline void CounterStop( GripMMICounterID id, __int64 start ) {
+	CounterSample( id, CounterStart() - start );
+}
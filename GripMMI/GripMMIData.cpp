@@ -24,6 +24,10 @@
 #include <vcclr.h>
 
 #include "GripMMIDesktop.h"
+#include "GripMMIFrameStore.h"
+#include "GripMMIFrameDecoder.h"
+#include "GripMMICounters.h"
+#include "GripMMITimeline.h"
 
 #include "..\Useful\Useful.h"
 #include "..\Useful\VectorsMixin.h"
@@ -31,6 +35,7 @@
 #include "..\Useful\fOutputDebugString.h"
 #include "..\Grip\GripPackets.h"
 #include "..\Grip\DexAnalogMixin.h"
+#include "..\Grip\GripTrace.h"
 
 using namespace GripMMI;
 
@@ -44,8 +49,11 @@ char packetBufferPathRoot[MAX_PATHLENGTH] = "";
 #define RETRY_PAUSE	20		
 // Error code to return if the cache file cannot be opened.
 #define ERROR_CACHE_NOT_FOUND	-1000
-// Grip force threshold for a valid CoP.
-#define COP_MIN_GRIP	0.5
+// Bytes of memory taken by one frame in the data buffers of GripMMIGlobals.h.
+#define FRAME_BYTES	( sizeof( *ManipulandumRotations ) + sizeof( *ManipulandumPosition ) + sizeof( *Acceleration ) \
+	+ sizeof( *GripForce ) + sizeof( *LoadForce ) + sizeof( *LoadForceMagnitude ) + sizeof( *RealMarkerTime ) + sizeof( *RealAnalogTime ) \
+	+ N_FORCE_TRANSDUCERS * ( sizeof( *NormalForce[0] ) + sizeof( *CenterOfPressure[0] ) + sizeof( *FilteredNormalForce[0] ) ) \
+	+ sizeof( *FilteredGripForce ) + sizeof( *FilteredLoadForce ) + sizeof( *FilteredLoadForceMagnitude ) )
 
 // A hint about restarting that may resolve certain intermittant (and hopefully, rare) error conditions.
 const char *restart_hint = 
@@ -56,6 +64,44 @@ const char *restart_hint =
 ///
 void GripMMIDesktop::ResetBuffers( void ){
 	nFrames = 0;
+	ResetSegments();
+}
+
+/// Where a reader has got to in a packet cache file.
+/// The first packet of the file is kept too, so that a cache that has been started over
+///  (e.g. after the packet source was restarted) can be recognized even if it has already
+///  grown back beyond the previous offset.
+typedef struct {
+	long				offset;
+	bool				first_known;
+	EPMTelemetryPacket	first;
+} CachePosition;
+
+/// Returns true if the cache file has been started over since the packets up to position->offset
+///  were read, in which case the position is set back to the start of the file.
+static bool CacheStartedOver( int fid, CachePosition *position, int packet_length ) {
+
+	EPMTelemetryPacket packet;
+	bool started_over = ( _lseek( fid, 0, SEEK_END ) < position->offset );
+
+	if ( !started_over && position->first_known ) {
+		if ( _lseek( fid, 0, SEEK_SET ) != 0 || _read( fid, &packet, packet_length ) != packet_length ) started_over = true;
+		else started_over = ( memcmp( &packet, &position->first, packet_length ) != 0 );
+	}
+	if ( started_over ) {
+		position->offset = 0;
+		position->first_known = false;
+	}
+	return( started_over );
+}
+
+/// Move the position past a packet that has just been read, remembering it if it is the first one.
+static void CacheAdvance( CachePosition *position, const EPMTelemetryPacket *packet, int packet_length ) {
+	if ( position->offset == 0 ) {
+		memcpy( &position->first, packet, packet_length );
+		position->first_known = true;
+	}
+	position->offset += packet_length;
 }
 
 /// Read in the cached realtime data packets.
@@ -67,6 +113,10 @@ void GripMMIDesktop::ResetBuffers( void ){
 /// routine will simply return FALSE, leaving the buffers in their former state.
 
 /// Note also that if the buffers reach their maximum, the 'live' mode for RT packets will be disabled.
+
+/// In live tail mode (liveTailHours > 0) the buffers never fill up. Only the new packets are read
+/// on each call and the oldest frames are dropped to make room. See GripMMIFrameStore.h.
+/// If the cache is started over, the buffers are emptied and it is read again from the start.
 int GripMMIDesktop::GetGripRT( void ) {
 
 	// Keep track of the last packet TM counter from previous call.
@@ -76,6 +126,15 @@ int GripMMIDesktop::GetGripRT( void ) {
 	// Keep track of whether we have already seen that the buffers are full.
 	static bool buffers_full_alert = false;
 
+	// In live tail mode we read only the packets that have been added to the cache
+	//  since the previous call, starting from this position in the file.
+	static CachePosition cache_position = { 0, false };
+	// Only the packets beyond this offset are new and should be traced. See GripTrace.h.
+	static long traced_offset = 0;
+	bool live_tail = ( liveTailHours > 0.0 );
+	// The buffers were allocated at startup, for LiveTailCapacity() frames in live tail mode.
+	unsigned int capacity = gripFrames.maxFrames;
+
 	// Buffers and structures to hold data from the real time science packets.
 	EPMTelemetryPacket		packet;
 	EPMTelemetryHeaderInfo	epmHeader;
@@ -90,7 +149,8 @@ int GripMMIDesktop::GetGripRT( void ) {
 	int bytes_read;
 	int packets_read;
 	int return_code;
-	int mrk, coda, count;
+	int mrk, coda;
+	__int64 decode_start, filter_start;
 
 	// If buffers were full the last time through, then don't fill them again.
 	// Just leave the buffers in their previous state and return saying that
@@ -106,8 +166,11 @@ int GripMMIDesktop::GetGripRT( void ) {
 	// The global variable 'packetBufferPathRoot' has been initialized elsewhere.
 	CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_RT_SCIENCE_PACKET, packetBufferPathRoot );
 
-	// Empty the data buffers.
-	ResetBuffers();
+	// Empty the data buffers, unless we are only adding the new packets in live tail mode.
+	if ( !live_tail ) {
+		ResetBuffers();
+		ResetFrameDecoder();
+	}
 
 	// Attempt to open the packet cache to read the accumulated packets.
 	// If it is not immediately available, keep trying for a few seconds.
@@ -126,15 +189,31 @@ int GripMMIDesktop::GetGripRT( void ) {
 			fMessageBox( MB_OK, "GripMMI", "Error opening packet file %s.\n\n%s", filename, restart_hint );
 			exit( -1 );
 	}
-
-	// Prepare for reading in packets. This is used to calculate the elapsed time between two packets.
-	// By setting it to zero here, the first packet read will be signaled as having arrived after a long delay.
-	double previous_packet_timestamp = 0.0;
+	// If the cache has been started over, nothing that came from it before is valid any more.
+	if ( CacheStartedOver( fid, &cache_position, rtPacketLengthInBytes ) ) {
+		ResetBuffers();
+		ResetFrameDecoder();
+		traced_offset = 0;
+	}
+	// Except in live tail mode, the whole file is read each time.
+	if ( !live_tail ) cache_position.offset = 0;
+	// Skip over the packets that we have already read.
+	if ( _lseek( fid, cache_position.offset, SEEK_SET ) != cache_position.offset ) {
+			fMessageBox( MB_OK, "GripMMI", "Error seeking in packet file %s.\n\n%s", filename, restart_hint );
+			exit( -1 );
+	}
 
 	// Read in all of the data packets in the file.
 	// Be careful not to overrun the data buffers.
 	packets_read = 0;
-	while ( nFrames < MAX_FRAMES ) {
+	while ( live_tail || nFrames < capacity ) {
+
+		// In live tail mode, make room for the next packet by dropping the oldest frames.
+		if ( live_tail && nFrames + RT_SLICES_PER_PACKET > capacity ) {
+			// Rotations that are waiting to be converted refer to frame indices, so convert them first.
+			FlushFrameDecoder();
+			DiscardFrames( LIVE_TAIL_DISCARD_FRAMES );
+		}
 
 		// Attempt to read next packet. Any error is terminal.
 		bytes_read = _read( fid, &packet, rtPacketLengthInBytes );
@@ -145,149 +224,51 @@ int GripMMIDesktop::GetGripRT( void ) {
 
 		// If the number of bytes read is less than the expected number
 		//  we are at the end of the file and should break out of the loop.
+		// A partial packet will be read again in full on the next call.
 		if ( rtPacketLengthInBytes != bytes_read ) break;
 
 		// We have a valid packet.
 		packets_read++;
+		CacheAdvance( &cache_position, &packet, bytes_read );
 
+		// Time the decoding and the filtering of each packet. See GripMMICounters.h.
+		decode_start = CounterStart();
 		// Check that it is a valid GRIP packet. It would be strange if it was not.
 		ExtractEPMTelemetryHeaderInfo( &epmHeader, &packet );
 		if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_RT_ID ) {
 			fMessageBox( MB_OK, "GripMMIlite", "Unrecognized packet from %s.\n\n%s", filename, restart_hint );
 			exit( -1 );
 		}
+		// Except in live tail mode, the whole file is read each time. Trace each packet only once.
+		if ( live_tail || packets_read * rtPacketLengthInBytes > traced_offset ) {
+			GripTrace( TRACE_READ, epmHeader.TMCounter );
+			if ( !live_tail ) traced_offset = packets_read * rtPacketLengthInBytes;
+		}
 			
 		// Packets are stings of bytes. Extract the data values into a more usable form.
 		ExtractGripRealtimeDataInfo( &rt, &packet );
+		filter_start = CounterStart();
+		CounterSample( CTR_DECODE_TIME, filter_start - decode_start );
 
-		// If there has been a break in the arrival of the packets, insert
-		//  a blank frame into the data buffer. This will cause breaks in
-		//  the traces in the data graphs.
-		if ( (rt.packetTimestamp - previous_packet_timestamp) > PACKET_STREAM_BREAK_THRESHOLD ) {
-			// Subsampling in graphs will be used when the data record is very long.
-			// Insert enough points so that we see the break even if we are sub-sampling in the graphs.
-			// MAX_PLOT_STEP defines the maximum number of frames that will be skipped when plotting.
-			for ( int count = 0; count < MAX_PLOT_STEP && nFrames < MAX_FRAMES - 1; count++ ) {
-				ManipulandumPosition[nFrames][X] = MISSING_DOUBLE;
-				ManipulandumPosition[nFrames][Y] = MISSING_DOUBLE;
-				ManipulandumPosition[nFrames][Z] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][X] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][Y] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][Z] = MISSING_DOUBLE;
-				GripForce[nFrames] = MISSING_DOUBLE;
-				GripForce[nFrames] = MISSING_DOUBLE;
-				NormalForce[LEFT_ATI][nFrames] = MISSING_DOUBLE;
-				NormalForce[LEFT_ATI][nFrames] = MISSING_DOUBLE;
-				NormalForce[RIGHT_ATI][nFrames] = MISSING_DOUBLE;
-				NormalForce[RIGHT_ATI][nFrames] = MISSING_DOUBLE;
-				Acceleration[nFrames][X] = MISSING_DOUBLE;
-				Acceleration[nFrames][Y] = MISSING_DOUBLE;
-				Acceleration[nFrames][Z] = MISSING_DOUBLE;
-				for ( mrk = 0; mrk < CODA_MARKERS; mrk++ ) MarkerVisibility[nFrames][mrk] = MISSING_DOUBLE;
-				ManipulandumVisibility[nFrames] = MISSING_DOUBLE;
-				FrameVisibility[nFrames] = MISSING_DOUBLE;
-				WristVisibility[nFrames] = MISSING_DOUBLE;
-				PacketReceived[nFrames] = MISSING_DOUBLE;
-				RealMarkerTime[nFrames] = MISSING_DOUBLE;
-				nFrames++;
-			}
-		}
-		previous_packet_timestamp = rt.packetTimestamp;
-
-		for ( int slice = 0; slice < RT_SLICES_PER_PACKET && nFrames < MAX_FRAMES; slice++ ) {
-			// Get the time of the slice.
-			RealMarkerTime[nFrames] = rt.dataSlice[slice].bestGuessPoseTimestamp;
-			RealAnalogTime[nFrames] = rt.dataSlice[slice].bestGuessAnalogTimestamp;
-			if ( rt.dataSlice[slice].manipulandumVisibility ) {
-				// Retrieve the position and convert to mm.
-				ManipulandumPosition[nFrames][X] = rt.dataSlice[slice].position[X] / 10.0;
-				ManipulandumPosition[nFrames][Y] = rt.dataSlice[slice].position[Y] / 10.0;
-				ManipulandumPosition[nFrames][Z] = rt.dataSlice[slice].position[Z] / 10.0;
-				// Convert quaternion to a form that is easier to understand in graphs.
-				dex.QuaternionToCannonicalRotations( ManipulandumRotations[nFrames], rt.dataSlice[slice].quaternion );
-				// Apply recursive filter to position data for this slice.
-				dex.FilterManipulandumPosition( ManipulandumPosition[nFrames] );
-				// If the orientation is available, filter it as well.
-				if ( _finite( ManipulandumRotations[nFrames][X] ) ) dex.FilterManipulandumRotations( ManipulandumRotations[nFrames] );
-			}
-			else {
-				// Manipulandum was not visible, so record as missing data.
-				ManipulandumPosition[nFrames][X] = MISSING_DOUBLE;
-				ManipulandumPosition[nFrames][Y] = MISSING_DOUBLE;
-				ManipulandumPosition[nFrames][Z] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][X] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][Y] = MISSING_DOUBLE;
-				ManipulandumRotations[nFrames][Z] = MISSING_DOUBLE;
-			}
-			// The GRIP ICD does not say what is the reference frame for the force data.
-			// I'm pretty sure that this is right.
-			GripForce[nFrames] = (float) dex.ComputeGripForce( rt.dataSlice[slice].ft[LEFT_ATI].force, rt.dataSlice[slice].ft[RIGHT_ATI].force );
-			GripForce[nFrames] = (float) dex.FilterGripForce( GripForce[nFrames] );
-			// It is useful to plot the normal force from each ATI sensor. They should be very similar unless
-			//  the subject is touching the manipulandum outside the ATI sensor surfaces.
-			NormalForce[LEFT_ATI][nFrames] = - (float) rt.dataSlice[slice].ft[LEFT_ATI].force[X];
-			NormalForce[LEFT_ATI][nFrames] = (float) dex.FilterNormalForce( NormalForce[LEFT_ATI][nFrames], LEFT_ATI );
-			NormalForce[RIGHT_ATI][nFrames] = (float) rt.dataSlice[slice].ft[RIGHT_ATI].force[X];
-			NormalForce[RIGHT_ATI][nFrames] = (float) dex.FilterNormalForce( NormalForce[RIGHT_ATI][nFrames], RIGHT_ATI );
-			// Compute the acceleration, load force, load force magnitude and center-of-pressures, and filter appropriately.
-			dex.ComputeLoadForce( LoadForce[nFrames], rt.dataSlice[slice].ft[0].force, rt.dataSlice[slice].ft[1].force );
-			LoadForceMagnitude[nFrames] = dex.FilterLoadForce( LoadForce[nFrames] );
-			for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
-				double cop_distance = dex.ComputeCoP( CenterOfPressure[ati][nFrames], rt.dataSlice[slice].ft[ati].force, rt.dataSlice[slice].ft[ati].torque, COP_MIN_GRIP );
-				if ( cop_distance >= 0.0 ) dex.FilterCoP( ati, CenterOfPressure[ati][nFrames] );
-			}
-			Acceleration[nFrames][X] = (float) rt.dataSlice[slice].acceleration[X];
-			Acceleration[nFrames][Y] = (float) rt.dataSlice[slice].acceleration[Y];
-			Acceleration[nFrames][Z] = (float) rt.dataSlice[slice].acceleration[Z];
-			dex.FilterAcceleration( Acceleration[nFrames] );
-
-			// Fill some data arrays to show when each marker is visible.
-			// We consider a marker visible if it is seen by either coda.
-			// Set a non-zero value if it is visible, MISSING if it is obscured.
-			// The non-zero values that are set when the marker is visible are a convenient
-			//  trick to make it easy to plot the traces for all markers in one graph.
-			for ( mrk = MANIPULANDUM_FIRST_MARKER; mrk <= MANIPULANDUM_LAST_MARKER; mrk++ ) {
-				unsigned long bit = 0x01 << mrk;
-				if ( rt.dataSlice[slice].markerVisibility[0] & bit || rt.dataSlice[slice].markerVisibility[1] & bit ) MarkerVisibility[nFrames][mrk] = mrk + 1;
-				else MarkerVisibility[nFrames][mrk] = MISSING_DOUBLE;
-			}
-			if (  (rt.dataSlice[slice].manipulandumVisibility & 0x01) ) ManipulandumVisibility[nFrames] = 10;
-			else ManipulandumVisibility[nFrames] = MISSING_DOUBLE;
-			for ( mrk = FRAME_FIRST_MARKER, count = 0; mrk <= FRAME_LAST_MARKER; mrk++ ) {
-				unsigned long bit = 0x01 << mrk;
-				if ( rt.dataSlice[slice].markerVisibility[0] & bit || rt.dataSlice[slice].markerVisibility[1] & bit ) {
-					MarkerVisibility[nFrames][mrk] = mrk + 3;
-					count++;
-				}
-				else MarkerVisibility[nFrames][mrk] = MISSING_DOUBLE;
-			}
-			if ( count == 4 ) FrameVisibility[nFrames] = 30;
-			else FrameVisibility[nFrames] = MISSING_DOUBLE;
-
-			for ( mrk = WRIST_FIRST_MARKER, count = 0; mrk <= WRIST_LAST_MARKER; mrk++ ) {
-				unsigned long bit = 0x01 << mrk;
-				if ( rt.dataSlice[slice].markerVisibility[0] & bit || rt.dataSlice[slice].markerVisibility[1] & bit ) {
-					MarkerVisibility[nFrames][mrk] = mrk + 5;
-					count++;
-				}
-				else MarkerVisibility[nFrames][mrk] = MISSING_DOUBLE;
-			}
-			if ( count >= 3 ) WristVisibility[nFrames] = 50;
-			else WristVisibility[nFrames] = MISSING_DOUBLE;
-			// Indicate that for this instant in time we received a data packet.
-			PacketReceived[nFrames] = -10.0;
-
-			// Count the number of frames.
-			nFrames++;
-		}
+		DecodeGripRTPacket( &rt );
+		CounterStop( CTR_FILTER_TIME, filter_start );
 
 	}
+	// Convert any quaternions that are still waiting.
+	FlushFrameDecoder();
 	// Finished reading. Close the file and check for errors.
 	return_code = _close( fid );
 	if ( return_code ) {
 		fMessageBox( MB_OK, "GripMMI", "Error closing %s after binary read.\nError code: %s\n\n%s", filename, return_code, restart_hint );
 		exit( return_code );
 	}
+	CounterAdd( CTR_PACKETS_READ, packets_read );
+	CounterSet( CTR_PACKETS_LAST_CYCLE, packets_read );
+	CounterAdd( CTR_BYTES_SCANNED, (__int64) packets_read * rtPacketLengthInBytes );
+	CounterSet( CTR_FRAMES, nFrames );
+	CounterSet( CTR_FRAME_STORE_BYTES, (__int64) capacity * FRAME_BYTES );
+	// In live tail mode there may not be any new packets.
+	if ( packets_read == 0 ) return( FALSE );
 	// Compute the visibility strings for the markers from the last frame.
 	for (coda = 0; coda < CODA_UNITS; coda++ ) {
 		strcpy( markerVisibilityString[coda], "" );
@@ -298,8 +279,8 @@ int GripMMIDesktop::GetGripRT( void ) {
 			else strcat( markerVisibilityString[coda], "m" );
 		}
 	}
-	fOutputDebugString( "Acquired Frames (max %d): %d\n", MAX_FRAMES, nFrames );
-	if ( nFrames >= MAX_FRAMES ) {
+	fOutputDebugString( "Acquired Frames (max %d): %d\n", capacity, nFrames );
+	if ( !live_tail && nFrames >= capacity ) {
 		char filename2[MAX_PATHLENGTH];
 		CreateGripPacketCacheFilename( filename2, sizeof( filename ), GRIP_HK_BULK_PACKET, packetBufferPathRoot );
 		fMessageBox( MB_OK | MB_ICONERROR, "GripMMI", 
@@ -332,7 +313,10 @@ void GripMMIDesktop::SimulateGripRT ( void ) {
 	fOutputDebugString( "Start SimulateGripRT().\n" );
 	count++;
 	unsigned int fill_frames = 60 * 20 * count;
-	for ( nFrames = 0; nFrames <= fill_frames && nFrames < MAX_FRAMES; nFrames++ ) {
+	// The simulated data is one continuous segment.
+	ResetSegments();
+	StartSegment( 0 );
+	for ( nFrames = 0; nFrames <= fill_frames && nFrames < gripFrames.maxFrames; nFrames++ ) {
 
 		RealMarkerTime[nFrames] = (float) nFrames * 0.05f;
 		ManipulandumPosition[nFrames][X] = 30.0 * sin( RealMarkerTime[nFrames] * Pi * 2.0 / 30.0 );
@@ -344,37 +328,33 @@ void GripMMIDesktop::SimulateGripRT ( void ) {
 			LoadForce[nFrames][i] = ManipulandumPosition[nFrames][ (i+2) % 3] / 200.0;
 		}
 
+		// Each marker toggles between visible and obscured now and then.
 		for ( mrk = 0; mrk <CODA_MARKERS; mrk++ ) {
-
-			int grp = ( mrk >= 8 ? ( mrk >= 16 ? mrk + 20 : mrk + 10 ) : mrk ) + 35;
-			if ( nFrames == 0 ) MarkerVisibility[nFrames][mrk] = grp;
-			else {
-				if ( MarkerVisibility[nFrames-1][mrk] != MISSING_CHAR ) {
-					if ( rand() % 1000 < 1 ) MarkerVisibility[nFrames][mrk] = MISSING_CHAR;
-					else MarkerVisibility[nFrames][mrk] = grp;
-				}
-				else {
-					if ( rand() % 1000 < 1 ) MarkerVisibility[nFrames][mrk] = grp;
-					else MarkerVisibility[nFrames][mrk] = MISSING_CHAR;
-				}
-			}
+			bool visible = ( nFrames == 0 ? true : FrameIsValid( MarkerVisible[mrk], nFrames - 1 ) );
+			if ( rand() % 1000 < 1 ) visible = !visible;
+			SetFrameValidity( MarkerVisible[mrk], nFrames, visible );
 		}
 			
-		ManipulandumVisibility[nFrames] = 0;
+		int visible_markers = 0;
 		for ( mrk = MANIPULANDUM_FIRST_MARKER; mrk <= MANIPULANDUM_LAST_MARKER; mrk++ ) {
-			if ( MarkerVisibility[nFrames][mrk] != MISSING_CHAR ) ManipulandumVisibility[nFrames]++;
+			if ( FrameIsValid( MarkerVisible[mrk], nFrames ) ) visible_markers++;
 		}
-		if ( ManipulandumVisibility[nFrames] < 3 ) ManipulandumPosition[nFrames][X] = ManipulandumPosition[nFrames][Y] = ManipulandumPosition[nFrames][Z] = MISSING_DOUBLE;
-		ManipulandumVisibility[nFrames] *= 3;
+		SetFrameValidity( ManipulandumVisible, nFrames, visible_markers >= 3 );
+		SetFrameValidity( FrameVisible, nFrames, true );
+		SetFrameValidity( WristVisible, nFrames, true );
+		SetFrameValidity( CenterOfPressureValid[LEFT_ATI], nFrames, false );
+		SetFrameValidity( CenterOfPressureValid[RIGHT_ATI], nFrames, false );
 
 	}
 	fOutputDebugString( "End SimulateGripRT().\n" );
-	fOutputDebugString( "nFrames: %d %d\n", nFrames, MAX_FRAMES );
+	fOutputDebugString( "nFrames: %d %d\n", nFrames, gripFrames.maxFrames );
 }
 
 /// Read housekeeping cache, taking just the most recent value.
 /// The path to the cache file is presumed to be set in global variable 'packetBufferPathRoot'.
 /// The contents of the latest HK packet are returned in the structure pointed to by parameter 'hk'.
+/// Only the packets that have been added to the cache since the previous call are read.
+/// Each one is added to the script timeline (see GripMMITimeline.h).
 int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 
 	static int count = 0;
@@ -384,6 +364,10 @@ int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 	int bytes_read;
 	int return_code;
 	static unsigned short previousTMCounter = 0;
+	// Where the new packets start in the cache file, and what the last packet said.
+	static CachePosition cache_position = { 0, false };
+	static GripHealthAndStatusInfo latest;
+	static unsigned short latestTMCounter = 0;
 	unsigned long bit = 0;
 	int retry_count;
 
@@ -413,8 +397,15 @@ int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 		fMessageBox( MB_OK, "GripMMI", "Error reading from %s.\n\n*s", filename, restart_hint );
 		exit( -1 );
 	}
+	// If the cache has been started over, so does the timeline.
+	if ( CacheStartedOver( fid, &cache_position, hkPacketLengthInBytes ) ) ResetTimeline( &gripTimeline );
+	if ( _lseek( fid, cache_position.offset, SEEK_SET ) != cache_position.offset ) {
+		fMessageBox( MB_OK, "GripMMI", "Error seeking in %s.\n\n%s", filename, restart_hint );
+		exit( -1 );
+	}
 
-	// Read in all of the data packets in the file.
+	// Read in the data packets that are new.
+	// A partial packet will be read again in full on the next call.
 	packets_read = 0;
 	while ( true ) {
 		bytes_read = _read( fid, &packet, hkPacketLengthInBytes );
@@ -427,6 +418,7 @@ int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 		if ( bytes_read < hkPacketLengthInBytes ) break;
 
 		packets_read++;
+		CacheAdvance( &cache_position, &packet, bytes_read );
 		// Check that it is a valid GRIP packet. It would be strange if it was not.
 		ExtractEPMTelemetryHeaderInfo( &epmHeader, &packet );
 		if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_HK_ID ) {
@@ -434,7 +426,9 @@ int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 			exit( -1 );
 		}
 		// Extract the interesting info in proper byte order.
-		ExtractGripHealthAndStatusInfo( hk, &packet );
+		ExtractGripHealthAndStatusInfo( &latest, &packet );
+		latestTMCounter = epmHeader.TMCounter;
+		TimelineAddHK( &gripTimeline, &latest, (double) EPMtoSeconds( &epmHeader ) );
 	}
 	// Finished reading. Close the file and check for errors.
 	return_code = _close( fid );
@@ -443,11 +437,12 @@ int GripMMIDesktop::GetLatestGripHK( GripHealthAndStatusInfo *hk ) {
 		exit( return_code );
 	}
 
-	// The structure pointed to by 'hk' contains the data from the last valid packet that was read from the cache file.
+	// The structure pointed to by 'hk' gets the data from the last valid packet that was read from the cache file.
+	*hk = latest;
 	// Check if there were new packets since the last time we read the cache.
 	// Return TRUE if yes, FALSE if no.
-	if ( previousTMCounter != epmHeader.TMCounter ) {
-		previousTMCounter = epmHeader.TMCounter;
+	if ( previousTMCounter != latestTMCounter ) {
+		previousTMCounter = latestTMCounter;
 		return( TRUE );
 	}
 	else return ( FALSE );
@@ -38,9 +38,12 @@
 #include "..\PsyPhy2dGraphicsLib\Views.h"
 #include "..\PsyPhy2dGraphicsLib\Layouts.h"
 #include "..\Grip\DexAnalogMixin.h"
+#include "GripMMIScriptTree.h"
+#include "GripMMIPictureCache.h"
 #include "..\Grip\GripPackets.h"
 
 #include "GripMMIGlobals.h"
+#include "GripMMICounters.h"
 
 // Time in milliseconds between screen refreshes.
 #define REFRESH_TIMEOUT	500
@@ -143,7 +146,8 @@ namespace GripMMI {
 	private: System::Windows::Forms::GroupBox^  groupBox11;
 	private: System::Windows::Forms::ListBox^  taskList;
 	private: System::Windows::Forms::GroupBox^  groupBox12;
-	private: System::Windows::Forms::ListBox^  stepList;
+	private: System::Windows::Forms::ListView^  stepList;
+	private: System::Windows::Forms::ColumnHeader^  stepColumn;
 
 	private: System::Windows::Forms::GroupBox^  groupBox13;
 	private: System::Windows::Forms::Label^  label1;
@@ -184,7 +188,7 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			char filename[MAX_PATHLENGTH];
 			strcpy( filename, scriptDirectory );
 			strcat( filename, "users.dex" );
-			if ( ERROR_EXIT == ParseSubjectFile( filename ) ) {
+			if ( ERROR_EXIT == LoadScripts( filename ) ) {
 			// If we are unable to parse the subject file, just shut down.
 				Close();
 			}
@@ -193,8 +197,7 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 				// Create a timer to periodically check for data and refresh.
 				CreateRefreshTimer( REFRESH_TIMEOUT );
 				// Set the filter constant according to the initial state of the filter checkbox.
-				if ( filterCheckbox->Checked ) dex.SetFilterConstant( System::Convert::ToDouble( filterConstantTextBox->Text ) );
-				else dex.SetFilterConstant( 0.0 );
+				SetFilter();
 				// Select the summary graph collection by default.
 				// This does a ForceUdate as a side effect, which requires that the refresh timer
 				//  be created already. That is why CreateRefreshTimer() is performed first in this else clause.
@@ -222,7 +225,11 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			timer->Interval = interval;
 			timer->Tick += gcnew EventHandler( this, &GripMMI::GripMMIDesktop::OnTimerElapsed );
 		}
+		// When the timer was started, to see how late it goes off. See GripMMICounters.h.
+		// Starting a timer that is already running does not restart it, so do not change the time then.
+		__int64 refreshTimerArmed;
 		void StartRefreshTimer( void ) {
+			if ( !timer->Enabled ) refreshTimerArmed = CounterStart();
 			timer->Start();
 		}
 		void StopRefreshTimer( void ) {
@@ -237,6 +244,10 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			int new_data;
 			// Stop the timer so that it does not retrigger until we are done refreshing.
 			StopRefreshTimer();
+			// The timer goes off late when the user interface thread is busy.
+			__int64 lateness = CounterStart() - refreshTimerArmed - (__int64) timer->Interval * gripMMICounters.frequency / 1000;
+			CounterSample( CTR_REFRESH_LATENESS, ( lateness > 0 ? lateness : 0 ) );
+			CounterAdd( CTR_REFRESH_CYCLES, 1 );
 			fOutputDebugString( "\n" );
 			fOutputDebugString( "Timer triggered.\n" );
 			// Get the realtime science data packets. Return value says if new packets
@@ -253,10 +264,17 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			// Handle HK packets and the script crawler display.
 			if ( scriptLiveCheckbox->Checked ) {
 				fOutputDebugString( "UpdateStatus.\n" );
+				__int64 status_start = CounterStart();
 				UpdateStatus( forceUpdate );
+				CounterStop( CTR_UPDATE_STATUS, status_start );
 			}
+			// Pick up changes to the script files.
+			CheckScripts();
+			CountPictures();
 			// If we forced an update, reset it to false so that we do it only once.
 			forceUpdate = false;
+			// Make the counters for this cycle available to GripMMIStats.
+			GripMMICountersPublish();
 			// Start the timer again to trigger the next cycle after a delay.
 			StartRefreshTimer();
 		}
@@ -275,19 +293,6 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 
 	private: 
 
-		// Objects used by the legacy code for data plots.
-		// These items will be initialized by InitializeGraphics().
-		::Display	xy_display;
-		::Display	zy_display;
-		::Display	cop_display;
-		::Display	stripchart_display;
-		::Layout	stripchart_layout;
-		::View		visibility_view;
-		::Layout	detailed_visibility_layout;
-		::View		xy_view;
-		::View		zy_view;
-		::View		cop_view;
-
 		// GripMMIGraphics.cpp
 
 		void InitializeGraphics( void );
@@ -295,20 +300,7 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 		void KillGraphics( void );
 		void AdjustScrollSpan( void );
 		void MoveToLatest( void );
-
-		void GraphManipulandumPosition( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-		void GraphManipulandumRotations( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-		void PlotManipulandumPosition( double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-		void GraphLoadForce( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip ) ;
-		void GraphAcceleration( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip ) ;
-		void GraphGripForce( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip ) ;
-		void GraphVisibility( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip ) ;
-		void GraphVisibilityDetails( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip ) ;
-		void GraphCoP( ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-		void PlotCoP( double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-
-		void GraphManipulandumPositionComponent( int component, ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
-		void GraphAccelerationComponent( int component, ::View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int skip );
+		void MoveToInstant( double instant );
 
 		// GripMMIData.cpp
 
@@ -320,16 +312,21 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 
 		// GripMMIScripts.cpp
 
-		void ParseTaskFile ( const char *task_file );
-		void ParseProtocolFile ( const char *protocol_file );
-		void ParseSessionFile ( const char *session_file );
-		int  ParseSubjectFile ( const char *subject_file );
+		int  LoadScripts ( const char *subject_file );
+		void CheckScripts ( void );
+		void CountPictures ( void );
+		void ShowTask ( GripScriptNode *node );
+		System::Windows::Forms::ListViewItem^ StepListItem( int line );
+		int  SelectedStep( void );
+		void SelectStep( int line );
 
 		void GoToSpecifiedSubject ( int subject );
 		void GoToSpecifiedProtocol ( int protocol );
 		void GoToSpecifiedTask ( int task );
 		void GoToSpecifiedStep ( int step );
+		void GoToNextStep( void );
 		void GoToSpecifiedIDs( int subject_id, int protocol_id, int task_id, int step_id );
+		void ShowStepData( void );
 
 	private:
 		/// <summary>
@@ -394,7 +391,8 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			this->groupBox11 = (gcnew System::Windows::Forms::GroupBox());
 			this->taskList = (gcnew System::Windows::Forms::ListBox());
 			this->groupBox12 = (gcnew System::Windows::Forms::GroupBox());
-			this->stepList = (gcnew System::Windows::Forms::ListBox());
+			this->stepList = (gcnew System::Windows::Forms::ListView());
+			this->stepColumn = (gcnew System::Windows::Forms::ColumnHeader());
 			this->groupBox13 = (gcnew System::Windows::Forms::GroupBox());
 			this->label1 = (gcnew System::Windows::Forms::Label());
 			this->markersTextBox = (gcnew System::Windows::Forms::TextBox());
@@ -1044,16 +1042,28 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 			// 
 			// stepList
 			// 
+			this->stepList->Columns->AddRange(gcnew cli::array< System::Windows::Forms::ColumnHeader^  >(1) {this->stepColumn});
 			this->stepList->Font = (gcnew System::Drawing::Font(L"Microsoft Sans Serif", 9, System::Drawing::FontStyle::Regular, System::Drawing::GraphicsUnit::Point, 
 				static_cast<System::Byte>(0)));
-			this->stepList->FormattingEnabled = true;
-			this->stepList->ItemHeight = 15;
+			this->stepList->FullRowSelect = true;
+			this->stepList->HeaderStyle = System::Windows::Forms::ColumnHeaderStyle::None;
+			this->stepList->HideSelection = false;
 			this->stepList->Location = System::Drawing::Point(4, 25);
+			this->stepList->MultiSelect = false;
 			this->stepList->Name = L"stepList";
 			this->stepList->Size = System::Drawing::Size(128, 409);
 			this->stepList->TabIndex = 3;
+			this->stepList->UseCompatibleStateImageBehavior = false;
+			this->stepList->View = System::Windows::Forms::View::Details;
+			this->stepList->VirtualMode = true;
+			this->stepList->RetrieveVirtualItem += gcnew System::Windows::Forms::RetrieveVirtualItemEventHandler(this, &GripMMIDesktop::stepList_RetrieveVirtualItem);
 			this->stepList->SelectedIndexChanged += gcnew System::EventHandler(this, &GripMMIDesktop::stepList_SelectedIndexChanged);
 			this->stepList->MouseDown += gcnew System::Windows::Forms::MouseEventHandler(this, &GripMMIDesktop::stepList_MouseDown);
+			this->stepList->DoubleClick += gcnew System::EventHandler(this, &GripMMIDesktop::stepList_DoubleClick);
+			// 
+			// stepColumn
+			// 
+			this->stepColumn->Width = 107;
 			// 
 			// groupBox13
 			// 
@@ -1307,6 +1317,8 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 	private: System::Void GripMMIDesktop_FormClosing(System::Object^  sender, System::Windows::Forms::FormClosingEventArgs^  e) {
 				 // Free resources allocated by the PsyPhy graphics routines.
 				 KillGraphics();
+				 // Stop reading the pictures of the script crawler.
+				 GripPictureCacheClose();
 			 }
 	private: System::Void spanSelector_ValueChanged(System::Object^  sender, System::EventArgs^  e) {
 				 // When the user selects a different span with the slider, update the parameters
@@ -1370,27 +1382,27 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 					 scriptLiveCheckbox->Checked = false;
 				 }
 			 }
+	private: System::Void stepList_DoubleClick(System::Object^  sender, System::EventArgs^  e) {
+				 // A double click on a step moves the graphs to the data recorded while GRIP was at that step.
+				 ShowStepData();
+			 }
+	private: System::Void stepList_RetrieveVirtualItem(System::Object^  sender, System::Windows::Forms::RetrieveVirtualItemEventArgs^  e) {
+				 // The step list only asks for the lines that it shows.
+				 e->Item = StepListItem( e->ItemIndex );
+			 }
 	private: System::Void stepList_SelectedIndexChanged(System::Object^  sender, System::EventArgs^  e) {
 				 // A new step has been selected.
-				 // Keep the selected step near the top of the box
-				 //  so that we can see what is coming next.
-				 int step = stepList->SelectedIndex;
-				 int top_index = step - 10;
-				 if ( top_index < 0 ) top_index = 0;
-				 stepList->TopIndex = top_index;
+				 // The list also says so when the previous step is deselected, which is ignored.
+				 int step = SelectedStep();
+				 if ( step < 0 ) return;
 				 // Now update the picture and text.
 				 GoToSpecifiedStep( step );
 			 }
 	private: System::Void nextButton_Click(System::Object^  sender, System::EventArgs^  e) {
 				 // Script crawler is no longer live.
 				 scriptLiveCheckbox->Checked = false;
-				 // Find the next non-comment step.
-				 // int selected_line = SendDlgItemMessage( IDC_STEPS, LB_GETCURSEL, 0, 0 );
-				 int selected_line = stepList->SelectedIndex;
-				 selected_line++;
-				 while ( comment[selected_line] ) selected_line++;
-				 stepList->SelectedIndex = selected_line;
-				 GoToSpecifiedStep( selected_line );
+				 // Go to the next non-comment step.
+				 GoToNextStep();
 			 }
 	private: System::Void gotoButton_Click(System::Object^  sender, System::EventArgs^  e) {
 				 // The user has entered subject, protocol, task and step IDs in the 
@@ -1564,22 +1576,36 @@ private: System::Windows::Forms::TextBox^  filterConstantTextBox;
 	// The Forms objects take care of changing the state according to the action and 
 	// the state of these objects will be read by the various graphing routines. But
 	// we need to force an update when the state of these indicators changes.
-	private: System::Void filterCheckbox_CheckedChanged(System::Object^  sender, System::EventArgs^  e) {
-				// Read the filter constant value to be used from the text box on the screen,
-				// taking care that it is a valid number.
-				double filter_constant;
+	// The filter text box holds either a number, which is the constant for the recursive
+	// filter applied as the data comes in, or the specification of one of the block filters
+	// (e.g. "butter:4" or "sg:11:3") that are applied to the history plots. In the latter
+	// case the data is read in unfiltered, so that the block filter sees the raw samples.
+	private: void SetFilter( void ) {
+				double filter_constant = 0.0;
+				bool block_filter = false;
 				try {
 					filter_constant = System::Convert::ToDouble( filterConstantTextBox->Text );
 				}
 				catch (System::FormatException^ e) {
-					// If there is a conversion error signal that the text box value is
-					// not valid and use 0.0 by default.
-					filterConstantTextBox->BackColor = Color::Pink;
-					filter_constant = 0.0;
+					// Not a number, so see if it is a block filter specification.
+					char specification[MAX_MENU_ITEM_LENGTH];
+					pin_ptr<const wchar_t> pinchars = PtrToStringChars( filterConstantTextBox->Text );
+					wcstombs_s( NULL, specification, sizeof( specification ), pinchars, _TRUNCATE );
+					if ( dex.historyFilter.Configure( specification ) ) block_filter = true;
+					else {
+						// If there is a conversion error signal that the text box value is
+						// not valid and use 0.0 by default.
+						filterConstantTextBox->BackColor = Color::Pink;
+						filter_constant = 0.0;
+					}
 					e; // Ingore e. This is here to avoid warning about unused.
 				}
-				 if ( filterCheckbox->Checked ) dex.SetFilterConstant( filter_constant );
-				 else dex.SetFilterConstant( 0.0 );
+				if ( !block_filter || !filterCheckbox->Checked ) dex.historyFilter.SetNone();
+				if ( filterCheckbox->Checked && !block_filter ) dex.SetFilterConstant( filter_constant );
+				else dex.SetFilterConstant( 0.0 );
+			 }
+	private: System::Void filterCheckbox_CheckedChanged(System::Object^  sender, System::EventArgs^  e) {
+				 SetFilter();
 				 ForceUpdate();
 			 }
 	private: System::Void scriptLiveCheckbox_CheckedChanged(System::Object^  sender, System::EventArgs^  e) {
@@ -0,0 +1,491 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Export of a recorded session, as processed by GripMMI. See GripMMIExport.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+#include <process.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+
+#include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
+#include "GripMMIFrameDecoder.h"
+#include "GripMMITimeline.h"
+#include "GripMMIColumnFile.h"
+#include "GripMMIExport.h"
+
+// No more threads than this, whatever the number of processors.
+#define MAX_EXPORT_THREADS	64
+
+#define EXPORT_GROUP_FRAMES	( EXPORT_GROUP_PACKETS * RT_SLICES_PER_PACKET )
+// Rows of the hk and steps tables that are written out at a time.
+#define EXPORT_GROUP_ROWS	4096
+// Rows of a CSV file that one thread formats at a time.
+#define CSV_SLICE_ROWS		1024
+
+// The channels of the frame store, each exported raw and filtered.
+#define FRAME_CHANNELS		22
+static const char *channelName[FRAME_CHANNELS] = {
+	"position_x", "position_y", "position_z", "rotation_x", "rotation_y", "rotation_z",
+	"acceleration_x", "acceleration_y", "acceleration_z", "grip_force", "normal_force_left", "normal_force_right",
+	"load_force_x", "load_force_y", "load_force_z", "load_force_magnitude",
+	"cop_left_x", "cop_left_y", "cop_left_z", "cop_right_x", "cop_right_y", "cop_right_z" };
+
+// The columns of the frames table.
+#define FRAME_TIME			0
+#define FRAME_ANALOG_TIME	1
+#define FRAME_SEGMENT_START	2
+#define FRAME_RAW			3
+#define FRAME_FILTERED		( FRAME_RAW + FRAME_CHANNELS )
+#define FRAME_MASKS			( FRAME_FILTERED + FRAME_CHANNELS )
+#define FRAME_MASK_COUNT	5
+#define FRAME_MARKERS		( FRAME_MASKS + FRAME_MASK_COUNT )
+#define FRAME_COLUMNS		( FRAME_MARKERS + 1 )
+static const char *maskName[FRAME_MASK_COUNT] = { "manipulandum_visible", "frame_visible", "wrist_visible", "cop_left_valid", "cop_right_valid" };
+
+#define HK_COLUMNS			20
+static const char *hkColumn[HK_COLUMNS] = {
+	"time", "user", "protocol", "task", "step", "script_engine_status", "iochannel_status", "motion_tracker_status",
+	"crew_camera_status", "crew_camera_rate", "running_bits", "cpu_usage", "memory_usage",
+	"horizontal_target_feedback", "vertical_target_feedback", "tone_feedback", "cradle_detectors",
+	"free_disk_space_c", "free_disk_space_d", "free_disk_space_e" };
+
+#define STEP_COLUMNS		7
+static const char *stepColumn[STEP_COLUMNS] = { "start", "stop", "user", "protocol", "task", "step", "script_engine_status" };
+
+static void *ExportAllocate( void *memory, size_t size ) {
+	memory = realloc( memory, size ? size : 1 );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory to export a session." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+// Run function on one thread per processor, this one included, at most one per item.
+// The function takes the items in turn from the work it is given.
+static void ExportInParallel( unsigned ( __stdcall *function )( void * ), void *work, int items ) {
+	HANDLE thread[MAX_EXPORT_THREADS];
+	SYSTEM_INFO system;
+	int threads, max_threads;
+	GetSystemInfo( &system );
+	max_threads = (int) system.dwNumberOfProcessors;
+	if ( max_threads > MAX_EXPORT_THREADS ) max_threads = MAX_EXPORT_THREADS;
+	for ( threads = 0; threads < max_threads - 1 && threads < items - 1; threads++ ) {
+		thread[threads] = (HANDLE) _beginthreadex( NULL, 0, function, work, 0, NULL );
+		if ( !thread[threads] ) break;
+	}
+	function( work );
+	for ( int i = 0; i < threads; i++ ) {
+		WaitForSingleObject( thread[i], INFINITE );
+		CloseHandle( thread[i] );
+	}
+}
+
+///
+/// Tables, written either to the column file or to a CSV file.
+///
+
+typedef struct {
+
+	GripColumnWriter		*writer;	// NULL for a CSV file.
+	FILE					*csv;
+	int						nColumns;
+	const GripColumnType	*type;
+	void					**value;	// One array of maxRows per column.
+	int						maxRows;
+	int						rows;
+	__int64					bytes;
+	bool					error;
+
+	// The text of the rows of the CSV file, formatted one slice at a time.
+	int						nSlices;
+	char					**text;
+	int						*length;
+	int						*capacity;
+	volatile LONG			next;
+
+} ExportTable;
+
+static void StartExportTable( ExportTable *table, GripColumnWriter *writer, FILE *csv, const char *name,
+							  const char * const *column, const GripColumnType *type, int nColumns, int max_rows ) {
+
+	memset( table, 0, sizeof( *table ) );
+	table->writer = writer;
+	table->csv = csv;
+	table->nColumns = nColumns;
+	table->type = type;
+	table->maxRows = max_rows;
+	table->value = (void **) ExportAllocate( NULL, nColumns * sizeof( void * ) );
+	for ( int c = 0; c < nColumns; c++ ) table->value[c] = ExportAllocate( NULL, (size_t) max_rows * GripColumnSize( type[c] ) );
+
+	if ( writer ) StartGripColumnTable( writer, name, column, type, nColumns );
+	else {
+		for ( int c = 0; c < nColumns; c++ ) table->bytes += fprintf( csv, "%s%c", column[c], ( c < nColumns - 1 ? ',' : '\n' ) );
+		table->nSlices = ( max_rows + CSV_SLICE_ROWS - 1 ) / CSV_SLICE_ROWS;
+		table->text = (char **) ExportAllocate( NULL, table->nSlices * sizeof( char * ) );
+		table->length = (int *) ExportAllocate( NULL, table->nSlices * sizeof( int ) );
+		table->capacity = (int *) ExportAllocate( NULL, table->nSlices * sizeof( int ) );
+		memset( table->text, 0, table->nSlices * sizeof( char * ) );
+		memset( table->capacity, 0, table->nSlices * sizeof( int ) );
+	}
+
+}
+
+static unsigned __stdcall FormatCSVThread( void *parameter ) {
+	ExportTable *table = (ExportTable *) parameter;
+	int slices = ( table->rows + CSV_SLICE_ROWS - 1 ) / CSV_SLICE_ROWS;
+	for ( int s = InterlockedIncrement( &table->next ) - 1; s < slices; s = InterlockedIncrement( &table->next ) - 1 ) {
+		int last = ( ( s + 1 ) * CSV_SLICE_ROWS < table->rows ? ( s + 1 ) * CSV_SLICE_ROWS : table->rows );
+		int length = 0;
+		for ( int row = s * CSV_SLICE_ROWS; row < last; row++ ) {
+			for ( int c = 0; c < table->nColumns; c++ ) {
+				// No field takes more than this.
+				if ( length + 64 > table->capacity[s] ) {
+					table->capacity[s] = 2 * table->capacity[s] + 64 * table->nColumns;
+					table->text[s] = (char *) ExportAllocate( table->text[s], table->capacity[s] );
+				}
+				char *text = table->text[s] + length;
+				if ( table->type[c] == COLUMN_FLOAT64 ) {
+					double value = ( (double *) table->value[c] )[row];
+					length += sprintf( text, ( fabs( value ) < 1e15 ? "%.6f" : "%.17g" ), value );
+				}
+				else if ( table->type[c] == COLUMN_UINT32 ) length += sprintf( text, "%lu", (unsigned long) ( (unsigned int *) table->value[c] )[row] );
+				else length += sprintf( text, "%u", ( (unsigned char *) table->value[c] )[row] );
+				table->text[s][length++] = ( c < table->nColumns - 1 ? ',' : '\n' );
+			}
+		}
+		table->length[s] = length;
+	}
+	return( 0 );
+}
+
+// Write out the rows that have been filled in.
+static void FlushExportTable( ExportTable *table ) {
+	if ( table->rows == 0 ) return;
+	if ( table->writer ) WriteGripRowGroup( table->writer, (const void * const *) table->value, table->rows );
+	else {
+		int slices = ( table->rows + CSV_SLICE_ROWS - 1 ) / CSV_SLICE_ROWS;
+		table->next = 0;
+		ExportInParallel( FormatCSVThread, table, slices );
+		for ( int s = 0; s < slices; s++ ) {
+			if ( fwrite( table->text[s], 1, table->length[s], table->csv ) != (size_t) table->length[s] ) table->error = true;
+			table->bytes += table->length[s];
+		}
+	}
+	table->rows = 0;
+}
+
+// The next row, once all its columns are filled in.
+static void EndExportRow( ExportTable *table ) {
+	if ( ++table->rows >= table->maxRows ) FlushExportTable( table );
+}
+
+static void SetExportDouble( ExportTable *table, int column, double value ) {
+	( (double *) table->value[column] )[table->rows] = value;
+}
+
+static void SetExportUnsigned( ExportTable *table, int column, unsigned long value ) {
+	( (unsigned int *) table->value[column] )[table->rows] = (unsigned int) value;
+}
+
+// Returns false if there was an error writing a CSV file. Errors writing the column file are seen when it is closed.
+static bool FinishExportTable( ExportTable *table, __int64 *bytes ) {
+	FlushExportTable( table );
+	if ( table->csv ) {
+		if ( fclose( table->csv ) ) table->error = true;
+		*bytes += table->bytes;
+		for ( int s = 0; s < table->nSlices; s++ ) free( table->text[s] );
+		free( table->text );
+		free( table->length );
+		free( table->capacity );
+	}
+	for ( int c = 0; c < table->nColumns; c++ ) free( table->value[c] );
+	free( table->value );
+	return( !table->error );
+}
+
+///
+/// Frames.
+///
+
+// Where the values of a channel are in a store, every stride doubles, and which bitmap says that they are valid.
+static const double *StoreChannel( const GripFrameStore *store, int channel, int *stride, const uint32_t **validity ) {
+	*stride = 3;
+	*validity = NULL;
+	if ( channel < 3 ) {
+		*validity = store->manipulandumVisible;
+		return( &store->manipulandumPosition[0][channel] );
+	}
+	if ( channel < 6 ) {
+		*validity = store->manipulandumVisible;
+		return( &store->manipulandumRotations[0][channel - 3] );
+	}
+	if ( channel < 9 ) return( &store->acceleration[0][channel - 6] );
+	if ( channel < 12 ) {
+		*stride = 1;
+		return( channel == 9 ? store->gripForce : store->normalForce[channel - 10] );
+	}
+	if ( channel < 15 ) return( &store->loadForce[0][channel - 12] );
+	if ( channel == 15 ) {
+		*stride = 1;
+		return( store->loadForceMagnitude );
+	}
+	int ati = ( channel - 16 ) / 3;
+	*validity = store->centerOfPressureValid[ati];
+	return( &store->centerOfPressure[ati][0][( channel - 16 ) % 3] );
+}
+
+// The two stores are decoded from the same packets, one on each thread.
+typedef struct {
+	GripFrameDecoder		*decoder[2];
+	GripRealtimeDataInfo	*rt;
+	int						count;
+	volatile LONG			next;
+} DecodeWork;
+
+static unsigned __stdcall DecodeFramesThread( void *parameter ) {
+	DecodeWork *work = (DecodeWork *) parameter;
+	for ( int i = InterlockedIncrement( &work->next ) - 1; i < 2; i = InterlockedIncrement( &work->next ) - 1 ) {
+		GripFrameDecoder *decoder = work->decoder[i];
+		decoder->store->nFrames = 0;
+		ResetStoreSegments( decoder->store );
+		for ( int p = 0; p < work->count; p++ ) DecodeGripRTFrames( decoder, &work->rt[p] );
+		FlushGripFrameDecoder( decoder );
+	}
+	return( 0 );
+}
+
+static void FillFrameColumns( ExportTable *table, const GripFrameStore *raw, const GripFrameStore *filtered ) {
+
+	int frames = raw->nFrames;
+
+	memcpy( table->value[FRAME_TIME], raw->realMarkerTime, frames * sizeof( double ) );
+	memcpy( table->value[FRAME_ANALOG_TIME], raw->realAnalogTime, frames * sizeof( double ) );
+	unsigned char *start = (unsigned char *) table->value[FRAME_SEGMENT_START];
+	memset( start, 0, frames );
+	for ( unsigned int s = 0; s < raw->nSegments; s++ ) start[raw->segmentStart[s]] = 1;
+
+	for ( int channel = 0; channel < FRAME_CHANNELS; channel++ ) {
+		for ( int pass = 0; pass < 2; pass++ ) {
+			const uint32_t *validity;
+			int stride;
+			const double *input = StoreChannel( pass ? filtered : raw, channel, &stride, &validity );
+			double *output = (double *) table->value[( pass ? FRAME_FILTERED : FRAME_RAW ) + channel];
+			for ( int f = 0; f < frames; f++ ) output[f] = ( !validity || FrameIsValid( validity, f ) ? input[f * stride] : MISSING_DOUBLE );
+		}
+	}
+
+	const uint32_t *mask[FRAME_MASK_COUNT] = { raw->manipulandumVisible, raw->frameVisible, raw->wristVisible,
+		raw->centerOfPressureValid[LEFT_ATI], raw->centerOfPressureValid[RIGHT_ATI] };
+	for ( int m = 0; m < FRAME_MASK_COUNT; m++ ) {
+		unsigned char *output = (unsigned char *) table->value[FRAME_MASKS + m];
+		for ( int f = 0; f < frames; f++ ) output[f] = FrameIsValid( mask[m], f );
+	}
+	unsigned int *markers = (unsigned int *) table->value[FRAME_MARKERS];
+	memset( markers, 0, frames * sizeof( unsigned int ) );
+	for ( int mrk = 0; mrk < CODA_MARKERS; mrk++ ) {
+		for ( int f = 0; f < frames; f++ ) if ( FrameIsValid( raw->markerVisible[mrk], f ) ) markers[f] |= 0x01U << mrk;
+	}
+	table->rows = frames;
+
+}
+
+static void ExportFrames( ExportTable *table, const char *root, double filter_constant, GripExportSummary *summary ) {
+
+	EPMTelemetryHeaderInfo	epmHeader;
+	DecodeWork				work;
+	GripFrameStore			*store[2];
+	char					filename[1024];
+	size_t					count;
+
+	CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_RT_SCIENCE_PACKET, root );
+	FILE *fp = fopen( filename, "rb" );
+	if ( !fp ) return;
+
+	unsigned char *packet = (unsigned char *) ExportAllocate( NULL, (size_t) EXPORT_GROUP_PACKETS * rtPacketLengthInBytes );
+	work.rt = (GripRealtimeDataInfo *) ExportAllocate( NULL, EXPORT_GROUP_PACKETS * sizeof( GripRealtimeDataInfo ) );
+	for ( int i = 0; i < 2; i++ ) {
+		store[i] = CreateGripFrameStore( EXPORT_GROUP_FRAMES );
+		store[i]->dex->SetFilterConstant( i ? filter_constant : 0.0 );
+		work.decoder[i] = (GripFrameDecoder *) ExportAllocate( NULL, sizeof( GripFrameDecoder ) );
+		ResetGripFrameDecoder( work.decoder[i], store[i] );
+	}
+
+	// A partial packet at the end is ignored.
+	while ( ( count = fread( packet, rtPacketLengthInBytes, EXPORT_GROUP_PACKETS, fp ) ) > 0 ) {
+		for ( size_t p = 0; p < count; p++ ) {
+			const EPMTelemetryPacket *epm = (const EPMTelemetryPacket *) ( packet + p * rtPacketLengthInBytes );
+			ExtractEPMTelemetryHeaderInfo( &epmHeader, epm );
+			if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_RT_ID ) {
+				fMessageBox( MB_OK, "GripMMI", "Unrecognized packet %d in %s.", summary->rtPackets + (int) p, filename );
+				exit( -1 );
+			}
+			ExtractGripRealtimeDataInfo( &work.rt[p], epm );
+		}
+		work.count = (int) count;
+		work.next = 0;
+		ExportInParallel( DecodeFramesThread, &work, 2 );
+		FillFrameColumns( table, store[0], store[1] );
+		summary->rtPackets += (int) count;
+		summary->frames += table->rows;
+		FlushExportTable( table );
+	}
+	fclose( fp );
+
+	for ( int i = 0; i < 2; i++ ) {
+		free( work.decoder[i] );
+		FreeGripFrameStore( store[i] );
+	}
+	free( work.rt );
+	free( packet );
+
+}
+
+///
+/// HK packets and the steps of the script.
+///
+
+static void ExportHK( ExportTable *table, GripTimeline *timeline, const char *root, GripExportSummary *summary ) {
+
+	EPMTelemetryPacket		packet;
+	EPMTelemetryHeaderInfo	epmHeader;
+	GripHealthAndStatusInfo	hk;
+	char filename[1024];
+
+	CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_HK_BULK_PACKET, root );
+	FILE *fp = fopen( filename, "rb" );
+	if ( !fp ) return;
+	while ( 1 == fread( &packet, hkPacketLengthInBytes, 1, fp ) ) {
+		ExtractEPMTelemetryHeaderInfo( &epmHeader, &packet );
+		if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_HK_ID ) {
+			fMessageBox( MB_OK, "GripMMI", "Unrecognized packet %d in %s.", summary->hkPackets, filename );
+			exit( -1 );
+		}
+		ExtractGripHealthAndStatusInfo( &hk, &packet );
+		double instant = (double) EPMtoSeconds( &epmHeader );
+		TimelineAddHK( timeline, &hk, instant );
+		const unsigned long field[HK_COLUMNS - 1] = {
+			hk.user, hk.protocol, hk.task, hk.step, hk.scriptEngineStatusEnum, hk.iochannelStatusEnum, hk.motionTrackerStatusEnum,
+			hk.crewCameraStatusEnum, hk.crewCameraRate, hk.runningBits, hk.cpuUsage, hk.memoryUsage,
+			hk.horizontalTargetFeedback, hk.verticalTargetFeedback, hk.toneFeedback, hk.cradleDetectors,
+			hk.freeDiskSpaceC, hk.freeDiskSpaceD, hk.freeDiskSpaceE };
+		SetExportDouble( table, 0, instant );
+		for ( int c = 1; c < HK_COLUMNS; c++ ) SetExportUnsigned( table, c, field[c - 1] );
+		EndExportRow( table );
+		summary->hkPackets++;
+	}
+	fclose( fp );
+
+}
+
+static void ExportSteps( ExportTable *table, const GripTimeline *timeline, GripExportSummary *summary ) {
+	for ( int i = 0; i < TimelineIntervals( timeline ); i++ ) {
+		const GripTimelineInterval *interval = TimelineInterval( timeline, i );
+		SetExportDouble( table, 0, interval->start );
+		SetExportDouble( table, 1, interval->stop );
+		SetExportUnsigned( table, 2, interval->user );
+		SetExportUnsigned( table, 3, interval->protocol );
+		SetExportUnsigned( table, 4, interval->task );
+		SetExportUnsigned( table, 5, interval->step );
+		SetExportUnsigned( table, 6, interval->scriptEngineStatus );
+		EndExportRow( table );
+		summary->steps++;
+	}
+}
+
+bool ExportGripSession( const char *root, const char *prefix, GripExportFormat format, double filter_constant, GripExportSummary *summary ) {
+
+	static const char *tableName[3] = { "frames", "hk", "steps" };
+	GripColumnWriter *writer = NULL;
+	FILE *csv[3] = { NULL, NULL, NULL };
+	char filename[1024];
+	bool ok = true;
+
+	LARGE_INTEGER frequency, start, finish;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+	memset( summary, 0, sizeof( *summary ) );
+
+	// All the files are opened first, so that nothing is done if one cannot be.
+	if ( format == EXPORT_COLUMNS ) {
+		_snprintf( filename, sizeof( filename ), "%s.gcol", prefix );
+		filename[sizeof( filename ) - 1] = 0;
+		if ( !( writer = CreateGripColumnFile( filename ) ) ) return( false );
+	}
+	else {
+		for ( int i = 0; i < 3; i++ ) {
+			_snprintf( filename, sizeof( filename ), "%s.%s.csv", prefix, tableName[i] );
+			filename[sizeof( filename ) - 1] = 0;
+			if ( !( csv[i] = fopen( filename, "w" ) ) ) {
+				for ( int j = 0; j < i; j++ ) fclose( csv[j] );
+				return( false );
+			}
+		}
+	}
+
+	// The names and types of the columns of each table.
+	char filteredName[FRAME_CHANNELS][GRIP_COLUMN_NAME_LENGTH];
+	const char *frameColumn[FRAME_COLUMNS];
+	GripColumnType frameType[FRAME_COLUMNS], hkType[HK_COLUMNS], stepType[STEP_COLUMNS];
+	frameColumn[FRAME_TIME] = "time";
+	frameColumn[FRAME_ANALOG_TIME] = "analog_time";
+	frameColumn[FRAME_SEGMENT_START] = "segment_start";
+	for ( int c = 0; c < FRAME_CHANNELS; c++ ) {
+		_snprintf( filteredName[c], GRIP_COLUMN_NAME_LENGTH, "filtered_%s", channelName[c] );
+		filteredName[c][GRIP_COLUMN_NAME_LENGTH - 1] = 0;
+		frameColumn[FRAME_RAW + c] = channelName[c];
+		frameColumn[FRAME_FILTERED + c] = filteredName[c];
+	}
+	for ( int m = 0; m < FRAME_MASK_COUNT; m++ ) frameColumn[FRAME_MASKS + m] = maskName[m];
+	frameColumn[FRAME_MARKERS] = "marker_visible";
+	for ( int c = 0; c < FRAME_COLUMNS; c++ ) frameType[c] = ( c >= FRAME_MASKS || c == FRAME_SEGMENT_START ? COLUMN_UINT8 : COLUMN_FLOAT64 );
+	frameType[FRAME_MARKERS] = COLUMN_UINT32;
+	for ( int c = 0; c < HK_COLUMNS; c++ ) hkType[c] = ( c == 0 ? COLUMN_FLOAT64 : COLUMN_UINT32 );
+	for ( int c = 0; c < STEP_COLUMNS; c++ ) stepType[c] = ( c < 2 ? COLUMN_FLOAT64 : COLUMN_UINT32 );
+
+	ExportTable table;
+	GripTimeline *timeline = CreateTimeline();
+
+	StartExportTable( &table, writer, csv[0], tableName[0], frameColumn, frameType, FRAME_COLUMNS, EXPORT_GROUP_FRAMES );
+	ExportFrames( &table, root, filter_constant, summary );
+	ok = FinishExportTable( &table, &summary->bytes ) && ok;
+
+	StartExportTable( &table, writer, csv[1], tableName[1], hkColumn, hkType, HK_COLUMNS, EXPORT_GROUP_ROWS );
+	ExportHK( &table, timeline, root, summary );
+	ok = FinishExportTable( &table, &summary->bytes ) && ok;
+
+	StartExportTable( &table, writer, csv[2], tableName[2], stepColumn, stepType, STEP_COLUMNS, EXPORT_GROUP_ROWS );
+	ExportSteps( &table, timeline, summary );
+	ok = FinishExportTable( &table, &summary->bytes ) && ok;
+
+	FreeTimeline( timeline );
+	if ( writer ) {
+		__int64 size;
+		ok = CloseGripColumnFile( writer, &size ) && ok;
+		summary->bytes = size;
+	}
+
+	QueryPerformanceCounter( &finish );
+	summary->seconds = (double) ( finish.QuadPart - start.QuadPart ) / (double) frequency.QuadPart;
+	return( ok );
+
+}
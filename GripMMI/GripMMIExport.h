@@ -0,0 +1,48 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Export of a recorded session, as processed by GripMMI, for analysis elsewhere.
+
+// The RT cache is read and decoded a group of packets at a time, twice: once without filtering
+//  and once with the filters of GripMMI, on two threads. Each group of frames is written out
+//  before the next is read, so the memory needed does not depend on the length of the session.
+// Three tables are written:
+//   frames   the time, the raw and filtered channels and the visibility of each frame, and
+//            whether it starts a segment (see GripMMIFrameStore.h). A channel holds
+//            MISSING_DOUBLE where it is not valid, as when the manipulandum was not seen;
+//            marker_visible has one bit per marker.
+//   hk       the script engine and system status of each HK packet.
+//   steps    the intervals of the script timeline (see GripMMITimeline.h).
+// The tables go into one column file (see GripMMIColumnFile.h), from which single channels can
+//  be read back, or else into one CSV file each, with a header line.
+
+#include "GripMMIColumnFile.h"
+
+typedef enum { EXPORT_COLUMNS, EXPORT_CSV } GripExportFormat;
+
+// Packets of the RT cache that are decoded and written out at a time.
+#define EXPORT_GROUP_PACKETS	2000
+
+typedef struct {
+	int			rtPackets;
+	int			hkPackets;
+	__int64		frames;
+	int			steps;
+	// Bytes written, over all the files.
+	__int64		bytes;
+	double		seconds;
+} GripExportSummary;
+
+// Export the session of the packet caches under root into prefix.gcol, or into prefix.frames.csv,
+//  prefix.hk.csv and prefix.steps.csv. The frames are filtered with filter_constant (see DexAnalogMixin.h).
+// Returns false if a file could not be written. Missing caches give empty tables.
+bool ExportGripSession( const char *root, const char *prefix, GripExportFormat format, double filter_constant, GripExportSummary *summary );
@@ -0,0 +1,281 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Decoding of the realtime science packets into frames. See GripMMIFrameDecoder.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\VectorsBatch.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+
+#include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
+#include "GripMMIFrameDecoder.h"
+
+// Grip force threshold for a valid CoP.
+#define COP_MIN_GRIP	0.5
+
+// The decoder of the frames that GripMMI shows.
+static GripFrameDecoder mmiDecoder = { &gripFrames, 0.0, { { 0.0 } }, { { 0.0 } }, { 0 }, 0 };
+
+///
+/// Conversion of the manipulandum orientation from quaternions to rotation angles.
+/// This used to be done one frame at a time with QuaternionToCannonicalRotations() and
+///  took most of the time needed to load a long cache file. Now the quaternions are
+///  queued as the frames are read and converted in batches with the SSE2 routines.
+/// The recursive filter is applied to the rotations as each batch is flushed, in frame order.
+///
+
+void FlushGripFrameDecoder( GripFrameDecoder *decoder ) {
+	GripFrameStore *store = decoder->store;
+	QuaternionColumns<double> q = { decoder->batchQuaternion[X], decoder->batchQuaternion[Y], decoder->batchQuaternion[Z], decoder->batchQuaternion[M] };
+	VectorColumns<double> r = { decoder->batchRotations[X], decoder->batchRotations[Y], decoder->batchRotations[Z] };
+	BatchQuaternionToCannonicalRotations( r, q, decoder->batchCount );
+	for ( int i = 0; i < decoder->batchCount; i++ ) {
+		double *rotations = store->manipulandumRotations[decoder->batchFrame[i]];
+		rotations[X] = decoder->batchRotations[X][i];
+		rotations[Y] = decoder->batchRotations[Y][i];
+		rotations[Z] = decoder->batchRotations[Z][i];
+		// If the orientation is available, filter it as well.
+		if ( _finite( rotations[X] ) ) store->dex->FilterManipulandumRotations( rotations );
+	}
+	decoder->batchCount = 0;
+}
+
+static void QueueRotation( GripFrameDecoder *decoder, unsigned int frame, const Quaternion q ) {
+	int i = decoder->batchCount;
+	decoder->batchQuaternion[X][i] = q[X];
+	decoder->batchQuaternion[Y][i] = q[Y];
+	decoder->batchQuaternion[Z][i] = q[Z];
+	decoder->batchQuaternion[M][i] = q[M];
+	decoder->batchFrame[i] = frame;
+	decoder->batchCount++;
+	if ( decoder->batchCount >= ROTATION_BATCH ) FlushGripFrameDecoder( decoder );
+}
+
+void ResetGripFrameDecoder( GripFrameDecoder *decoder, GripFrameStore *store ) {
+	decoder->store = store;
+	decoder->previousPacketTimestamp = 0.0;
+	decoder->batchCount = 0;
+}
+
+void DecodeGripRTFrames( GripFrameDecoder *decoder, GripRealtimeDataInfo *rt ) {
+
+	int mrk, count;
+	GripFrameStore *store = decoder->store;
+	DexAnalogMixin *dex = store->dex;
+	unsigned int frame;
+
+	// If there has been a break in the arrival of the packets, start a new
+	//  segment. The graphs do not draw across from one segment to the next.
+	// This used to be done by inserting MAX_PLOT_STEP blank frames.
+	if ( (rt->packetTimestamp - decoder->previousPacketTimestamp) > PACKET_STREAM_BREAK_THRESHOLD ) StartStoreSegment( store, store->nFrames );
+	decoder->previousPacketTimestamp = rt->packetTimestamp;
+
+	for ( int slice = 0; slice < RT_SLICES_PER_PACKET && store->nFrames < store->maxFrames; slice++ ) {
+		ManipulandumPacket *data = &rt->dataSlice[slice];
+		frame = store->nFrames;
+		// Get the time of the slice.
+		store->realMarkerTime[frame] = data->bestGuessPoseTimestamp;
+		store->realAnalogTime[frame] = data->bestGuessAnalogTimestamp;
+		SetFrameValidity( store->manipulandumVisible, frame, data->manipulandumVisibility != 0 );
+		if ( data->manipulandumVisibility ) {
+			// Retrieve the position and convert to mm.
+			double *position = store->manipulandumPosition[frame];
+			position[X] = data->position[X] / 10.0;
+			position[Y] = data->position[Y] / 10.0;
+			position[Z] = data->position[Z] / 10.0;
+			// Convert quaternion to a form that is easier to understand in graphs.
+			// This is done in batches. See FlushGripFrameDecoder().
+			QueueRotation( decoder, frame, data->quaternion );
+			// Apply recursive filter to position data for this slice.
+			dex->FilterManipulandumPosition( position );
+		}
+		else {
+			// Manipulandum was not visible, so record as missing data, as well as clearing
+			//  the bit in manipulandumVisible, so that stale values are never shown.
+			double *position = store->manipulandumPosition[frame];
+			double *rotations = store->manipulandumRotations[frame];
+			position[X] = position[Y] = position[Z] = MISSING_DOUBLE;
+			rotations[X] = rotations[Y] = rotations[Z] = MISSING_DOUBLE;
+		}
+		// The GRIP ICD does not say what is the reference frame for the force data.
+		// I'm pretty sure that this is right.
+		store->gripForce[frame] = (float) dex->ComputeGripForce( data->ft[LEFT_ATI].force, data->ft[RIGHT_ATI].force );
+		store->gripForce[frame] = (float) dex->FilterGripForce( store->gripForce[frame] );
+		// It is useful to plot the normal force from each ATI sensor. They should be very similar unless
+		//  the subject is touching the manipulandum outside the ATI sensor surfaces.
+		store->normalForce[LEFT_ATI][frame] = - (float) data->ft[LEFT_ATI].force[X];
+		store->normalForce[LEFT_ATI][frame] = (float) dex->FilterNormalForce( store->normalForce[LEFT_ATI][frame], LEFT_ATI );
+		store->normalForce[RIGHT_ATI][frame] = (float) data->ft[RIGHT_ATI].force[X];
+		store->normalForce[RIGHT_ATI][frame] = (float) dex->FilterNormalForce( store->normalForce[RIGHT_ATI][frame], RIGHT_ATI );
+		// Compute the acceleration, load force, load force magnitude and center-of-pressures, and filter appropriately.
+		dex->ComputeLoadForce( store->loadForce[frame], data->ft[0].force, data->ft[1].force );
+		store->loadForceMagnitude[frame] = dex->FilterLoadForce( store->loadForce[frame] );
+		for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+			double cop_distance = dex->ComputeCoP( store->centerOfPressure[ati][frame], data->ft[ati].force, data->ft[ati].torque, COP_MIN_GRIP );
+			if ( cop_distance >= 0.0 ) dex->FilterCoP( ati, store->centerOfPressure[ati][frame] );
+			SetFrameValidity( store->centerOfPressureValid[ati], frame, cop_distance >= 0.0 );
+		}
+		double *acceleration = store->acceleration[frame];
+		acceleration[X] = (float) data->acceleration[X];
+		acceleration[Y] = (float) data->acceleration[Y];
+		acceleration[Z] = (float) data->acceleration[Z];
+		dex->FilterAcceleration( acceleration );
+
+		// Set the bits that show when each marker is visible.
+		// We consider a marker visible if it is seen by either coda.
+		// The frame is visible if all of its markers are visible and
+		//  the wrist is visible if at least 3 of its markers are visible.
+		unsigned long seen = data->markerVisibility[0] | data->markerVisibility[1];
+		for ( mrk = 0; mrk < CODA_MARKERS; mrk++ ) SetFrameValidity( store->markerVisible[mrk], frame, ( seen & ( 0x01 << mrk ) ) != 0 );
+		for ( mrk = FRAME_FIRST_MARKER, count = 0; mrk <= FRAME_LAST_MARKER; mrk++ ) if ( seen & ( 0x01 << mrk ) ) count++;
+		SetFrameValidity( store->frameVisible, frame, count == 4 );
+		for ( mrk = WRIST_FIRST_MARKER, count = 0; mrk <= WRIST_LAST_MARKER; mrk++ ) if ( seen & ( 0x01 << mrk ) ) count++;
+		SetFrameValidity( store->wristVisible, frame, count >= 3 );
+
+		// Count the number of frames.
+		store->nFrames++;
+	}
+
+}
+
+void ResetFrameDecoder( void ) {
+	ResetGripFrameDecoder( &mmiDecoder, &gripFrames );
+}
+
+void DecodeGripRTPacket( GripRealtimeDataInfo *rt ) {
+	DecodeGripRTFrames( &mmiDecoder, rt );
+}
+
+void FlushFrameDecoder( void ) {
+	FlushGripFrameDecoder( &mmiDecoder );
+}
+
+///
+/// Whole caches.
+///
+
+// The cache is mapped rather than read, so the packets are decoded where they lie in the page cache.
+// A partial packet at the end, which DexGroundMonitorClient may be in the middle of writing, is ignored.
+typedef struct {
+	HANDLE				file;
+	HANDLE				mapping;
+	const unsigned char	*data;
+	__int64				size;
+} MappedCache;
+
+// Returns false if the cache holds no complete packet, in which case nothing is mapped.
+static bool MapGripRTCache( MappedCache *cache, const char *filename ) {
+	LARGE_INTEGER size;
+	cache->mapping = NULL;
+	cache->data = NULL;
+	cache->file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if ( cache->file == INVALID_HANDLE_VALUE || !GetFileSizeEx( cache->file, &size ) ) {
+		fMessageBox( MB_OK, "GripMMI", "Error opening packet file %s.", filename );
+		exit( -1 );
+	}
+	cache->size = size.QuadPart;
+	// A file mapping cannot be empty.
+	if ( cache->size < rtPacketLengthInBytes ) {
+		CloseHandle( cache->file );
+		return( false );
+	}
+	cache->mapping = CreateFileMappingA( cache->file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( cache->mapping ) cache->data = (const unsigned char *) MapViewOfFile( cache->mapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( !cache->data ) {
+		fMessageBox( MB_OK, "GripMMI", "Error mapping packet file %s into memory.\nError code: %d", filename, GetLastError() );
+		exit( -1 );
+	}
+	return( true );
+}
+
+static void UnmapGripRTCache( MappedCache *cache ) {
+	UnmapViewOfFile( cache->data );
+	CloseHandle( cache->mapping );
+	CloseHandle( cache->file );
+}
+
+static int DecodeGripRTCache( GripFrameDecoder *decoder, const MappedCache *cache, const char *filename ) {
+
+	EPMTelemetryHeaderInfo	epmHeader;
+	GripRealtimeDataInfo	rt;
+	GripFrameStore			*store = decoder->store;
+	int packets = 0;
+
+	for ( __int64 offset = 0; offset + rtPacketLengthInBytes <= cache->size && store->nFrames < store->maxFrames; offset += rtPacketLengthInBytes ) {
+		const EPMTelemetryPacket *packet = (const EPMTelemetryPacket *) ( cache->data + offset );
+		ExtractEPMTelemetryHeaderInfo( &epmHeader, packet );
+		if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_RT_ID ) {
+			fMessageBox( MB_OK, "GripMMI", "Unrecognized packet at byte %lld of %s.", offset, filename );
+			exit( -1 );
+		}
+		ExtractGripRealtimeDataInfo( &rt, packet );
+		DecodeGripRTFrames( decoder, &rt );
+		packets++;
+	}
+	FlushGripFrameDecoder( decoder );
+	return( packets );
+
+}
+
+int LoadGripRTCache( const char *filename ) {
+
+	MappedCache cache;
+	int packets;
+	__int64 frames;
+
+	nFrames = 0;
+	ResetSegments();
+	ResetFrameDecoder();
+	if ( !MapGripRTCache( &cache, filename ) ) return( 0 );
+	// The buffers are sized to the cache, as for LoadGripFrameStore(), up to MAX_FRAMES.
+	frames = cache.size / rtPacketLengthInBytes * RT_SLICES_PER_PACKET;
+	AllocateFrameBuffers( (unsigned int) ( frames < MAX_FRAMES ? frames : MAX_FRAMES ) );
+	packets = DecodeGripRTCache( &mmiDecoder, &cache, filename );
+	UnmapGripRTCache( &cache );
+	return( packets );
+
+}
+
+GripFrameStore *LoadGripFrameStore( const char *filename, double filter_constant, int *packets ) {
+
+	MappedCache cache;
+	GripFrameStore *store;
+	int decoded = 0;
+
+	if ( !MapGripRTCache( &cache, filename ) ) store = CreateGripFrameStore( 0 );
+	else {
+		store = CreateGripFrameStore( (unsigned int) ( cache.size / rtPacketLengthInBytes ) * RT_SLICES_PER_PACKET );
+		store->dex->SetFilterConstant( filter_constant );
+		// The decoder is too big for the stack of a loader thread.
+		GripFrameDecoder *decoder = (GripFrameDecoder *) malloc( sizeof( GripFrameDecoder ) );
+		if ( !decoder ) {
+			fMessageBox( MB_OK, "GripMMI", "Error allocating memory to decode %s.", filename );
+			exit( -1 );
+		}
+		ResetGripFrameDecoder( decoder, store );
+		decoded = DecodeGripRTCache( decoder, &cache, filename );
+		free( decoder );
+		UnmapGripRTCache( &cache );
+	}
+	if ( packets ) *packets = decoded;
+	return( store );
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Decoding of the realtime science packets into the frames of a GripFrameStore (see GripMMIFrameStore.h).
+
+// GetGripRT() reads the packets from the cache as they arrive and hands each one to DecodeGripRTPacket().
+// Tools that work on a finished session, such as GripMMISnapshot, use LoadGripRTCache() instead,
+//  which maps the whole cache file into memory and decodes it in one pass.
+// These decode into gripFrames, the frames that GripMMI shows. A GripFrameDecoder decodes into
+//  a store of its own, so that several sessions can be decoded at the same time on different threads.
+//  LoadGripFrameStore() does that for a whole cache.
+// The exporter (see GripMMIExport.h) decodes a cache a group of packets at a time into small stores,
+//  with and without filtering, so that it never holds the whole session.
+
+#include "..\Grip\GripPackets.h"
+
+#include "GripMMIFrameStore.h"
+
+// Number of frames for which quaternions are converted to rotations in one batch.
+#define ROTATION_BATCH	1024
+
+typedef struct {
+	GripFrameStore	*store;
+	// This is used to calculate the elapsed time between two packets.
+	// By setting it to zero, the first packet read will be signaled as having arrived after a long delay.
+	double			previousPacketTimestamp;
+	// The quaternions that are waiting to be converted, and for which frames.
+	double			batchQuaternion[4][ROTATION_BATCH];
+	double			batchRotations[3][ROTATION_BATCH];
+	unsigned int	batchFrame[ROTATION_BATCH];
+	int				batchCount;
+} GripFrameDecoder;
+
+// Forget the timestamp of the previous packet, so that the next one starts a new segment.
+void ResetFrameDecoder( void );
+
+// Decode the slices of a packet into the next frames of the data buffers, computing and filtering
+//  the forces, the CoP, etc. A new segment is started if there was a break in the packet stream.
+// Slices that do not fit in the buffers are dropped.
+// The rotations are converted in batches, so FlushFrameDecoder() must be called before they are used.
+void DecodeGripRTPacket( GripRealtimeDataInfo *rt );
+void FlushFrameDecoder( void );
+
+// Empty the data buffers and fill them from the realtime packet cache file.
+// Returns the number of packets that were decoded.
+int LoadGripRTCache( const char *filename );
+
+// The same, for a given decoder and its store.
+void ResetGripFrameDecoder( GripFrameDecoder *decoder, GripFrameStore *store );
+void DecodeGripRTFrames( GripFrameDecoder *decoder, GripRealtimeDataInfo *rt );
+void FlushGripFrameDecoder( GripFrameDecoder *decoder );
+
+// A new store, just big enough for the frames of the cache file, filled from it.
+// The frames are filtered with the given filter constant (see DexAnalogMixin::SetFilterConstant()).
+// If packets is not NULL, it gets the number of packets that were decoded.
+GripFrameStore *LoadGripFrameStore( const char *filename, double filter_constant, int *packets );
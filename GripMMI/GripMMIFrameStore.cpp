@@ -0,0 +1,279 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Stores of frames, segments of contiguous packets and runs of valid frames.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\Grip\GripPackets.h"
+
+#include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
+
+///
+/// Stores.
+///
+
+static void *StoreAllocate( size_t count, size_t size ) {
+	void *memory = calloc( count ? count : 1, size );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for the frames of a session." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+static void AllocateStoreBuffers( GripFrameStore *store, unsigned int max_frames ) {
+
+	unsigned int words = ( max_frames + 31 ) / 32;
+
+	store->maxFrames = max_frames;
+	store->nFrames = 0;
+	store->manipulandumRotations = (Vector3 *) StoreAllocate( max_frames, sizeof( Vector3 ) );
+	store->manipulandumPosition = (Vector3 *) StoreAllocate( max_frames, sizeof( Vector3 ) );
+	store->acceleration = (Vector3 *) StoreAllocate( max_frames, sizeof( Vector3 ) );
+	store->gripForce = (double *) StoreAllocate( max_frames, sizeof( double ) );
+	store->loadForce = (Vector3 *) StoreAllocate( max_frames, sizeof( Vector3 ) );
+	store->loadForceMagnitude = (double *) StoreAllocate( max_frames, sizeof( double ) );
+	store->realMarkerTime = (double *) StoreAllocate( max_frames, sizeof( double ) );
+	store->realAnalogTime = (double *) StoreAllocate( max_frames, sizeof( double ) );
+	for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+		store->normalForce[ati] = (double *) StoreAllocate( max_frames, sizeof( double ) );
+		store->centerOfPressure[ati] = (Vector3 *) StoreAllocate( max_frames, sizeof( Vector3 ) );
+		store->centerOfPressureValid[ati] = (uint32_t *) StoreAllocate( words, sizeof( uint32_t ) );
+	}
+
+	// There cannot be more segments than packets.
+	store->maxSegments = ( max_frames + RT_SLICES_PER_PACKET - 1 ) / RT_SLICES_PER_PACKET;
+	store->nSegments = 0;
+	store->segmentStart = (unsigned int *) StoreAllocate( store->maxSegments, sizeof( unsigned int ) );
+	store->manipulandumVisible = (uint32_t *) StoreAllocate( words, sizeof( uint32_t ) );
+	store->frameVisible = (uint32_t *) StoreAllocate( words, sizeof( uint32_t ) );
+	store->wristVisible = (uint32_t *) StoreAllocate( words, sizeof( uint32_t ) );
+	for ( int mrk = 0; mrk < CODA_MARKERS; mrk++ ) store->markerVisible[mrk] = (uint32_t *) StoreAllocate( words, sizeof( uint32_t ) );
+
+}
+
+static void FreeStoreBuffers( GripFrameStore *store ) {
+	free( store->manipulandumRotations );
+	free( store->manipulandumPosition );
+	free( store->acceleration );
+	free( store->gripForce );
+	free( store->loadForce );
+	free( store->loadForceMagnitude );
+	free( store->realMarkerTime );
+	free( store->realAnalogTime );
+	for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+		free( store->normalForce[ati] );
+		free( store->centerOfPressure[ati] );
+		free( store->centerOfPressureValid[ati] );
+	}
+	free( store->segmentStart );
+	free( store->manipulandumVisible );
+	free( store->frameVisible );
+	free( store->wristVisible );
+	for ( int mrk = 0; mrk < CODA_MARKERS; mrk++ ) free( store->markerVisible[mrk] );
+}
+
+GripFrameStore *CreateGripFrameStore( unsigned int max_frames ) {
+	GripFrameStore *store = (GripFrameStore *) StoreAllocate( 1, sizeof( GripFrameStore ) );
+	AllocateStoreBuffers( store, max_frames );
+	store->dex = new DexAnalogMixin();
+	return( store );
+}
+
+void ResizeGripFrameStore( GripFrameStore *store, unsigned int max_frames ) {
+	FreeStoreBuffers( store );
+	AllocateStoreBuffers( store, max_frames );
+}
+
+void FreeGripFrameStore( GripFrameStore *store ) {
+	if ( !store || store == &gripFrames ) return;
+	FreeStoreBuffers( store );
+	delete store->dex;
+	free( store );
+}
+
+int FindStoreFrame( const GripFrameStore *store, double instant ) {
+	if ( store->nFrames == 0 || instant < store->realMarkerTime[0] ) return( -1 );
+	int low = 0, high = (int) store->nFrames - 1;
+	while ( low < high ) {
+		int mid = ( low + high + 1 ) / 2;
+		if ( store->realMarkerTime[mid] <= instant ) low = mid;
+		else high = mid - 1;
+	}
+	return( low );
+}
+
+///
+/// Segments and runs.
+///
+
+void ResetStoreSegments( GripFrameStore *store ) {
+	store->nSegments = 0;
+}
+
+void StartStoreSegment( GripFrameStore *store, unsigned int frame ) {
+	// There cannot be more segments than packets, so this should not happen.
+	// But if it does, the new frames simply get added to the last segment.
+	if ( store->nSegments >= store->maxSegments ) return;
+	store->segmentStart[store->nSegments++] = frame;
+}
+
+void ResetSegments( void ) {
+	ResetStoreSegments( &gripFrames );
+}
+
+void StartSegment( unsigned int frame ) {
+	StartStoreSegment( &gripFrames, frame );
+}
+
+// Find the first frame from 'frame' to 'limit' whose bit in the bitmap is set (value true)
+//  or cleared (value false). Returns limit + 1 if there is none.
+// Whole words that are all zeros or all ones are skipped in one go.
+static int ScanBits( const uint32_t *bitmap, int frame, int limit, bool value ) {
+	while ( frame <= limit ) {
+		uint32_t word = bitmap[frame >> 5];
+		if ( !value ) word = ~word;
+		word >>= ( frame & 31 );
+		if ( word == 0 ) {
+			frame = ( frame | 31 ) + 1;
+			continue;
+		}
+		while ( !( word & 0x01 ) ) {
+			word >>= 1;
+			frame++;
+		}
+		return( frame <= limit ? frame : limit + 1 );
+	}
+	return( limit + 1 );
+}
+
+int FindValidRuns( ViewRun *run, int max_runs, const uint32_t *bitmap, int start, int stop ) {
+	return( FindStoreValidRuns( &gripFrames, run, max_runs, bitmap, start, stop ) );
+}
+
+int FindStoreValidRuns( const GripFrameStore *store, ViewRun *run, int max_runs, const uint32_t *bitmap, int start, int stop ) {
+
+	int n = 0;
+	unsigned int seg, low, high;
+	unsigned int nFrames = store->nFrames;
+	unsigned int nSegments = store->nSegments;
+	const unsigned int *segmentStart = store->segmentStart;
+
+	if ( start < 0 ) start = 0;
+	if ( stop >= (int) nFrames ) stop = nFrames - 1;
+	if ( nSegments == 0 || stop < start ) return( 0 );
+
+	// Find the segment that contains the first frame.
+	low = 0;
+	high = nSegments - 1;
+	while ( low < high ) {
+		unsigned int mid = ( low + high + 1 ) / 2;
+		if ( (int) segmentStart[mid] <= start ) low = mid;
+		else high = mid - 1;
+	}
+
+	for ( seg = low; seg < nSegments && (int) segmentStart[seg] <= stop && n < max_runs; seg++ ) {
+		int first = ( (int) segmentStart[seg] > start ? segmentStart[seg] : start );
+		int last = ( seg + 1 < nSegments ? segmentStart[seg + 1] : nFrames ) - 1;
+		if ( last > stop ) last = stop;
+		if ( !bitmap ) {
+			run[n].first = first;
+			run[n].last = last;
+			n++;
+			continue;
+		}
+		while ( first <= last && n < max_runs ) {
+			first = ScanBits( bitmap, first, last, true );
+			if ( first > last ) break;
+			int end = ScanBits( bitmap, first, last, false );
+			run[n].first = first;
+			run[n].last = end - 1;
+			n++;
+			first = end;
+		}
+	}
+	return( n );
+}
+
+///
+/// Live tail mode.
+///
+
+unsigned int LiveTailCapacity( void ) {
+	double frames = liveTailHours * 60.0 * 60.0 * 20.0;
+	// Keep at least as much again as what gets discarded, and no more than MAX_FRAMES.
+	if ( frames < 2 * LIVE_TAIL_DISCARD_FRAMES ) frames = 2 * LIVE_TAIL_DISCARD_FRAMES;
+	if ( frames > MAX_FRAMES ) frames = MAX_FRAMES;
+	return( (unsigned int) frames );
+}
+
+// Shift a bitmap down by count bits.
+static void ShiftBitmap( uint32_t *bitmap, unsigned int count, unsigned int frames ) {
+	unsigned int words = ( frames + 31 ) / 32;
+	unsigned int skip = count / 32;
+	unsigned int shift = count % 32;
+	for ( unsigned int i = 0; i + skip < words; i++ ) {
+		uint32_t word = bitmap[i + skip] >> shift;
+		if ( shift && i + skip + 1 < words ) word |= bitmap[i + skip + 1] << ( 32 - shift );
+		bitmap[i] = word;
+	}
+}
+
+// Drop the oldest count frames and move the rest down to the start of the buffers.
+void DiscardFrames( unsigned int count ) {
+
+	unsigned int seg, kept;
+
+	if ( count >= nFrames ) {
+		nFrames = 0;
+		nSegments = 0;
+		return;
+	}
+	unsigned int remaining = nFrames - count;
+
+	memmove( &ManipulandumRotations[0], &ManipulandumRotations[count], remaining * sizeof( *ManipulandumRotations ) );
+	memmove( &ManipulandumPosition[0], &ManipulandumPosition[count], remaining * sizeof( *ManipulandumPosition ) );
+	memmove( &Acceleration[0], &Acceleration[count], remaining * sizeof( *Acceleration ) );
+	memmove( &GripForce[0], &GripForce[count], remaining * sizeof( *GripForce ) );
+	memmove( &LoadForce[0], &LoadForce[count], remaining * sizeof( *LoadForce ) );
+	memmove( &LoadForceMagnitude[0], &LoadForceMagnitude[count], remaining * sizeof( *LoadForceMagnitude ) );
+	memmove( &RealMarkerTime[0], &RealMarkerTime[count], remaining * sizeof( *RealMarkerTime ) );
+	memmove( &RealAnalogTime[0], &RealAnalogTime[count], remaining * sizeof( *RealAnalogTime ) );
+	for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+		memmove( &NormalForce[ati][0], &NormalForce[ati][count], remaining * sizeof( *NormalForce[ati] ) );
+		memmove( &CenterOfPressure[ati][0], &CenterOfPressure[ati][count], remaining * sizeof( *CenterOfPressure[ati] ) );
+		ShiftBitmap( CenterOfPressureValid[ati], count, nFrames );
+	}
+	ShiftBitmap( ManipulandumVisible, count, nFrames );
+	ShiftBitmap( FrameVisible, count, nFrames );
+	ShiftBitmap( WristVisible, count, nFrames );
+	for ( int mrk = 0; mrk < CODA_MARKERS; mrk++ ) ShiftBitmap( MarkerVisible[mrk], count, nFrames );
+
+	// Shift the segments as well. The segment that contains the new first frame now starts at 0.
+	for ( seg = 0, kept = 0; seg < nSegments; seg++ ) {
+		unsigned int end = ( seg + 1 < nSegments ? segmentStart[seg + 1] : nFrames );
+		if ( end <= count ) continue;
+		segmentStart[kept++] = ( segmentStart[seg] > count ? segmentStart[seg] - count : 0 );
+	}
+	nSegments = kept;
+	nFrames = remaining;
+
+}
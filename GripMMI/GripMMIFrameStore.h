@@ -0,0 +1,110 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The frames of a session, with the bookkeeping for breaks in the data stream and for frames where a signal is not valid.
+
+// The frames are grouped into segments of contiguous packets (segmentStart[] and nSegments)
+//  and the validity of the manipulandum, markers, etc. is held as one bit per frame.
+// The plotting routines ask for the runs of valid frames within the plotted window
+//  and hand them to the ...Runs() routines of the Views library.
+
+// A GripFrameStore holds the frames of one session. GripMMI shows the frames of gripFrames,
+//  whose buffers and counts are also known by the names of GripMMIGlobals.h (ManipulandumPosition, 
+//  nFrames, etc.), so the code that works on those directly sees the same data. The sessions that are compared
+//  with it (see GripMMISessions.h) are held in stores of their own, sized to their packet caches,
+//  so that several can be loaded and decoded at the same time.
+// The routines without a store work on gripFrames.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "..\PsyPhy2dGraphicsLib\Displays.h"
+#include "..\PsyPhy2dGraphicsLib\Views.h"
+
+typedef struct {
+
+	unsigned int	maxFrames;
+	unsigned int	nFrames;
+	Vector3			*manipulandumRotations;
+	Vector3			*manipulandumPosition;
+	Vector3			*acceleration;
+	double			*gripForce;
+	Vector3			*loadForce;
+	double			*normalForce[N_FORCE_TRANSDUCERS];
+	double			*loadForceMagnitude;
+	Vector3			*centerOfPressure[N_FORCE_TRANSDUCERS];
+	double			*realMarkerTime;
+	double			*realAnalogTime;
+
+	unsigned int	maxSegments;
+	unsigned int	nSegments;
+	unsigned int	*segmentStart;
+	uint32_t		*manipulandumVisible;
+	uint32_t		*markerVisible[CODA_MARKERS];
+	uint32_t		*frameVisible;
+	uint32_t		*wristVisible;
+	uint32_t		*centerOfPressureValid[N_FORCE_TRANSDUCERS];
+
+	// The filters applied as the frames are decoded.
+	DexAnalogMixin	*dex;
+
+} GripFrameStore;
+
+extern GripFrameStore gripFrames;
+
+// A store for max_frames frames, with filters of its own, and its release.
+GripFrameStore *CreateGripFrameStore( unsigned int max_frames );
+void FreeGripFrameStore( GripFrameStore *store );
+// Replace the buffers of a store with empty ones for max_frames frames. The filters are kept.
+void ResizeGripFrameStore( GripFrameStore *store, unsigned int max_frames );
+
+// A run is at least one frame long and two runs in the same segment are separated
+//  by at least one invalid frame, so this is the most runs that one can find.
+#define MAX_FRAME_RUNS	(MAX_FRAMES / 2 + MAX_SEGMENTS)
+
+// Set or test the bit for one frame in one of the validity bitmaps.
+// The bitmaps are made of 32-bit words on every platform, so that they have the same layout everywhere.
+inline void SetFrameValidity( uint32_t *bitmap, unsigned int frame, bool valid ) {
+	uint32_t bit = (uint32_t) 0x01 << ( frame & 31 );
+	if ( valid ) bitmap[frame >> 5] |= bit;
+	else bitmap[frame >> 5] &= ~bit;
+}
+inline bool FrameIsValid( const uint32_t *bitmap, unsigned int frame ) {
+	return( ( bitmap[frame >> 5] >> ( frame & 31 ) & 0x01 ) != 0 );
+}
+
+// Segments are started when there is a break in the packet stream.
+void ResetSegments( void );
+void StartSegment( unsigned int frame );
+void ResetStoreSegments( GripFrameStore *store );
+void StartStoreSegment( GripFrameStore *store, unsigned int frame );
+
+// In live tail mode (see liveTailHours) only the most recent frames are held in memory, and
+//  the buffers of gripFrames are allocated for just LiveTailCapacity() frames.
+// When the buffers are full, the oldest LIVE_TAIL_DISCARD_FRAMES frames are
+//  dropped and the remaining frames are shifted down to index 0.
+// The data arrays therefore stay in time order starting at index 0, so the plotting
+//  routines and the scroll bar, which work in seconds, are not affected.
+// The frames that are dropped are still in the RT cache, from which GripMMISnapshot and
+//  GripMMIExporter can decode them again.
+unsigned int LiveTailCapacity( void );
+void DiscardFrames( unsigned int count );
+
+// Fill run[] with the runs of frames between start and stop (inclusive) that are valid
+//  according to bitmap. Runs never cross from one segment to the next.
+// If bitmap is NULL, all the frames are considered valid and one gets just the segments.
+// Returns the number of runs.
+int FindValidRuns( ViewRun *run, int max_runs, const uint32_t *bitmap, int start, int stop );
+int FindStoreValidRuns( const GripFrameStore *store, ViewRun *run, int max_runs, const uint32_t *bitmap, int start, int stop );
+
+// The last frame at or before the instant, or -1 if there is none.
+int FindStoreFrame( const GripFrameStore *store, double instant );
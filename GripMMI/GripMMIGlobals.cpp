@@ -14,10 +14,17 @@
 // VC 2010 doesn't allow 'mixed' types in Forms objects. So here I define a number of global variables to 
 //  replace the arrays that I was using previously. It's ugly, but this was an unexpected 'feature' of VC2010.
 
-#include "StdAfx.h"
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "..\Useful\fMessageBox.h"
 #include "..\Grip\DexAnalogMixin.h"
 #include "..\Grip\GripPackets.h"
 #include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
 
 // Time span in seconds for each position of the span selector.
 double windowSpanSeconds[SPAN_VALUES] = { 43200.0, 14400.0, 3600.0, 1800.0, 600.0, 300.0, 60.0, 30.0 };
@@ -51,28 +58,16 @@ char *soundBar[16] = {
 //  is actually the EPM order (bit 0 is MSB). Therefore 01 = 600 gm and 10 = 400 gm.
 char *massDecoder[4] = {".", "M", "S", "L" };
 
-// Data buffers
-// Data are read from the packet caches and then written into these buffers.
-// They can then be plotted on the screen.
-Vector3 ManipulandumRotations[MAX_FRAMES];
-Vector3 ManipulandumPosition[MAX_FRAMES];
-Vector3 Acceleration[MAX_FRAMES];
-double GripForce[MAX_FRAMES];
-Vector3 LoadForce[MAX_FRAMES];
-double NormalForce[N_FORCE_TRANSDUCERS][MAX_FRAMES];
-double LoadForceMagnitude[MAX_FRAMES];
-Vector3 CenterOfPressure[N_FORCE_TRANSDUCERS][MAX_FRAMES];
-double RealMarkerTime[MAX_FRAMES];
-double CompressedMarkerTime[MAX_FRAMES];
-double RealAnalogTime[MAX_FRAMES];
-double CompressedAnalogTime[MAX_FRAMES];
-double  MarkerVisibility[MAX_FRAMES][CODA_MARKERS];
-double  ManipulandumVisibility[MAX_FRAMES];
-double  FrameVisibility[MAX_FRAMES];
-double  WristVisibility[MAX_FRAMES];
-double  PacketReceived[MAX_FRAMES];
 char markerVisibilityString[CODA_UNITS][32];
-unsigned int nFrames = 0;
+
+// Hours of data to keep in memory in live tail mode. Zero means read the whole cache.
+double liveTailHours = 0.0;
+
+// Buffers to hold the output of the block filters.
+double *FilteredGripForce = NULL;
+double *FilteredNormalForce[N_FORCE_TRANSDUCERS] = { NULL };
+Vector3 *FilteredLoadForce = NULL;
+double *FilteredLoadForceMagnitude = NULL;
 
 // This value is used to adjust timestamps to align packet times
 //  to a specific timebase. For instance, EPM uses GPS time, which 
@@ -81,4 +76,58 @@ unsigned int nFrames = 0;
 int TimebaseOffset = -16;
 
 // A helper object
-DexAnalogMixin	dex;
\ No newline at end of file
+DexAnalogMixin	dex;
+
+// The store of the frames that GripMMI shows (see GripMMIFrameStore.h).
+// It has no buffers until AllocateFrameBuffers() is called.
+static GripFrameStore GlobalFrameStore( void ) {
+	GripFrameStore store;
+	memset( &store, 0, sizeof( store ) );
+	store.dex = &dex;
+	return( store );
+}
+GripFrameStore gripFrames = GlobalFrameStore();
+unsigned int &nFrames = gripFrames.nFrames;
+unsigned int &nSegments = gripFrames.nSegments;
+
+// Data buffers
+// Data are read from the packet caches and then written into these buffers.
+// They can then be plotted on the screen.
+Vector3 *&ManipulandumRotations = gripFrames.manipulandumRotations;
+Vector3 *&ManipulandumPosition = gripFrames.manipulandumPosition;
+Vector3 *&Acceleration = gripFrames.acceleration;
+double *&GripForce = gripFrames.gripForce;
+Vector3 *&LoadForce = gripFrames.loadForce;
+double *(&NormalForce)[N_FORCE_TRANSDUCERS] = gripFrames.normalForce;
+double *&LoadForceMagnitude = gripFrames.loadForceMagnitude;
+Vector3 *(&CenterOfPressure)[N_FORCE_TRANSDUCERS] = gripFrames.centerOfPressure;
+double *&RealMarkerTime = gripFrames.realMarkerTime;
+double *&RealAnalogTime = gripFrames.realAnalogTime;
+
+// Segments of contiguous packets and bitmaps of valid frames.
+unsigned int *&segmentStart = gripFrames.segmentStart;
+uint32_t *&ManipulandumVisible = gripFrames.manipulandumVisible;
+uint32_t *(&MarkerVisible)[CODA_MARKERS] = gripFrames.markerVisible;
+uint32_t *&FrameVisible = gripFrames.frameVisible;
+uint32_t *&WristVisible = gripFrames.wristVisible;
+uint32_t *(&CenterOfPressureValid)[N_FORCE_TRANSDUCERS] = gripFrames.centerOfPressureValid;
+
+static void *FilteredAllocate( void *previous, unsigned int max_frames, size_t size ) {
+	free( previous );
+	void *memory = calloc( max_frames ? max_frames : 1, size );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for %u frames.", max_frames );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+void AllocateFrameBuffers( unsigned int max_frames ) {
+	ResizeGripFrameStore( &gripFrames, max_frames );
+	FilteredGripForce = (double *) FilteredAllocate( FilteredGripForce, max_frames, sizeof( *FilteredGripForce ) );
+	for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+		FilteredNormalForce[ati] = (double *) FilteredAllocate( FilteredNormalForce[ati], max_frames, sizeof( *FilteredNormalForce[ati] ) );
+	}
+	FilteredLoadForce = (Vector3 *) FilteredAllocate( FilteredLoadForce, max_frames, sizeof( *FilteredLoadForce ) );
+	FilteredLoadForceMagnitude = (double *) FilteredAllocate( FilteredLoadForceMagnitude, max_frames, sizeof( *FilteredLoadForceMagnitude ) );
+}
@@ -12,6 +12,8 @@
 
 /// Definition of preprocessor constants and global variables for GripMMI.
 
+#include <stdint.h>
+
 /// <summary>
 /// Buffers to hold the GRIP data.
 /// The reason that all of these are doubles (or vectors of doubles) is because
@@ -26,32 +28,56 @@
 #define N_VERTICAL_TARGETS		13
 #define N_HORIZONTAL_TARGETS	10
 
-// Buffers to hold the data.
-extern Vector3 ManipulandumRotations[MAX_FRAMES];
-extern Vector3 ManipulandumPosition[MAX_FRAMES];
-extern Vector3 Acceleration[MAX_FRAMES];
-extern double GripForce[MAX_FRAMES];
-extern Vector3 LoadForce[MAX_FRAMES];
-extern double NormalForce[N_FORCE_TRANSDUCERS][MAX_FRAMES];
-extern double LoadForceMagnitude[MAX_FRAMES];
-extern Vector3 CenterOfPressure[N_FORCE_TRANSDUCERS][MAX_FRAMES];
-extern double RealMarkerTime[MAX_FRAMES];
-extern double CompressedMarkerTime[MAX_FRAMES];
-extern double RealAnalogTime[MAX_FRAMES];
-extern double CompressedAnalogTime[MAX_FRAMES];
-extern double  MarkerVisibility[MAX_FRAMES][CODA_MARKERS];
+// Buffers to hold the data, which are those of gripFrames (see GripMMIFrameStore.h).
+// They are allocated by AllocateFrameBuffers(), below.
+extern Vector3 *&ManipulandumRotations;
+extern Vector3 *&ManipulandumPosition;
+extern Vector3 *&Acceleration;
+extern double *&GripForce;
+extern Vector3 *&LoadForce;
+extern double *(&NormalForce)[N_FORCE_TRANSDUCERS];
+extern double *&LoadForceMagnitude;
+extern Vector3 *(&CenterOfPressure)[N_FORCE_TRANSDUCERS];
+extern double *&RealMarkerTime;
+extern double *&RealAnalogTime;
 #define MANIPULANDUM_FIRST_MARKER 0
 #define MANIPULANDUM_LAST_MARKER  7
 #define FRAME_FIRST_MARKER 8
 #define FRAME_LAST_MARKER 11
 #define WRIST_FIRST_MARKER 12
 #define WRIST_LAST_MARKER 19
-extern double  ManipulandumVisibility[MAX_FRAMES];
-extern double  FrameVisibility[MAX_FRAMES];
-extern double  WristVisibility[MAX_FRAMES];
-extern double  PacketReceived[MAX_FRAMES];
+// Frames are no longer padded with MISSING_DOUBLE to show breaks in the data stream or
+//  when the manipulandum is not visible. Instead, the frames are grouped into segments
+//  of contiguous packets and one bit per frame says whether a given signal is valid.
+// See GripMMIFrameStore.h for the routines that turn these into runs of valid frames.
+#define MAX_SEGMENTS	((MAX_FRAMES + RT_SLICES_PER_PACKET - 1) / RT_SLICES_PER_PACKET)
+extern unsigned int *&segmentStart;
+extern unsigned int &nSegments;
+extern uint32_t *&ManipulandumVisible;
+extern uint32_t *(&MarkerVisible)[CODA_MARKERS];
+extern uint32_t *&FrameVisible;
+extern uint32_t *&WristVisible;
+extern uint32_t *(&CenterOfPressureValid)[N_FORCE_TRANSDUCERS];
+// Number of hours of data to hold in memory in 'live tail' mode, set by the 4th command line argument.
+// When it is zero (the default) the whole cache is read into the buffers each time, up to MAX_FRAMES.
+// Otherwise the cache is read incrementally and the oldest frames are dropped from the buffers,
+//  so that the memory used stays bounded and the MMI can run unattended for days.
+// The buffers are then allocated for LiveTailCapacity() frames rather than MAX_FRAMES.
+extern double liveTailHours;
+#define LIVE_TAIL_DISCARD_FRAMES	(30 * 60 * 20)	// Drop half an hour at a time.
 extern char markerVisibilityString[CODA_UNITS][32];
-extern unsigned int nFrames;
+// The number of frames in the buffers, which with the buffers make up gripFrames (see GripMMIFrameStore.h).
+extern unsigned int &nFrames;
+// Filtered copies of the force data, filled in just before plotting
+//  when one of the block filters is selected.
+extern double *FilteredGripForce;
+extern double *FilteredNormalForce[N_FORCE_TRANSDUCERS];
+extern Vector3 *FilteredLoadForce;
+extern double *FilteredLoadForceMagnitude;
+// Allocate the buffers above, empty, for max_frames frames, replacing any that were allocated before.
+// GripMMI does this once at startup, for MAX_FRAMES frames or for LiveTailCapacity() frames in live tail mode.
+// GripMMISnapshot does it for the frames of the cache that it loads (see LoadGripRTCache()).
+void AllocateFrameBuffers( unsigned int max_frames );
 /// <summary>
 /// Data display.
 /// </summary>
@@ -78,19 +104,11 @@ extern char pictureFilenamePrefix[MAX_PATHLENGTH];
 /// Buffers to hold the contents of the scripts.
 /// </summary>
 #define MAX_TOKENS				32			// No DEX command has close to this many tokens.
-#define MAX_STEPS				4096		// I am not aware of any limit on the number of steps in a task definition.
 #define MAX_MENU_ITEMS			256			// This should be more than enough for subject, protocol and task menus.
 #define MAX_MENU_ITEM_LENGTH	1024		// Text strings in the ListBoxes will be much smaller than this as well.
-#define MAX_PICTURE_LENGTH	256				// Name of a picture file will be much shorter than this.
-#define MAX_MESSAGE_LENGTH	256				// DEX Messages are also shorter than this.
 #define MAX_ERROR_MESSAGE_LENGTH 2048		// More than long enough to hold a path and a lot of text.
 
-
-// Define the buffers used to hold the contents of the currently selected task script.
-extern char picture[MAX_STEPS][MAX_PICTURE_LENGTH];
-extern char message[MAX_STEPS][MAX_MESSAGE_LENGTH];
-extern const char *type[MAX_STEPS];
-extern bool comment[MAX_STEPS];
+// The contents of the currently selected task script are shown from the script tree (see GripMMIScriptTree.h).
 /// <summary>
 /// Constants to translate enums to strings.
 /// </summary>
@@ -0,0 +1,662 @@
+///
+/// Module:	GripMMI
+/// 
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Drawing of the strip charts and phase plots. See GripMMIGraphs.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fOutputDebugString.h"
+
+// We make use of a package of plotting routines that I have had around for decades.
+#include "..\PsyPhy2dGraphicsLib\Graphics.h"
+#include "..\PsyPhy2dGraphicsLib\Displays.h"
+#include "..\PsyPhy2dGraphicsLib\Views.h"
+#include "..\PsyPhy2dGraphicsLib\Layouts.h"
+
+// Some of the raw data needs to be processed in the same way as the GRIP hardware does it.
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\Grip\GripPackets.h"
+
+#include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
+#include "GripMMICounters.h"
+#include "GripMMIGraphs.h"
+#include "GripMMITimeline.h"
+
+// Local constants defining the ranges of various plots.
+
+double	lowerPositionLimit = -500.0;
+double	upperPositionLimit =  750.0;
+
+double	lowerRotationLimit = -Pi;
+double	upperRotationLimit =  Pi;
+
+double	lowerAccelerationLimit = -2.0;
+double	upperAccelerationLimit =  2.0;
+
+double	lowerVisibilityLimit = -20.0;
+double	upperVisibilityLimit =  100.0;
+
+double	lowerForceLimit = -10.0;
+double	upperForceLimit =  10.0;
+
+double	lowerGripLimit =  -2.0;
+double	upperGripLimit =  40.0;
+
+double	lowerCopLimit =  -0.030;
+double	upperCopLimit =   0.030;
+
+// It is convenient to have an array of position ranges
+//  that are specific to X, Y and Z.
+double lowerPositionLimitSpecific[3] = { -200.0, -100.0, -800.0 };
+double upperPositionLimitSpecific[3] = {  600.0,  700.0,    0.0 };
+
+// Define the pairs for each phase plot.
+static struct {
+	int abscissa;
+	int ordinate;
+} pair[PHASEPLOTS] = { {X,Y}, {Z,Y}, {X,Z} };
+
+static int  atiColorMap[N_FORCE_TRANSDUCERS] = { CYAN, MAGENTA };
+
+// Runs of valid frames within the time window being plotted.
+// Each graph fills this in according to the validity of the data that it plots.
+static ViewRun plotRuns[MAX_FRAME_RUNS];
+
+// Values at which the visibility traces are plotted. A size of 0 is passed to
+//  ViewScatterPlotDoubleRuns() so that the same value is used for every frame.
+static double packetReceivedLevel = -10.0;
+static double manipulandumVisibleLevel = 10.0;
+static double frameVisibleLevel = 30.0;
+static double wristVisibleLevel = 50.0;
+// Each marker is assigned a unique non-zero value in the detailed visibility graph,
+//  such that the traces are spread out and grouped in the view.
+static double markerVisibleLevel[CODA_MARKERS] = { 1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 13, 14, 17, 18, 19, 20, 21, 22, 23, 24 };
+
+// Apply the block filter to each segment separately so as not to smooth across breaks in the data.
+static void FilterSegments( double *output, unsigned output_size, double *input, unsigned input_size, int start_frame, int stop_frame ) {
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+	for ( int r = 0; r < n_runs; r++ ) dex.historyFilter.Apply( output, output_size, input, input_size, plotRuns[r].first, plotRuns[r].last );
+}
+
+// Define the Views with respect to each Display and initialize the limits in user coordinates.
+// The View code defines 'Displays' as regions of a window and 'Views' as sub-regions with
+//  defined limits in user coordinates.
+void CreateGraphViews( GripMMIGraphs *graphs ) {
+
+	for ( int i = 0; i < PHASEPLOTS; i++ ) {
+		graphs->phase_view[i] = CreateView( graphs->phase_display[i] );
+		ViewSetDisplayEdgesRelative( graphs->phase_view[i], 0.01, 0.01, 0.99, 0.99 );
+		ViewSetEdges( graphs->phase_view[i], 0, 0, 1, 1 );
+		ViewMakeSquare( graphs->phase_view[i] );
+	}
+
+	// Create a Layout (an array of Views) that will be used to plot data in stripchart form.
+	graphs->stripchart_layout = CreateLayout( graphs->stripchart_display, STRIPCHARTS, 1 );
+	LayoutSetDisplayEdgesRelative( graphs->stripchart_layout, 0.0, 0.065, 1.0, 1.0 );
+	graphs->visibility_view = CreateView( graphs->stripchart_display );
+	ViewSetDisplayEdgesRelative( graphs->visibility_view, 0.005, 0.0, 0.995, 0.06 );
+
+	// Create a specific view for displaying detailed visibility information.
+	// It is not part of the stripchart Layout because I want it to be smaller in height
+	//  than the rest of the stripcharts.
+	graphs->detailed_visibility_layout = CreateLayout( graphs->stripchart_display, 4, 1 );
+	LayoutSetDisplayEdgesRelative( graphs->detailed_visibility_layout, 0.0, 0.065, 1.0, 1.0 );
+
+}
+
+// The times are in increasing order, so the limits of the window are found by bisection.
+// This matters when a whole session is rendered window by window.
+void FindWindowFrames( double first_instant, double last_instant, int *first_frame, int *last_frame, int *step ) {
+
+	int low, high, middle;
+
+	// The last frame at or before last_instant, or frame 0 if there is none.
+	low = 0;
+	high = (int) nFrames - 1;
+	while ( low < high ) {
+		middle = ( low + high + 1 ) / 2;
+		if ( RealMarkerTime[middle] <= last_instant ) low = middle;
+		else high = middle - 1;
+	}
+	*last_frame = ( low > 0 ? low : 0 );
+
+	// The first frame at or after first_instant, but never frame 0, as before.
+	// If there is none, the window is empty and the first frame comes after the last.
+	low = 1;
+	high = *last_frame + 1;
+	while ( low < high ) {
+		middle = ( low + high ) / 2;
+		if ( RealMarkerTime[middle] < first_instant ) low = middle + 1;
+		else high = middle;
+	}
+	*first_frame = low;
+
+	// Subsample the data if there is a lot to be plotted.
+	*step = 1;
+	while ( ( ( *last_frame - *first_frame ) / *step ) > MAX_PLOT_SAMPLES && *step < ( MAX_PLOT_STEP - 1 ) ) (*step)++;
+
+}
+
+// Draw a line where each script step starts within the time window, as found in the
+//  HK packets (see GripMMITimeline.h), and if asked, the task and step IDs next to it.
+// When there are too many steps in the window for the lines to be told apart, there are none.
+#define MAX_STEP_MARKS	100
+static void MarkScriptSteps( View view, double start_instant, double stop_instant, bool label ) {
+
+	int first = TimelineFindInstant( &gripTimeline, start_instant );
+	int last = TimelineFindInstant( &gripTimeline, stop_instant );
+	if ( last < 0 || last - first > MAX_STEP_MARKS ) return;
+	if ( first < 0 ) first = 0;
+
+	ViewColor( view, GREY4 );
+	for ( int i = first; i <= last; i++ ) {
+		const GripTimelineInterval *interval = TimelineInterval( &gripTimeline, i );
+		if ( interval->start < start_instant ) continue;
+		ViewVerticalLine( view, interval->start );
+		if ( label ) {
+			char ids[32];
+			sprintf( ids, " %d.%d", interval->task, interval->step );
+			ViewText( view, ids, interval->start, ViewTop( view ), 0.0 );
+		}
+	}
+
+}
+
+// Here we do the actual work of plotting the strip charts.
+// It is assumed that the global data arrays have been filled.
+void DrawStripCharts( GripMMIGraphs *graphs, const GripMMIGraphWindow *window ) {
+
+	int first_sample, last_sample, step;
+	double first_instant = window->first_instant;
+	double last_instant = window->last_instant;
+	bool autoscale = window->autoscale;
+	Layout stripchart_layout = graphs->stripchart_layout;
+	Layout detailed_visibility_layout = graphs->detailed_visibility_layout;
+	View visibility_view = graphs->visibility_view;
+
+	FindWindowFrames( first_instant, last_instant, &first_sample, &last_sample, &step );
+
+	DisplayActivate( graphs->stripchart_display );
+	Erase( graphs->stripchart_display );
+
+	// The user can select different combinations of strip charts to plot.
+	switch ( window->collection ) {
+	// Marker Visibility Plot
+	case GRAPHS_MARKER_VISIBILITY:
+		GraphManipulandumPositionComponent( X, LayoutViewN( detailed_visibility_layout, 0 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphManipulandumPositionComponent( Y, LayoutViewN( detailed_visibility_layout, 1 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphManipulandumPositionComponent( Z, LayoutViewN( detailed_visibility_layout, 2 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphVisibilityDetails( LayoutViewN( detailed_visibility_layout, 3 ), first_instant, last_instant, first_sample, last_sample, step );
+		GraphVisibility( visibility_view, first_instant, last_instant, first_sample, last_sample, step );
+		break;
+	// Kinematics Plot
+	case GRAPHS_KINEMATICS:
+		GraphManipulandumPositionComponent( X, LayoutViewN( stripchart_layout, 0 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphManipulandumPositionComponent( Y, LayoutViewN( stripchart_layout, 1 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphManipulandumPositionComponent( Z, LayoutViewN( stripchart_layout, 2 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphAccelerationComponent( X, LayoutViewN( stripchart_layout, 3 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphAccelerationComponent( Y, LayoutViewN( stripchart_layout, 4 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphAccelerationComponent( Z, LayoutViewN( stripchart_layout, 5 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphVisibility( visibility_view, first_instant, last_instant, first_sample, last_sample, step );
+		break;
+	// Summary Plot
+	case GRAPHS_SUMMARY:
+	default:
+		GraphManipulandumPosition( LayoutViewN( stripchart_layout, 0 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphManipulandumRotations( LayoutViewN( stripchart_layout, 1 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphAcceleration( LayoutViewN( stripchart_layout, 2 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphGripForce( LayoutViewN( stripchart_layout, 3 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphLoadForce( LayoutViewN( stripchart_layout, 4 ), first_instant, last_instant, first_sample, last_sample, step, autoscale );
+		GraphCoP( LayoutViewN( stripchart_layout, 5 ), first_instant, last_instant, first_sample, last_sample, step );
+		GraphVisibility( visibility_view, first_instant, last_instant, first_sample, last_sample, step );
+		break;
+	}
+	// Show where the script steps start on each chart, with the IDs on the top one.
+	if ( window->collection == GRAPHS_MARKER_VISIBILITY ) {
+		for ( int i = 0; i < 4; i++ ) MarkScriptSteps( LayoutViewN( detailed_visibility_layout, i ), first_instant, last_instant, i == 0 );
+	}
+	else {
+		for ( int i = 0; i < STRIPCHARTS; i++ ) MarkScriptSteps( LayoutViewN( stripchart_layout, i ), first_instant, last_instant, i == 0 );
+	}
+	// The Views code requires a display swap to make the plots visible.
+	DisplaySwap( graphs->stripchart_display );
+
+}
+
+///
+/// Plotting into Stripcharts
+///
+
+// The following routines all share a similar format:
+//
+//  Parameter 'view' is a pointer to a structure that maps data values to screen coordinates. Basically it references a rectangle on the screen.
+//  Parameters 'start_instant' and 'stop_instant' determine the time window in seconds.
+//  Parameters 'start_frame', 'stop_frame' determine the range of entries in the data arrays to be used for the graphs.
+//  Parameter 'step' allows for sub-sampling of the data to reduce the number of points that are actually plotted.
+//  Parameter 'autoscale', where there is one, fits the vertical limits to the data rather than using the fixed limits above.
+//
+// All of these routines assume that the data arrays are already filled with valid data.
+
+// The plotting routines use pointers and byte sizes to allow one to plot, for instance, one component from an array 
+// of vectors. The sizeof() macro is used to compute the distance in bytes between elements in the array.
+
+// The plotting routines are given the runs of frames that hold valid data, found with FindValidRuns().
+// Nothing is plotted between runs. This is how breaks in the data stream and periods when the
+//  manipulandum was not visible show up in the graphs.
+
+// In the following routine names, 'Graph...' refers to a stripchart, while 'Plot...' refers to a phase plot.
+
+void GraphManipulandumPosition( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ){
+	__int64 render_start = CounterStart();
+			
+	double range;
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, ManipulandumVisible, start_frame, stop_frame );
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Manipulandum Position ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	// Plot all 3 components of the manipulandum position in the same view;
+	// The autoscaling is a bit complicated. I want each trace centered on its own mean
+	//  but I want the range of values to be common to all three so that magnitudes of movement
+	//  can be compared between X, Y and Z.
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		// Find the common range.
+		range = 0.0;
+		for ( int i = X; i <= Z; i++ ) {
+			ViewAutoScaleInit( view );
+			ViewAutoScaleDoubleRuns( view, &ManipulandumPosition[0][i], plotRuns, n_runs, sizeof( *ManipulandumPosition ) );
+			if ( ViewYRange( view ) > range ) range = ViewYRange( view );
+		}
+	}
+	ViewAxes( view );
+	for ( int i = X; i <= Z; i++ ) {
+		ViewSelectColor( view, i );
+		if ( autoscale ) {
+			// Autoscale each component to center each trace on its respective mean.
+			ViewAutoScaleInit( view );
+			ViewAutoScaleDoubleRuns( view, &ManipulandumPosition[0][i], plotRuns, n_runs, sizeof( *ManipulandumPosition ) );
+			// But expand the Y limits so that all 3 components are plotted on a common scale.
+			ViewSetYRange( view, range );
+		}
+		else {
+			// Use the fixed limits.
+			ViewSetYLimits( view, lowerPositionLimit, upperPositionLimit );
+		}
+		// Actually plot the data.
+		ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &ManipulandumPosition[0][i], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *ManipulandumPosition ) );
+	}
+	CounterStop( CTR_GRAPH_POSITION, render_start );
+
+}
+
+void GraphManipulandumPositionComponent( int component, View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ){
+	__int64 render_start = CounterStart();
+			
+	char *title;
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, ManipulandumVisible, start_frame, stop_frame );
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	switch ( component ) {
+	case X: title = "Manipulandum Position X "; break;
+	case Y: title = "Manipulandum Position Y "; break;
+	case Z: title = "Manipulandum Position Z "; break;
+	default: title = "error";
+	}
+	ViewTitle( view, title, INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		ViewAutoScaleDoubleRuns( view, &ManipulandumPosition[0][component], plotRuns, n_runs, sizeof( *ManipulandumPosition ) );
+	}
+	else ViewSetYLimits( view, lowerPositionLimit, upperPositionLimit );
+	ViewAxes( view );
+	ViewSelectColor( view, component );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &ManipulandumPosition[0][component], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *ManipulandumPosition ) );
+	CounterStop( CTR_GRAPH_POSITION_COMPONENT, render_start );
+}
+
+void GraphAccelerationComponent( int component, View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ){
+	__int64 render_start = CounterStart();
+			
+	char *title;
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	switch ( component ) {
+	case X: title = "Manipulandum Acceleration X "; break;
+	case Y: title = "Manipulandum Acceleration Y "; break;
+	case Z: title = "Manipulandum Acceleration Z "; break;
+	default: title = "error";
+	}
+	ViewTitle( view, title, INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		ViewAutoScaleDoubleRuns( view, &Acceleration[0][component], plotRuns, n_runs, sizeof( *Acceleration ) );
+	}
+	else ViewSetYLimits( view, lowerAccelerationLimit, upperAccelerationLimit );
+	ViewAxes( view );
+	ViewSelectColor( view, component );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &Acceleration[0][component], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *Acceleration ) );
+	CounterStop( CTR_GRAPH_ACCELERATION_COMPONENT, render_start );
+}
+
+void GraphManipulandumRotations( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ){
+	__int64 render_start = CounterStart();
+
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, ManipulandumVisible, start_frame, stop_frame );
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Manipulandum Rotation ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	// Plot all 3 components of the manipulandum rotation in the same view;
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		for ( int i = X; i <= Z; i++ ) ViewAutoScaleDoubleRuns( view, &ManipulandumRotations[0][i], plotRuns, n_runs, sizeof( *ManipulandumRotations ) );
+		ViewAutoScaleExpand( view, 0.01 );
+	}
+	else ViewSetYLimits( view, lowerRotationLimit, upperRotationLimit );
+	ViewAxes( view );
+	for ( int i = X; i <= Z; i++ ) {
+		ViewSelectColor( view, i );
+		ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &ManipulandumRotations[0][i], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *ManipulandumRotations ) );
+	}
+	CounterStop( CTR_GRAPH_ROTATIONS, render_start );
+}
+
+
+void GraphLoadForce( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ) {
+	__int64 render_start = CounterStart();
+	
+	int i;
+	
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Load Force ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	// If one of the block filters is selected, filter the frames that are about to be
+	//  plotted into separate buffers and plot those instead of the raw data.
+	Vector3 *load_force = LoadForce;
+	double *load_force_magnitude = LoadForceMagnitude;
+	if ( dex.historyFilter.Enabled() && stop_frame > start_frame ) {
+		for ( i = X; i <= Z; i++ ) FilterSegments( &FilteredLoadForce[0][i], sizeof( *FilteredLoadForce ), &LoadForce[0][i], sizeof( *LoadForce ), start_frame, stop_frame );
+		FilterSegments( FilteredLoadForceMagnitude, sizeof( *FilteredLoadForceMagnitude ), LoadForceMagnitude, sizeof( *LoadForceMagnitude ), start_frame, stop_frame );
+		load_force = FilteredLoadForce;
+		load_force_magnitude = FilteredLoadForceMagnitude;
+	}
+	// The force data is valid wherever a packet was received.
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+
+	// Plot all 3 components of the load force in the same view;
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		for ( int i = X; i <= Z; i++ ) ViewAutoScaleDoubleRuns( view, &load_force[0][i], plotRuns, n_runs, sizeof( *LoadForce ) );
+		ViewAutoScaleDoubleRuns( view, &load_force_magnitude[0], plotRuns, n_runs, sizeof( *LoadForceMagnitude ) );
+		ViewAutoScaleExpand( view, 0.01 );
+	}
+	else ViewSetYLimits( view, lowerForceLimit, upperForceLimit );
+	ViewAxes( view );
+	// Show zero load force and a +/- 4 Newton range.
+	ViewHorizontalLine( view, 0.0 );
+	if ( view->user_top > 4.0 ) ViewHorizontalLine( view, 4.0 );
+	if ( view->user_bottom < -4.0 ) ViewHorizontalLine( view, -4.0 );
+	for ( i = X; i <= Z; i++ ) {
+		ViewSelectColor( view, i );
+		ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &load_force[0][i], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *LoadForce ) );
+	}
+	ViewSelectColor( view, i );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &load_force_magnitude[0], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *LoadForceMagnitude ) );
+	CounterStop( CTR_GRAPH_LOAD, render_start );
+
+}
+void GraphAcceleration( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ) {
+	__int64 render_start = CounterStart();
+
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Acceleration ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	// Plot all 3 components of the acceleration in a single view;
+	ViewSetXLimits( view, start_instant, stop_instant );
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		for ( int i = X; i <= Z; i++ ) ViewAutoScaleDoubleRuns( view, &Acceleration[0][i], plotRuns, n_runs, sizeof( *Acceleration ) );
+		ViewAutoScaleExpand( view, 0.01 );
+	}
+	else ViewSetYLimits( view, lowerAccelerationLimit, upperAccelerationLimit );
+	ViewAxes( view );	
+	for ( int i = 0; i < 3; i++ ) {
+		ViewSelectColor( view, i );
+		ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &Acceleration[0][i], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *Acceleration ) );
+	}
+	CounterStop( CTR_GRAPH_ACCELERATION, render_start );
+}
+
+void GraphGripForce( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale ) {
+	__int64 render_start = CounterStart();
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Grip Force ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	// Apply the block filter, if any, as for the load force.
+	double *grip_force = GripForce;
+	double *normal_force[N_FORCE_TRANSDUCERS] = { NormalForce[LEFT_ATI], NormalForce[RIGHT_ATI] };
+	if ( dex.historyFilter.Enabled() && stop_frame > start_frame ) {
+		FilterSegments( FilteredGripForce, sizeof( *FilteredGripForce ), GripForce, sizeof( *GripForce ), start_frame, stop_frame );
+		grip_force = FilteredGripForce;
+		for ( int ati = 0; ati < N_FORCE_TRANSDUCERS; ati++ ) {
+			FilterSegments( FilteredNormalForce[ati], sizeof( *FilteredNormalForce[ati] ), NormalForce[ati], sizeof( *NormalForce[ati] ), start_frame, stop_frame );
+			normal_force[ati] = FilteredNormalForce[ati];
+		}
+	}
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+
+	ViewSetXLimits( view, start_instant, stop_instant );
+	ViewSetYLimits( view, lowerGripLimit, upperGripLimit );
+	ViewAxes( view );
+
+	if ( autoscale ) {
+		ViewAutoScaleInit( view );
+		ViewAutoScaleDoubleRuns( view, &grip_force[0], plotRuns, n_runs, sizeof( *GripForce ) );
+		ViewAutoScaleDoubleRuns( view, &normal_force[LEFT_ATI][0], plotRuns, n_runs, sizeof( *NormalForce[LEFT_ATI] ) );
+		ViewAutoScaleDoubleRuns( view, &normal_force[RIGHT_ATI][0], plotRuns, n_runs, sizeof( *NormalForce[RIGHT_ATI] ) );
+		ViewAutoScaleExpand( view, 0.01 );
+	}
+
+	ViewColor( view, atiColorMap[LEFT_ATI] );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &normal_force[LEFT_ATI][0], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *NormalForce[LEFT_ATI] ) );
+	ViewColor( view, atiColorMap[RIGHT_ATI] );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &normal_force[RIGHT_ATI][0], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *NormalForce[LEFT_ATI] ) );
+	ViewColor( view, GREEN );
+	ViewXYPlotDoubleRuns( view, &RealMarkerTime[0], &grip_force[0], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *GripForce ) );
+	CounterStop( CTR_GRAPH_GRIP, render_start );
+
+}
+
+void GraphVisibility( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step ) {
+	__int64 render_start = CounterStart();
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Visibility ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	ViewSetXLimits( view, start_instant, stop_instant );
+	ViewSetYLimits( view, lowerVisibilityLimit, upperVisibilityLimit );
+
+	int n_runs;
+
+	// Show when packets were received, i.e. the segments, and when the
+	//  manipulandum, the reference frame and the wrist were visible.
+	ViewColor( view, BLACK );
+	n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, NULL, start_frame, stop_frame );
+	ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &RealMarkerTime[0], &packetReceivedLevel, plotRuns, n_runs, step, sizeof( *RealMarkerTime ), 0 );
+	ViewColor( view, RED );
+	n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, ManipulandumVisible, start_frame, stop_frame );
+	ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &RealMarkerTime[0], &manipulandumVisibleLevel, plotRuns, n_runs, step, sizeof( *RealMarkerTime ), 0 );
+	ViewColor( view, GREEN );
+	n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, FrameVisible, start_frame, stop_frame );
+	ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &RealMarkerTime[0], &frameVisibleLevel, plotRuns, n_runs, step, sizeof( *RealMarkerTime ), 0 );
+	ViewColor( view, BLUE );
+	n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, WristVisible, start_frame, stop_frame );
+	ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &RealMarkerTime[0], &wristVisibleLevel, plotRuns, n_runs, step, sizeof( *RealMarkerTime ), 0 );
+	CounterStop( CTR_GRAPH_VISIBILITY, render_start );
+
+}
+
+void GraphVisibilityDetails( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step ) {
+	__int64 render_start = CounterStart();
+
+	int mrk, n_runs;
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Marker Visibility ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	ViewSetXLimits( view, start_instant, stop_instant );
+	ViewSetYLimits( view, 0, 28 );
+
+	ViewSetColor( view, GREY6 );
+	for ( mrk = 1; mrk <= 8; mrk++ ) ViewHorizontalLine( view, mrk );
+	for ( mrk = 11; mrk <= 14; mrk++ ) ViewHorizontalLine( view, mrk );
+	for ( mrk = 17; mrk <= 24; mrk++ ) ViewHorizontalLine( view, mrk );
+
+	// Plot all the visibility traces in the same view;
+	// Each marker is plotted at its own level when it is visible (see markerVisibleLevel[]).
+	for ( mrk = 0; mrk < CODA_MARKERS; mrk++ ) {
+		ViewSelectColor( view, mrk );
+		n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, MarkerVisible[mrk], start_frame, stop_frame );
+		ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &RealMarkerTime[0], &markerVisibleLevel[mrk], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), 0 );
+	}
+	CounterStop( CTR_GRAPH_VISIBILITY_DETAILS, render_start );
+}
+
+void GraphCoP( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step ){
+	__int64 render_start = CounterStart();
+
+	ViewColor( view, GREY6 );
+	ViewBox( view );
+	ViewColor( view, BLACK );
+	ViewTitle( view, "Center of Pressure ", INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+
+	ViewSetXLimits( view, start_instant, stop_instant );
+	ViewSetYLimits( view, lowerCopLimit, upperCopLimit );
+	ViewAxes( view );
+	ViewHorizontalLine( view,  0.01 );
+	ViewHorizontalLine( view, -0.01 );
+		
+	for ( int ati = 0; ati < 2; ati++ ) {
+		int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, CenterOfPressureValid[ati], start_frame, stop_frame );
+		for ( int i = X; i <= Z; i++ ) {
+			ViewSelectColor( view, 3 * ati + i );
+			ViewXYPlotClippedDoubleRuns( view, &RealMarkerTime[0], &CenterOfPressure[ati][0][i], plotRuns, n_runs, step, sizeof( *RealMarkerTime ), sizeof( *CenterOfPressure[ati] ) );
+		}
+	}
+	CounterStop( CTR_GRAPH_COP, render_start );
+}
+
+///
+/// Phase plots
+///
+
+// Phase plots of Manipulandum position data.
+static void PlotManipulandumPosition( GripMMIGraphs *graphs, int start_frame, int stop_frame, int step ){
+	__int64 render_start = CounterStart();
+
+	View view;
+	int n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, ManipulandumVisible, start_frame, stop_frame );
+
+	for ( int i = 0; i < PHASEPLOTS - 1; i++ ) {
+
+		DisplayActivate( graphs->phase_display[i] );
+		Erase( graphs->phase_display[i] );
+		view = graphs->phase_view[i];
+		ViewSetXLimits( view, lowerPositionLimitSpecific[pair[i].abscissa], upperPositionLimitSpecific[pair[i].abscissa] );
+		ViewSetYLimits( view, lowerPositionLimitSpecific[pair[i].ordinate], upperPositionLimitSpecific[pair[i].ordinate] );
+		ViewMakeSquare( view );
+		ViewSelectColor( view, i );
+		// ViewBox( view );
+		if ( stop_frame > start_frame ) ViewXYPlotDoubleRuns( view, &ManipulandumPosition[0][pair[i].abscissa], &ManipulandumPosition[0][pair[i].ordinate], plotRuns, n_runs, step, sizeof( *ManipulandumPosition ), sizeof( *ManipulandumPosition ) );
+		DisplaySwap( graphs->phase_display[i] );
+	}
+	CounterStop( CTR_PLOT_POSITION, render_start );
+}
+
+// Phase plots of center-of-pressure data.
+static void PlotCoP( GripMMIGraphs *graphs, int start_frame, int stop_frame, int step, bool live ){
+	__int64 render_start = CounterStart();
+
+	Display display = graphs->phase_display[PHASEPLOTS - 1];
+	View view = graphs->phase_view[PHASEPLOTS - 1];
+
+	DisplayActivate( display );
+	Erase( display );
+	ViewSetXLimits( view, lowerCopLimit, upperCopLimit );
+	ViewSetYLimits( view, lowerCopLimit, upperCopLimit );
+	ViewMakeSquare( view );
+
+	// Plot the history of CoPs within the selected time window.
+	if ( stop_frame > start_frame ) {
+		int n_runs;
+		ViewColor( view, atiColorMap[RIGHT_ATI] );
+		n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, CenterOfPressureValid[RIGHT_ATI], start_frame, stop_frame );
+		ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &CenterOfPressure[RIGHT_ATI][0][Z], &CenterOfPressure[RIGHT_ATI][0][Y], plotRuns, n_runs, step, sizeof( *CenterOfPressure[RIGHT_ATI] ), sizeof( *CenterOfPressure[RIGHT_ATI] ) );
+		ViewColor( view, atiColorMap[LEFT_ATI] );
+		n_runs = FindValidRuns( plotRuns, MAX_FRAME_RUNS, CenterOfPressureValid[LEFT_ATI], start_frame, stop_frame );
+		ViewScatterPlotDoubleRuns( view, SYMBOL_FILLED_SQUARE, &CenterOfPressure[LEFT_ATI][0][Z], &CenterOfPressure[LEFT_ATI][0][Y], plotRuns, n_runs, step, sizeof( *CenterOfPressure[LEFT_ATI] ), sizeof( *CenterOfPressure[0] ) );
+	}
+
+	// If we are live, plot the current CoP.
+	if ( live ) {	
+		ViewSetColor( view, RED );
+		ViewFilledCircle( view, CenterOfPressure[0][stop_frame][Z], CenterOfPressure[0][stop_frame][Y], 0.0025 );
+		ViewSetColor( view, BLUE );
+		ViewFilledCircle( view, CenterOfPressure[1][stop_frame][Z], CenterOfPressure[1][stop_frame][Y], 0.0025 );
+	}
+
+	// Plot the critical region for a centered grip.
+	ViewSetColor( view, GREY6 );
+	ViewCircle( view, 0.0, 0.0, 0.010 );
+	ViewSetColor( view, GREY6 );
+	ViewCircle( view, 0.0, 0.0, 0.020 );
+	DisplaySwap( display );
+	CounterStop( CTR_PLOT_COP, render_start );
+
+}
+
+void DrawPhasePlots( GripMMIGraphs *graphs, const GripMMIGraphWindow *window ) {
+	int first_sample, last_sample, step;
+	FindWindowFrames( window->first_instant, window->last_instant, &first_sample, &last_sample, &step );
+	PlotManipulandumPosition( graphs, first_sample, last_sample, step );
+	PlotCoP( graphs, first_sample, last_sample, step, window->live );
+}
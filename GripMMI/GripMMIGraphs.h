@@ -0,0 +1,72 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Drawing of the strip charts and phase plots from the data buffers of GripMMIGlobals.h.
+
+// These routines do not know about the GripMMI window. They draw into whatever Displays they
+//  are given, so GripMMI draws into the OpenGL panes of its form and GripMMISnapshot draws into
+//  displays that write image files. Both get the same graphs.
+
+#include "..\PsyPhy2dGraphicsLib\Displays.h"
+#include "..\PsyPhy2dGraphicsLib\Views.h"
+#include "..\PsyPhy2dGraphicsLib\Layouts.h"
+
+// The collections of strip charts, in the order of the pull-down list of GripMMI.
+typedef enum {
+	GRAPHS_SUMMARY = 0,
+	GRAPHS_KINEMATICS,
+	GRAPHS_MARKER_VISIBILITY,
+	GRAPH_COLLECTIONS
+} GripMMIGraphCollection;
+
+// The displays in which the graphs are drawn and the views that map the data onto them.
+// The displays are created and initialized by the caller. CreateGraphViews() does the rest.
+typedef struct {
+	Display		stripchart_display;
+	Layout		stripchart_layout;
+	View		visibility_view;
+	Layout		detailed_visibility_layout;
+	// XY, ZY and CoP, in that order.
+	Display		phase_display[PHASEPLOTS];
+	View		phase_view[PHASEPLOTS];
+} GripMMIGraphs;
+
+// What to plot and how.
+typedef struct {
+	GripMMIGraphCollection	collection;
+	double					first_instant;	// Time window in seconds.
+	double					last_instant;
+	bool					autoscale;
+	bool					live;			// Mark the latest CoP in the phase plot.
+} GripMMIGraphWindow;
+
+void CreateGraphViews( GripMMIGraphs *graphs );
+
+// Find the frames that fall within the time window and the subsampling that keeps
+//  the number of points plotted within MAX_PLOT_SAMPLES.
+void FindWindowFrames( double first_instant, double last_instant, int *first_frame, int *last_frame, int *step );
+
+// Erase, draw and swap the strip chart display or the phase plot displays.
+void DrawStripCharts( GripMMIGraphs *graphs, const GripMMIGraphWindow *window );
+void DrawPhasePlots( GripMMIGraphs *graphs, const GripMMIGraphWindow *window );
+
+// The individual strip charts. See GripMMIGraphs.cpp for the parameters.
+void GraphManipulandumPosition( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphManipulandumPositionComponent( int component, View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphManipulandumRotations( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphAcceleration( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphAccelerationComponent( int component, View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphGripForce( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphLoadForce( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step, bool autoscale );
+void GraphCoP( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step );
+void GraphVisibility( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step );
+void GraphVisibilityDetails( View view, double start_instant, double stop_instant, int start_frame, int stop_frame, int step );
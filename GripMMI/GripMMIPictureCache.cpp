@@ -0,0 +1,460 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The pictures of the DEX screen mirror, read and decoded ahead of time. See GripMMIPictureCache.h.
+
+// The pictures in memory are found by their file name in a hash table and are kept in a list
+//  from the most to the least recently used. Pictures that are being shown are pinned and are
+//  never dropped.
+// The background thread works through the files given by the last call to GripPictureCachePrefetch().
+//  It drops pictures to make room, but not those that it has read for the same call and that
+//  have not been shown yet, so that a task with more pictures than the budget does not push out
+//  its own first pictures. It waits instead until some of them have been shown.
+// When there is nothing that it can do, the thread waits on an event. The event is set when
+//  there are new files to read, when a picture has been shown while the thread waits for room,
+//  and when the cache is closed.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <process.h>
+
+#include "GripMMIPictureCache.h"
+
+#define PICTURE_CACHE_BUCKETS	256
+// Larger pictures are not decoded.
+#define PICTURE_MAX_DIMENSION	16384
+
+typedef struct PictureEntry {
+	GripPicture			picture;			// First, so that a picture gives back its entry.
+	char				*filename;
+	unsigned int		hash;
+	size_t				size;
+	int					pins;
+	long				generation;			// Of the prefetch that read it, or -1.
+	struct PictureEntry	*hashNext;
+	struct PictureEntry	*newer, *older;
+} PictureEntry;
+
+static CRITICAL_SECTION	cacheLock;
+static bool				cacheOpen = false;
+static HANDLE			loaderThread = NULL;
+static HANDLE			loaderWake = NULL;
+static bool				stopLoader = false;
+static size_t			cacheBudget = PICTURE_CACHE_BUDGET;
+static size_t			cacheBytes = 0;
+static PictureEntry		*bucket[PICTURE_CACHE_BUCKETS];
+static PictureEntry		*newest = NULL, *oldest = NULL;
+static GripPictureCacheStats	cacheStats;
+
+// The files still to be read in the background.
+static char				**prefetchFilename = NULL;
+static int				prefetchCount = 0;
+static int				prefetchNext = 0;
+static long				prefetchGeneration = 0;
+// Counts the flushes, so that a file read across a flush is not kept.
+static long				flushes = 0;
+// Whether the budget is full of pictures of the current prefetch that have not been shown, and
+//  how many pictures had been shown then.
+static bool				prefetchBlocked = false;
+static long				prefetchShown = 0;
+static long				blockedShown = 0;
+
+static unsigned int HashPictureFilename( const char *filename ) {
+	unsigned int hash = 2166136261u;
+	for ( const unsigned char *c = (const unsigned char *) filename; *c; c++ ) hash = ( hash ^ *c ) * 16777619u;
+	return( hash );
+}
+
+/// Reading and decoding.
+
+static unsigned int LittleEndian16( const unsigned char *bytes ) {
+	return( bytes[0] | ( bytes[1] << 8 ) );
+}
+static unsigned int LittleEndian32( const unsigned char *bytes ) {
+	return( bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 ) | ( (unsigned int) bytes[3] << 24 ) );
+}
+
+// Decode an uncompressed BMP file with 1, 4, 8, 24 or 32 bits per pixel into 32-bit pixels.
+// Returns false for anything else, which is then left for the caller to decode.
+static bool DecodeBitmap( GripPicture *picture, const unsigned char *bytes, size_t size ) {
+
+	if ( size < 54 || bytes[0] != 'B' || bytes[1] != 'M' ) return( false );
+	unsigned int offset = LittleEndian32( bytes + 10 );
+	unsigned int header = LittleEndian32( bytes + 14 );
+	if ( header < 40 || 14 + (size_t) header > size ) return( false );
+	int width = (int) LittleEndian32( bytes + 18 );
+	int height = (int) LittleEndian32( bytes + 22 );
+	unsigned int bits = LittleEndian16( bytes + 28 );
+	unsigned int compression = LittleEndian32( bytes + 30 );
+	unsigned int colors = LittleEndian32( bytes + 46 );
+
+	// A negative height means that the rows are stored from the top down.
+	bool top_down = ( height < 0 );
+	if ( top_down ) height = -height;
+	if ( width <= 0 || height <= 0 || width > PICTURE_MAX_DIMENSION || height > PICTURE_MAX_DIMENSION ) return( false );
+	if ( compression != 0 ) return( false );
+	if ( bits != 1 && bits != 4 && bits != 8 && bits != 24 && bits != 32 ) return( false );
+
+	const unsigned char *palette = bytes + 14 + header;
+	if ( bits <= 8 ) {
+		if ( colors == 0 || colors > ( 1u << bits ) ) colors = 1u << bits;
+		if ( (size_t) ( palette - bytes ) + colors * 4 > size ) return( false );
+	}
+	size_t stride = ( ( (size_t) width * bits + 31 ) / 32 ) * 4;
+	if ( offset > size || ( size - offset ) / stride < (size_t) height ) return( false );
+
+	unsigned char *pixels = (unsigned char *) malloc( (size_t) width * height * 4 );
+	if ( !pixels ) return( false );
+	for ( int y = 0; y < height; y++ ) {
+		const unsigned char *row = bytes + offset + stride * ( top_down ? y : height - 1 - y );
+		unsigned char *out = pixels + (size_t) y * width * 4;
+		for ( int x = 0; x < width; x++, out += 4 ) {
+			const unsigned char *color;
+			switch ( bits ) {
+			case 32:
+			case 24:
+				color = row + x * ( bits / 8 );
+				break;
+			default:
+				{
+					// Palette entries are packed from the most significant bits of each byte.
+					int per_byte = 8 / bits;
+					unsigned int index = ( row[x / per_byte] >> ( ( per_byte - 1 - x % per_byte ) * bits ) ) & ( ( 1 << bits ) - 1 );
+					if ( index >= colors ) index = 0;
+					color = palette + index * 4;
+				}
+				break;
+			}
+			out[0] = color[0];
+			out[1] = color[1];
+			out[2] = color[2];
+			out[3] = 0xFF;
+		}
+	}
+	picture->width = width;
+	picture->height = height;
+	picture->pixels = pixels;
+	return( true );
+
+}
+
+// Read a file into a new entry. Returns NULL if the file cannot be read.
+// This is done without holding the lock.
+static PictureEntry *ReadPicture( const char *filename ) {
+
+	FILE *fp = fopen( filename, "rb" );
+	if ( !fp ) return( NULL );
+	fseek( fp, 0, SEEK_END );
+	long length = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+	PictureEntry *entry = (PictureEntry *) calloc( 1, sizeof( PictureEntry ) );
+	unsigned char *bytes = ( length > 0 ? (unsigned char *) malloc( length ) : NULL );
+	char *name = _strdup( filename );
+	if ( !entry || !bytes || !name || fread( bytes, 1, length, fp ) != (size_t) length ) {
+		fclose( fp );
+		free( entry );
+		free( bytes );
+		free( name );
+		return( NULL );
+	}
+	fclose( fp );
+
+	entry->filename = name;
+	entry->hash = HashPictureFilename( filename );
+	entry->generation = -1;
+	if ( DecodeBitmap( &entry->picture, bytes, length ) ) {
+		free( bytes );
+		entry->size = (size_t) entry->picture.width * entry->picture.height * 4;
+	}
+	else {
+		entry->picture.bytes = bytes;
+		entry->picture.nBytes = length;
+		entry->size = length;
+	}
+	return( entry );
+
+}
+
+static void FreePicture( PictureEntry *entry ) {
+	free( entry->picture.pixels );
+	free( entry->picture.bytes );
+	free( entry->filename );
+	free( entry );
+}
+
+/// The table and the list. The lock is held for all of these.
+
+static PictureEntry *FindPicture( const char *filename, unsigned int hash ) {
+	for ( PictureEntry *entry = bucket[hash % PICTURE_CACHE_BUCKETS]; entry; entry = entry->hashNext ) {
+		if ( entry->hash == hash && !strcmp( entry->filename, filename ) ) return( entry );
+	}
+	return( NULL );
+}
+
+static void Unlink( PictureEntry *entry ) {
+	if ( entry->newer ) entry->newer->older = entry->older;
+	else newest = entry->older;
+	if ( entry->older ) entry->older->newer = entry->newer;
+	else oldest = entry->newer;
+	entry->newer = entry->older = NULL;
+}
+
+static void MakeNewest( PictureEntry *entry ) {
+	entry->older = newest;
+	entry->newer = NULL;
+	if ( newest ) newest->newer = entry;
+	else oldest = entry;
+	newest = entry;
+}
+
+static void InsertPicture( PictureEntry *entry ) {
+	PictureEntry **head = &bucket[entry->hash % PICTURE_CACHE_BUCKETS];
+	entry->hashNext = *head;
+	*head = entry;
+	MakeNewest( entry );
+	cacheBytes += entry->size;
+	cacheStats.pictures++;
+}
+
+static void DropPicture( PictureEntry *entry ) {
+	PictureEntry **link = &bucket[entry->hash % PICTURE_CACHE_BUCKETS];
+	while ( *link != entry ) link = &( *link )->hashNext;
+	*link = entry->hashNext;
+	Unlink( entry );
+	cacheBytes -= entry->size;
+	cacheStats.pictures--;
+	cacheStats.evicted++;
+	FreePicture( entry );
+}
+
+// Drop the least recently used pictures until there is room for the given size.
+// Pictures of the given prefetch generation are kept. Returns false if there is not enough room.
+static bool MakeRoom( size_t size, long keep ) {
+	PictureEntry *entry = oldest;
+	while ( cacheBytes + size > cacheBudget && entry ) {
+		PictureEntry *newer = entry->newer;
+		if ( entry->pins == 0 && !( keep >= 0 && entry->generation == keep ) ) DropPicture( entry );
+		entry = newer;
+	}
+	return( cacheBytes + size <= cacheBudget );
+}
+
+/// The background thread.
+
+static unsigned __stdcall PictureLoaderThread( void *parameter ) {
+
+	UNREFERENCED_PARAMETER( parameter );
+	EnterCriticalSection( &cacheLock );
+	while ( !stopLoader ) {
+
+		// Wait for files to read, or for room to read the next one.
+		// The event stays set if it is set before we wait, so no wake up is lost.
+		if ( prefetchNext >= prefetchCount || ( prefetchBlocked && prefetchShown == blockedShown ) ) {
+			LeaveCriticalSection( &cacheLock );
+			WaitForSingleObject( loaderWake, INFINITE );
+			EnterCriticalSection( &cacheLock );
+			continue;
+		}
+		prefetchBlocked = false;
+		long generation = prefetchGeneration;
+		long flushed = flushes;
+		PictureEntry *cached = FindPicture( prefetchFilename[prefetchNext], HashPictureFilename( prefetchFilename[prefetchNext] ) );
+		if ( cached ) {
+			cached->generation = generation;
+			free( prefetchFilename[prefetchNext] );
+			prefetchFilename[prefetchNext++] = NULL;
+			continue;
+		}
+		char *filename = _strdup( prefetchFilename[prefetchNext] );
+		LeaveCriticalSection( &cacheLock );
+
+		PictureEntry *entry = ( filename ? ReadPicture( filename ) : NULL );
+		free( filename );
+
+		EnterCriticalSection( &cacheLock );
+		// Prefetch() or Flush() may have been called in the meantime.
+		if ( generation != prefetchGeneration || flushed != flushes ) {
+			if ( entry ) FreePicture( entry );
+			continue;
+		}
+		if ( !entry || FindPicture( entry->filename, entry->hash ) ) {
+			if ( entry ) FreePicture( entry );
+		}
+		else {
+			entry->generation = generation;
+			if ( MakeRoom( entry->size, generation ) ) {
+				InsertPicture( entry );
+				cacheStats.prefetched++;
+			}
+			else {
+				// The budget is full of pictures of this task that have not been shown yet.
+				// Try again once one of them has been shown.
+				FreePicture( entry );
+				prefetchBlocked = true;
+				blockedShown = prefetchShown;
+				continue;
+			}
+		}
+		free( prefetchFilename[prefetchNext] );
+		prefetchFilename[prefetchNext++] = NULL;
+
+	}
+	LeaveCriticalSection( &cacheLock );
+	return( 0 );
+
+}
+
+static void ClearPrefetch( void ) {
+	for ( int i = 0; i < prefetchCount; i++ ) free( prefetchFilename[i] );
+	free( prefetchFilename );
+	prefetchFilename = NULL;
+	prefetchCount = prefetchNext = 0;
+	prefetchBlocked = false;
+}
+
+/// The interface.
+
+void GripPictureCacheOpen( size_t budget ) {
+	if ( cacheOpen ) return;
+	cacheOpen = true;
+	InitializeCriticalSection( &cacheLock );
+	cacheBudget = budget;
+	memset( &cacheStats, 0, sizeof( cacheStats ) );
+	stopLoader = false;
+	// Without the thread, pictures are still read when they are asked for.
+	loaderWake = CreateEvent( NULL, FALSE, FALSE, NULL );
+	if ( loaderWake ) loaderThread = (HANDLE) _beginthreadex( NULL, 0, PictureLoaderThread, NULL, 0, NULL );
+}
+
+void GripPictureCacheClose( void ) {
+	if ( !cacheOpen ) return;
+	EnterCriticalSection( &cacheLock );
+	stopLoader = true;
+	LeaveCriticalSection( &cacheLock );
+	if ( loaderThread ) {
+		SetEvent( loaderWake );
+		WaitForSingleObject( loaderThread, INFINITE );
+		CloseHandle( loaderThread );
+		loaderThread = NULL;
+	}
+	if ( loaderWake ) {
+		CloseHandle( loaderWake );
+		loaderWake = NULL;
+	}
+	ClearPrefetch();
+	while ( oldest ) DropPicture( oldest );
+	DeleteCriticalSection( &cacheLock );
+	cacheOpen = false;
+}
+
+void GripPictureCachePrefetch( const char *filename[], int count ) {
+
+	// Copy the names before taking the lock.
+	char **copy = (char **) calloc( count > 0 ? count : 1, sizeof( char * ) );
+	int copied = 0;
+	for ( int i = 0; copy && i < count; i++ ) if ( ( copy[copied] = _strdup( filename[i] ) ) ) copied++;
+
+	EnterCriticalSection( &cacheLock );
+	ClearPrefetch();
+	prefetchFilename = copy;
+	prefetchCount = copied;
+	prefetchGeneration++;
+	LeaveCriticalSection( &cacheLock );
+	if ( loaderWake ) SetEvent( loaderWake );
+
+}
+
+void GripPictureCacheFlush( void ) {
+	EnterCriticalSection( &cacheLock );
+	ClearPrefetch();
+	prefetchGeneration++;
+	flushes++;
+	PictureEntry *entry = oldest;
+	while ( entry ) {
+		PictureEntry *newer = entry->newer;
+		if ( entry->pins == 0 ) DropPicture( entry );
+		entry = newer;
+	}
+	LeaveCriticalSection( &cacheLock );
+}
+
+// A picture that has been shown is dropped in its turn like any other, once it is given back.
+static void ShownPicture( PictureEntry *entry ) {
+	entry->pins++;
+	entry->generation = -1;
+}
+
+const GripPicture *GripPictureCacheGet( const char *filename ) {
+
+	unsigned int hash = HashPictureFilename( filename );
+
+	EnterCriticalSection( &cacheLock );
+	PictureEntry *entry = FindPicture( filename, hash );
+	if ( entry ) {
+		Unlink( entry );
+		MakeNewest( entry );
+		ShownPicture( entry );
+		cacheStats.hits++;
+		LeaveCriticalSection( &cacheLock );
+		return( &entry->picture );
+	}
+	LeaveCriticalSection( &cacheLock );
+
+	// Not there yet, so read it now.
+	PictureEntry *read = ReadPicture( filename );
+	if ( !read ) return( NULL );
+
+	EnterCriticalSection( &cacheLock );
+	cacheStats.misses++;
+	// The background thread may have read it in the meantime.
+	entry = FindPicture( filename, hash );
+	if ( entry ) {
+		FreePicture( read );
+		Unlink( entry );
+		MakeNewest( entry );
+	}
+	else {
+		// A picture that is to be shown is kept even if it does not fit.
+		MakeRoom( read->size, -1 );
+		InsertPicture( read );
+		entry = read;
+	}
+	ShownPicture( entry );
+	LeaveCriticalSection( &cacheLock );
+	return( &entry->picture );
+
+}
+
+void GripPictureCacheRelease( const GripPicture *picture ) {
+	if ( !picture ) return;
+	EnterCriticalSection( &cacheLock );
+	( (PictureEntry *) picture )->pins--;
+	MakeRoom( 0, -1 );
+	// The picture can now be dropped, so the background thread can read on if it was waiting for room.
+	prefetchShown++;
+	bool wake = prefetchBlocked;
+	LeaveCriticalSection( &cacheLock );
+	if ( wake && loaderWake ) SetEvent( loaderWake );
+}
+
+void GripPictureCacheGetStats( GripPictureCacheStats *stats ) {
+	if ( !cacheOpen ) {
+		memset( stats, 0, sizeof( *stats ) );
+		return;
+	}
+	EnterCriticalSection( &cacheLock );
+	*stats = cacheStats;
+	stats->bytes = cacheBytes;
+	LeaveCriticalSection( &cacheLock );
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The pictures of the DEX screen mirror, read and decoded ahead of time.
+
+// GoToSpecifiedStep() used to load the picture of each step from disk as the step was shown.
+// When a task is selected, the pictures of its steps are now read and decoded on a background
+//  thread, in the order of the steps, and kept in memory up to a budget. The pictures that
+//  have not been shown for the longest time are dropped first. A picture that is asked for
+//  before it has been read is read there and then.
+// BMP files are decoded here into 32-bit pixels. Other files are kept as they are read, for
+//  the caller to decode from memory.
+
+#include <stddef.h>
+
+// How much memory the pictures can take, by default.
+#define PICTURE_CACHE_BUDGET	( 64 * 1024 * 1024 )
+
+typedef struct {
+	// The decoded picture: width * height pixels, blue, green, red and an unused byte,
+	//  from the top row down. Width and height are 0 if the file was not decoded.
+	int				width;
+	int				height;
+	unsigned char	*pixels;
+	// The contents of a file that was not decoded.
+	unsigned char	*bytes;
+	size_t			nBytes;
+} GripPicture;
+
+typedef struct {
+	long	hits;			// Asked for and already in memory.
+	long	misses;			// Read when asked for.
+	long	prefetched;		// Read by the background thread.
+	long	evicted;
+	long	pictures;		// In memory now.
+	size_t	bytes;
+} GripPictureCacheStats;
+
+// Start the background thread. The budget is in bytes.
+// The other functions are to be called only while the cache is open.
+void GripPictureCacheOpen( size_t budget );
+// Stop the thread and free all the pictures.
+void GripPictureCacheClose( void );
+
+// Read the given files in the background, in that order, replacing the files still to be read
+//  from a previous call. Files are read until the budget is filled.
+void GripPictureCachePrefetch( const char *filename[], int count );
+
+// Forget the pictures that are not being shown and the files still to be read, as when the
+//  scripts have changed, since their pictures may have changed with them.
+void GripPictureCacheFlush( void );
+
+// The picture of a file, or NULL if it cannot be read. The picture stays in memory until it is
+//  given back with GripPictureCacheRelease().
+const GripPicture *GripPictureCacheGet( const char *filename );
+void GripPictureCacheRelease( const GripPicture *picture );
+
+// What the cache has done since it was opened. All 0 if it is not open.
+void GripPictureCacheGetStats( GripPictureCacheStats *stats );
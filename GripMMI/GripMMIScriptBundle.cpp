@@ -0,0 +1,533 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The GRIP scripts, compiled into a single file. See GripMMIScriptBundle.h.
+
+// A bundle is a header followed by the records of the nodes, the items, the steps, the integers
+//  of the menus and ID indexes, the errors, and the strings. Records refer to strings by their
+//  offset in the string section and to other records by their index. The header holds a checksum
+//  of all that follows it, and every index and offset is checked when the bundle is loaded.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <io.h>
+#include <sys\types.h>
+#include <sys\stat.h>
+
+#include "..\Useful\fMessageBox.h"
+
+#include "GripMMIScriptTree.h"
+#include "GripMMIScriptBundle.h"
+
+typedef struct {
+	char			magic[8];
+	int				version;
+	int				size;			// Of the whole file.
+	unsigned int	checksum;		// Of everything after the header.
+	int				nNodes, nodes;	// Count and offset of each section.
+	int				nItems, items;
+	int				nSteps, steps;
+	int				nInts, ints;
+	int				nErrors, errors;
+	int				stringsSize, strings;
+	int				errorText;		// The errors found when compiling, as a string, or -1.
+	int				fatal;
+} BundleHeader;
+
+// Indexes of items and steps are into the whole item or step section, those of the menus into the integers.
+typedef struct {
+	int		filename;
+	int		type;
+	int		missing;
+	int		nItems, item;
+	int		nSteps, step;	// A task has nSteps + 1 records, the last being the end of the script.
+	int		nEntries, entry, child;
+	int		nIdSlots, idSlot;
+} BundleNode;
+
+typedef struct {
+	int		id;
+	int		label;
+	int		filename;
+	int		line;
+	int		ignore;
+} BundleItem;
+
+typedef struct {
+	int		text;
+	int		message;
+	int		picture;
+	int		stepID;
+	int		type;			// 0 status, 1 query, 2 alert.
+	int		comment;
+} BundleStep;
+
+// An error found when compiling. Those of the tree come first, then those of each file.
+typedef struct {
+	int		filename;		// -1 if it is not about a given file.
+	int		line;
+	int		message;
+} BundleError;
+
+static void *BundleAllocate( size_t size ) {
+	void *memory = calloc( 1, size ? size : 1 );
+	if ( !memory ) {
+		fMessageBox( MB_OK | MB_ICONERROR, "GRIP Script Crawler", "Error allocating memory for the script bundle." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+static unsigned int BundleChecksum( const unsigned char *bytes, size_t length ) {
+	unsigned int hash = 2166136261u;
+	for ( size_t i = 0; i < length; i++ ) hash = ( hash ^ bytes[i] ) * 16777619u;
+	return( hash );
+}
+
+static bool StatBundle( const char *filename, time_t *mtime, long long *size ) {
+	struct _stat64 file_stat;
+	if ( _stat64( filename, &file_stat ) ) return( false );
+	*mtime = file_stat.st_mtime;
+	*size = (long long) file_stat.st_size;
+	return( true );
+}
+
+///
+/// Writing.
+///
+
+// A buffer that grows as things are added to it.
+typedef struct {
+	char	*data;
+	int		length;
+	int		allocated;
+} BundleBuffer;
+
+static int BundleAppend( BundleBuffer *buffer, const void *data, int length ) {
+	int offset = buffer->length;
+	if ( buffer->length + length > buffer->allocated ) {
+		int allocated = ( buffer->allocated ? buffer->allocated : 4096 );
+		while ( allocated < buffer->length + length ) allocated *= 2;
+		char *bigger = (char *) BundleAllocate( allocated );
+		if ( buffer->length ) memcpy( bigger, buffer->data, buffer->length );
+		free( buffer->data );
+		buffer->data = bigger;
+		buffer->allocated = allocated;
+	}
+	memcpy( buffer->data + buffer->length, data, length );
+	buffer->length += length;
+	return( offset );
+}
+
+// The strings, each stored once. The table holds offsets into the buffer and is kept at most half full.
+typedef struct {
+	BundleBuffer	buffer;
+	int				*slot;
+	int				nSlots;
+	int				nStrings;
+} BundleStrings;
+
+static unsigned int HashString( const char *string ) {
+	return( BundleChecksum( (const unsigned char *) string, strlen( string ) ) );
+}
+
+static int InternString( BundleStrings *strings, const char *string ) {
+
+	if ( !string ) string = "";
+	if ( 2 * ( strings->nStrings + 1 ) > strings->nSlots ) {
+		int slots = ( strings->nSlots ? 2 * strings->nSlots : 1024 );
+		int *slot = (int *) BundleAllocate( slots * sizeof( int ) );
+		for ( int i = 0; i < slots; i++ ) slot[i] = -1;
+		for ( int i = 0; i < strings->nSlots; i++ ) {
+			if ( strings->slot[i] < 0 ) continue;
+			unsigned int s = HashString( strings->buffer.data + strings->slot[i] ) & ( slots - 1 );
+			while ( slot[s] >= 0 ) s = ( s + 1 ) & ( slots - 1 );
+			slot[s] = strings->slot[i];
+		}
+		free( strings->slot );
+		strings->slot = slot;
+		strings->nSlots = slots;
+	}
+	unsigned int s = HashString( string ) & ( strings->nSlots - 1 );
+	for ( ; strings->slot[s] >= 0; s = ( s + 1 ) & ( strings->nSlots - 1 ) ) {
+		if ( !strcmp( strings->buffer.data + strings->slot[s], string ) ) return( strings->slot[s] );
+	}
+	strings->slot[s] = BundleAppend( &strings->buffer, string, (int) strlen( string ) + 1 );
+	strings->nStrings++;
+	return( strings->slot[s] );
+
+}
+
+// File names relative to the directory of the subject file, so that the bundle can be moved.
+static const char *RelativeName( const char *filename, const char *directory, size_t length ) {
+	if ( !strncmp( filename, directory, length ) ) return( filename + length );
+	return( filename );
+}
+
+static int StepType( const char *type ) {
+	if ( type == type_query ) return( 1 );
+	if ( type == type_alert ) return( 2 );
+	return( 0 );
+}
+
+bool WriteGripScriptBundle( GripScriptTree *tree, const char *filename ) {
+
+	BundleHeader header;
+	BundleBuffer nodes = {}, items = {}, steps = {}, ints = {}, errors = {};
+	BundleStrings strings = {};
+
+	const char *subject_file = tree->node[0].file->filename;
+	size_t directory;
+	for ( directory = strlen( subject_file ); directory > 0; directory-- ) {
+		if ( subject_file[directory - 1] == '\\' || subject_file[directory - 1] == '/' ) break;
+	}
+
+	// Offset 0 is the empty string.
+	InternString( &strings, "" );
+
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+
+		GripScriptNode *node = &tree->node[n];
+		GripScriptFile *file = node->file;
+		BundleNode record = {};
+
+		record.filename = InternString( &strings, RelativeName( file->filename, subject_file, directory ) );
+		record.type = file->type;
+		record.missing = file->missing;
+		record.nItems = file->nItems;
+		record.item = items.length / (int) sizeof( BundleItem );
+		for ( int i = 0; i < file->nItems; i++ ) {
+			BundleItem item;
+			item.id = file->item[i].id;
+			item.label = InternString( &strings, file->item[i].label );
+			item.filename = InternString( &strings, RelativeName( file->item[i].filename, subject_file, directory ) );
+			item.line = file->item[i].line;
+			item.ignore = file->item[i].ignore;
+			BundleAppend( &items, &item, sizeof( item ) );
+		}
+		record.nSteps = file->nSteps;
+		record.step = steps.length / (int) sizeof( BundleStep );
+		for ( int i = 0; file->step && i <= file->nSteps; i++ ) {
+			BundleStep step;
+			step.text = InternString( &strings, file->step[i].text );
+			step.message = InternString( &strings, file->step[i].message );
+			step.picture = InternString( &strings, file->step[i].picture );
+			step.stepID = file->step[i].stepID;
+			step.type = StepType( file->step[i].type );
+			step.comment = file->step[i].comment;
+			BundleAppend( &steps, &step, sizeof( step ) );
+		}
+		record.nEntries = node->nEntries;
+		record.entry = ints.length / (int) sizeof( int );
+		if ( node->nEntries ) BundleAppend( &ints, node->entry, node->nEntries * sizeof( int ) );
+		record.child = ints.length / (int) sizeof( int );
+		if ( node->nEntries ) BundleAppend( &ints, node->child, node->nEntries * sizeof( int ) );
+		record.nIdSlots = node->nIdSlots;
+		record.idSlot = ints.length / (int) sizeof( int );
+		if ( node->nIdSlots ) BundleAppend( &ints, node->idSlot, node->nIdSlots * sizeof( int ) );
+		BundleAppend( &nodes, &record, sizeof( record ) );
+
+	}
+
+	for ( int n = -1; n < tree->nNodes; n++ ) {
+		const GripScriptError *error = ( n < 0 ? tree->error : tree->node[n].file->error );
+		int nErrors = ( n < 0 ? tree->nErrors : tree->node[n].file->nErrors );
+		for ( int i = 0; i < nErrors; i++ ) {
+			BundleError record;
+			record.filename = ( error[i].filename ? InternString( &strings, RelativeName( error[i].filename, subject_file, directory ) ) : -1 );
+			record.line = error[i].line;
+			record.message = InternString( &strings, error[i].message );
+			BundleAppend( &errors, &record, sizeof( record ) );
+		}
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	strcpy( header.magic, GRIP_SCRIPT_BUNDLE_MAGIC );
+	header.version = GRIP_SCRIPT_BUNDLE_VERSION;
+	header.errorText = ( tree->errors ? InternString( &strings, tree->errors ) : -1 );
+	header.fatal = tree->fatal;
+	// Keep the records aligned.
+	while ( strings.buffer.length % (int) sizeof( int ) ) BundleAppend( &strings.buffer, "", 1 );
+	header.nNodes = tree->nNodes;
+	header.nodes = (int) sizeof( header );
+	header.nItems = items.length / (int) sizeof( BundleItem );
+	header.items = header.nodes + nodes.length;
+	header.nSteps = steps.length / (int) sizeof( BundleStep );
+	header.steps = header.items + items.length;
+	header.nInts = ints.length / (int) sizeof( int );
+	header.ints = header.steps + steps.length;
+	header.nErrors = errors.length / (int) sizeof( BundleError );
+	header.errors = header.ints + ints.length;
+	header.stringsSize = strings.buffer.length;
+	header.strings = header.errors + errors.length;
+	header.size = header.strings + strings.buffer.length;
+
+	// The checksum goes over the sections in the order that they are written.
+	BundleBuffer body = {};
+	if ( nodes.length ) BundleAppend( &body, nodes.data, nodes.length );
+	if ( items.length ) BundleAppend( &body, items.data, items.length );
+	if ( steps.length ) BundleAppend( &body, steps.data, steps.length );
+	if ( ints.length ) BundleAppend( &body, ints.data, ints.length );
+	if ( errors.length ) BundleAppend( &body, errors.data, errors.length );
+	BundleAppend( &body, strings.buffer.data, strings.buffer.length );
+	header.checksum = BundleChecksum( (const unsigned char *) body.data, body.length );
+
+	bool written = false;
+	FILE *fp = fopen( filename, "wb" );
+	if ( fp ) {
+		written = ( 1 == fwrite( &header, sizeof( header ), 1, fp ) && 1 == fwrite( body.data, body.length, 1, fp ) );
+		if ( fclose( fp ) ) written = false;
+	}
+
+	free( nodes.data );
+	free( items.data );
+	free( steps.data );
+	free( ints.data );
+	free( errors.data );
+	free( body.data );
+	free( strings.buffer.data );
+	free( strings.slot );
+	return( written );
+
+}
+
+///
+/// Loading.
+///
+
+// A section of count records of the given size lies within the file.
+static bool InBundle( const BundleHeader *header, int offset, int count, size_t size ) {
+	return( offset >= (int) sizeof( BundleHeader ) && count >= 0 && offset <= header->size && (size_t) count <= ( header->size - offset ) / size );
+}
+
+// Check every reference of the bundle, so that the tree made of it can be trusted as one from the text files.
+static bool BundleIsSound( const BundleHeader *header, const char *base ) {
+
+	const BundleNode *node = (const BundleNode *) ( base + header->nodes );
+	const BundleItem *item = (const BundleItem *) ( base + header->items );
+	const BundleStep *step = (const BundleStep *) ( base + header->steps );
+	const int *ints = (const int *) ( base + header->ints );
+	const BundleError *error = (const BundleError *) ( base + header->errors );
+	const char *strings = base + header->strings;
+
+	if ( header->nNodes < 1 || !InBundle( header, header->nodes, header->nNodes, sizeof( BundleNode ) )
+		|| !InBundle( header, header->items, header->nItems, sizeof( BundleItem ) )
+		|| !InBundle( header, header->steps, header->nSteps, sizeof( BundleStep ) )
+		|| !InBundle( header, header->ints, header->nInts, sizeof( int ) )
+		|| !InBundle( header, header->errors, header->nErrors, sizeof( BundleError ) )
+		|| !InBundle( header, header->strings, header->stringsSize, 1 )
+		|| header->stringsSize < 1 || strings[header->stringsSize - 1] != 0 ) return( false );
+
+#define STRING_OK( s )	( (s) >= 0 && (s) < header->stringsSize )
+#define RANGE_OK( first, count, total )	( (count) >= 0 && (first) >= 0 && (first) <= (total) && (count) <= (total) - (first) )
+
+	if ( header->errorText != -1 && !STRING_OK( header->errorText ) ) return( false );
+	for ( int i = 0; i < header->nErrors; i++ ) {
+		if ( ( error[i].filename != -1 && !STRING_OK( error[i].filename ) ) || !STRING_OK( error[i].message ) ) return( false );
+	}
+	for ( int n = 0; n < header->nNodes; n++ ) {
+		const BundleNode *nd = &node[n];
+		if ( !STRING_OK( nd->filename ) || nd->type < SCRIPT_SUBJECT_FILE || nd->type > SCRIPT_TASK_FILE ) return( false );
+		if ( !RANGE_OK( nd->item, nd->nItems, header->nItems ) ) return( false );
+		for ( int i = nd->item; i < nd->item + nd->nItems; i++ ) {
+			if ( !STRING_OK( item[i].label ) || !STRING_OK( item[i].filename ) ) return( false );
+		}
+		if ( nd->nSteps && !RANGE_OK( nd->step, nd->nSteps + 1, header->nSteps ) ) return( false );
+		for ( int i = nd->step; nd->nSteps && i <= nd->step + nd->nSteps; i++ ) {
+			if ( !STRING_OK( step[i].text ) || !STRING_OK( step[i].message ) || !STRING_OK( step[i].picture ) ) return( false );
+			if ( step[i].type < 0 || step[i].type > 2 ) return( false );
+		}
+		if ( nd->nEntries > nd->nItems || !RANGE_OK( nd->entry, nd->nEntries, header->nInts ) || !RANGE_OK( nd->child, nd->nEntries, header->nInts ) ) return( false );
+		for ( int i = 0; i < nd->nEntries; i++ ) {
+			if ( ints[nd->entry + i] < 0 || ints[nd->entry + i] >= nd->nItems ) return( false );
+			if ( ints[nd->child + i] < 0 || ints[nd->child + i] >= header->nNodes ) return( false );
+		}
+		// The ID index is searched until an empty slot, so there has to be one.
+		if ( nd->nIdSlots && ( ( nd->nIdSlots & ( nd->nIdSlots - 1 ) ) || nd->nIdSlots <= nd->nEntries ) ) return( false );
+		if ( !RANGE_OK( nd->idSlot, nd->nIdSlots, header->nInts ) ) return( false );
+		for ( int i = 0; i < nd->nIdSlots; i++ ) {
+			if ( ints[nd->idSlot + i] < -1 || ints[nd->idSlot + i] >= nd->nEntries ) return( false );
+		}
+	}
+
+#undef STRING_OK
+#undef RANGE_OK
+
+	return( true );
+
+}
+
+// Map the whole file. The view stays valid after the handles are closed.
+static const char *MapBundle( const char *filename, long long *size ) {
+	HANDLE file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) return( NULL );
+	LARGE_INTEGER file_size;
+	HANDLE mapping = NULL;
+	void *view = NULL;
+	if ( GetFileSizeEx( file, &file_size ) && file_size.QuadPart >= (long long) sizeof( BundleHeader ) && file_size.QuadPart < 0x7fffffff ) {
+		mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+		if ( mapping ) view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	}
+	if ( mapping ) CloseHandle( mapping );
+	CloseHandle( file );
+	*size = file_size.QuadPart;
+	return( (const char *) view );
+}
+
+// What is loaded when the bundle cannot be used, like a tree whose subject file cannot be read.
+static GripScriptTree *UnusableBundle( GripScriptTree *tree, const char *filename, const char *reason ) {
+
+	// Nothing of the view is used.
+	if ( tree->bundle ) UnmapViewOfFile( tree->bundle );
+	tree->bundle = NULL;
+
+	char message[2048];
+	_snprintf( message, sizeof( message ) - 1, "Error reading script bundle %s: %s.", filename, reason );
+	message[sizeof( message ) - 1] = 0;
+	tree->errors = (char *) BundleAllocate( strlen( message ) + 2 );
+	strcpy( tree->errors, message );
+	strcat( tree->errors, "\n" );
+	tree->nErrors = 1;
+	tree->error = (GripScriptError *) BundleAllocate( sizeof( GripScriptError ) );
+	tree->error[0].message = (char *) BundleAllocate( strlen( message ) + 1 );
+	strcpy( tree->error[0].message, message );
+	tree->fatal = true;
+
+	tree->nNodes = 1;
+	tree->node = (GripScriptNode *) BundleAllocate( sizeof( GripScriptNode ) );
+	GripScriptFile *file = tree->node[0].file = (GripScriptFile *) BundleAllocate( sizeof( GripScriptFile ) );
+	file->filename = (char *) BundleAllocate( strlen( filename ) + 1 );
+	strcpy( file->filename, filename );
+	file->type = SCRIPT_SUBJECT_FILE;
+	file->missing = true;
+	return( tree );
+
+}
+
+GripScriptTree *LoadGripScriptBundle( const char *filename ) {
+
+	LARGE_INTEGER frequency, start, finish;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	GripScriptTree *tree = (GripScriptTree *) BundleAllocate( sizeof( GripScriptTree ) );
+	tree->bundleFilename = (char *) BundleAllocate( strlen( filename ) + 1 );
+	strcpy( tree->bundleFilename, filename );
+	StatBundle( filename, &tree->bundleTime, &tree->bundleSize );
+
+	long long size;
+	const char *base = MapBundle( filename, &size );
+	if ( !base ) return( UnusableBundle( tree, filename, "cannot map the file" ) );
+	tree->bundle = base;
+
+	const BundleHeader *header = (const BundleHeader *) base;
+	if ( strncmp( header->magic, GRIP_SCRIPT_BUNDLE_MAGIC, sizeof( header->magic ) ) ) return( UnusableBundle( tree, filename, "not a script bundle" ) );
+	if ( header->version != GRIP_SCRIPT_BUNDLE_VERSION ) return( UnusableBundle( tree, filename, "wrong version" ) );
+	if ( header->size != size ) return( UnusableBundle( tree, filename, "wrong size" ) );
+	if ( header->checksum != BundleChecksum( (const unsigned char *) base + sizeof( BundleHeader ), header->size - sizeof( BundleHeader ) ) ) return( UnusableBundle( tree, filename, "wrong checksum" ) );
+	if ( !BundleIsSound( header, base ) ) return( UnusableBundle( tree, filename, "inconsistent contents" ) );
+
+	const BundleNode *node = (const BundleNode *) ( base + header->nodes );
+	const BundleItem *item = (const BundleItem *) ( base + header->items );
+	const BundleStep *step = (const BundleStep *) ( base + header->steps );
+	const int *ints = (const int *) ( base + header->ints );
+	const char *strings = base + header->strings;
+	const char *types[] = { type_status, type_query, type_alert };
+
+	tree->nNodes = header->nNodes;
+	tree->node = (GripScriptNode *) BundleAllocate( tree->nNodes * sizeof( GripScriptNode ) );
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		const BundleNode *nd = &node[n];
+		GripScriptNode *tn = &tree->node[n];
+		GripScriptFile *file = tn->file = (GripScriptFile *) BundleAllocate( sizeof( GripScriptFile ) );
+		// The file names are not copied. ReleaseGripScriptBundle() clears them before the files are freed.
+		file->filename = (char *) strings + nd->filename;
+		file->type = (GripScriptFileType) nd->type;
+		file->missing = ( nd->missing != 0 );
+		file->nItems = nd->nItems;
+		if ( nd->nItems ) file->item = (GripScriptItem *) BundleAllocate( nd->nItems * sizeof( GripScriptItem ) );
+		for ( int i = 0; i < nd->nItems; i++ ) {
+			const BundleItem *bi = &item[nd->item + i];
+			file->item[i].id = bi->id;
+			file->item[i].label = strings + bi->label;
+			file->item[i].filename = strings + bi->filename;
+			file->item[i].line = bi->line;
+			file->item[i].ignore = ( bi->ignore != 0 );
+		}
+		file->nSteps = nd->nSteps;
+		if ( nd->nSteps ) file->step = (GripScriptStep *) BundleAllocate( ( nd->nSteps + 1 ) * sizeof( GripScriptStep ) );
+		for ( int i = 0; nd->nSteps && i <= nd->nSteps; i++ ) {
+			const BundleStep *bs = &step[nd->step + i];
+			file->step[i].text = strings + bs->text;
+			file->step[i].message = strings + bs->message;
+			file->step[i].picture = strings + bs->picture;
+			file->step[i].type = types[bs->type];
+			file->step[i].stepID = bs->stepID;
+			file->step[i].comment = ( bs->comment != 0 );
+		}
+		tn->nEntries = nd->nEntries;
+		if ( nd->nEntries ) {
+			tn->entry = (int *) BundleAllocate( nd->nEntries * sizeof( int ) );
+			memcpy( tn->entry, ints + nd->entry, nd->nEntries * sizeof( int ) );
+			tn->child = (int *) BundleAllocate( nd->nEntries * sizeof( int ) );
+			memcpy( tn->child, ints + nd->child, nd->nEntries * sizeof( int ) );
+		}
+		tn->nIdSlots = nd->nIdSlots;
+		if ( nd->nIdSlots ) {
+			tn->idSlot = (int *) BundleAllocate( nd->nIdSlots * sizeof( int ) );
+			memcpy( tn->idSlot, ints + nd->idSlot, nd->nIdSlots * sizeof( int ) );
+		}
+	}
+
+	// The errors that were found when the bundle was compiled, all with the tree.
+	// The file names are not copied, as for the files.
+	const BundleError *error = (const BundleError *) ( base + header->errors );
+	tree->nErrors = header->nErrors;
+	if ( header->nErrors ) tree->error = (GripScriptError *) BundleAllocate( header->nErrors * sizeof( GripScriptError ) );
+	for ( int i = 0; i < header->nErrors; i++ ) {
+		tree->error[i].filename = ( error[i].filename >= 0 ? strings + error[i].filename : NULL );
+		tree->error[i].line = error[i].line;
+		tree->error[i].message = (char *) BundleAllocate( strlen( strings + error[i].message ) + 1 );
+		strcpy( tree->error[i].message, strings + error[i].message );
+	}
+	if ( header->errorText >= 0 ) {
+		tree->errors = (char *) BundleAllocate( strlen( strings + header->errorText ) + 1 );
+		strcpy( tree->errors, strings + header->errorText );
+	}
+	tree->fatal = ( header->fatal != 0 );
+
+	QueryPerformanceCounter( &finish );
+	tree->seconds = (double) ( finish.QuadPart - start.QuadPart ) / (double) frequency.QuadPart;
+	return( tree );
+
+}
+
+void ReleaseGripScriptBundle( GripScriptTree *tree ) {
+	// Of what is freed with the tree, only the file names point into the view.
+	if ( tree->bundle ) {
+		for ( int n = 0; n < tree->nNodes; n++ ) tree->node[n].file->filename = NULL;
+		UnmapViewOfFile( tree->bundle );
+		tree->bundle = NULL;
+	}
+	free( tree->bundleFilename );
+	tree->bundleFilename = NULL;
+}
+
+bool GripScriptBundleChanged( GripScriptTree *tree ) {
+	time_t mtime;
+	long long size;
+	// If the bundle has gone, the text files are to be loaded again.
+	if ( !StatBundle( tree->bundleFilename, &mtime, &size ) ) return( true );
+	return( mtime != tree->bundleTime || size != tree->bundleSize );
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The GRIP scripts, compiled into a single file.
+
+// GripScriptCompiler parses a script directory with LoadGripScriptTree() and writes the tree into
+//  a bundle: one file that holds each distinct string once, the steps with their type already
+//  decided, the menus and the ID indexes of GripMMIScriptTree.h. If a bundle is found in the
+//  script directory, GripMMI maps it into memory instead of reading the text files.
+// The strings of a tree loaded from a bundle point into the mapped file. The rest of the tree
+//  is built from the fixed-size records of the bundle, so it is used as any other tree.
+// The bundle is written in the byte order of the machine that compiles it, which is that of
+//  the consoles (little-endian).
+
+#include "GripMMIScriptTree.h"
+
+// The name of the bundle in the script directory.
+#define GRIP_SCRIPT_BUNDLE		"users.gsb"
+
+#define GRIP_SCRIPT_BUNDLE_MAGIC	"GRIPSCB"
+#define GRIP_SCRIPT_BUNDLE_VERSION	2
+
+// Write a tree that was loaded from the text files. Returns false if the file could not be written.
+// The file names are written relative to the directory of the subject file.
+bool WriteGripScriptBundle( GripScriptTree *tree, const char *filename );
+
+// Map a bundle and make a tree of it. If the bundle cannot be read or does not check out, the
+//  tree has only a missing subject file and a fatal error, as when users.dex cannot be read.
+GripScriptTree *LoadGripScriptBundle( const char *filename );
+
+// Called by FreeGripScriptTree() and GripScriptTreeChanged() for a tree from a bundle.
+void ReleaseGripScriptBundle( GripScriptTree *tree );
+bool GripScriptBundleChanged( GripScriptTree *tree );
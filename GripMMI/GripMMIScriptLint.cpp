@@ -0,0 +1,348 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Checks of the GRIP scripts, all gathered into one report. See GripMMIScriptLint.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <io.h>
+#include <process.h>
+#include <sys\types.h>
+#include <sys\stat.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\ParseCommaDelimitedLine.h"
+
+#include "GripMMIScriptTree.h"
+#include "GripMMIScriptLint.h"
+
+// Number of threads that check the files and look for the pictures.
+#define LINT_THREADS	8
+
+static const char *checkName[] = { "parse", "parameters", "picture", "duplicate ID" };
+static const char *severityName[] = { "error", "warning" };
+
+// A picture and where it is first shown.
+typedef struct {
+	const char	*name;
+	int			node;
+	int			line;
+	int			uses;
+	bool		found;
+} LintPicture;
+
+// What was found in one file, or for the tree as a whole.
+typedef struct {
+	int				nFindings;
+	int				maxFindings;
+	GripLintFinding	*finding;
+	int				nPictures;
+	int				maxPictures;
+	LintPicture		*picture;
+} LintList;
+
+typedef struct {
+	GripScriptTree	*tree;
+	LintList		*list;			// One per node.
+	const char		*prefix;
+	LintPicture		*picture;		// The distinct pictures of the whole tree.
+	int				nPictures;
+	volatile LONG	next;
+} LintWork;
+
+static void *LintAllocate( void *memory, size_t size ) {
+	memory = realloc( memory, size ? size : 1 );
+	if ( !memory ) {
+		fMessageBox( MB_OK | MB_ICONERROR, "GRIP Script Crawler", "Error allocating memory for the script report." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+static char *LintString( const char *string, size_t length ) {
+	char *copy = (char *) LintAllocate( NULL, length + 1 );
+	memcpy( copy, string, length );
+	copy[length] = 0;
+	return( copy );
+}
+
+static void AddFinding( LintList *list, GripLintSeverity severity, GripLintCheck check, const char *filename, int line, const char *format, ... ) {
+
+	char message[1024];
+	va_list args;
+
+	va_start( args, format );
+	_vsnprintf( message, sizeof( message ) - 1, format, args );
+	va_end( args );
+	message[sizeof( message ) - 1] = 0;
+
+	if ( list->nFindings >= list->maxFindings ) {
+		list->maxFindings = ( list->maxFindings ? 2 * list->maxFindings : 16 );
+		list->finding = (GripLintFinding *) LintAllocate( list->finding, list->maxFindings * sizeof( GripLintFinding ) );
+	}
+	GripLintFinding *finding = &list->finding[list->nFindings];
+	finding->sequence = list->nFindings++;
+	finding->severity = severity;
+	finding->check = check;
+	finding->filename = ( filename ? LintString( filename, strlen( filename ) ) : NULL );
+	finding->line = line;
+	finding->message = LintString( message, strlen( message ) );
+
+}
+
+// The errors found when loading the tree.
+static void AddParseErrors( LintList *list, const GripScriptError *error, int nErrors ) {
+	for ( int i = 0; i < nErrors; i++ ) AddFinding( list, LINT_ERROR, LINT_PARSE, error[i].filename, error[i].line, "%s", error[i].message );
+}
+
+// Note a picture shown by a task, once per picture and file.
+static void AddPicture( LintList *list, const char *name, int node, int line ) {
+	if ( !*name ) return;
+	// Most lines show the same picture as the line before.
+	for ( int i = list->nPictures - 1; i >= 0; i-- ) {
+		if ( !strcmp( list->picture[i].name, name ) ) {
+			list->picture[i].uses++;
+			return;
+		}
+	}
+	if ( list->nPictures >= list->maxPictures ) {
+		list->maxPictures = ( list->maxPictures ? 2 * list->maxPictures : 16 );
+		list->picture = (LintPicture *) LintAllocate( list->picture, list->maxPictures * sizeof( LintPicture ) );
+	}
+	LintPicture *picture = &list->picture[list->nPictures++];
+	picture->name = name;
+	picture->node = node;
+	picture->line = line;
+	picture->uses = 1;
+	picture->found = false;
+}
+
+// The number of fields that a command needs for what the crawler shows, or 0 if it does not matter.
+static int RequiredFields( char *token[MAX_TOKENS], int tokens ) {
+	const GripScriptAlert *alert = GripScriptFindAlert( token[0] );
+	if ( alert ) return( alert->message < 0 ? 0 : 1 + ( alert->message > alert->picture ? alert->message : alert->picture ) );
+	if ( !strcmp( token[0], "CMD_WAIT_SUBJ_READY" ) ) return( 3 );
+	if ( !strcmp( token[0], "CMD_SET_PICTURE" ) ) return( 2 );
+	// A user message (see ParseScriptSteps()) needs the message.
+	if ( !strcmp( token[0], "CMD_LOG_MESSAGE" ) && tokens > 1 ) {
+		int value = 0;
+		if ( !strcmp( token[1], "usermsg" ) || ( 1 == sscanf( token[1], "%d", &value ) && value ) ) return( 3 );
+	}
+	return( 0 );
+}
+
+///
+/// The checks of each file.
+///
+
+static void LintTask( LintList *list, GripScriptFile *file, int node ) {
+
+	// The first and last steps are not lines of the file.
+	int lines = file->nSteps - 1;
+
+	size_t longest = 0;
+	for ( int i = 1; i <= lines; i++ ) if ( strlen( file->step[i].text ) > longest ) longest = strlen( file->step[i].text );
+	char *buffer = (char *) LintAllocate( NULL, longest + 1 );
+
+	for ( int i = 0; i <= file->nSteps; i++ ) {
+		GripScriptStep *step = &file->step[i];
+		AddPicture( list, step->picture, node, ( i <= lines ? i : 0 ) );
+		if ( i == 0 || i > lines || step->comment ) continue;
+		char *token[MAX_TOKENS];
+		int tokens = ParseCommaDelimitedLineBuffer( token, step->text, buffer, longest + 1 );
+		if ( tokens == 0 ) continue;
+		int required = RequiredFields( token, tokens );
+		if ( tokens < required ) {
+			AddFinding( list, LINT_WARNING, LINT_PARAMETERS, file->filename, i,
+				"%s has %d fields but needs %d for the message and picture shown: %s", token[0], tokens, required, step->text );
+		}
+	}
+	free( buffer );
+
+}
+
+static void LintMenu( LintList *list, GripScriptFile *file ) {
+	for ( int i = 0; i < file->nItems; i++ ) {
+		GripScriptItem *item = &file->item[i];
+		if ( item->ignore ) continue;
+		for ( int j = 0; j < i; j++ ) {
+			if ( !file->item[j].ignore && file->item[j].id == item->id ) {
+				AddFinding( list, LINT_ERROR, LINT_DUPLICATE_ID, file->filename, item->line,
+					"ID %d is already used on line %d, so the crawler cannot go to %s.", item->id, file->item[j].line, item->label );
+				break;
+			}
+		}
+	}
+}
+
+static unsigned __stdcall LintFileThread( void *parameter ) {
+	LintWork *work = (LintWork *) parameter;
+	int node;
+	while ( ( node = InterlockedIncrement( &work->next ) - 1 ) < work->tree->nNodes ) {
+		GripScriptFile *file = work->tree->node[node].file;
+		if ( file->missing ) continue;
+		// The errors stay with a file that is taken over by a new tree, so they are reported again.
+		AddParseErrors( &work->list[node], file->error, file->nErrors );
+		if ( file->type == SCRIPT_TASK_FILE ) LintTask( &work->list[node], file, node );
+		else LintMenu( &work->list[node], file );
+	}
+	return( 0 );
+}
+
+static unsigned __stdcall LintPictureThread( void *parameter ) {
+	LintWork *work = (LintWork *) parameter;
+	int i;
+	char path[MAX_PATHLENGTH];
+	while ( ( i = InterlockedIncrement( &work->next ) - 1 ) < work->nPictures ) {
+		struct _stat64 picture_stat;
+		_snprintf( path, sizeof( path ), "%s%s", work->prefix, work->picture[i].name );
+		path[sizeof( path ) - 1] = 0;
+		work->picture[i].found = ( 0 == _stat64( path, &picture_stat ) );
+	}
+	return( 0 );
+}
+
+// Run a thread function on LINT_THREADS threads, this one included.
+static void LintInParallel( unsigned (__stdcall *function)( void * ), LintWork *work, int items ) {
+	HANDLE thread[LINT_THREADS];
+	int threads;
+	work->next = 0;
+	for ( threads = 0; threads < LINT_THREADS - 1 && threads < items - 1; threads++ ) {
+		thread[threads] = (HANDLE) _beginthreadex( NULL, 0, function, work, 0, NULL );
+		if ( !thread[threads] ) break;
+	}
+	function( work );
+	for ( int i = 0; i < threads; i++ ) {
+		WaitForSingleObject( thread[i], INFINITE );
+		CloseHandle( thread[i] );
+	}
+}
+
+static int ComparePictures( const void *a, const void *b ) {
+	const LintPicture *x = (const LintPicture *) a, *y = (const LintPicture *) b;
+	int names = strcmp( x->name, y->name );
+	if ( names ) return( names );
+	if ( x->node != y->node ) return( x->node - y->node );
+	return( x->line - y->line );
+}
+
+// By line, and in the order found within a line.
+static int CompareFindings( const void *a, const void *b ) {
+	const GripLintFinding *x = (const GripLintFinding *) a, *y = (const GripLintFinding *) b;
+	if ( x->line != y->line ) return( x->line - y->line );
+	return( x->sequence - y->sequence );
+}
+
+GripLintReport *LintGripScriptTree( GripScriptTree *tree, const char *picture_prefix ) {
+
+	LARGE_INTEGER frequency, start, finish;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	GripLintReport *report = (GripLintReport *) LintAllocate( NULL, sizeof( GripLintReport ) );
+	memset( report, 0, sizeof( *report ) );
+
+	LintWork work;
+	LintList parsing;
+	memset( &parsing, 0, sizeof( parsing ) );
+	work.tree = tree;
+	work.prefix = picture_prefix;
+	work.list = (LintList *) LintAllocate( NULL, ( tree->nNodes ? tree->nNodes : 1 ) * sizeof( LintList ) );
+	memset( work.list, 0, ( tree->nNodes ? tree->nNodes : 1 ) * sizeof( LintList ) );
+
+	// The files.
+	AddParseErrors( &parsing, tree->error, tree->nErrors );
+	LintInParallel( LintFileThread, &work, tree->nNodes );
+
+	// The pictures, each looked for once.
+	int total = 0;
+	for ( int n = 0; n < tree->nNodes; n++ ) total += work.list[n].nPictures;
+	LintPicture *picture = (LintPicture *) LintAllocate( NULL, ( total ? total : 1 ) * sizeof( LintPicture ) );
+	total = 0;
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		if ( work.list[n].nPictures ) memcpy( picture + total, work.list[n].picture, work.list[n].nPictures * sizeof( LintPicture ) );
+		total += work.list[n].nPictures;
+	}
+	qsort( picture, total, sizeof( LintPicture ), ComparePictures );
+	int distinct = 0;
+	for ( int i = 0; i < total; i++ ) {
+		if ( distinct > 0 && !strcmp( picture[distinct - 1].name, picture[i].name ) ) picture[distinct - 1].uses += picture[i].uses;
+		else picture[distinct++] = picture[i];
+	}
+	work.picture = picture;
+	work.nPictures = distinct;
+	LintInParallel( LintPictureThread, &work, distinct );
+	for ( int i = 0; i < distinct; i++ ) {
+		if ( picture[i].found ) continue;
+		AddFinding( &work.list[picture[i].node], LINT_ERROR, LINT_PICTURE, tree->node[picture[i].node].file->filename, picture[i].line,
+			"Missing picture %s%s, shown %d times.", picture_prefix, picture[i].name, picture[i].uses );
+	}
+
+	// Gather the findings: those of the links between files, then those of each file by line.
+	int findings = parsing.nFindings;
+	for ( int n = 0; n < tree->nNodes; n++ ) findings += work.list[n].nFindings;
+	report->finding = (GripLintFinding *) LintAllocate( NULL, ( findings ? findings : 1 ) * sizeof( GripLintFinding ) );
+	if ( parsing.nFindings ) memcpy( report->finding, parsing.finding, parsing.nFindings * sizeof( GripLintFinding ) );
+	report->nFindings = parsing.nFindings;
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		LintList *list = &work.list[n];
+		if ( list->nFindings > 1 ) qsort( list->finding, list->nFindings, sizeof( GripLintFinding ), CompareFindings );
+		if ( list->nFindings ) memcpy( report->finding + report->nFindings, list->finding, list->nFindings * sizeof( GripLintFinding ) );
+		report->nFindings += list->nFindings;
+		GripScriptFile *file = tree->node[n].file;
+		if ( !file->missing ) {
+			report->files++;
+			if ( file->type == SCRIPT_TASK_FILE ) report->lines += file->nSteps - 1;
+		}
+		free( list->finding );
+		free( list->picture );
+	}
+	for ( int i = 0; i < report->nFindings; i++ ) {
+		if ( report->finding[i].severity == LINT_ERROR ) report->errors++;
+		else report->warnings++;
+	}
+	report->pictures = distinct;
+
+	free( parsing.finding );
+	free( picture );
+	free( work.list );
+
+	QueryPerformanceCounter( &finish );
+	report->seconds = (double) ( finish.QuadPart - start.QuadPart ) / (double) frequency.QuadPart;
+	return( report );
+
+}
+
+void FreeGripLintReport( GripLintReport *report ) {
+	if ( !report ) return;
+	for ( int i = 0; i < report->nFindings; i++ ) {
+		free( report->finding[i].filename );
+		free( report->finding[i].message );
+	}
+	free( report->finding );
+	free( report );
+}
+
+void WriteGripLintReport( const GripLintReport *report, FILE *fp ) {
+	for ( int i = 0; i < report->nFindings; i++ ) {
+		const GripLintFinding *finding = &report->finding[i];
+		if ( finding->filename && finding->line ) fprintf( fp, "%s Line %03d ", finding->filename, finding->line );
+		else if ( finding->filename ) fprintf( fp, "%s ", finding->filename );
+		fprintf( fp, "%s (%s): %s\n", severityName[finding->severity], checkName[finding->check], finding->message );
+	}
+	fprintf( fp, "%d errors and %d warnings in %d files, %d lines and %d pictures, checked in %.3f s.\n",
+		report->errors, report->warnings, report->files, report->lines, report->pictures, report->seconds );
+}
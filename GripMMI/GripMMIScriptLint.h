@@ -0,0 +1,65 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Checks of the GRIP scripts, all gathered into one report.
+
+// LoadGripScriptTree() lists the errors that stop it from parsing a file. LintGripScriptTree()
+//  goes on to check a loaded tree for what the crawler would otherwise find only when a task is
+//  shown, or not at all:
+//   - lines with fewer parameters than their command needs for the message and picture shown,
+//     per the table of alerts in GripMMIScriptTree.h;
+//   - pictures that are not in the picture directory;
+//   - IDs that are used twice in a menu, since the crawler only ever goes to the first one.
+// The files are checked on several threads, and then the pictures are looked for on several
+//  threads. The findings are listed by file, in the order of the tree, and by line, so the
+//  report does not depend on which thread checked what.
+// GripMMI writes the report to a file at startup instead of showing the errors one by one.
+//  GripScriptCompiler -lint prints it, to check the scripts before they are uploaded.
+
+#include <stdio.h>
+
+#include "GripMMIScriptTree.h"
+
+typedef enum { LINT_ERROR, LINT_WARNING } GripLintSeverity;
+typedef enum { LINT_PARSE, LINT_PARAMETERS, LINT_PICTURE, LINT_DUPLICATE_ID } GripLintCheck;
+
+typedef struct {
+	GripLintSeverity	severity;
+	GripLintCheck		check;
+	char				*filename;	// NULL if it is not about a given file.
+	int					line;		// 0 if it is about the whole file.
+	char				*message;
+	int					sequence;	// The order in which it was found, within its file.
+} GripLintFinding;
+
+typedef struct {
+
+	int				nFindings;
+	GripLintFinding	*finding;
+	int				errors;
+	int				warnings;
+
+	// What was checked.
+	int				files;
+	int				lines;
+	int				pictures;
+	double			seconds;
+
+} GripLintReport;
+
+// Check a tree. Pictures are looked for with picture_prefix in front of their names.
+// The report does not refer to the tree, which can be freed first.
+GripLintReport *LintGripScriptTree( GripScriptTree *tree, const char *picture_prefix );
+void FreeGripLintReport( GripLintReport *report );
+
+// One line per finding, then a summary.
+void WriteGripLintReport( const GripLintReport *report, FILE *fp );
@@ -0,0 +1,653 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The GRIP scripts, parsed once into memory. See GripMMIScriptTree.h.
+
+// The parsing follows what ParseSubjectFile(), ParseSessionFile(), ParseProtocolFile() and
+//  ParseTaskFile() in GripMMIScripts.cpp used to do one file at a time, including the error messages.
+// Since the files are parsed on worker threads, the errors are collected and shown by the caller
+//  rather than in a MessageBox as they are found.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <io.h>
+#include <process.h>
+#include <sys\types.h>
+#include <sys\stat.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Useful\ParseCommaDelimitedLine.h"
+
+#include "GripMMIScriptTree.h"
+#include "GripMMIScriptBundle.h"
+
+// Number of threads that parse the files of a level.
+#define SCRIPT_LOADER_THREADS	8
+
+// These are the 3 types of steps.
+const char *type_status = "Status (script will continue)";
+const char *type_query =  "Query (waiting for response)";
+const char *type_alert =  "Alert (seen only if error)";
+
+// The lines that ParseTaskFile() put before and after the lines of a task.
+static const char *start_of_script = "<Waiting to start ...>";
+static const char *end_of_script_line = "************ End of Script ************";
+static const char *end_of_script_message = "*********** End of Script ***********\n*********** End of Script ***********\n*********** End of Script ***********\n*********** End of Script ***********";
+
+// The alerts show the message and picture given by these fields of the line.
+static const GripScriptAlert alerts[] = {
+	{ "CMD_WAIT_MANIP_ATTARGET", 13, 14 },
+	{ "CMD_WAIT_MANIP_GRIP", 4, 5 },
+	{ "CMD_WAIT_MANIP_GRIPFORCE", 11, 12 },
+	{ "CMD_WAIT_MANIP_SLIP", 11, 12 },
+	{ "CMD_CHK_MASS_SELECTION", -1, -1 },
+	{ "CMD_CHK_HW_CONFIG", 1, 2 },
+	{ "CMD_ALIGN_CODA", 1, 2 },
+	{ "CMD_CHK_CODA_ALIGNMENT", 4, 5 },
+	{ "CMD_CHK_CODA_FIELDOFVIEW", 9, 10 },
+	{ "CMD_CHK_CODA_PLACEMENT", 11, 12 },
+	{ "CMD_CHK_MOVEMENTS_AMPL", 6, 7 },
+	{ "CMD_CHK_MOVEMENTS_CYCLES", 7, 8 },
+	{ "CMD_CHK_START_POS", 7, 8 },
+	{ "CMD_CHK_MOVEMENTS_DIR", 6, 7 },
+	{ "CMD_CHK_COLLISIONFORCE", 4, 5 },
+	{ "CMD_CHK_MANIP_VISIBILITY", 3, 4 },
+};
+
+const GripScriptAlert *GripScriptFindAlert( const char *command ) {
+	for ( int alert = 0; alert < (int) ( sizeof( alerts ) / sizeof( alerts[0] ) ); alert++ ) {
+		if ( !strcmp( command, alerts[alert].command ) ) return( &alerts[alert] );
+	}
+	return( NULL );
+}
+
+///
+/// Helpers.
+///
+
+static void *ScriptAllocate( size_t size ) {
+	void *memory = calloc( 1, size ? size : 1 );
+	if ( !memory ) {
+		fMessageBox( MB_OK | MB_ICONERROR, "GRIP Script Crawler", "Error allocating memory for the scripts." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+// Add an error to a list of errors. The file name is not copied.
+static void ScriptError( GripScriptError **error, int *nErrors, const char *filename, int line, const char *format, ... ) {
+
+	char message[2048];
+	va_list args;
+
+	va_start( args, format );
+	_vsnprintf( message, sizeof( message ) - 1, format, args );
+	va_end( args );
+	message[sizeof( message ) - 1] = 0;
+
+	GripScriptError *longer = (GripScriptError *) ScriptAllocate( ( *nErrors + 1 ) * sizeof( GripScriptError ) );
+	if ( *nErrors ) memcpy( longer, *error, *nErrors * sizeof( GripScriptError ) );
+	free( *error );
+	*error = longer;
+	GripScriptError *added = &longer[( *nErrors )++];
+	added->filename = filename;
+	added->line = line;
+	added->message = (char *) ScriptAllocate( strlen( message ) + 1 );
+	strcpy( added->message, message );
+
+}
+
+static void FreeScriptErrors( GripScriptError *error, int nErrors ) {
+	for ( int i = 0; i < nErrors; i++ ) free( error[i].message );
+	free( error );
+}
+
+// Add errors to a text, one per line, with the file name and the line number in front
+//  of those that are about a line of a file, as the crawler used to show them.
+static void ScriptErrorText( char **errors, const GripScriptError *error, int nErrors ) {
+
+	for ( int i = 0; i < nErrors; i++ ) {
+		char line[2048];
+		size_t length = ( *errors ? strlen( *errors ) : 0 );
+		if ( error[i].filename && error[i].line ) _snprintf( line, sizeof( line ) - 2, "%s Line %03d %s", error[i].filename, error[i].line, error[i].message );
+		else _snprintf( line, sizeof( line ) - 2, "%s", error[i].message );
+		line[sizeof( line ) - 2] = 0;
+		strcat( line, "\n" );
+		char *longer = (char *) realloc( *errors, length + strlen( line ) + 1 );
+		if ( !longer ) return;
+		strcpy( longer + length, line );
+		*errors = longer;
+	}
+
+}
+
+// The token if the line has that many, NULL otherwise.
+// The old parser did not check, which could crash it on a malformed line.
+static const char *Token( char *token[MAX_TOKENS], int tokens, int i ) {
+	return( i < tokens ? token[i] : NULL );
+}
+
+static bool StatScriptFile( const char *filename, time_t *mtime, long long *size ) {
+	struct _stat64 file_stat;
+	if ( _stat64( filename, &file_stat ) ) return( false );
+	*mtime = file_stat.st_mtime;
+	*size = (long long) file_stat.st_size;
+	return( true );
+}
+
+static GripScriptFile *NewScriptFile( const char *filename, GripScriptFileType type ) {
+	GripScriptFile *file = (GripScriptFile *) ScriptAllocate( sizeof( GripScriptFile ) );
+	file->filename = (char *) ScriptAllocate( strlen( filename ) + 1 );
+	strcpy( file->filename, filename );
+	file->type = type;
+	return( file );
+}
+
+static void FreeScriptFile( GripScriptFile *file ) {
+	if ( !file ) return;
+	free( file->filename );
+	free( file->item );
+	free( file->step );
+	FreeScriptErrors( file->error, file->nErrors );
+	free( file->contents );
+	free( file->tokens );
+	free( file->names );
+	free( file );
+}
+
+///
+/// Parsing of the files.
+///
+
+// Parse the items of a subject, session or protocol file.
+static void ParseScriptItems( GripScriptFile *file, char **line, int lines ) {
+
+	// What each kind of file looks like.
+	const char *command;
+	int fields, id_field, file_field, label_field;
+	switch ( file->type ) {
+	case SCRIPT_SUBJECT_FILE: command = "CMD_USER"; fields = 5; id_field = 1; file_field = 3; label_field = 4; break;
+	case SCRIPT_SESSION_FILE: command = "CMD_PROTOCOL"; fields = 4; id_field = 1; file_field = 2; label_field = 3; break;
+	default: command = "CMD_TASK"; fields = 4; id_field = 1; file_field = 2; label_field = 3; break;
+	}
+	bool subject = ( file->type == SCRIPT_SUBJECT_FILE );
+
+	// We want to work in the same directory as the file.
+	size_t directory;
+	for ( directory = strlen( file->filename ); directory > 0; directory-- ) {
+		if ( file->filename[directory - 1] == '\\' || file->filename[directory - 1] == '/' ) break;
+	}
+
+	file->item = (GripScriptItem *) ScriptAllocate( lines * sizeof( GripScriptItem ) );
+	// Room for the directory in front of each file name.
+	char *name = file->names = (char *) ScriptAllocate( lines * ( directory + 1 ) + (size_t) file->size + lines + 1 );
+
+	for ( int n = 0; n < lines; n++ ) {
+
+		char *token[MAX_TOKENS];
+		int line_n = n + 1;
+		int tokens = ParseCommaDelimitedLineBuffer( token, line[n], file->tokens + ( line[n] - file->contents ), strlen( line[n] ) + 1 );
+
+		// If the number of tokens is 0, it is a comment or blank line.
+		if ( tokens == 0 ) continue;
+		if ( tokens != fields ) {
+			ScriptError( &file->error, &file->nErrors, file->filename, line_n, "Wrong number of parameters: %s", line[n] );
+			// This used to stop the parsing of a subject or session file.
+			if ( subject ) file->fatal = true;
+			if ( file->type != SCRIPT_PROTOCOL_FILE ) break;
+			continue;
+		}
+		if ( strcmp( token[0], command ) ) {
+			ScriptError( &file->error, &file->nErrors, file->filename, line_n, "Command not %s: %s", command, token[0] );
+			if ( subject ) {
+				file->fatal = true;
+				break;
+			}
+		}
+		GripScriptItem *item = &file->item[file->nItems];
+		if ( 1 != sscanf( token[id_field], "%d", &item->id ) ) {
+			ScriptError( &file->error, &file->nErrors, file->filename, line_n, "Error reading %s ID: %s",
+				( subject ? "subject" : ( file->type == SCRIPT_SESSION_FILE ? "protocol" : "task" ) ), token[id_field] );
+			file->fatal = true;
+			break;
+		}
+		item->label = token[label_field];
+		item->line = line_n;
+		// Sessions and protocols can be left out by giving 'ignore' as the file.
+		item->ignore = ( !subject && strstr( token[file_field], "ignore" ) != NULL );
+		strncpy( name, file->filename, directory );
+		strcpy( name + directory, token[file_field] );
+		item->filename = name;
+		name += strlen( name ) + 1;
+		file->nItems++;
+	}
+
+}
+
+// Parse the lines of a task file. The first line is a dummy comment, as in the GUI list,
+//  and an 'End of Script' line follows the last one, at step[nSteps].
+static void ParseScriptSteps( GripScriptFile *file, char **line, int lines ) {
+
+	// Keep track of the most recent step, excluding comments.
+	int current_step = 0;
+	const char *status_picture = "blank.bmp";
+	const char *status_message = "";
+
+	file->step = (GripScriptStep *) ScriptAllocate( ( lines + 2 ) * sizeof( GripScriptStep ) );
+
+	// Create a dummy first line, which is a comment.
+	GripScriptStep *step = &file->step[0];
+	step->text = start_of_script;
+	step->message = status_message;
+	step->picture = status_picture;
+	step->type = type_status;
+	step->comment = true;
+	step->stepID = current_step;
+
+	for ( int n = 0; n < lines; n++ ) {
+
+		char *token[MAX_TOKENS];
+		int tokens = ParseCommaDelimitedLineBuffer( token, line[n], file->tokens + ( line[n] - file->contents ), strlen( line[n] ) + 1 );
+		step = &file->step[n + 1];
+		step->text = line[n];
+
+		if ( tokens > 0 ) {
+
+			// First we handle commands that change the status message and picture.
+			if ( !strcmp( token[0], "CMD_LOG_MESSAGE" ) ) {
+				int value = 0;
+				const char *kind = Token( token, tokens, 1 );
+				// CMD_LOG_MESSAGE takes a 0 or a 1 as the second value,
+				// but some scripts use the constants 'logmsg' (0) or 'usermsg' (1).
+				if ( !kind ) value = 0;
+				else if ( !strcmp( kind, "logmsg" ) ) value = 0;
+				else if ( !strcmp( kind, "usermsg" ) ) value = 1;
+				// If neither 'logmsg' or 'usermsg', then read a 0 or 1, defaulting to 0.
+				else {
+					int items = sscanf( kind, "%d", &value );
+					value = items && value;
+				}
+				// Only user messages (value == 1) change the status message that is shown to the subject.
+				if ( value != 0 ) status_message = ( Token( token, tokens, 2 ) ? token[2] : "" );
+			}
+			else if ( !strcmp( token[0], "CMD_SET_PICTURE" ) ) {
+				status_picture = ( tokens > 1 ? token[1] : "blank.bmp" );
+			}
+
+			// Now interpret actual commands.
+			// CMD_WAIT_SUBJ_READY generates a 'query'. Alerts show the message and picture given
+			//  in the table of alerts. Anything else is a 'status' command.
+			const GripScriptAlert *alert = GripScriptFindAlert( token[0] );
+			if ( !strcmp( token[0], "CMD_WAIT_SUBJ_READY" ) ) {
+				step->message = ( Token( token, tokens, 1 ) ? token[1] : "" );
+				step->picture = ( Token( token, tokens, 2 ) ? token[2] : "" );
+				step->type = type_query;
+			}
+			else if ( alert ) {
+				if ( alert->message < 0 ) {
+					step->message = "Put mass in cradle X and pick up mass from cradle Y.";
+					step->picture = "TakeMass.bmp";
+				}
+				else {
+					const char *message = Token( token, tokens, alert->message );
+					const char *picture = Token( token, tokens, alert->picture );
+					step->message = ( message ? message : "" );
+					step->picture = ( picture ? picture : "" );
+				}
+				step->type = type_alert;
+			}
+			else {
+				step->message = status_message;
+				step->picture = status_picture;
+				step->type = type_status;
+			}
+			step->comment = false;
+			current_step++;
+			step->stepID = current_step;
+		}
+		// If there were no tokens, then the line is a comment line.
+		// Use the the most recent status, picture and stepID and mark it as a comment.
+		else {
+			step->message = status_message;
+			step->picture = status_picture;
+			step->type = type_status;
+			step->comment = true;
+			step->stepID = current_step;
+		}
+	}
+	file->nSteps = lines + 1;
+
+	// The end of the script, shown as a final comment line and status message.
+	step = &file->step[file->nSteps];
+	step->text = end_of_script_line;
+	step->message = end_of_script_message;
+	step->picture = "blank.bmp";
+	step->type = type_status;
+	step->comment = true;
+	step->stepID = 9999;
+
+}
+
+// Read a file into memory, split it into lines and parse them.
+// A file that cannot be read is marked as missing.
+static void ParseScriptFile( GripScriptFile *file ) {
+
+	FILE *fp;
+
+	if ( !StatScriptFile( file->filename, &file->mtime, &file->size ) ) {
+		file->missing = true;
+		return;
+	}
+	fp = fopen( file->filename, "rb" );
+	if ( !fp ) {
+		file->missing = true;
+		return;
+	}
+	file->contents = (char *) ScriptAllocate( (size_t) file->size + 1 );
+	size_t length = fread( file->contents, 1, (size_t) file->size, fp );
+	file->contents[length] = 0;
+	fclose( fp );
+	// The tokens of each line go at the same place in a buffer of the same size.
+	file->tokens = (char *) ScriptAllocate( length + 1 );
+
+	// Split into lines, dropping the line ends.
+	int lines = 0;
+	for ( size_t c = 0; c < length; c++ ) if ( file->contents[c] == '\n' ) lines++;
+	if ( length > 0 && file->contents[length - 1] != '\n' ) lines++;
+	char **line = (char **) ScriptAllocate( ( lines + 1 ) * sizeof( char * ) );
+	char *chr = file->contents;
+	for ( int n = 0; n < lines; n++ ) {
+		line[n] = chr;
+		while ( *chr && *chr != '\n' ) chr++;
+		if ( *chr ) *chr++ = 0;
+		size_t end = strlen( line[n] );
+		if ( end > 0 && line[n][end - 1] == '\r' ) line[n][end - 1] = 0;
+	}
+
+	if ( file->type == SCRIPT_TASK_FILE ) ParseScriptSteps( file, line, lines );
+	else ParseScriptItems( file, line, lines );
+	free( line );
+
+}
+
+///
+/// Loading of the tree.
+///
+
+static unsigned int HashScriptFilename( const char *filename ) {
+	unsigned int hash = 2166136261u;
+	for ( ; *filename; filename++ ) hash = ( hash ^ (unsigned char) *filename ) * 16777619u;
+	return( hash );
+}
+
+static unsigned int HashScriptID( int id ) {
+	return( (unsigned int) id * 2654435761u >> 8 );
+}
+
+// The node of a file, or -1 if the file is not in the tree.
+static int FindScriptNode( GripScriptTree *tree, const char *filename ) {
+	if ( !tree || !tree->nSlots ) return( -1 );
+	for ( unsigned int slot = HashScriptFilename( filename ) & ( tree->nSlots - 1 ); tree->slot[slot] >= 0; slot = ( slot + 1 ) & ( tree->nSlots - 1 ) ) {
+		if ( !strcmp( tree->node[tree->slot[slot]].file->filename, filename ) ) return( tree->slot[slot] );
+	}
+	return( -1 );
+}
+
+// Add a node for a file that is not in the tree yet and return it.
+// The table is kept at most half full.
+static int AddScriptNode( GripScriptTree *tree, const char *filename, GripScriptFileType type ) {
+
+	int index = FindScriptNode( tree, filename );
+	if ( index >= 0 ) return( index );
+
+	if ( 2 * ( tree->nNodes + 1 ) > tree->nSlots ) {
+		int slots = ( tree->nSlots ? 2 * tree->nSlots : 64 );
+		GripScriptNode *node = (GripScriptNode *) ScriptAllocate( slots / 2 * sizeof( GripScriptNode ) );
+		if ( tree->nNodes ) memcpy( node, tree->node, tree->nNodes * sizeof( GripScriptNode ) );
+		free( tree->node );
+		tree->node = node;
+		free( tree->slot );
+		tree->slot = (int *) ScriptAllocate( slots * sizeof( int ) );
+		tree->nSlots = slots;
+		for ( int slot = 0; slot < slots; slot++ ) tree->slot[slot] = -1;
+		for ( int n = 0; n < tree->nNodes; n++ ) {
+			unsigned int slot = HashScriptFilename( tree->node[n].file->filename ) & ( slots - 1 );
+			while ( tree->slot[slot] >= 0 ) slot = ( slot + 1 ) & ( slots - 1 );
+			tree->slot[slot] = n;
+		}
+	}
+
+	index = tree->nNodes++;
+	tree->node[index].file = NewScriptFile( filename, type );
+	unsigned int slot = HashScriptFilename( filename ) & ( tree->nSlots - 1 );
+	while ( tree->slot[slot] >= 0 ) slot = ( slot + 1 ) & ( tree->nSlots - 1 );
+	tree->slot[slot] = index;
+	return( index );
+
+}
+
+// What the threads that load a level share.
+typedef struct {
+	GripScriptTree	*tree;
+	GripScriptTree	*previous;
+	int				first;
+	int				last;
+	volatile LONG	next;
+	volatile LONG	reused;
+} ScriptLevel;
+
+// Take over the file from the previous tree if it has not changed since, otherwise parse it.
+// Each node is handled by only one thread, and a file name is in only one node of each tree.
+static void LoadScriptNode( ScriptLevel *level, int index ) {
+
+	GripScriptFile *file = level->tree->node[index].file;
+	int old = FindScriptNode( level->previous, file->filename );
+
+	if ( old >= 0 ) {
+		GripScriptFile *previous = level->previous->node[old].file;
+		time_t mtime;
+		long long size;
+		if ( previous && !previous->missing && previous->type == file->type
+			&& StatScriptFile( file->filename, &mtime, &size ) && mtime == previous->mtime && size == previous->size ) {
+			// Leave the name in the previous tree, since its hash table still refers to it.
+			level->previous->node[old].file = NewScriptFile( previous->filename, previous->type );
+			level->tree->node[index].file = previous;
+			level->tree->node[index].reused = true;
+			FreeScriptFile( file );
+			InterlockedIncrement( &level->reused );
+			return;
+		}
+	}
+	ParseScriptFile( file );
+
+}
+
+static unsigned __stdcall ScriptLoaderThread( void *parameter ) {
+	ScriptLevel *level = (ScriptLevel *) parameter;
+	int index;
+	while ( ( index = level->first + InterlockedIncrement( &level->next ) - 1 ) < level->last ) LoadScriptNode( level, index );
+	return( 0 );
+}
+
+// Load the nodes from first to last, in parallel if there are several.
+static void LoadScriptLevel( GripScriptTree *tree, GripScriptTree *previous, int first, int last ) {
+
+	ScriptLevel level;
+	HANDLE thread[SCRIPT_LOADER_THREADS];
+	int threads = 0;
+
+	level.tree = tree;
+	level.previous = previous;
+	level.first = first;
+	level.last = last;
+	level.next = 0;
+	level.reused = 0;
+
+	if ( last - first > 1 ) {
+		for ( threads = 0; threads < SCRIPT_LOADER_THREADS && threads < last - first; threads++ ) {
+			thread[threads] = (HANDLE) _beginthreadex( NULL, 0, ScriptLoaderThread, &level, 0, NULL );
+			if ( !thread[threads] ) break;
+		}
+	}
+	// Whatever the threads do not get to is done here.
+	ScriptLoaderThread( &level );
+	for ( int i = 0; i < threads; i++ ) {
+		WaitForSingleObject( thread[i], INFINITE );
+		CloseHandle( thread[i] );
+	}
+	tree->reused += level.reused;
+	tree->parsed += ( last - first ) - level.reused;
+
+}
+
+GripScriptTree *LoadGripScriptTree( const char *subject_file, GripScriptTree *previous ) {
+
+	LARGE_INTEGER frequency, start, finish;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	GripScriptTree *tree = (GripScriptTree *) ScriptAllocate( sizeof( GripScriptTree ) );
+	AddScriptNode( tree, subject_file, SCRIPT_SUBJECT_FILE );
+	// The strings of a tree from a bundle go away with the bundle.
+	if ( previous && previous->bundleFilename ) previous = NULL;
+
+	// The files of each level are known once the level above has been loaded.
+	int first = 0;
+	while ( first < tree->nNodes ) {
+		int last = tree->nNodes;
+		LoadScriptLevel( tree, previous, first, last );
+		for ( int n = first; n < last; n++ ) {
+			GripScriptFile *file = tree->node[n].file;
+			if ( file->type == SCRIPT_TASK_FILE || file->missing ) continue;
+			tree->node[n].child = (int *) ScriptAllocate( file->nItems * sizeof( int ) );
+			for ( int i = 0; i < file->nItems; i++ ) {
+				if ( file->item[i].ignore ) tree->node[n].child[i] = -1;
+				else tree->node[n].child[i] = AddScriptNode( tree, file->item[i].filename, (GripScriptFileType) ( file->type + 1 ) );
+			}
+		}
+		first = last;
+	}
+
+	// The menus show the items whose files could be read.
+	static const char *what[] = { "subject", "session", "protocol", "task" };
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		GripScriptNode *node = &tree->node[n];
+		GripScriptFile *file = node->file;
+		if ( !node->child ) continue;
+		node->entry = (int *) ScriptAllocate( file->nItems * sizeof( int ) );
+		for ( int i = 0; i < file->nItems; i++ ) {
+			if ( node->child[i] < 0 ) continue;
+			GripScriptFile *child = tree->node[node->child[i]].file;
+			if ( child->missing ) {
+				ScriptError( &tree->error, &tree->nErrors, file->filename, file->item[i].line, "Cannot access %s file: %s", what[child->type], child->filename );
+				// A subject without a session file used to stop the crawler.
+				if ( file->type == SCRIPT_SUBJECT_FILE ) tree->fatal = true;
+				continue;
+			}
+			node->entry[node->nEntries] = i;
+			node->child[node->nEntries] = node->child[i];
+			node->nEntries++;
+		}
+		// Index the entries by ID. The table is kept at most half full.
+		for ( node->nIdSlots = 4; node->nIdSlots < 2 * node->nEntries; node->nIdSlots *= 2 );
+		node->idSlot = (int *) ScriptAllocate( node->nIdSlots * sizeof( int ) );
+		for ( int slot = 0; slot < node->nIdSlots; slot++ ) node->idSlot[slot] = -1;
+		for ( int i = 0; i < node->nEntries; i++ ) {
+			int id = file->item[node->entry[i]].id;
+			unsigned int slot = HashScriptID( id ) & ( node->nIdSlots - 1 );
+			while ( node->idSlot[slot] >= 0 && file->item[node->entry[node->idSlot[slot]]].id != id ) slot = ( slot + 1 ) & ( node->nIdSlots - 1 );
+			if ( node->idSlot[slot] < 0 ) node->idSlot[slot] = i;
+		}
+	}
+	if ( tree->node[0].file->missing ) {
+		ScriptError( &tree->error, &tree->nErrors, NULL, 0, "Error opening subject file %s for read.", subject_file );
+		tree->fatal = true;
+	}
+
+	// The text of the errors has those of the tree and those of the files that were parsed this time.
+	// Those of the files that were taken over have been shown already.
+	ScriptErrorText( &tree->errors, tree->error, tree->nErrors );
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		GripScriptFile *file = tree->node[n].file;
+		if ( tree->node[n].reused ) continue;
+		ScriptErrorText( &tree->errors, file->error, file->nErrors );
+		if ( file->fatal ) tree->fatal = true;
+	}
+
+	QueryPerformanceCounter( &finish );
+	tree->seconds = (double) ( finish.QuadPart - start.QuadPart ) / (double) frequency.QuadPart;
+	return( tree );
+
+}
+
+void FreeGripScriptTree( GripScriptTree *tree ) {
+	if ( !tree ) return;
+	if ( tree->bundleFilename ) ReleaseGripScriptBundle( tree );
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		FreeScriptFile( tree->node[n].file );
+		free( tree->node[n].entry );
+		free( tree->node[n].child );
+		free( tree->node[n].idSlot );
+	}
+	free( tree->node );
+	free( tree->slot );
+	FreeScriptErrors( tree->error, tree->nErrors );
+	free( tree->errors );
+	free( tree );
+}
+
+// Only the files of the tree are checked. A file that is newly listed can only be listed
+//  by one that has been modified, which is detected.
+bool GripScriptTreeChanged( GripScriptTree *tree ) {
+	if ( tree->bundleFilename ) return( GripScriptBundleChanged( tree ) );
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		GripScriptFile *file = tree->node[n].file;
+		time_t mtime;
+		long long size;
+		bool present = StatScriptFile( file->filename, &mtime, &size );
+		if ( present == file->missing ) return( true );
+		if ( present && ( mtime != file->mtime || size != file->size ) ) return( true );
+	}
+	return( false );
+}
+
+GripScriptNode *GripScriptChild( GripScriptTree *tree, GripScriptNode *node, int index ) {
+	if ( !node || index < 0 || index >= node->nEntries ) return( NULL );
+	return( &tree->node[node->child[index]] );
+}
+
+const GripScriptItem *GripScriptEntry( GripScriptNode *node, int index ) {
+	if ( !node || index < 0 || index >= node->nEntries ) return( NULL );
+	return( &node->file->item[node->entry[index]] );
+}
+
+int GripScriptFindEntry( GripScriptNode *node, int id ) {
+	if ( !node || !node->nIdSlots ) return( -1 );
+	for ( unsigned int slot = HashScriptID( id ) & ( node->nIdSlots - 1 ); node->idSlot[slot] >= 0; slot = ( slot + 1 ) & ( node->nIdSlots - 1 ) ) {
+		if ( node->file->item[node->entry[node->idSlot[slot]]].id == id ) return( node->idSlot[slot] );
+	}
+	return( -1 );
+}
+
+// The step IDs of a task count the non-comment lines, so they never decrease from one line
+//  to the next and the lines can be searched by bisection.
+int GripScriptFindStep( GripScriptFile *task, int step_id ) {
+	int low = 0, high = task->nSteps;
+	while ( low < high ) {
+		int middle = ( low + high ) / 2;
+		if ( task->step[middle].stepID < step_id ) low = middle + 1;
+		else high = middle;
+	}
+	return( low );
+}
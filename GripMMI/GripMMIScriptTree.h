@@ -0,0 +1,166 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// The GRIP scripts, parsed once into memory.
+
+// The script crawler used to reopen and reparse the session, protocol and task files each time
+//  that the subject, protocol or task changed. LoadGripScriptTree() now reads the whole hierarchy
+//  of files below the subject file at startup, one level at a time and the files of each level in
+//  parallel, so that moving around in the scripts does not touch the disk.
+// A tree is not modified once it has been loaded. To pick up changes to the scripts, a new tree is
+//  loaded with the previous one as a reference. Files whose modification time and size have not
+//  changed are taken over from the previous tree rather than being parsed again.
+
+#include <time.h>
+
+// The levels of the hierarchy. Each level lists the files of the next one.
+typedef enum { SCRIPT_SUBJECT_FILE, SCRIPT_SESSION_FILE, SCRIPT_PROTOCOL_FILE, SCRIPT_TASK_FILE } GripScriptFileType;
+
+// A line of a subject, session or protocol file, i.e. an entry in the menu of subjects, protocols or tasks.
+typedef struct {
+	int			id;
+	const char	*label;		// What is shown in the menu.
+	const char	*filename;	// The file that it refers to, with the directory of this file in front.
+	int			line;		// Line number, for error messages.
+	bool		ignore;		// Sessions and protocols may have 'ignore' as the file name.
+} GripScriptItem;
+
+// A line of a task file. Comment lines are there as well, so that the task is shown as it is in the file.
+typedef struct {
+	const char	*text;		// The whole line.
+	const char	*message;	// What the subject sees at this step.
+	const char	*picture;
+	const char	*type;		// One of the type_status, type_query or type_alert strings.
+	int			stepID;
+	bool		comment;
+} GripScriptStep;
+
+// An error found when loading the scripts.
+typedef struct {
+	const char	*filename;	// The file that it is about, or NULL. It points into the tree.
+	int			line;		// The line of that file, or 0 if it is not about a given line.
+	char		*message;	// Without the file name and the line.
+} GripScriptError;
+
+// The contents of a file.
+typedef struct {
+
+	char				*filename;
+	GripScriptFileType	type;
+	time_t				mtime;
+	long long			size;
+	// The file could not be read. Nothing else is filled in.
+	bool				missing;
+
+	// Subject, session and protocol files.
+	int					nItems;
+	GripScriptItem		*item;
+	// Task files.
+	int					nSteps;
+	GripScriptStep		*step;
+
+	// Errors found in the file. They stay with the file when it is taken over by a new tree.
+	int					nErrors;
+	GripScriptError		*error;
+	// Errors that used to make the crawler give up.
+	bool				fatal;
+
+	// The lines of the file, the tokens of each line and the paths of the files of the items,
+	//  which the strings above point into.
+	char				*contents;
+	char				*tokens;
+	char				*names;
+
+} GripScriptFile;
+
+// A file in the hierarchy. The items of its file that are shown in the menu are those that
+//  are not ignored and whose file could be read. child[i] is the node of the file of entry[i].
+typedef struct {
+	GripScriptFile		*file;
+	int					nEntries;
+	int					*entry;
+	int					*child;
+	// Hash table from the IDs of the entries to the first entry with each ID.
+	int					nIdSlots;
+	int					*idSlot;
+	// The file was taken over from the previous tree.
+	bool				reused;
+} GripScriptNode;
+
+typedef struct {
+
+	// Node 0 is the subject file. A file that is listed more than once has a single node.
+	int				nNodes;
+	GripScriptNode	*node;
+
+	// Files that could not be read and other errors in the links between files. A tree loaded
+	//  from a bundle has the errors of the files here as well, since it has no error in its files.
+	int				nErrors;
+	GripScriptError	*error;
+	// The errors above, followed by those of the files that were parsed for this tree, as text,
+	//  one per line, or NULL if there were none.
+	char			*errors;
+	bool			fatal;
+
+	// What was done to load the tree.
+	int				parsed;
+	int				reused;
+	double			seconds;
+
+	// Hash table from file names to nodes.
+	int				nSlots;
+	int				*slot;
+
+	// A tree loaded from a compiled bundle (see GripMMIScriptBundle.h) has the name, modification
+	//  time and size of the bundle, to detect changes, and points into the mapped bundle if it could be used.
+	char			*bundleFilename;
+	const void		*bundle;
+	time_t			bundleTime;
+	long long		bundleSize;
+
+} GripScriptTree;
+
+// The step types.
+extern const char *type_status;
+extern const char *type_query;
+extern const char *type_alert;
+
+// A command that stops the script with an alert if its test fails, and the fields of its line
+//  that hold the message and the picture shown then, or -1 if they are always the same.
+typedef struct {
+	const char	*command;
+	int			message;
+	int			picture;
+} GripScriptAlert;
+
+// The alert for a command, or NULL if the command is not an alert.
+const GripScriptAlert *GripScriptFindAlert( const char *command );
+
+// Load the files below the subject file. If a previous tree is given, the files that have not
+//  changed are moved from it to the new tree, so the previous tree has to be freed afterwards
+//  and must not be used for anything else. Nothing is taken over from a tree that was loaded
+//  from a bundle. Errors in the scripts are listed in the tree.
+GripScriptTree *LoadGripScriptTree( const char *subject_file, GripScriptTree *previous );
+void FreeGripScriptTree( GripScriptTree *tree );
+
+// Check whether any of the files of the tree has been modified, added or removed since it was loaded.
+bool GripScriptTreeChanged( GripScriptTree *tree );
+
+// The node for the file that the index'th entry of the menu of a node refers to, or NULL if out of range.
+GripScriptNode *GripScriptChild( GripScriptTree *tree, GripScriptNode *node, int index );
+// The item of the file that is shown as the index'th entry of the menu of a node.
+const GripScriptItem *GripScriptEntry( GripScriptNode *node, int index );
+
+// The index of the first entry of the menu of a node with the given ID, or -1 if there is none.
+int GripScriptFindEntry( GripScriptNode *node, int id );
+// The first line of a task whose step ID is at least the given one, or nSteps if there is none.
+int GripScriptFindStep( GripScriptFile *task, int step_id );
@@ -39,6 +39,11 @@
 #include <vcclr.h>
 
 #include "GripMMIDesktop.h"
+#include "GripMMIScriptTree.h"
+#include "GripMMIScriptBundle.h"
+#include "GripMMIScriptLint.h"
+#include "GripMMIPictureCache.h"
+#include "GripMMITimeline.h"
 #include "..\Useful\Useful.h"
 #include "..\Useful\VectorsMixin.h"
 #include "..\Useful\fMessageBox.h"
@@ -62,513 +67,286 @@ using namespace GripMMI;
 char scriptDirectory[MAX_PATHLENGTH];
 char pictureFilenamePrefix[MAX_PATHLENGTH];
 
-// The subject/session file defines the session file for each subject.
-int  subjectID[MAX_MENU_ITEMS];
-char session_file_list[MAX_MENU_ITEMS][MAX_MENU_ITEM_LENGTH];
-int  nSubjects = 0;
-
-// A protocol file contains a list protocols for a defined session.
-char protocol_file_list[MAX_MENU_ITEMS][MAX_MENU_ITEM_LENGTH];
-int  protocolID[MAX_MENU_ITEMS];
-int  nProtocols = 0;
-
-// A task file contains the list of tasks for a given protocol.
-char task_file_list[MAX_MENU_ITEMS][MAX_MENU_ITEM_LENGTH];
-int  taskID[MAX_MENU_ITEMS];
-int	 nTasks = 0;			
+// The whole hierarchy of script files is parsed into memory at startup (see GripMMIScriptTree.h).
+static GripScriptTree *scriptTree = NULL;
+static char scriptFile[MAX_PATHLENGTH];
+// A compiled bundle of the scripts, used instead of the text files if it is there (see GripMMIScriptBundle.h).
+static char bundleFile[MAX_PATHLENGTH];
+// The files whose contents are shown in the subject, protocol and task menus and in the step list.
+static GripScriptNode *subjectNode = NULL;
+static GripScriptNode *sessionNode = NULL;
+static GripScriptNode *protocolNode = NULL;
+static GripScriptNode *taskNode = NULL;
+// The files that the protocol, task and step lists currently show, so that a list is refilled
+//  only when it has to show a different file.
+static GripScriptNode *shownProtocols = NULL;
+static GripScriptNode *shownTasks = NULL;
+static GripScriptNode *shownSteps = NULL;
+// What GoToSpecifiedStep() last showed, so that nothing is redone when a HK packet
+//  points to the same step as the previous one.
+static int shownStep = UNDEFINED;
+static bool shownLive = false;
+static bool shownError = false;
+static char shownPicture[MAX_PATHLENGTH] = "";
+// The picture shown when no step is selected.
+#define BLANK_PICTURE	"blank.bmp"
+// The report of the checks of the scripts is written next to the packet caches, with this after packetBufferPathRoot.
+#define SCRIPT_REPORT_EXTENSION	".scripts.txt"
+// The scripts are checked for changes every so many refresh cycles.
+#define SCRIPT_CHECK_CYCLES	10
+static int scriptCheckCountdown = SCRIPT_CHECK_CYCLES;
 
 // A task is a list of lines made up of steps and comments.
 // Each step has an associated step ID and the picture and message that the GRIP
-// subject will see at that point in the script execution.
-const char *type[MAX_STEPS];
-char picture[MAX_STEPS][MAX_PICTURE_LENGTH];
-char message[MAX_STEPS][MAX_MESSAGE_LENGTH];
-int  stepID[MAX_STEPS];
-// The 'comment' array determines which lines are steps and which are comments.
-// This is used to skip to the next actual step when the 'Next' button in pressed.
-bool comment[MAX_STEPS];
+// subject will see at that point in the script execution. The step list shows the
+// lines of the task in the script tree, where they are kept with their messages and pictures.
+// Line i of the step list is step[i] of the task file, including the dummy first line
+// and the end of the script, at step[nSteps].
 // nSteps holds the number of lines, including comments, in the task script.
 // It is not the number of executable steps. Therefore nSteps is a misnomer.
 int nSteps = 0; 
 
-// These are the 3 types of steps. 
-const char *type_status = "Status (script will continue)";
-const char *type_query =  "Query (waiting for response)";
-const char *type_alert =  "Alert (seen only if error)";
-
-// A convenient macro to hand message/picture pairs.
-// It makes the parsing code more readable, but be careful how it is used.
-// Improper use could lead to side effects that are hard to detect.
-#define add_alert(y,z) { strcpy( message[lines], y ); if ( z ) strcpy( picture[lines], z ); else strcpy( picture[lines], "" ); type[lines] = type_alert; }
+// A line of the task shown in the step list, or NULL if there is no such line.
+static GripScriptStep *ShownLine( int line ) {
+	if ( !shownSteps || line < 0 || line > nSteps ) return( NULL );
+	return( &shownSteps->file->step[line] );
+}
 
-// Parse the specified task file, filling the GUI ListBox and the global tables
-// 'message', 'picture', 'comment' and 'stepID'.
-void GripMMIDesktop::ParseTaskFile ( const char *task_file ) {
+// Load the scripts from the bundle if there is one, otherwise from the text files,
+//  taking over what has not changed from the previous tree.
+static GripScriptTree *LoadScriptTree( GripScriptTree *previous ) {
+	if ( 0 == _access( bundleFile, 0 ) ) return( LoadGripScriptBundle( bundleFile ) );
+	else return( LoadGripScriptTree( scriptFile, previous ) );
+}
 
-	FILE *fp;
+// Have the pictures of a task read in the background, in the order of the steps, so that
+//  they are in memory by the time that the steps are shown (see GripMMIPictureCache.h).
+static void PrefetchTaskPictures( GripScriptFile *task ) {
 
-	// Count the number of lines in the text file / task list.;
-	int lines;
-	// Keep track of the most recent step, excluding comments.
-	int current_step;
-
-	// Buffers used to read in and parse the lines in the task file.
-	int tokens;
-	char *token[MAX_TOKENS];
-	char line[2048];
-	char status_picture[MAX_PICTURE_LENGTH] = "blank.bmp";
-	char status_message[MAX_MESSAGE_LENGTH] = "";
-
-	// A string used to create error messages.
-	char msg[MAX_ERROR_MESSAGE_LENGTH];
-
-	fp = fopen( task_file, "r" );
-	if ( !fp ) {
-		// Signal the error.
-		sprintf( msg, "Error opening task file %s for read.\n", task_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
+	const char **path = (const char **) calloc( task->nSteps + 2, sizeof( const char * ) );
+	char *paths = (char *) malloc( ( task->nSteps + 2 ) * MAX_PATHLENGTH );
+	int count = 0;
+	if ( !path || !paths ) {
+		free( path );
+		free( paths );
 		return;
 	}
-
-	// Clear the menu and reset the list lengths.
-	stepList->Items->Clear();
-	nSteps = 0;
-	lines = 0;
-	current_step = 0;
-
-	// Create a dummy first line, which is a comment.
-	stepList->Items->Add( "<Waiting to start ...>" );
-	strcpy( message[lines], status_message );
-	strcpy( picture[lines], status_picture );
-	type[lines] = type_status;
-	comment[lines] = true;
-	stepID[lines] = current_step;
-	lines++;
-
-	// Step through each line in the file.
-	// Read in the entire line as a character string each time.
-	while ( fgets( line, sizeof( line ), fp ) && lines < MAX_STEPS ) {
-
-		// Make sure the line is a null terminated string.
-		// In the unlikely event that a line in the file exceeds the size of the line buffer,
-		// the line will be truncated and a second line will be read. This will surely generate
-		// an error in the parsing of the second line, so I don't treat the overflow explicitly here.
-		line[strlen( line ) - 1] = 0;
-		// Insert the entire line into the GUI list.
-		String^ line_string = gcnew String( line );
-		stepList->Items->Add( line_string );
-
-		// Now parse the line according to the fields defined by the GRIP ICD.
-		tokens = ParseCommaDelimitedLine( token, line );
-
-		if ( tokens ) {
-
-			// First we hand commands that change the status messag and picture.
-			if ( !strcmp( token[0], "CMD_LOG_MESSAGE" ) ) {
-				int value, items;
-				// CMD_LOG_MESSAGE takes a 0 or a 1 as the second value,
-				// but some scripts use the constants 'logmsg' (0) or 'usermsg' (1).
-				// So here we treat those as a special case to set the value of the second parameter.
-				if ( !strcmp( token[1], "logmsg" ) ) value = 0;
-				else if ( !strcmp( token[1], "usermsg" ) ) value = 1;
-				// If neither 'logmsg' or 'usermsg', then read a 0 or 1.
-				// But if the sscanf fails (items == 0) then default to 0.
-				else {
-					items = sscanf( token[1], "%d", &value );
-					value = items && value;
-				}
-				// Only user messages (value == 1) change the status message that is shown to the subject.
-				// We ignore log messages.
-				if ( value != 0 ) {
-					if ( token[2] ) strcpy( status_message, token[2] );
-					else strcpy( status_message, "" );
-				}
-			}
-			else if ( !strcmp( token[0], "CMD_SET_PICTURE" ) ) {
-				if ( tokens > 1 ) strcpy( status_picture, token[1] );
-				else strcpy( status_picture, "blank.bmp" );
-			}
-
-			// Now interpret actual commands.
-			// CMD_WAIT_SUBJ_READY generates a 'query'.
-			if ( !strcmp( token[0], "CMD_WAIT_SUBJ_READY" ) ) {
-				strcpy( message[lines], token[1] );
-				strcpy( picture[lines], token[2] );
-				type[lines] = type_query;
-			}
-			// The following commands generate 'alerts'.
-			else if ( !strcmp( token[0], "CMD_WAIT_MANIP_ATTARGET" ) ) add_alert( token[13], token[14] )		
-			else if ( !strcmp( token[0], "CMD_WAIT_MANIP_GRIP" ) ) add_alert( token[4], token[5] )
-			else if ( !strcmp( token[0], "CMD_WAIT_MANIP_GRIPFORCE" ) ) add_alert( token[11], token[12] )
-			else if ( !strcmp( token[0], "CMD_WAIT_MANIP_SLIP" ) ) add_alert( token[11], token[12] )
-			else if ( !strcmp( token[0], "CMD_CHK_MASS_SELECTION" ) ) add_alert( "Put mass in cradle X and pick up mass from cradle Y.", "TakeMass.bmp" )
-			else if ( !strcmp( token[0], "CMD_CHK_HW_CONFIG" ) ) add_alert( token[1], token[2] )
-			else if ( !strcmp( token[0], "CMD_ALIGN_CODA" ) ) add_alert( token[1], token[2] )
-			else if ( !strcmp( token[0], "CMD_CHK_CODA_ALIGNMENT" ) ) add_alert( token[4], token[5] )
-			else if ( !strcmp( token[0], "CMD_CHK_CODA_FIELDOFVIEW" ) ) add_alert( token[9], token[10] )
-			else if ( !strcmp( token[0], "CMD_CHK_CODA_PLACEMENT" ) ) add_alert( token[11], token[12] )
-			else if ( !strcmp( token[0], "CMD_CHK_MOVEMENTS_AMPL" ) ) add_alert( token[6], token[7] )
-			else if ( !strcmp( token[0], "CMD_CHK_MOVEMENTS_CYCLES" ) ) add_alert( token[7], token[8] )
-			else if ( !strcmp( token[0], "CMD_CHK_START_POS" ) ) add_alert( token[7], token[8] )
-			else if ( !strcmp( token[0], "CMD_CHK_MOVEMENTS_DIR" ) ) add_alert( token[6], token[7] )
-			else if ( !strcmp( token[0], "CMD_CHK_COLLISIONFORCE" ) ) add_alert( token[4], token[5] )
-			else if ( !strcmp( token[0], "CMD_CHK_MANIP_VISIBILITY" ) ) add_alert( token[3], token[4] )
-			// If it wasn't a 'query' or an 'alert' then it was a 'status' command.
-			else {
-				strcpy( message[lines], status_message );
-				strcpy( picture[lines], status_picture );
-				type[lines] = type_status;
-			}
-			comment[lines] = false;
-			current_step++;
-			stepID[lines] = current_step;
-		}
-		// If there were no tokes, then the line is a comment line.
-		// Use the the most recent status, picture and stepID and mark is as a comment.
-		else {
-			strcpy( message[lines], status_message );
-			strcpy( picture[lines], status_picture );
-			type[lines] = type_status;
-			comment[lines] = true;
-			stepID[lines] = current_step;
-		}
-		// Count the total number of lines.
-		lines++;
+	for ( int line = -1; line <= task->nSteps; line++ ) {
+		const char *picture = ( line < 0 ? BLANK_PICTURE : task->step[line].picture );
+		if ( !*picture ) continue;
+		char *full = paths + count * MAX_PATHLENGTH;
+		_snprintf( full, MAX_PATHLENGTH, "%s%s", pictureFilenamePrefix, picture );
+		full[MAX_PATHLENGTH - 1] = 0;
+		// Most steps show the same picture as the one before.
+		int i;
+		for ( i = count - 1; i >= 0; i-- ) if ( !strcmp( path[i], full ) ) break;
+		if ( i < 0 ) path[count++] = full;
 	}
-	fclose( fp );
+	GripPictureCachePrefetch( path, count );
+	free( path );
+	free( paths );
 
-	// nSteps holds the number of lines in the menu showing the task, including comments 
-	// not the number of real steps. So nSteps is a misnomer.
-	nSteps = lines;
-	// Check for overrun of step buffer.
-	if ( nSteps >= MAX_STEPS ) {
-		// Signal the error, but allow execution to continue.
-		sprintf( msg, "Number of lines in %s exceeds limit.\n", task_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-	}
-	else {
-		// Show the end of the script in the GUI with a final comment line and status message.
-		stepList->Items->Add( "************ End of Script ************" );
-		strcpy( message[lines], "*********** End of Script ***********\n*********** End of Script ***********\n*********** End of Script ***********\n*********** End of Script ***********" );
-		strcpy( picture[lines], "blank.bmp" );
-		type[lines] = type_status;
-		comment[lines] = true;
-		stepID[lines] = 9999;
-	}
 }
 
-// Parse the specified protocol file, filling the GUI ListBox 'taskList'
-//  and the global table 'task_file'.
-void GripMMIDesktop::ParseProtocolFile ( const char *protocol_file ) {
-
-	FILE *fp;
-
-	// Buffers to read in the lines in the protocol file.
-	int tokens;
-	char *token[MAX_TOKENS];
-	char line[2048];
-
-	// Count the number of lines read.
-	int line_n = 0;
-
-	// Initialize the list of tasks in the GUI to empty.
-	taskList->Items->Clear();
-	// Set the number of tasks to zero so that if we exit early
-	// due to an error, the task list will be marked as empty.
-	nTasks = 0;
-
-	// Buffer for constructing error message.
-	char msg[MAX_ERROR_MESSAGE_LENGTH];
-
-	// We want to work in the same directory as the subject file.
-	// Get the directory from the filename.
-	char directory[MAX_PATHLENGTH];
-	// Work backward until we find a backslash, if any.
-	int i;
-	for ( i = strlen( protocol_file ); i >=0; i-- ) {
-		if ( protocol_file[i] == '\\' ) break;
+// Show a picture from the cache, reading it if it has not been read yet.
+// The box gets its own copy of the pixels, so the cache is free to drop them.
+static void ShowPicture( System::Windows::Forms::PictureBox^ box, const char *path ) {
+
+	System::Drawing::Image^ image = nullptr;
+	const GripPicture *picture = GripPictureCacheGet( path );
+	if ( !picture ) fOutputDebugString( "Scripts: cannot read picture %s.\n", path );
+	else if ( picture->pixels ) {
+		System::Drawing::Bitmap^ pixels = gcnew System::Drawing::Bitmap( picture->width, picture->height, picture->width * 4,
+			System::Drawing::Imaging::PixelFormat::Format32bppRgb, System::IntPtr( picture->pixels ) );
+		image = gcnew System::Drawing::Bitmap( pixels );
+		delete pixels;
 	}
-	// Copy what is before the backslash as the directory.
-	// Make it a null-terminated string.
-	strncpy( directory, protocol_file, i + 1 );
-	directory[i+1] = 0;
-
-	// Open the protocol file.
-	fp = fopen( protocol_file, "r" );
-	if ( !fp ) {
-		// Signal the error.
-		sprintf( msg, "Error opening protocol file %s for read.\n", protocol_file );
-		::MessageBox( NULL, msg, "DexScriptRunner", MB_OK | MB_ICONERROR );
-		return;
+	else {
+		// Not a picture that the cache decodes, so decode it from the bytes that it read.
+		array<unsigned char>^ bytes = gcnew array<unsigned char>( (int) picture->nBytes );
+		System::Runtime::InteropServices::Marshal::Copy( System::IntPtr( picture->bytes ), bytes, 0, (int) picture->nBytes );
+		System::IO::MemoryStream^ stream = gcnew System::IO::MemoryStream( bytes );
+		System::Drawing::Image^ decoded = System::Drawing::Image::FromStream( stream );
+		image = gcnew System::Drawing::Bitmap( decoded );
+		delete decoded;
+		delete stream;
 	}
+	GripPictureCacheRelease( picture );
 
-	// Work our way through the protocol file line-by-line.
-	while ( fgets( line, sizeof( line ), fp ) && nTasks <= MAX_MENU_ITEMS ) {
+	System::Drawing::Image^ old = box->Image;
+	box->Image = image;
+	if ( old && old != box->ErrorImage && old != box->InitialImage ) delete old;
 
-		// Split the line into tokens.
-		tokens = ParseCommaDelimitedLine( token, line );
+}
 
-		// Lines in protocol files are divided into 4 fields.
-		if ( tokens == 4 ) {
-			// First parameter must be CMD_TASK.
-			if ( strcmp( token[0], "CMD_TASK" ) ) {
-				sprintf( msg, "%s Line %03d Command not CMD_TASK: %s\n", protocol_file, line_n, token[0] );
-				::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-			}
-			// Second parameter is a task ID. Should be an integer value.
-			if ( 1 != sscanf( token[1], "%d", &taskID[nTasks] ) ) {
-				sprintf( msg, "%s Line %03d Error reading task ID: %s\n", protocol_file, line_n, token[1] );
-				::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-				exit( - 1 );
-			}
-			// The third item is the name of the protocol file.
-			// Check if it is present and readable, unless told to ignore it.
-			if ( !strstr( token[2], "ignore" ) ) {
-				char task_filename[1024];
-				strcpy( task_filename, directory );
-				strcat( task_filename, token[2] );
-				if ( _access( task_filename, 0x00 ) ) {
-					sprintf( msg, "%s Line %03d Cannot access protocol file: %s\n", protocol_file, line_n, task_filename );
-					::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-				}
-				else {
-					// Add the filename to the global list of protocols and to the GUI.
-					strcpy( task_file_list[nTasks], task_filename );
-					taskList->Items->Add( gcnew String( token[3] ) );
-					nTasks++;
-				}
-			}
-		}
-		else if ( tokens != 0 ) {
-			sprintf( msg, "%s Line %03d Wrong number of parameters: %s\n", protocol_file, line_n, line );
-			::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-		}
-		// If tokens is 0, then skip the line as a comment.
-		else {}
-	}
-	fclose( fp );
-	if ( nTasks >= MAX_MENU_ITEMS ) {
-		// Signal the error, but allow execution to continue.
-		sprintf( msg, "Number of items in %s exceeds limit.\n", protocol_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-	}
+// Show the errors found while loading the scripts.
+static void ShowScriptErrors( GripScriptTree *tree ) {
+	if ( tree->errors ) ::MessageBox( NULL, tree->errors, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
 }
 
-// Parse the specified session file, filling the GUI ListBox 'protocolList'
-//  and the global table 'protocol_file'.
-// The parameter session_filename is assumed to be a null terminated string.
-void GripMMIDesktop::ParseSessionFile ( const char *session_file ) {
+// Check the scripts and write what was found to the report file (see GripMMIScriptLint.h).
+// Only the errors that keep the crawler from working are shown in a dialog, so that
+//  starting up does not wait for someone to click through the others.
+static void ReportScripts( GripScriptTree *tree ) {
 
+	char filename[MAX_PATHLENGTH];
 	FILE *fp;
 
-	// Buffer to hold a line from the file;
-	char line[2048];
-	// The line will be broken into tokens (fields).
-	int tokens;
-	char *token[MAX_TOKENS];
-
-	// Count the number of lines read.
-	int line_n = 0;
-
-	// Buffer for constructing error messages.
-	char msg[MAX_ERROR_MESSAGE_LENGTH];
-
-	// Clear the list of protocols in the GUI ListBox.
-	protocolList->Items->Clear();
-
-	// Set the number of protocols to zero. So if we exit early
-	// due to an error, the protocol list will be marked as empty.
-	nProtocols = 0;
-
-	// We want to work in the same directory as the subject file.
-	// Get the directory from the filename.
-	char directory[MAX_PATHLENGTH];
-	// Work backward until we find a backslash, if any.
-	int i;
-	for ( i = strlen( session_file ); i >=0; i-- ) {
-		if ( session_file[i] == '\\' ) break;
+	GripLintReport *report = LintGripScriptTree( tree, pictureFilenamePrefix );
+	if ( _snprintf( filename, sizeof( filename ), "%s%s", packetBufferPathRoot, SCRIPT_REPORT_EXTENSION ) < 0 ) {
+		fOutputDebugString( "Path to the script report is too long. The report will not be written.\n" );
+		filename[sizeof( filename ) - 1] = 0;
 	}
-	// Copy what is before the backslash as the directory.
-	// Make it a null-terminated string.
-	strncpy( directory, session_file, i + 1 );
-	directory[i+1] = 0;
-
-	// Open the session file, if we can.
-	fp = fopen( session_file, "r" );
-	if ( !fp ) {
-		// Signal the error.
-		sprintf( msg, "Error opening session file %s for read.\n", session_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-		return;
+	else if ( !( fp = fopen( filename, "w" ) ) ) {
+		fOutputDebugString( "Error opening script report %s for writing.\n", filename );
 	}
+	else {
+		WriteGripLintReport( report, fp );
+		fclose( fp );
+	}
+	fOutputDebugString( "Scripts: %d errors and %d warnings found in %.3f s (see %s).\n", report->errors, report->warnings, report->seconds, filename );
+	FreeGripLintReport( report );
+	if ( tree->fatal ) ShowScriptErrors( tree );
 
-	// Work our way through the session file line-by-line.
-	while ( fgets( line, sizeof( line ), fp ) && nProtocols < MAX_MENU_ITEMS ) {
+}
 
-		line_n++;
-		tokens = ParseCommaDelimitedLine( token, line );
+// Fill a menu with the entries of a node of the script tree, unless it already shows them.
+static void FillScriptMenu( System::Windows::Forms::ListBox^ list, GripScriptNode *node, GripScriptNode **shown ) {
+	if ( shown ) {
+		if ( *shown == node ) return;
+		*shown = node;
+	}
+	list->BeginUpdate();
+	list->Items->Clear();
+	for ( int i = 0; node && i < node->nEntries; i++ ) list->Items->Add( gcnew String( GripScriptEntry( node, i )->label ) );
+	list->EndUpdate();
+}
 
-		// Lines in session files are divided into 4 fields.
-		if ( tokens == 4 ) {
-			// First parameter must be CMD_PROTOCOL.
-			if ( strcmp( token[0], "CMD_PROTOCOL" ) ) {
-				sprintf( msg, "%s Line %03d Command not CMD_PROTOCOL: %s\n", session_file, line_n, token[0] );
-				::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-			}
-			// Second parameter is a protocol ID. Should be an integer value.
-			if ( 1 != sscanf( token[1], "%d", &protocolID[nProtocols] ) ) {
-				sprintf( msg, "%s Line %03d Error reading protocol ID: %s\n", session_file, line_n, token[1] );
-				::MessageBox( NULL, msg, "DexScriptRunner", MB_OK | MB_ICONERROR );
-				exit( - 1 );
-			}
-			// The third item is the name of the protocol file.
-			// Check if it is present and readable, unless told to ignore it.
-			if ( !strstr( token[2], "ignore" ) ) {
-				char protocol_filename[MAX_PATHLENGTH];
-				strcpy( protocol_filename, directory );
-				strcat( protocol_filename, token[2] );
-				if ( _access( protocol_filename, 0x00 ) ) {
-					sprintf( msg, "%s Line %03d Cannot access protocol file: %s\n", session_file, line_n, protocol_filename );
-					::MessageBox( NULL, msg, "DexScriptRunner", MB_OK | MB_ICONERROR );
-				}
-				else {
-					// Add the filename to the list of protocols.
-					strcpy( protocol_file_list[nProtocols], protocol_filename );
-					// SendDlgItemMessage( IDC_PROTOCOLS, LB_ADDSTRING, 0, (LPARAM) token[3] );
-					protocolList->Items->Add( gcnew String( token[3] ) );
-					nProtocols++;
-				}
-			}
+// Show a parsed task file in the GUI step list, or empty the list if node is NULL.
+// The list is in virtual mode. It only asks for the lines that it shows (see StepListItem()),
+//  so showing a task takes the same time however many lines it has. Nothing is read from disk.
+void GripMMIDesktop::ShowTask ( GripScriptNode *node ) {
 
-		}
-		else if ( tokens != 0 ) {
-			sprintf( msg, "%s Line %03d Wrong number of parameters: %s\n", session_file, line_n, line );
-			::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-			return;
-		}
-		// If tokens is 0, then skip the line as a comment.
-		else {}
-	}
-	fclose( fp );
-	if ( nProtocols >= MAX_MENU_ITEMS ) {
-		// Signal the error, but allow execution to continue.
-		sprintf( msg, "Number of items in %s exceeds limit.\n", session_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
+	if ( node == shownSteps ) return;
+	shownSteps = node;
+	stepList->SelectedIndices->Clear();
+	if ( !node ) {
+		nSteps = 0;
+		stepList->VirtualListSize = 0;
+		return;
 	}
+	// nSteps holds the number of lines in the menu showing the task, including comments 
+	// not the number of real steps. So nSteps is a misnomer.
+	nSteps = node->file->nSteps;
+	// The end of the script is shown in the GUI with a final comment line and status message.
+	stepList->VirtualListSize = nSteps + 1;
+	stepList->EnsureVisible( 0 );
+	stepList->Invalidate();
+	PrefetchTaskPictures( node->file );
 }
 
-// Parse the specified subject file, filling the GUI ListBox 'subjectList'
-//  and the global table 'session_file'.
-// The parameter subject_filename is assumed to be a null terminated string.
-int GripMMIDesktop::ParseSubjectFile ( const char *subject_file ) {
+// The row of the step list for a line of the task.
+System::Windows::Forms::ListViewItem^ GripMMIDesktop::StepListItem( int line ) {
+	GripScriptStep *step = ShownLine( line );
+	return( gcnew System::Windows::Forms::ListViewItem( gcnew String( step ? step->text : "" ) ) );
+}
 
-	FILE *fp;
+// The line selected in the step list, or -1 if none is.
+int GripMMIDesktop::SelectedStep( void ) {
+	if ( stepList->SelectedIndices->Count == 0 ) return( -1 );
+	return( stepList->SelectedIndices[0] );
+}
 
-	// Buffer to hold a line from the file.
-	char line[2048];
-	// Each line will be broken into tokens (fields).
-	int tokens;
-	char *token[MAX_TOKENS];
-
-	// Number of lines in the file.
-	int line_n = 0;
-
-	// Clear the list of protocols in the GUI ListBox.
-	subjectList->Items->Clear();
-	nSubjects = 0;
-
-	// We want to work in the same directory as the subject file.
-	// Get the directory from the filename.
-	char directory[MAX_PATHLENGTH];
-	// Work backward until we find a backslash, if any.
-	int i;
-	for ( i = strlen( subject_file ); i >=0; i-- ) {
-		if ( subject_file[i] == '\\' ) break;
+// Select a line of the step list, or none if line is out of range.
+void GripMMIDesktop::SelectStep( int line ) {
+	if ( !ShownLine( line ) ) {
+		stepList->SelectedIndices->Clear();
+		return;
 	}
-	// Copy what is before the backslash as the directory.
-	// Make it a null-terminated string.
-	strncpy( directory, subject_file, i + 1 );
-	directory[i+1] = 0;
-
-	// Open the subject file, if we can.
-	fp = fopen( subject_file, "r" );
-	if ( !fp ) {
-		char msg[1024];
-		sprintf( msg, "Error opening subject file %s for read.", subject_file );
-		printf( "%s\n", msg );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
+	System::Windows::Forms::ListViewItem^ item = stepList->Items[line];
+	item->Selected = true;
+	item->Focused = true;
+	// Keep the selected step near the top of the box
+	//  so that we can see what is coming next.
+	int top_index = line - 10;
+	if ( top_index < 0 ) top_index = 0;
+	stepList->TopItem = stepList->Items[top_index];
+}
+
+// Load the subject file and all the files below it, or their bundle, and fill the GUI ListBox 'subjectList'.
+// Returns ERROR_EXIT if the crawler cannot work with the scripts.
+int GripMMIDesktop::LoadScripts ( const char *subject_file ) {
+
+	strncpy( scriptFile, subject_file, sizeof( scriptFile ) - 1 );
+	scriptFile[sizeof( scriptFile ) - 1] = 0;
+	strcpy( bundleFile, scriptDirectory );
+	strcat( bundleFile, GRIP_SCRIPT_BUNDLE );
+	scriptTree = LoadScriptTree( NULL );
+	if ( scriptTree->bundleFilename ) fOutputDebugString( "Scripts: bundle %s mapped in %.3f s.\n", bundleFile, scriptTree->seconds );
+	else fOutputDebugString( "Scripts: %d files parsed in %.3f s.\n", scriptTree->parsed, scriptTree->seconds );
+	ReportScripts( scriptTree );
+	if ( scriptTree->fatal ) {
+		printf( "%s", scriptTree->errors );
 		return( ERROR_EXIT );
 	}
+	subjectNode = &scriptTree->node[0];
+	FillScriptMenu( subjectList, subjectNode, NULL );
+	GripPictureCacheOpen( PICTURE_CACHE_BUDGET );
+	return( 0 );
 
-	// Step through line by line and follow the links to the session files.
-	while ( fgets( line, sizeof( line ), fp ) && nSubjects < MAX_MENU_ITEMS ) {
-
-		// Count the lines in the file.
-		line_n++;
-
-		// Break the line into pieces as defined by the DEX/GRIP ICD.
-		tokens = ParseCommaDelimitedLine( token, line );
+}
 
-		// Parse each line and do some syntax error checking.
-		if ( tokens == 5 ) {
+// Called on each refresh cycle. Copy what the picture cache has done to the counters. See GripMMICounters.h.
+void GripMMIDesktop::CountPictures ( void ) {
 
-			// First parameter must be CMD_USER.
-			if ( strcmp( token[0], "CMD_USER" ) ) {
-				char msg[1024];
-				sprintf( msg, "%s Line %03d Command not CMD_USER: %s\n", subject_file, line_n, token[0] );
-				::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-				exit( ERROR_EXIT );
-			}
-			// Second parameter is a subject ID. Should be an integer value.
-			// Verify also that subject IDs are unique.
-			if ( 1 != sscanf( token[1], "%d", &subjectID[nSubjects] ) ) {
-				char msg[1024];
-				// Report error for invalid subject ID field.
-				sprintf( msg, "%s Line %03d Error reading subject ID: %s\n", subject_file, line_n, token[1] );
-				::MessageBox( NULL, msg, "DexScriptRunner", MB_OK | MB_ICONERROR );
-				exit( ERROR_EXIT );
-			}
-			// The third parameter is the name of the session file.
-			// Here we check that it is present and if so, we process it as well.
-			char session_filename[1024];
-			strcpy( session_filename, directory );
-			strcat( session_filename, token[3] );
-			if ( _access( session_filename, 0x00 ) ) {
-				char msg[1024];
-				// The file must not only be present, it also has to be readable.
-				// I had a funny problem with this at one point. Maybe MAC OS had created links.
-				sprintf( msg, "%s Line %03d Cannot access session file: %s\n", subject_file, line_n, session_filename );
-				::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-				exit( ERROR_EXIT );
-			}	
-			else {		
-				strcpy( session_file_list[nSubjects], session_filename );
-				subjectList->Items->Add( gcnew String( token[4] ));
-				nSubjects++;	
-			}
-			// There is a fifth field to the line, which is text describing the subject.
-			// For the moment I don't do any error checking on that parameter.
-		}
-		// If the number of tokens is anything but 0 or 5, it is an error.
-		else if ( tokens != 0 ) {
-			char msg[MAX_ERROR_MESSAGE_LENGTH];
-			sprintf( msg, "%s Line %03d Wrong number of parameters: %s\n", subject_file, line_n, line );
-			::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-			exit( ERROR_EXIT );
-		}	
-		// If the number of tokens is 0, it is a comment or blank line.
-		else {}
-	}
+	GripPictureCacheStats stats;
+	GripPictureCacheGetStats( &stats );
+	CounterSet( CTR_PICTURE_HITS, stats.hits );
+	CounterSet( CTR_PICTURE_MISSES, stats.misses );
+	CounterSet( CTR_PICTURES_PREFETCHED, stats.prefetched );
+	CounterSet( CTR_PICTURES_EVICTED, stats.evicted );
+	CounterSet( CTR_PICTURES, stats.pictures );
+	CounterSet( CTR_PICTURE_BYTES, (__int64) stats.bytes );
 
-	fclose( fp );
-	if ( nSubjects >= MAX_MENU_ITEMS ) {
-		char msg[MAX_ERROR_MESSAGE_LENGTH];
-		// Signal the error, but allow execution to continue.
-		sprintf( msg, "Number of items in %s exceeds limit.\n", subject_file );
-		::MessageBox( NULL, msg, "GRIP Script Crawler", MB_OK | MB_ICONERROR );
-	}
-	return( 0 );
+}
 
+// Called on each refresh cycle. Every so often, check whether the script files have changed
+//  and if so, reload those that have and show the same selections as before.
+void GripMMIDesktop::CheckScripts ( void ) {
+
+	if ( --scriptCheckCountdown > 0 ) return;
+	scriptCheckCountdown = SCRIPT_CHECK_CYCLES;
+	if ( !scriptTree ) return;
+	// A bundle that has just been put in the script directory counts as a change as well.
+	bool bundle_added = ( !scriptTree->bundleFilename && 0 == _access( bundleFile, 0 ) );
+	if ( !bundle_added && !GripScriptTreeChanged( scriptTree ) ) return;
+
+	int subject = subjectList->SelectedIndex;
+	int protocol = protocolList->SelectedIndex;
+	int task = taskList->SelectedIndex;
+	int step = SelectedStep();
+
+	GripScriptTree *tree = LoadScriptTree( scriptTree );
+	FreeGripScriptTree( scriptTree );
+	scriptTree = tree;
+	fOutputDebugString( "Scripts: %d files parsed and %d unchanged in %.3f s.\n", scriptTree->parsed, scriptTree->reused, scriptTree->seconds );
+	ReportScripts( scriptTree );
+	GripPictureCacheFlush();
+	shownPicture[0] = 0;
+
+	// The nodes of the new tree may be where those of the old one were, so empty the lists.
+	subjectNode = &scriptTree->node[0];
+	sessionNode = protocolNode = taskNode = NULL;
+	FillScriptMenu( subjectList, subjectNode, NULL );
+	FillScriptMenu( protocolList, NULL, NULL );
+	FillScriptMenu( taskList, NULL, NULL );
+	shownProtocols = shownTasks = NULL;
+	ShowTask( NULL );
+	shownStep = UNDEFINED;
+	GoToSpecifiedSubject( subject );
+	if ( protocol >= 0 ) GoToSpecifiedProtocol( protocol );
+	if ( task >= 0 ) GoToSpecifiedTask( task );
+	if ( step >= 0 && step < nSteps ) GoToSpecifiedStep( step );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -577,21 +355,20 @@ int GripMMIDesktop::ParseSubjectFile ( const char *subject_file ) {
 //  and show the specified subject as the selected subject in the subjectList ListBox.
 void GripMMIDesktop::GoToSpecifiedSubject( int subject ) 
 {
-	if ( subject < 0 || subject >= nSubjects ) {
+	sessionNode = GripScriptChild( scriptTree, subjectNode, subject );
+	if ( !sessionNode ) {
 		// If subject index is out of range, show no subject selected.
 		subjectList->SelectedIndex = -1;
 		subjectIDBox->Text = "";
 		// Clear the protocol list to reflect that there is no subject selected.
-		protocolList->Items->Clear();
-		nProtocols = 0;
+		FillScriptMenu( protocolList, NULL, &shownProtocols );
 	}
 	else {
-		// Parse the session file associated with this subject.
-		// This will reload the list of protocols stored in global variable protocol_file_list.
-		ParseSessionFile( session_file_list[subject] );
+		// Show the protocols of the session file associated with this subject.
+		FillScriptMenu( protocolList, sessionNode, &shownProtocols );
 		// Show which subject is selected in both the ListBox and TextBox of the GUI.
 		subjectList->SelectedIndex = subject;
-		subjectIDBox->Text = Convert::ToString( subjectID[subject] );
+		subjectIDBox->Text = Convert::ToString( GripScriptEntry( subjectNode, subject )->id );
 	}	
 	// We don't know yet what protocol will be selected.
 	GoToSpecifiedProtocol( UNDEFINED );
@@ -601,21 +378,20 @@ void GripMMIDesktop::GoToSpecifiedSubject( int subject )
 //  and show it as the selected protocol in the protocolList ListBox.
 void GripMMIDesktop::GoToSpecifiedProtocol( int protocol ) 
 {
-	if ( protocol < 0 || protocol >= nProtocols ) {
+	protocolNode = GripScriptChild( scriptTree, sessionNode, protocol );
+	if ( !protocolNode ) {
 		// If out of range, show no protocol selected.
 		protocolList->SelectedIndex = -1;
 		protocolIDBox->Text = "";
 		// Clear the protocol list to reflect that there is no subject selected.
-		taskList->Items->Clear();
-		nTasks = 0;
+		FillScriptMenu( taskList, NULL, &shownTasks );
 	}
 	else {
-		// Parse the protocol file associated with the selected protocol.
-		// This will reload the list of tasks stored in the global variable task_file_list.
-		ParseProtocolFile( protocol_file_list[protocol] );
+		// Show the tasks of the protocol file associated with the selected protocol.
+		FillScriptMenu( taskList, protocolNode, &shownTasks );
 		// Show which protocol is selected in the ListBox and TextBox of the GUI.
 		protocolList->SelectedIndex = protocol;
-		protocolIDBox->Text = Convert::ToString( protocolID[protocol] );
+		protocolIDBox->Text = Convert::ToString( GripScriptEntry( sessionNode, protocol )->id );
 	}	
 	// We don't know yet what task will be selected.
 	GoToSpecifiedTask( UNDEFINED );
@@ -625,56 +401,66 @@ void GripMMIDesktop::GoToSpecifiedProtocol( int protocol )
 //  and show it as the selected task in the taskList ListBox.
 void GripMMIDesktop::GoToSpecifiedTask( int task ) 
 {
-	if ( task < 0 || task >= nTasks ) {
+	taskNode = GripScriptChild( scriptTree, protocolNode, task );
+	if ( !taskNode ) {
 		// If task is out of range, show no task selected.
 		taskList->SelectedIndex = -1;
 		taskIDBox->Text = "";
 		// Clear the step list to reflect that there is no task selected.
-		stepList->Items->Clear();
-		nSteps = 0;
+		ShowTask( NULL );
 	}
 	else {
-		// Load the steps in the selected task.
-		ParseTaskFile( task_file_list[task] );
+		// Show the steps of the selected task.
+		ShowTask( taskNode );
 		// Show which task is selected in the ListBox and TextBox of the GUI.
 		taskList->SelectedIndex = task;
-		taskIDBox->Text = Convert::ToString( taskID[task] );
+		taskIDBox->Text = Convert::ToString( GripScriptEntry( protocolNode, task )->id );
 	}	
 	// We don't know yet what protocol will be selected.
 	GoToSpecifiedStep( UNDEFINED );
 }
 
 // Given an index into the current list of steps, update the message, picture and status accordingly 
-//  and show the specified stap as the selected step in the stepList ListBox.
+//  and show the specified stap as the selected step in the step list.
 void GripMMIDesktop::GoToSpecifiedStep( int step ) 
 {
 	char local_message[1024], local_picture[1024];
-
-	if ( step <= 0 ) {
+	const char *step_message, *step_picture;
+
+	// Nothing to do if the same step is shown in the same way already.
+	// Selecting a line of the step list also comes back here through stepList_SelectedIndexChanged.
+	if ( step < 0 ) step = UNDEFINED;
+	if ( step == shownStep && scriptLiveCheckbox->Checked == shownLive && scriptErrorCheckbox->Checked == shownError ) return;
+	shownStep = step;
+	shownLive = scriptLiveCheckbox->Checked;
+	shownError = scriptErrorCheckbox->Checked;
+
+	GripScriptStep *line = ShownLine( step );
+	if ( step <= 0 || !line ) {
 		// If step is out of range, show no step selected.
 		stepIDBox->Text = "";
-		stepList->SelectedIndex = -1;
+		SelectStep( UNDEFINED );
 		// Clear the DEX display;
-		strcpy( local_message, "" );
-		strcpy( local_picture, "blank.bmp" );
+		step_message = "";
+		step_picture = BLANK_PICTURE;
 		fullStepForm->fullStep->Text = "";
 		messageTypeBox->Text =	"";
 	}
 	else {
 		// Center the selected line in the box.
 		// This allows us to see what is going to come next.
-		stepList->SelectedIndex = step;
-		stepIDBox->Text = Convert::ToString( stepID[step] );
+		SelectStep( step );
+		stepIDBox->Text = Convert::ToString( line->stepID );
 
 		// Show the full line in a larger, popup text box.
 		// This box is typically hidden but can be shown by right-clicking on the step menu.
-		fullStepForm->fullStep->Text = stepList->SelectedItem->ToString();
+		fullStepForm->fullStep->Text = gcnew String( line->text );
 
 		// Update the representation of the GRIP display.
 		// There are 'fake' buttons that show which options the user sees on the GRIP touchscreen.
 		// Show or hide buttons according to what kind of text and message is current (status, query, alert).
 		// Then show the picture and message that the subject sees at this step in the script.
-		if ( type[step] == type_alert ) {
+		if ( line->type == type_alert ) {
 			fakeOK->Visible = false;
 			fakeRetry->Visible = true;
 			fakeIgnore->Visible = true;
@@ -690,25 +476,25 @@ void GripMMIDesktop::GoToSpecifiedStep( int step )
 			// an error state or not.
 			if ( scriptLiveCheckbox->Checked && scriptErrorCheckbox->Checked ) {
 				// Error state means that the alert has been triggered.
-				strcpy( local_message, message[step] );
-				strcpy( local_picture, picture[step] );
+				step_message = line->message;
+				step_picture = line->picture;
 				messageTypeBox->Text = "Alert (triggered)";
 			}
 			else if ( scriptLiveCheckbox->Checked ) {
 				// Live, but no error state means that the test is still pending.
-				strcpy( local_message, "Test pending ..." );
-				strcpy( local_picture, "blank.bmp" );
+				step_message = "Test pending ...";
+				step_picture = BLANK_PICTURE;
 				messageTypeBox->Text = "Alert (not triggered)";
 			}
 			else {
 				// Not 'live' means that we are navigating through the script manually.
 				// So here we show what could happen when the subject gets to this point in the script.
-				strcpy( local_message, message[step] );
-				strcpy( local_picture, picture[step] );
+				step_message = line->message;
+				step_picture = line->picture;
 				messageTypeBox->Text = "Alert (shown if error)";
 			}
 		}
-		else if ( type[step] == type_query ) {
+		else if ( line->type == type_query ) {
 			// Show the options available to the subject when queried.
 			fakeOK->Visible = true;
 			fakeRetry->Visible = false;
@@ -716,8 +502,8 @@ void GripMMIDesktop::GoToSpecifiedStep( int step )
 			fakeCancel->Visible = true;
 			fakeInterrupt->Visible = false;
 			// The text and picture of the query.
-			strcpy( local_message, message[step] );
-			strcpy( local_picture, picture[step] );
+			step_message = line->message;
+			step_picture = line->picture;
 			// Inidicate that GRIP is waiting for the subject to respond.
 			messageTypeBox->Text = "Query (Awaiting user response)";
 		}
@@ -727,14 +513,18 @@ void GripMMIDesktop::GoToSpecifiedStep( int step )
 			fakeIgnore->Visible = false;
 			fakeCancel->Visible = false;
 			fakeInterrupt->Visible = true;
-			strcpy( local_message, message[step] );
-			strcpy( local_picture, picture[step] );
+			step_message = line->message;
+			step_picture = line->picture;
 			messageTypeBox->Text = "Status (Script will continue)";
 		}
 	}
 
 	// Show the text message.
 	// Convert and \n escape sequences within the message to newline. 
+	strncpy( local_message, step_message, sizeof( local_message ) - 1 );
+	local_message[sizeof( local_message ) - 1] = 0;
+	strncpy( local_picture, step_picture, sizeof( local_picture ) - 1 );
+	local_picture[sizeof( local_picture ) - 1] = 0;
 	for ( char *ptr = local_message; *ptr; ptr++ ) {
 		if ( *ptr == '\\' && *(ptr+1) == 'n' ) {
 			*ptr = '\r';
@@ -743,16 +533,27 @@ void GripMMIDesktop::GoToSpecifiedStep( int step )
 	}
 	dexText->Text = gcnew String( local_message );
 
-	// Show the picture.
-	if ( strlen( local_picture ) ) {
+	// Show the picture, if it is not the one that is shown already.
+	// It has normally been read in the background when the task was selected.
+	if ( strlen( local_picture ) && strcmp( local_picture, shownPicture ) ) {
 		char picture_path[1024];
 		strcpy( picture_path, pictureFilenamePrefix );
 		strcat( picture_path, local_picture );
-		dexPicture->ImageLocation = gcnew String( picture_path );
-		dexPicture->Load();
+		ShowPicture( dexPicture, picture_path );
+		strncpy( shownPicture, local_picture, sizeof( shownPicture ) - 1 );
 	}
 }
 
+// Go to the line after the selected one that is not a comment, or to the end of the script.
+void GripMMIDesktop::GoToNextStep( void ) 
+{
+	if ( !shownSteps ) return;
+	int line = SelectedStep() + 1;
+	while ( line < nSteps && shownSteps->file->step[line].comment ) line++;
+	if ( line > nSteps ) line = nSteps;
+	GoToSpecifiedStep( line );
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Position the script selections according to the specified user, protocol, task and step IDs.
@@ -772,23 +573,19 @@ void GripMMIDesktop::GoToSpecifiedIDs( int subject_id, int protocol_id, int task
 
 	// Which subject is already selected?
 	current_selection = subjectList->SelectedIndex;
-	// Look for the desired subject ID in the table of available subject IDs.
-	for ( i = 0; i < nSubjects - 1; i++ ) {
-		if ( subjectID[i] == subject_id ) break;
-	}
-	// If we did not find the desired subject ID ...
-	if ( subjectID[i] != subject_id ) GoToSpecifiedSubject( UNDEFINED );
+	// Look for the desired subject ID in the menu of subjects.
+	i = GripScriptFindEntry( subjectNode, subject_id );
+	// If we did not find the desired subject ID and one is selected ...
+	if ( i < 0 ) { if ( current_selection >= 0 ) GoToSpecifiedSubject( UNDEFINED ); }
 	// If we found the desired ID and it is not already selected, change the selection.
 	else if ( i != current_selection ) GoToSpecifiedSubject( i );
 
 	// Which protocol is already selected?
 	current_selection = protocolList->SelectedIndex;
-	// Look for the desired protocol ID in the table of available protocols.
-	for ( i = 0; i < nProtocols - 1; i++ ) {
-		if ( protocolID[i] == protocol_id ) break;
-	}
-	// If we do not find the desired protocol ...
-	if ( protocolID[i] != protocol_id ) GoToSpecifiedProtocol( UNDEFINED );
+	// Look for the desired protocol ID in the menu of protocols.
+	i = GripScriptFindEntry( sessionNode, protocol_id );
+	// If we do not find the desired protocol and one is selected ...
+	if ( i < 0 ) { if ( current_selection >= 0 ) GoToSpecifiedProtocol( UNDEFINED ); }
 	// If we found the desired and it is not already selected, change the selection.
 	else if ( i != current_selection ) GoToSpecifiedProtocol( i );
 
@@ -806,12 +603,10 @@ void GripMMIDesktop::GoToSpecifiedIDs( int subject_id, int protocol_id, int task
 	// If task_id and step_id are zero, but not for the first time, do nothing.
 	else if ( task_id == 0 && step_id == 0 ) {}
 	else {
-		// Look for the desired task ID in the table of available tasks.
-		for ( i = 0; i < nTasks; i++ ) {
-			if ( taskID[i] == task_id ) break;
-		}
-		// If we do not find the desired task ...
-		if ( taskID[i] != task_id ) GoToSpecifiedTask( UNDEFINED );
+		// Look for the desired task ID in the menu of tasks.
+		i = GripScriptFindEntry( protocolNode, task_id );
+		// If we do not find the desired task and one is selected ...
+		if ( i < 0 ) { if ( current_selection >= 0 ) GoToSpecifiedTask( UNDEFINED ); }
 		// If we found the desired and it is not already selected, change the selection.
 		else if ( i != current_selection ) {
 			GoToSpecifiedTask( i );
@@ -821,10 +616,41 @@ void GripMMIDesktop::GoToSpecifiedIDs( int subject_id, int protocol_id, int task
 	}
 
 	// Find the desired step number and go to it. Or to the nearest possible.
-	for ( i = 0; i < nSteps; i++ ) {
-		if ( stepID[i] >= step_id ) break;
-	}
+	if ( !taskNode ) i = 0;
+	else i = GripScriptFindStep( taskNode->file, step_id );
 	GoToSpecifiedStep( i );
 
 }
 
+// Show the data recorded while GRIP was at the selected step, as found in the HK packets (see
+//  GripMMITimeline.h). If the step has been run more than once, the latest run is shown.
+void GripMMIDesktop::ShowStepData( void ) 
+{
+	int subject = subjectList->SelectedIndex;
+	int protocol = protocolList->SelectedIndex;
+	int task = taskList->SelectedIndex;
+	int step = SelectedStep();
+	if ( subject < 0 || protocol < 0 || task < 0 || step <= 0 || step > nSteps ) return;
+	int step_id = ShownLine( step )->stepID;
+
+	int user_id = GripScriptEntry( subjectNode, subject )->id;
+	int protocol_id = GripScriptEntry( sessionNode, protocol )->id;
+	int task_id = GripScriptEntry( protocolNode, task )->id;
+	int i = TimelineLastStepInterval( &gripTimeline, user_id, protocol_id, task_id, step_id );
+	if ( i < 0 ) {
+		fOutputDebugString( "Scripts: no data for user %d protocol %d task %d step %d.\n", user_id, protocol_id, task_id, step_id );
+		return;
+	}
+	// A change in the status of the script engine starts a new interval within the same run.
+	while ( i > 0 ) {
+		const GripTimelineInterval *previous = TimelineInterval( &gripTimeline, i - 1 );
+		if ( previous->nextSameStep != i || previous->stop != TimelineInterval( &gripTimeline, i )->start ) break;
+		i--;
+	}
+
+	// Stop following the latest data and show the start of the step.
+	dataLiveCheckbox->Checked = false;
+	MoveToInstant( TimelineInterval( &gripTimeline, i )->start );
+	RefreshGraphics();
+
+}
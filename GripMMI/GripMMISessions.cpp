@@ -0,0 +1,205 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Recorded sessions, loaded side by side to be compared. See GripMMISessions.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+#include <process.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <io.h>
+#include <sys\types.h>
+#include <sys\stat.h>
+
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+
+#include "GripMMIGlobals.h"
+#include "GripMMIFrameStore.h"
+#include "GripMMIFrameDecoder.h"
+#include "GripMMITimeline.h"
+#include "GripMMISessions.h"
+
+// No more loader threads than this, whatever the number of processors.
+#define MAX_SESSION_THREADS	64
+
+typedef struct {
+	GripSession		**session;
+	const char		**root;
+	int				*order;			// Largest RT cache first.
+	int				count;
+	double			filterConstant;
+	volatile LONG	next;
+} SessionWork;
+
+static void *SessionAllocate( size_t size ) {
+	void *memory = calloc( 1, size );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for a recorded session." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+// Add the HK packets of the session to its timeline.
+static int LoadGripSessionHK( GripTimeline *timeline, const char *root ) {
+
+	EPMTelemetryPacket		packet;
+	EPMTelemetryHeaderInfo	epmHeader;
+	GripHealthAndStatusInfo	hk;
+	char filename[1024];
+	int packets = 0;
+
+	CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_HK_BULK_PACKET, root );
+	FILE *fp = fopen( filename, "rb" );
+	if ( !fp ) return( 0 );
+	// A partial packet at the end is ignored, as for the RT cache.
+	while ( 1 == fread( &packet, hkPacketLengthInBytes, 1, fp ) ) {
+		ExtractEPMTelemetryHeaderInfo( &epmHeader, &packet );
+		if ( epmHeader.epmSyncMarker != EPM_TELEMETRY_SYNC_VALUE || epmHeader.TMIdentifier != GRIP_HK_ID ) {
+			fMessageBox( MB_OK, "GripMMI", "Unrecognized packet %d in %s.", packets, filename );
+			exit( -1 );
+		}
+		ExtractGripHealthAndStatusInfo( &hk, &packet );
+		TimelineAddHK( timeline, &hk, (double) EPMtoSeconds( &epmHeader ) );
+		packets++;
+	}
+	fclose( fp );
+	return( packets );
+
+}
+
+GripSession *LoadGripSession( const char *root, double filter_constant ) {
+
+	char filename[1024];
+	LARGE_INTEGER frequency, start, finish;
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	GripSession *session = (GripSession *) SessionAllocate( sizeof( GripSession ) );
+	session->root = _strdup( root );
+	CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_RT_SCIENCE_PACKET, root );
+	session->frames = LoadGripFrameStore( filename, filter_constant, &session->rtPackets );
+	session->timeline = CreateTimeline();
+	session->hkPackets = LoadGripSessionHK( session->timeline, root );
+	QueryPerformanceCounter( &finish );
+	session->seconds = (double) ( finish.QuadPart - start.QuadPart ) / (double) frequency.QuadPart;
+	return( session );
+
+}
+
+void FreeGripSession( GripSession *session ) {
+	if ( !session ) return;
+	free( session->root );
+	FreeGripFrameStore( session->frames );
+	FreeTimeline( session->timeline );
+	free( session );
+}
+
+static unsigned __stdcall LoadSessionThread( void *parameter ) {
+	SessionWork *work = (SessionWork *) parameter;
+	for ( int i = InterlockedIncrement( &work->next ) - 1; i < work->count; i = InterlockedIncrement( &work->next ) - 1 ) {
+		int which = work->order[i];
+		work->session[which] = LoadGripSession( work->root[which], work->filterConstant );
+	}
+	return( 0 );
+}
+
+void LoadGripSessions( GripSession *session[], const char *root[], int count, double filter_constant ) {
+
+	SessionWork work;
+	HANDLE thread[MAX_SESSION_THREADS];
+	SYSTEM_INFO system;
+	__int64 *size;
+	char filename[1024];
+	int threads, max_threads;
+
+	if ( count <= 0 ) return;
+
+	// The threads take the sessions in order of decreasing size, so that the largest
+	//  is not the last to start.
+	work.order = (int *) SessionAllocate( count * sizeof( int ) );
+	size = (__int64 *) SessionAllocate( count * sizeof( __int64 ) );
+	for ( int i = 0; i < count; i++ ) {
+		struct _stat64 status;
+		CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_RT_SCIENCE_PACKET, root[i] );
+		size[i] = ( _stat64( filename, &status ) == 0 ? status.st_size : 0 );
+		int j;
+		for ( j = i; j > 0 && size[work.order[j - 1]] < size[i]; j-- ) work.order[j] = work.order[j - 1];
+		work.order[j] = i;
+	}
+	free( size );
+
+	work.session = session;
+	work.root = root;
+	work.count = count;
+	work.filterConstant = filter_constant;
+	work.next = 0;
+
+	// One thread per processor, this one included.
+	GetSystemInfo( &system );
+	max_threads = (int) system.dwNumberOfProcessors;
+	if ( max_threads > MAX_SESSION_THREADS ) max_threads = MAX_SESSION_THREADS;
+	for ( threads = 0; threads < max_threads - 1 && threads < count - 1; threads++ ) {
+		thread[threads] = (HANDLE) _beginthreadex( NULL, 0, LoadSessionThread, &work, 0, NULL );
+		if ( !thread[threads] ) break;
+	}
+	LoadSessionThread( &work );
+	for ( int i = 0; i < threads; i++ ) {
+		WaitForSingleObject( thread[i], INFINITE );
+		CloseHandle( thread[i] );
+	}
+	free( work.order );
+
+}
+
+double GripSessionStepStart( const GripSession *session, int user, int protocol, int task, int step ) {
+	int first = TimelineFirstStepInterval( session->timeline, user, protocol, task, step );
+	if ( first < 0 ) return( MISSING_DOUBLE );
+	return( TimelineInterval( session->timeline, first )->start );
+}
+
+int DecimateGripChannel( const GripFrameStore *store, const double *channel, int stride, const uint32_t *validity,
+						 double origin, double first, double period, int bins, double *output ) {
+
+	int filled = 0;
+	double start = origin + first;
+
+	// The frames are in time order, so the first frame of the first bin is found by bisection
+	//  and then the frames are taken in turn.
+	int frame = FindStoreFrame( store, start );
+	if ( frame < 0 ) frame = 0;
+	else if ( store->realMarkerTime[frame] < start ) frame++;
+
+	for ( int bin = 0; bin < bins; bin++ ) {
+		double stop = start + ( bin + 1 ) * period;
+		double sum = 0.0;
+		int n = 0;
+		for ( ; frame < (int) store->nFrames && store->realMarkerTime[frame] < stop; frame++ ) {
+			if ( validity && !FrameIsValid( validity, frame ) ) continue;
+			sum += channel[(size_t) frame * stride];
+			n++;
+		}
+		if ( n > 0 ) {
+			output[bin] = sum / n;
+			filled++;
+		}
+		else output[bin] = MISSING_DOUBLE;
+	}
+	return( filled );
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Recorded sessions, loaded side by side to be compared.
+
+// A session is the pair of packet caches (RT and HK) written under one packet buffer root.
+// Each session gets a frame store sized to its RT cache and a timeline of its HK packets,
+//  so that nothing is shared with the session shown by GripMMI (gripFrames and gripTimeline)
+//  or with the other sessions. LoadGripSessions() therefore decodes several sessions at once,
+//  one per processor, starting with the largest, so that loading ten sessions takes about as
+//  long as loading the largest of them on its own.
+// To compare the sessions, each is put on a time base of its own that starts when a given step
+//  was first run, per its timeline, and its channels are reduced to the same bins of that time.
+
+#include "..\Grip\GripPackets.h"
+
+#include "GripMMIFrameStore.h"
+#include "GripMMITimeline.h"
+
+typedef struct {
+	char			*root;
+	GripFrameStore	*frames;
+	GripTimeline	*timeline;
+	int				rtPackets;
+	int				hkPackets;
+	// Time taken to load the session, in seconds.
+	double			seconds;
+} GripSession;
+
+// Load one session, given the packet buffer root of its caches. The frames are filtered
+//  with filter_constant (see DexAnalogMixin.h). If there is no HK cache the timeline is empty.
+GripSession *LoadGripSession( const char *root, double filter_constant );
+void FreeGripSession( GripSession *session );
+
+// Load count sessions at the same time. session[i] gets the session of root[i].
+void LoadGripSessions( GripSession *session[], const char *root[], int count, double filter_constant );
+
+// EPM time at which the session first went to the given step, or MISSING_DOUBLE if it never did.
+double GripSessionStepStart( const GripSession *session, int user, int protocol, int task, int step );
+
+// Reduce a channel to bins of period seconds, the first starting first seconds after origin.
+// The channel is read every stride doubles, as with &store->manipulandumPosition[0][Y] and
+//  a stride of 3, and only from the frames that are valid according to validity (all if NULL).
+// Each bin gets the mean of its frames, or MISSING_DOUBLE if it has none.
+// Returns the number of bins that got a value.
+int DecimateGripChannel( const GripFrameStore *store, const double *channel, int stride, const uint32_t *validity,
+						 double origin, double first, double period, int bins, double *output );
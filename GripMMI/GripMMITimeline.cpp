@@ -0,0 +1,163 @@
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Which script step GRIP was at, over time. See GripMMITimeline.h.
+
+#include "stdafx.h"
+#include <Windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+
+#include "GripMMITimeline.h"
+
+// Room for this many intervals at first. The array doubles when it fills up.
+#define TIMELINE_INITIAL_INTERVALS	1024
+
+// The timeline of the session shown by GripMMI.
+GripTimeline gripTimeline = { NULL, 0, 0, NULL, 0, 0, 0.0 };
+
+static void *TimelineAllocate( void *memory, size_t bytes ) {
+	memory = realloc( memory, bytes );
+	if ( !memory ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for the script timeline." );
+		exit( -1 );
+	}
+	return( memory );
+}
+
+// The IDs of a step in one number. The high bit keeps it from being 0.
+static unsigned long long TimelineKey( int user, int protocol, int task, int step ) {
+	return( 0x8000000000000000ULL | (unsigned long long) ( user & 0xFFFF ) << 48 | (unsigned long long) ( protocol & 0xFFFF ) << 32
+		| (unsigned long long) ( task & 0xFFFF ) << 16 | (unsigned long long) ( step & 0xFFFF ) );
+}
+
+static GripTimelineStep *FindTimelineStep( const GripTimeline *timeline, unsigned long long key ) {
+	if ( !timeline->nStepSlots ) return( NULL );
+	int mask = timeline->nStepSlots - 1;
+	unsigned long long hash = key * 0x9E3779B97F4A7C15ULL;
+	for ( int slot = (int) ( hash >> 32 ) & mask; ; slot = ( slot + 1 ) & mask ) {
+		GripTimelineStep *step = &timeline->stepSlot[slot];
+		if ( step->key == key || step->key == 0 ) return( step );
+	}
+}
+
+// Keep the table at most half full.
+static void GrowTimelineSteps( GripTimeline *timeline ) {
+	GripTimelineStep *old = timeline->stepSlot;
+	int old_slots = timeline->nStepSlots;
+	timeline->nStepSlots = ( old_slots ? 2 * old_slots : 256 );
+	timeline->stepSlot = (GripTimelineStep *) calloc( timeline->nStepSlots, sizeof( GripTimelineStep ) );
+	if ( !timeline->stepSlot ) {
+		fMessageBox( MB_OK, "GripMMI", "Error allocating memory for the script timeline." );
+		exit( -1 );
+	}
+	for ( int i = 0; i < old_slots; i++ ) if ( old[i].key ) *FindTimelineStep( timeline, old[i].key ) = old[i];
+	free( old );
+}
+
+GripTimeline *CreateTimeline( void ) {
+	GripTimeline *timeline = (GripTimeline *) TimelineAllocate( NULL, sizeof( GripTimeline ) );
+	memset( timeline, 0, sizeof( *timeline ) );
+	return( timeline );
+}
+
+void FreeTimeline( GripTimeline *timeline ) {
+	if ( !timeline ) return;
+	ResetTimeline( timeline );
+	free( timeline );
+}
+
+void ResetTimeline( GripTimeline *timeline ) {
+	free( timeline->interval );
+	free( timeline->stepSlot );
+	timeline->interval = NULL;
+	timeline->stepSlot = NULL;
+	timeline->nIntervals = timeline->maxIntervals = 0;
+	timeline->nStepSlots = timeline->nSteps = 0;
+	timeline->lastInstant = 0.0;
+}
+
+void TimelineAddHK( GripTimeline *timeline, const GripHealthAndStatusInfo *hk, double instant ) {
+
+	int n = timeline->nIntervals;
+	GripTimelineInterval *last = ( n > 0 ? &timeline->interval[n - 1] : NULL );
+	bool contiguous = ( last && instant - timeline->lastInstant <= TIMELINE_BREAK_THRESHOLD );
+	timeline->lastInstant = instant;
+
+	// Nothing new, so the current interval just gets longer.
+	if ( contiguous ) {
+		last->stop = instant;
+		if ( last->user == hk->user && last->protocol == hk->protocol && last->task == hk->task
+			&& last->step == hk->step && last->scriptEngineStatus == hk->scriptEngineStatusEnum ) return;
+	}
+
+	if ( n >= timeline->maxIntervals ) {
+		timeline->maxIntervals = ( timeline->maxIntervals ? 2 * timeline->maxIntervals : TIMELINE_INITIAL_INTERVALS );
+		timeline->interval = (GripTimelineInterval *) TimelineAllocate( timeline->interval, timeline->maxIntervals * sizeof( GripTimelineInterval ) );
+	}
+	GripTimelineInterval *next = &timeline->interval[n];
+	next->start = next->stop = instant;
+	next->user = hk->user;
+	next->protocol = hk->protocol;
+	next->task = hk->task;
+	next->step = hk->step;
+	next->scriptEngineStatus = hk->scriptEngineStatusEnum;
+	next->nextSameStep = -1;
+
+	// Chain it to the previous intervals of the same step.
+	if ( 2 * ( timeline->nSteps + 1 ) > timeline->nStepSlots ) GrowTimelineSteps( timeline );
+	unsigned long long key = TimelineKey( hk->user, hk->protocol, hk->task, hk->step );
+	GripTimelineStep *step = FindTimelineStep( timeline, key );
+	if ( step->key ) timeline->interval[step->last].nextSameStep = n;
+	else {
+		step->key = key;
+		step->first = n;
+		timeline->nSteps++;
+	}
+	step->last = n;
+	timeline->nIntervals++;
+
+}
+
+int TimelineIntervals( const GripTimeline *timeline ) {
+	return( timeline->nIntervals );
+}
+
+const GripTimelineInterval *TimelineInterval( const GripTimeline *timeline, int index ) {
+	if ( index < 0 || index >= timeline->nIntervals ) return( NULL );
+	return( &timeline->interval[index] );
+}
+
+int TimelineFindInstant( const GripTimeline *timeline, double instant ) {
+	const GripTimelineInterval *interval = timeline->interval;
+	if ( timeline->nIntervals == 0 || instant < interval[0].start ) return( -1 );
+	int low = 0, high = timeline->nIntervals - 1;
+	while ( low < high ) {
+		int mid = ( low + high + 1 ) / 2;
+		if ( interval[mid].start <= instant ) low = mid;
+		else high = mid - 1;
+	}
+	return( low );
+}
+
+int TimelineFirstStepInterval( const GripTimeline *timeline, int user, int protocol, int task, int step ) {
+	GripTimelineStep *slot = FindTimelineStep( timeline, TimelineKey( user, protocol, task, step ) );
+	return( slot && slot->key ? slot->first : -1 );
+}
+
+int TimelineLastStepInterval( const GripTimeline *timeline, int user, int protocol, int task, int step ) {
+	GripTimelineStep *slot = FindTimelineStep( timeline, TimelineKey( user, protocol, task, step ) );
+	return( slot && slot->key ? slot->last : -1 );
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+///
+/// Module:	GripMMI
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// Which script step GRIP was at, over time.
+
+// Each HK packet says where the GRIP script engine is (user, protocol, task and step IDs and
+//  the status of the engine). As the HK packets are read, consecutive packets that say the same
+//  thing are merged into one interval of EPM time, the time base of RealMarkerTime[] in the
+//  frame store (see GripMMIFrameStore.h). The strip charts use the intervals to mark where each
+//  step starts, and the script crawler to find the data of a step.
+// The intervals are kept in time order, so the interval at a given instant is found by bisection.
+//  The intervals of each step are chained together from a hash table, so the times at which a
+//  given step was run are found without going through the others.
+// Unlike the frames, the intervals are never dropped in live tail mode, so they cover the whole session.
+// GripMMI keeps the timeline of the session that it shows in gripTimeline. The sessions that
+//  are compared with it (see GripMMISessions.h) each have a timeline of their own.
+
+#include "..\Grip\GripPackets.h"
+
+// A gap this long between HK packets, in seconds, ends an interval even if nothing has changed.
+// HK packets normally come once a second.
+#define TIMELINE_BREAK_THRESHOLD	5.0
+
+typedef struct {
+	double			start;			// EPM time of the first HK packet of the interval.
+	double			stop;			// Of the next interval, or of the last packet before a gap.
+	unsigned short	user;
+	unsigned short	protocol;
+	unsigned short	task;
+	unsigned short	step;
+	unsigned short	scriptEngineStatus;
+	int				nextSameStep;	// The next interval with the same IDs, or -1.
+} GripTimelineInterval;
+
+// The first and last intervals of each step, found by open addressing.
+typedef struct {
+	unsigned long long	key;		// 0 for an empty slot.
+	int					first;
+	int					last;
+} GripTimelineStep;
+
+typedef struct {
+	GripTimelineInterval	*interval;
+	int						nIntervals;
+	int						maxIntervals;
+	GripTimelineStep		*stepSlot;
+	int						nStepSlots;
+	int						nSteps;
+	// Time of the last HK packet that was added.
+	double					lastInstant;
+} GripTimeline;
+
+extern GripTimeline gripTimeline;
+
+// An empty timeline, and its release.
+GripTimeline *CreateTimeline( void );
+void FreeTimeline( GripTimeline *timeline );
+
+// Forget all the intervals, as when the HK packets are read again from the start.
+void ResetTimeline( GripTimeline *timeline );
+
+// Add one HK packet, given its EPM time. Packets are to be added in time order.
+void TimelineAddHK( GripTimeline *timeline, const GripHealthAndStatusInfo *hk, double instant );
+
+int TimelineIntervals( const GripTimeline *timeline );
+const GripTimelineInterval *TimelineInterval( const GripTimeline *timeline, int index );
+
+// The last interval that starts at or before the instant, or -1 if there is none.
+int TimelineFindInstant( const GripTimeline *timeline, double instant );
+
+// The first or last interval with the given IDs, whatever the status of the script engine,
+//  or -1 if GRIP has not been there. Follow nextSameStep for the others.
+int TimelineFirstStepInterval( const GripTimeline *timeline, int user, int protocol, int task, int step );
+int TimelineLastStepInterval( const GripTimeline *timeline, int user, int protocol, int task, int step );
@@ -0,0 +1,115 @@
+///
+/// Module:	GripMMIExporter (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that exports a recorded session, decoded and
+///  filtered as GripMMI does it, for analysis in other tools (see GripMMIExport.h).
+///  By default the frames, the HK packets and the steps of the script are written into one
+///  column file, <prefix>.gcol. With -csv they are written into three CSV files instead.
+///
+/// With -column, one column of a column file is printed, one value per line, without
+///  reading the others.
+///
+/// Usage: GripMMIExporter [-csv] [-filter=constant] [-output=prefix] <packet buffer root>
+///        GripMMIExporter -column=table.column <column file>
+
+#include "stdafx.h"
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\GripMMI\GripMMIGlobals.h"
+#include "..\GripMMI\GripMMIColumnFile.h"
+#include "..\GripMMI\GripMMIExport.h"
+
+// Print the column table.column of the column file.
+static int PrintColumn( const char *filename, const char *table_column ) {
+
+	char table_name[GRIP_COLUMN_NAME_LENGTH];
+	const char *column_name = strchr( table_column, '.' );
+	if ( !column_name || column_name - table_column >= GRIP_COLUMN_NAME_LENGTH ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "Expected table.column: %s", table_column );
+		exit( -1 );
+	}
+	strncpy( table_name, table_column, column_name - table_column );
+	table_name[column_name - table_column] = 0;
+	column_name++;
+
+	GripColumnFile *file = OpenGripColumnFile( filename );
+	if ( !file ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "%s is not a column file, or is damaged.", filename );
+		exit( -1 );
+	}
+	int table = FindGripColumnTable( file, table_name );
+	int column = FindGripColumn( file, table, column_name );
+	if ( column < 0 ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "There is no column %s in %s.", table_column, filename );
+		exit( -1 );
+	}
+	GripColumnType type = (GripColumnType) file->column[table][column].type;
+	__int64 rows = file->table[table].rows;
+	void *values = malloc( (size_t) rows * GripColumnSize( type ) + 1 );
+	if ( !values ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "Error allocating memory for %lld values.", rows );
+		exit( -1 );
+	}
+	if ( !ReadGripColumn( file, table, column, values ) ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "Error reading %s from %s.", table_column, filename );
+		exit( -1 );
+	}
+	for ( __int64 row = 0; row < rows; row++ ) {
+		if ( type == COLUMN_FLOAT64 ) printf( "%.6f\n", ( (double *) values )[row] );
+		else if ( type == COLUMN_UINT32 ) printf( "%u\n", ( (unsigned int *) values )[row] );
+		else printf( "%u\n", ( (unsigned char *) values )[row] );
+	}
+	free( values );
+	FreeGripColumnFile( file );
+	return( 0 );
+
+}
+
+int _tmain( int argc, char **argv )
+{
+	char *root = NULL;
+	char *prefix = NULL;
+	char *column = NULL;
+	GripExportFormat format = EXPORT_COLUMNS;
+	double filter_constant = dex.GetFilterConstant();
+	GripExportSummary summary;
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strcmp( argv[arg], "-csv" ) ) format = EXPORT_CSV;
+		else if ( !strncmp( argv[arg], "-filter=", strlen( "-filter=" ) ) ) filter_constant = atof( argv[arg] + strlen( "-filter=" ) );
+		else if ( !strncmp( argv[arg], "-output=", strlen( "-output=" ) ) ) prefix = argv[arg] + strlen( "-output=" );
+		else if ( !strncmp( argv[arg], "-column=", strlen( "-column=" ) ) ) column = argv[arg] + strlen( "-column=" );
+		else root = argv[arg];
+	}
+	if ( !root || filter_constant < 0.0 ) {
+		printf( "Usage: GripMMIExporter [-csv] [-filter=constant] [-output=prefix] <packet buffer root>\n" );
+		printf( "       GripMMIExporter -column=table.column <column file>\n" );
+		return( -1 );
+	}
+	if ( column ) return( PrintColumn( root, column ) );
+	if ( !prefix ) prefix = root;
+
+	if ( !ExportGripSession( root, prefix, format, filter_constant, &summary ) ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "Error writing the export of %s to %s.", root, prefix );
+		exit( -1 );
+	}
+	if ( summary.rtPackets == 0 && summary.hkPackets == 0 ) {
+		fMessageBox( MB_OK, "GripMMIExporter", "No data in the packet caches of %s.", root );
+		exit( -1 );
+	}
+	printf( "%d RT packets (%lld frames), %d HK packets and %d script intervals exported in %.3f s.\n",
+		summary.rtPackets, summary.frames, summary.hkPackets, summary.steps, summary.seconds );
+	printf( "%.1f MB written%s (%.1f MB/s).\n", summary.bytes / 1e6, ( format == EXPORT_CSV ? " in CSV" : "" ),
+		( summary.seconds > 0.0 ? summary.bytes / 1e6 / summary.seconds : 0.0 ) );
+	return( 0 );
+}
@@ -0,0 +1,317 @@
+///
+/// Module:	GripMMISnapshot (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that draws the GripMMI graphs of a
+///  recorded session into image files, without a screen. It decodes the realtime
+///  packet cache in the same way as GripMMI and draws with the same routines
+///  (see GripMMIGraphs.h) into displays that write PNG, SVG or PDF files.
+///  SVG and PDF files are written as the graphs are drawn (see VectorDisplay.h).
+///
+/// Without -end, the whole session is cut into consecutive windows of the given span
+///  and one image is written per window. With -end, only the window that ends that
+///  many seconds after the first frame is drawn.
+///
+/// With -compare, several recorded sessions are loaded at the same time (see GripMMISessions.h)
+///  and drawn over each other, one color per session, for the span of seconds that starts when
+///  each session first went to the given step. The overlays are always autoscaled.
+///
+/// Usage: GripMMISnapshot [-collection=summary|kinematics|visibility] [-span=seconds] [-end=seconds]
+///          [-width=pixels] [-height=pixels] [-format=png|svg|pdf] [-autoscale] [-phase]
+///          [-output=prefix] <packet buffer root or .gpk file>
+///        GripMMISnapshot -compare=user.protocol.task.step [-span=seconds] [-width=pixels] [-height=pixels]
+///          [-format=png|svg|pdf] [-output=prefix] <packet buffer root> <packet buffer root> ...
+
+#include "stdafx.h"
+#include "..\Useful\Useful.h"
+#include "..\Useful\VectorsMixin.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripPackets.h"
+#include "..\Grip\DexAnalogMixin.h"
+#include "..\PsyPhy2dGraphicsLib\Graphics.h"
+#include "..\PsyPhy2dGraphicsLib\Displays.h"
+#include "..\PsyPhy2dGraphicsLib\Views.h"
+#include "..\PsyPhy2dGraphicsLib\Layouts.h"
+#include "..\PsyPhy2dGraphicsLib\RasterDisplay.h"
+#include "..\PsyPhy2dGraphicsLib\VectorDisplay.h"
+#include "..\GripMMI\GripMMIGlobals.h"
+#include "..\GripMMI\GripMMIFrameDecoder.h"
+#include "..\GripMMI\GripMMIGraphs.h"
+#include "..\GripMMI\GripMMISessions.h"
+
+// Same as the default span of GripMMI.
+#define DEFAULT_SPAN	30.0
+// Same as the size of the strip chart pane of GripMMI.
+#define DEFAULT_WIDTH	1000
+#define DEFAULT_HEIGHT	640
+// The phase plots are square.
+#define PHASE_PLOT_SIZE	300
+
+static const char *collectionName[GRAPH_COLLECTIONS] = { "summary", "kinematics", "visibility" };
+static const char *phaseName[PHASEPLOTS] = { "xy", "zy", "cop" };
+
+// The most sessions that can be compared at once.
+#define MAX_COMPARE_SESSIONS	16
+// The frames are binned one bin per pixel, but never into bins so short that some get no frame,
+//  which would break the lines.
+#define MIN_COMPARE_BIN			( 2.0 * RT_DEFAULT_SECONDS_PER_SLICE )
+// The channels that are compared, one view each.
+#define COMPARE_CHANNELS		5
+static char compareTitle[COMPARE_CHANNELS][16] = { "Position X ", "Position Y ", "Position Z ", "Grip Force ", "Load Force " };
+
+// Also the extension of the files.
+static const char *format = "png";
+
+static bool VectorSnapshot( void ) {
+	return( strcmp( format, "png" ) != 0 );
+}
+
+static Display CreateSnapshotDisplay( int width, int height ) {
+	Display display = ( VectorSnapshot() ? CreateVectorDisplay() : CreateRasterDisplay() );
+	DisplaySetSizePixels( display, width, height );
+	DisplayInit( display );
+	return( display );
+}
+
+static void SnapshotFilename( char *filename, const char *prefix, const char *graph, int window ) {
+	_snprintf( filename, MAX_PATH, "%s.%s.%04d.%s", prefix, graph, window, format );
+	filename[MAX_PATH - 1] = 0;
+}
+
+// A vector display writes what is drawn straight into the file, so the file is opened before drawing.
+static void StartSnapshot( Display display, const char *filename ) {
+	if ( VectorSnapshot() && VectorDisplayOpen( display, filename ) ) {
+		fMessageBox( MB_OK, "GripMMISnapshot", "Error opening %s for writing.", filename );
+		exit( -1 );
+	}
+}
+
+// Draw the sessions of root[] over each other, each from where it first went to the given step.
+static int CompareSessions( const char *root[], int count, const int ids[4], double span, int width, int height, const char *prefix ) {
+
+	GripSession *session[MAX_COMPARE_SESSIONS];
+	double origin[MAX_COMPARE_SESSIONS];
+	char filename[MAX_PATH];
+	int bins = width;
+	if ( span / bins < MIN_COMPARE_BIN ) bins = (int) ceil( span / MIN_COMPARE_BIN );
+	double period = span / bins;
+
+	LARGE_INTEGER frequency, start, loaded, finished;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+	LoadGripSessions( session, root, count, dex.GetFilterConstant() );
+	QueryPerformanceCounter( &loaded );
+
+	int aligned = 0;
+	for ( int i = 0; i < count; i++ ) {
+		origin[i] = GripSessionStepStart( session[i], ids[0], ids[1], ids[2], ids[3] );
+		printf( "%2d: %d packets, %d frames read from %s in %.3f s, ", i, session[i]->rtPackets, session[i]->frames->nFrames, root[i], session[i]->seconds );
+		if ( origin[i] == MISSING_DOUBLE ) printf( "step %d.%d.%d.%d not found.\n", ids[0], ids[1], ids[2], ids[3] );
+		else {
+			printf( "step %d.%d.%d.%d at %.3f s.\n", ids[0], ids[1], ids[2], ids[3], origin[i] );
+			aligned++;
+		}
+	}
+	printf( "%d sessions loaded in %.3f s.\n", count, (double) ( loaded.QuadPart - start.QuadPart ) / (double) frequency.QuadPart );
+	if ( aligned == 0 ) {
+		fMessageBox( MB_OK, "GripMMISnapshot", "None of the sessions went to step %d.%d.%d.%d.", ids[0], ids[1], ids[2], ids[3] );
+		exit( -1 );
+	}
+
+	// The time of each bin, from the start of the step, and the binned channels of each session.
+	double *instant = (double *) malloc( bins * sizeof( double ) );
+	double *binned = (double *) malloc( (size_t) count * COMPARE_CHANNELS * bins * sizeof( double ) );
+	if ( !instant || !binned ) {
+		fMessageBox( MB_OK, "GripMMISnapshot", "Error allocating memory to compare %d sessions.", count );
+		exit( -1 );
+	}
+	for ( int bin = 0; bin < bins; bin++ ) instant[bin] = ( bin + 0.5 ) * period;
+	for ( int i = 0; i < count; i++ ) {
+		GripFrameStore *frames = session[i]->frames;
+		double *channel = binned + (size_t) i * COMPARE_CHANNELS * bins;
+		if ( origin[i] == MISSING_DOUBLE ) continue;
+		for ( int c = X; c <= Z; c++ ) {
+			DecimateGripChannel( frames, &frames->manipulandumPosition[0][c], 3, frames->manipulandumVisible, origin[i], 0.0, period, bins, channel + c * bins );
+		}
+		DecimateGripChannel( frames, frames->gripForce, 1, NULL, origin[i], 0.0, period, bins, channel + 3 * bins );
+		DecimateGripChannel( frames, frames->loadForceMagnitude, 1, NULL, origin[i], 0.0, period, bins, channel + 4 * bins );
+	}
+
+	Display display = CreateSnapshotDisplay( width, height );
+	Layout layout = CreateLayout( display, COMPARE_CHANNELS, 1 );
+	LayoutSetDisplayEdgesRelative( layout, 0.0, 0.0, 1.0, 1.0 );
+	_snprintf( filename, sizeof( filename ), "%s.compare.%s", prefix, format );
+	filename[sizeof( filename ) - 1] = 0;
+	StartSnapshot( display, filename );
+	DisplayActivate( display );
+	Erase( display );
+	for ( int c = 0; c < COMPARE_CHANNELS; c++ ) {
+		View view = LayoutViewN( layout, c );
+		ViewColor( view, GREY6 );
+		ViewBox( view );
+		ViewColor( view, BLACK );
+		ViewTitle( view, compareTitle[c], INSIDE_RIGHT, INSIDE_TOP, 0.0 );
+		ViewSetXLimits( view, 0.0, span );
+		ViewAutoScaleInit( view );
+		for ( int i = 0; i < count; i++ ) {
+			if ( origin[i] != MISSING_DOUBLE ) ViewAutoScaleAvailableDoubles( view, binned + ( (size_t) i * COMPARE_CHANNELS + c ) * bins, 0, bins - 1, sizeof( double ), MISSING_DOUBLE );
+		}
+		ViewAutoScaleExpand( view, 0.01 );
+		ViewAxes( view );
+		for ( int i = 0; i < count; i++ ) {
+			if ( origin[i] == MISSING_DOUBLE ) continue;
+			ViewSelectColor( view, i );
+			ViewXYPlotAvailableDoubles( view, instant, binned + ( (size_t) i * COMPARE_CHANNELS + c ) * bins, 0, bins - 1, 1, sizeof( double ), sizeof( double ), MISSING_DOUBLE );
+		}
+	}
+	Hardcopy( display, filename );
+	QueryPerformanceCounter( &finished );
+	printf( "%d sessions aligned on step %d.%d.%d.%d and drawn into %s in %.3f s.\n", aligned, ids[0], ids[1], ids[2], ids[3], filename,
+		(double) ( finished.QuadPart - loaded.QuadPart ) / (double) frequency.QuadPart );
+
+	Close( display );
+	free( instant );
+	free( binned );
+	for ( int i = 0; i < count; i++ ) FreeGripSession( session[i] );
+	return( 0 );
+
+}
+
+int _tmain( int argc, char **argv )
+{
+	char *root = NULL;
+	const char *compare_root[MAX_COMPARE_SESSIONS];
+	int compare_ids[4];
+	bool compare = false;
+	int roots = 0;
+	char *prefix = NULL;
+	char filename[MAX_PATH];
+	char snapshot[PHASEPLOTS + 1][MAX_PATH];
+	GripMMIGraphWindow window;
+	double span = DEFAULT_SPAN;
+	double end = -1.0;
+	int width = DEFAULT_WIDTH;
+	int height = DEFAULT_HEIGHT;
+	bool phase = false;
+	int collection;
+
+	window.collection = GRAPHS_SUMMARY;
+	window.autoscale = false;
+	window.live = false;
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strncmp( argv[arg], "-collection=", strlen( "-collection=" ) ) ) {
+			for ( collection = 0; collection < GRAPH_COLLECTIONS; collection++ ) {
+				if ( !_stricmp( argv[arg] + strlen( "-collection=" ), collectionName[collection] ) ) break;
+			}
+			if ( collection >= GRAPH_COLLECTIONS ) {
+				fMessageBox( MB_OK, "GripMMISnapshot", "Unrecognized collection: %s", argv[arg] + strlen( "-collection=" ) );
+				exit( -1 );
+			}
+			window.collection = (GripMMIGraphCollection) collection;
+		}
+		else if ( !strncmp( argv[arg], "-span=", strlen( "-span=" ) ) ) span = atof( argv[arg] + strlen( "-span=" ) );
+		else if ( !strncmp( argv[arg], "-end=", strlen( "-end=" ) ) ) end = atof( argv[arg] + strlen( "-end=" ) );
+		else if ( !strncmp( argv[arg], "-width=", strlen( "-width=" ) ) ) width = atoi( argv[arg] + strlen( "-width=" ) );
+		else if ( !strncmp( argv[arg], "-height=", strlen( "-height=" ) ) ) height = atoi( argv[arg] + strlen( "-height=" ) );
+		else if ( !strcmp( argv[arg], "-format=svg" ) ) format = "svg";
+		else if ( !strcmp( argv[arg], "-format=pdf" ) ) format = "pdf";
+		else if ( !strcmp( argv[arg], "-format=png" ) ) format = "png";
+		else if ( !strcmp( argv[arg], "-autoscale" ) ) window.autoscale = true;
+		else if ( !strcmp( argv[arg], "-phase" ) ) phase = true;
+		else if ( !strncmp( argv[arg], "-output=", strlen( "-output=" ) ) ) prefix = argv[arg] + strlen( "-output=" );
+		else if ( !strncmp( argv[arg], "-compare=", strlen( "-compare=" ) ) ) {
+			compare = ( 4 == sscanf( argv[arg] + strlen( "-compare=" ), "%d.%d.%d.%d", &compare_ids[0], &compare_ids[1], &compare_ids[2], &compare_ids[3] ) );
+			if ( !compare ) {
+				fMessageBox( MB_OK, "GripMMISnapshot", "Expected user.protocol.task.step: %s", argv[arg] + strlen( "-compare=" ) );
+				exit( -1 );
+			}
+		}
+		else {
+			root = argv[arg];
+			if ( roots < MAX_COMPARE_SESSIONS ) compare_root[roots] = root;
+			roots++;
+		}
+	}
+	if ( compare && roots > MAX_COMPARE_SESSIONS ) {
+		fMessageBox( MB_OK, "GripMMISnapshot", "No more than %d sessions can be compared.", MAX_COMPARE_SESSIONS );
+		exit( -1 );
+	}
+	if ( !root || span <= 0.0 || width <= 0 || height <= 0 ) {
+		printf( "Usage: GripMMISnapshot [-collection=summary|kinematics|visibility] [-span=seconds] [-end=seconds]\n" );
+		printf( "         [-width=pixels] [-height=pixels] [-format=png|svg|pdf] [-autoscale] [-phase]\n" );
+		printf( "         [-output=prefix] <packet buffer root or .gpk file>\n" );
+		printf( "       GripMMISnapshot -compare=user.protocol.task.step [-span=seconds] [-width=pixels] [-height=pixels]\n" );
+		printf( "         [-format=png|svg|pdf] [-output=prefix] <packet buffer root> <packet buffer root> ...\n" );
+		return( -1 );
+	}
+	if ( compare ) return( CompareSessions( compare_root, roots, compare_ids, span, width, height, prefix ? prefix : compare_root[0] ) );
+	// Accept either the cache file itself or the root that was given to GripMMI.
+	size_t length = strlen( root );
+	if ( length > strlen( ".gpk" ) && !_stricmp( root + length - strlen( ".gpk" ), ".gpk" ) ) _snprintf( filename, sizeof( filename ), "%s", root );
+	else CreateGripPacketCacheFilename( filename, sizeof( filename ), GRIP_RT_SCIENCE_PACKET, root );
+	filename[sizeof( filename ) - 1] = 0;
+	if ( !prefix ) prefix = root;
+
+	LARGE_INTEGER frequency, start, loaded, finished;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	int packets = LoadGripRTCache( filename );
+	if ( nFrames == 0 ) {
+		fMessageBox( MB_OK, "GripMMISnapshot", "No data in %s.", filename );
+		exit( -1 );
+	}
+	QueryPerformanceCounter( &loaded );
+	printf( "%d packets, %d frames, %.1f s of data read from %s in %.3f s.\n", packets, nFrames,
+		RealMarkerTime[nFrames - 1] - RealMarkerTime[0], filename, (double) ( loaded.QuadPart - start.QuadPart ) / (double) frequency.QuadPart );
+
+	GripMMIGraphs graphs;
+	graphs.stripchart_display = CreateSnapshotDisplay( width, height );
+	for ( int i = 0; i < PHASEPLOTS; i++ ) graphs.phase_display[i] = CreateSnapshotDisplay( PHASE_PLOT_SIZE, PHASE_PLOT_SIZE );
+	CreateGraphViews( &graphs );
+
+	// Either the one window that was asked for, or all of them.
+	double first_instant, last_instant;
+	int windows = 0;
+	if ( end >= 0.0 ) {
+		first_instant = RealMarkerTime[0] + end - span;
+		last_instant = first_instant;
+	}
+	else {
+		first_instant = RealMarkerTime[0];
+		last_instant = RealMarkerTime[nFrames - 1];
+	}
+	// The last window may be only partly filled.
+	for ( double instant = first_instant; windows == 0 || instant < last_instant; instant += span ) {
+		window.first_instant = instant;
+		window.last_instant = instant + span;
+		SnapshotFilename( snapshot[PHASEPLOTS], prefix, collectionName[window.collection], windows );
+		StartSnapshot( graphs.stripchart_display, snapshot[PHASEPLOTS] );
+		DrawStripCharts( &graphs, &window );
+		Hardcopy( graphs.stripchart_display, snapshot[PHASEPLOTS] );
+		if ( phase ) {
+			for ( int i = 0; i < PHASEPLOTS; i++ ) {
+				SnapshotFilename( snapshot[i], prefix, phaseName[i], windows );
+				StartSnapshot( graphs.phase_display[i], snapshot[i] );
+			}
+			DrawPhasePlots( &graphs, &window );
+			for ( int i = 0; i < PHASEPLOTS; i++ ) Hardcopy( graphs.phase_display[i], snapshot[i] );
+		}
+		windows++;
+	}
+	QueryPerformanceCounter( &finished );
+
+	double elapsed = (double) ( finished.QuadPart - loaded.QuadPart ) / (double) frequency.QuadPart;
+	printf( "%d windows of %.1f s drawn and written in %.3f s (%.1f windows/s).\n", windows, span, elapsed, ( elapsed > 0.0 ? windows / elapsed : 0.0 ) );
+
+	for ( int i = 0; i < PHASEPLOTS; i++ ) Close( graphs.phase_display[i] );
+	Close( graphs.stripchart_display );
+	return( 0 );
+}
@@ -0,0 +1,158 @@
+///
+/// Module:	GripMMIStats (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that shows the performance counters
+///  of a running GripMMI (see GripMMICounters.h). It maps the stats file that GripMMI
+///  writes next to the packet cache and prints the counters at regular intervals,
+///  with the rates and the mean durations over each interval.
+///
+/// Usage: GripMMIStats [-interval=seconds] [-count=n] <packet buffer root or .stats file>
+
+#include "stdafx.h"
+#include "..\Useful\Useful.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\GripMMI\GripMMICounters.h"
+
+#define DEFAULT_INTERVAL	5.0
+// How many times to try to get a consistent copy of the counters before giving up for this interval.
+#define MAX_SNAPSHOT_RETRIES	100
+
+// Copy the counters from the file while GripMMI is not writing them.
+static bool Snapshot( GripMMICounterBlock *snapshot, const GripMMICounterBlock *mapped ) {
+	for ( int retry = 0; retry < MAX_SNAPSHOT_RETRIES; retry++ ) {
+		long sequence = mapped->sequence;
+		if ( !( sequence & 0x01 ) ) {
+			MemoryBarrier();
+			memcpy( snapshot, (const void *) mapped, sizeof( *snapshot ) );
+			MemoryBarrier();
+			if ( mapped->sequence == sequence ) return( true );
+		}
+		Sleep( 1 );
+	}
+	return( false );
+}
+
+static double Milliseconds( __int64 ticks, __int64 frequency ) {
+	return( 1000.0 * (double) ticks / (double) frequency );
+}
+
+// Show the counters, with the rates and means since the previous snapshot if there is one.
+static void ShowCounters( const GripMMICounterBlock *now, const GripMMICounterBlock *before ) {
+
+	double elapsed = 0.0;
+	if ( before ) elapsed = (double) ( now->published - before->published ) / (double) now->frequency;
+
+	printf( "\nGripMMI process %lu", now->pid );
+	if ( before && elapsed <= 0.0 ) printf( " (no refresh cycle since the last update)" );
+	else if ( before ) printf( " (%.1f s since the last update)", elapsed );
+	printf( "\n" );
+
+	printf( "%-28s %14s %14s %10s %10s %10s\n", "counter", "value", "rate/s", "mean ms", "last ms", "max ms" );
+	for ( unsigned int i = 0; i < now->nCounters; i++ ) {
+		const GripMMICounter *c = &now->counter[i];
+		const GripMMICounter *p = ( before ? &before->counter[i] : NULL );
+		char name[64];
+		_snprintf( name, sizeof( name ), "%s%s%s%s", c->name, ( *c->unit ? " (" : "" ), c->unit, ( *c->unit ? ")" : "" ) );
+		name[sizeof( name ) - 1] = 0;
+		switch ( c->kind ) {
+		case COUNTER_TOTAL:
+			printf( "%-28s %14" PRId64, name, (int64_t) c->count );
+			if ( p && elapsed > 0.0 ) printf( " %14.1f", (double) ( c->count - p->count ) / elapsed );
+			printf( "\n" );
+			break;
+		case COUNTER_GAUGE:
+			printf( "%-28s %14" PRId64 "\n", name, (int64_t) c->count );
+			break;
+		case COUNTER_TIMER: {
+			// The mean is over the samples of the last interval, if there were any, and over all samples otherwise.
+			__int64 count = c->count - ( p ? p->count : 0 );
+			__int64 total = c->total - ( p ? p->total : 0 );
+			if ( count <= 0 ) {
+				count = c->count;
+				total = c->total;
+			}
+			printf( "%-28s %14" PRId64, name, (int64_t) c->count );
+			if ( p && elapsed > 0.0 ) printf( " %14.1f", (double) ( c->count - p->count ) / elapsed );
+			else printf( " %14s", "" );
+			if ( count > 0 ) printf( " %10.3f %10.3f %10.3f", Milliseconds( total, now->frequency ) / count, Milliseconds( c->last, now->frequency ), Milliseconds( c->max, now->frequency ) );
+			printf( "\n" );
+			break;
+			}
+		}
+	}
+	fflush( stdout );
+
+}
+
+int _tmain( int argc, char **argv )
+{
+	char *root = NULL;
+	char filename[MAX_PATH];
+	double interval = DEFAULT_INTERVAL;
+	int count = 0;
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strncmp( argv[arg], "-interval=", strlen( "-interval=" ) ) ) interval = atof( argv[arg] + strlen( "-interval=" ) );
+		else if ( !strncmp( argv[arg], "-count=", strlen( "-count=" ) ) ) count = atoi( argv[arg] + strlen( "-count=" ) );
+		else root = argv[arg];
+	}
+	if ( !root || interval <= 0.0 ) {
+		printf( "Usage: GripMMIStats [-interval=seconds] [-count=n] <packet buffer root or .stats file>\n" );
+		return( -1 );
+	}
+	// Accept either the stats file itself or the root that was given to GripMMI.
+	size_t length = strlen( root );
+	size_t extension = strlen( GRIPMMI_COUNTERS_FILE_EXTENSION );
+	if ( length > extension && !_stricmp( root + length - extension, GRIPMMI_COUNTERS_FILE_EXTENSION ) ) _snprintf( filename, sizeof( filename ), "%s", root );
+	else _snprintf( filename, sizeof( filename ), "%s%s", root, GRIPMMI_COUNTERS_FILE_EXTENSION );
+	filename[sizeof( filename ) - 1] = 0;
+
+	// GripMMI has the file open for writing, so we have to share it.
+	HANDLE file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		fMessageBox( MB_OK, "GripMMIStats", "Error opening stats file %s.\nIs GripMMI running?", filename );
+		exit( -1 );
+	}
+	if ( GetFileSize( file, NULL ) < sizeof( GripMMICounterBlock ) ) {
+		fMessageBox( MB_OK, "GripMMIStats", "%s is not a GripMMI stats file.", filename );
+		exit( -1 );
+	}
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, sizeof( GripMMICounterBlock ), NULL );
+	CloseHandle( file );
+	const GripMMICounterBlock *mapped = ( mapping ? (const GripMMICounterBlock *) MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, sizeof( GripMMICounterBlock ) ) : NULL );
+	if ( !mapped ) {
+		fMessageBox( MB_OK, "GripMMIStats", "Error mapping stats file %s.", filename );
+		exit( -1 );
+	}
+
+	GripMMICounterBlock snapshot[2];
+	int current = 0;
+	bool have_previous = false;
+	for ( int poll = 0; count <= 0 || poll < count; poll++ ) {
+		if ( poll > 0 ) Sleep( (DWORD) ( interval * 1000.0 ) );
+		if ( !Snapshot( &snapshot[current], mapped ) ) {
+			printf( "\nGripMMI is updating the counters too often to get a consistent copy. Trying again later.\n" );
+			continue;
+		}
+		if ( strncmp( snapshot[current].magic, GRIPMMI_COUNTERS_MAGIC, sizeof( snapshot[current].magic ) ) || snapshot[current].nCounters != GRIPMMI_COUNTERS ) {
+			fMessageBox( MB_OK, "GripMMIStats", "%s is not a GripMMI stats file, or comes from a different version of GripMMI.", filename );
+			exit( -1 );
+		}
+		// If GripMMI was restarted, the counters started over.
+		if ( have_previous && snapshot[current].pid != snapshot[!current].pid ) have_previous = false;
+		ShowCounters( &snapshot[current], ( have_previous ? &snapshot[!current] : NULL ) );
+		have_previous = true;
+		current = !current;
+	}
+
+	UnmapViewOfFile( mapped );
+	CloseHandle( mapping );
+	return( 0 );
+}
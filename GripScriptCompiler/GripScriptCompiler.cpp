@@ -0,0 +1,158 @@
+///
+/// Module:	GripScriptCompiler (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that compiles a GRIP script directory into
+///  a single bundle file (see GripMMIScriptBundle.h). The scripts are parsed as GripMMI
+///  parses them and checked as GripMMI checks them at startup (see GripMMIScriptLint.h),
+///  with the pictures looked for in the pictures subdirectory. The bundle is then loaded
+///  back and compared with the parsed scripts before the tool says that it is good to distribute.
+///
+/// By default the bundle is written as users.gsb in the script directory, where GripMMI looks for it.
+/// With -lint, the scripts are only checked. The report is printed and the exit code is 1 if
+///  errors were found, so that scripts can be checked before they are uploaded.
+///
+/// Usage: GripScriptCompiler [-output=bundle] [-force] [-lint] <script directory>
+
+#include "stdafx.h"
+#include <io.h>
+#include <sys\types.h>
+#include <sys\stat.h>
+#include "..\Useful\fMessageBox.h"
+#include "..\GripMMI\GripMMIScriptTree.h"
+#include "..\GripMMI\GripMMIScriptBundle.h"
+#include "..\GripMMI\GripMMIScriptLint.h"
+
+static double Seconds( LARGE_INTEGER from, LARGE_INTEGER to, LARGE_INTEGER frequency ) {
+	return( (double) ( to.QuadPart - from.QuadPart ) / (double) frequency.QuadPart );
+}
+
+// Check that the bundle gives the same tree as the text files.
+static int CompareTrees( GripScriptTree *text, GripScriptTree *bundle ) {
+
+	int differences = 0;
+	if ( text->nNodes != bundle->nNodes ) return( 1 );
+	for ( int n = 0; n < text->nNodes; n++ ) {
+		GripScriptNode *a = &text->node[n], *b = &bundle->node[n];
+		if ( a->file->type != b->file->type || a->file->missing != b->file->missing ) differences++;
+		if ( a->nEntries != b->nEntries || a->file->nItems != b->file->nItems || a->file->nSteps != b->file->nSteps ) {
+			differences++;
+			continue;
+		}
+		for ( int i = 0; i < a->nEntries; i++ ) {
+			if ( a->child[i] != b->child[i] ) differences++;
+			const GripScriptItem *x = GripScriptEntry( a, i ), *y = GripScriptEntry( b, i );
+			if ( x->id != y->id || strcmp( x->label, y->label ) ) differences++;
+			if ( GripScriptFindEntry( b, x->id ) != GripScriptFindEntry( a, x->id ) ) differences++;
+		}
+		for ( int i = 0; a->file->step && i <= a->file->nSteps; i++ ) {
+			GripScriptStep *x = &a->file->step[i], *y = &b->file->step[i];
+			if ( x->type != y->type || x->stepID != y->stepID || x->comment != y->comment
+				|| strcmp( x->text, y->text ) || strcmp( x->message, y->message ) || strcmp( x->picture, y->picture ) ) differences++;
+		}
+	}
+	return( differences );
+
+}
+
+int _tmain( int argc, char **argv )
+{
+	char *directory = NULL;
+	char *output = NULL;
+	bool force = false;
+	bool lint = false;
+	char subject_file[MAX_PATH];
+	char bundle_file[MAX_PATH];
+	char picture_prefix[MAX_PATH];
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strncmp( argv[arg], "-output=", strlen( "-output=" ) ) ) output = argv[arg] + strlen( "-output=" );
+		else if ( !strcmp( argv[arg], "-force" ) ) force = true;
+		else if ( !strcmp( argv[arg], "-lint" ) ) lint = true;
+		else directory = argv[arg];
+	}
+	if ( !directory ) {
+		printf( "Usage: GripScriptCompiler [-output=bundle] [-force] [-lint] <script directory>\n" );
+		printf( "  -force writes the bundle even if the checks of the scripts find errors.\n" );
+		printf( "  -lint only checks the scripts. The exit code is 1 if errors were found.\n" );
+		return( -1 );
+	}
+
+	// The script directory is given with or without the final separator.
+	// A slash is added if needed, since Windows takes it as well.
+	size_t length = strlen( directory );
+	const char *separator = ( length > 0 && ( directory[length - 1] == '\\' || directory[length - 1] == '/' ) ? "" : "/" );
+	_snprintf( subject_file, sizeof( subject_file ), "%s%susers.dex", directory, separator );
+	_snprintf( picture_prefix, sizeof( picture_prefix ), "%s%spictures/", directory, separator );
+	if ( output ) _snprintf( bundle_file, sizeof( bundle_file ), "%s", output );
+	else _snprintf( bundle_file, sizeof( bundle_file ), "%s%s%s", directory, separator, GRIP_SCRIPT_BUNDLE );
+
+	LARGE_INTEGER frequency, start, parsed, written, loaded;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &start );
+
+	GripScriptTree *tree = LoadGripScriptTree( subject_file, NULL );
+	QueryPerformanceCounter( &parsed );
+	GripLintReport *report = LintGripScriptTree( tree, picture_prefix );
+	WriteGripLintReport( report, stdout );
+	if ( lint ) {
+		int status = ( report->errors ? 1 : 0 );
+		FreeGripLintReport( report );
+		FreeGripScriptTree( tree );
+		return( status );
+	}
+	if ( tree->fatal ) {
+		fMessageBox( MB_OK, "GripScriptCompiler", "The scripts in %s cannot be used by GripMMI.", directory );
+		exit( -1 );
+	}
+	if ( report->errors && !force ) {
+		fMessageBox( MB_OK, "GripScriptCompiler", "%d errors were found in the scripts. Use -force to write the bundle anyway.", report->errors );
+		exit( -1 );
+	}
+
+	// Count what there is.
+	int files = 0, tasks = 0, lines = 0;
+	for ( int n = 0; n < tree->nNodes; n++ ) {
+		GripScriptFile *file = tree->node[n].file;
+		if ( file->missing ) continue;
+		files++;
+		if ( file->type != SCRIPT_TASK_FILE ) continue;
+		tasks++;
+		// Step 0 is the dummy first line, so the lines of the file are counted as in the lint report.
+		lines += file->nSteps - 1;
+	}
+	int pictures = report->pictures;
+	FreeGripLintReport( report );
+
+	if ( !WriteGripScriptBundle( tree, bundle_file ) ) {
+		fMessageBox( MB_OK, "GripScriptCompiler", "Error writing %s.", bundle_file );
+		exit( -1 );
+	}
+	QueryPerformanceCounter( &written );
+
+	// Read it back as GripMMI would.
+	GripScriptTree *bundle = LoadGripScriptBundle( bundle_file );
+	QueryPerformanceCounter( &loaded );
+	int differences = CompareTrees( tree, bundle );
+	if ( bundle->fatal || differences ) {
+		if ( bundle->errors ) printf( "%s", bundle->errors );
+		fMessageBox( MB_OK, "GripScriptCompiler", "%s does not give back the scripts (%d differences).", bundle_file, differences );
+		exit( -1 );
+	}
+
+	struct _stat64 bundle_stat;
+	_stat64( bundle_file, &bundle_stat );
+	printf( "%d files (%d tasks, %d lines) and %d pictures parsed in %.3f s.\n", files, tasks, lines, pictures, Seconds( start, parsed, frequency ) );
+	printf( "%s written in %.3f s: %lld bytes.\n", bundle_file, Seconds( parsed, written, frequency ), (long long) bundle_stat.st_size );
+	printf( "Bundle loaded back in %.3f s and checked against the scripts.\n", Seconds( written, loaded, frequency ) );
+
+	FreeGripScriptTree( bundle );
+	FreeGripScriptTree( tree );
+	return( 0 );
+}
@@ -0,0 +1,335 @@
+///
+/// Module:	GripTraceMerge (GripMMI)
+///
+///	Author:					J. McIntyre, PsyPhy Consulting
+/// Initial release:		18 December 2014
+/// Modification History:	see https://github.com/PsyPhy/GripMMI
+///
+/// Copyright (c) 2014, 2015 PsyPhy Consulting
+///
+
+/// This module creates a console application that merges the trace files written by
+///  CLWSemulator, DexGroundMonitorClient and GripMMI when the GRIPTRACE environment
+///  variable is set (see GripTrace.h). It follows each packet, by its TMCounter,
+///  from one stage to the next and reports the distribution of the latencies
+///  between stages. It can also write the whole run as a Chrome trace (JSON)
+///  to be viewed in chrome://tracing.
+///
+/// Usage: GripTraceMerge [-json=trace.json] <directory or .trc files> ...
+///
+/// The processes must have run on the same machine, since the timestamps come from
+///  each process' performance counter.
+
+#include "stdafx.h"
+#include "..\Useful\fMessageBox.h"
+#include "..\Grip\GripTrace.h"
+
+#define MAX_TRACE_FILES	32
+// TMCounter is 16 bits, so we can look up the most recent packet with a given counter directly.
+#define COUNTER_VALUES	65536
+
+// Limits of the histogram bins, in milliseconds.
+static const double histogramLimit[] = { 0.1, 0.2, 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0 };
+#define HISTOGRAM_BINS	( sizeof( histogramLimit ) / sizeof( histogramLimit[0] ) + 1 )
+
+// A trace record, with the process that it came from and its time in seconds.
+typedef struct {
+	double			time;
+	unsigned long	counter;
+	int				stage;
+	int				process;
+} TraceEvent;
+
+// The times at which one packet reached each stage. Negative if it was not seen at that stage.
+typedef struct {
+	unsigned long	counter;
+	double			time[TRACE_STAGES];
+} PacketPath;
+
+// The processes that contributed trace files.
+static GripTraceFileHeader processHeader[MAX_TRACE_FILES];
+static int nProcesses = 0;
+
+static TraceEvent *event = NULL;
+static int nEvents = 0, maxEvents = 0;
+
+static PacketPath *packet = NULL;
+static int nPackets = 0, maxPackets = 0;
+
+// Read the records of one trace file.
+// The time of each record is measured from the start of the performance counter, in seconds.
+void ReadTraceFile( const char *filename ) {
+
+	FILE *fp;
+	GripTraceRecord record;
+	GripTraceFileHeader *header;
+
+	if ( nProcesses >= MAX_TRACE_FILES ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "Too many trace files (max %d).", MAX_TRACE_FILES );
+		exit( -1 );
+	}
+	header = &processHeader[nProcesses];
+
+	fp = fopen( filename, "rb" );
+	if ( !fp ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "Error opening trace file %s.", filename );
+		exit( -1 );
+	}
+	if ( fread( header, sizeof( *header ), 1, fp ) != 1 || strncmp( header->magic, GRIP_TRACE_MAGIC, sizeof( header->magic ) ) || header->frequency <= 0 ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "%s is not a GripTrace file.", filename );
+		exit( -1 );
+	}
+	header->process[sizeof( header->process ) - 1] = 0;
+
+	while ( fread( &record, sizeof( record ), 1, fp ) == 1 ) {
+		if ( record.stage >= TRACE_STAGES ) continue;
+		if ( nEvents >= maxEvents ) {
+			maxEvents = ( maxEvents ? 2 * maxEvents : 65536 );
+			event = (TraceEvent *) realloc( event, maxEvents * sizeof( TraceEvent ) );
+			if ( !event ) {
+				fMessageBox( MB_OK, "GripTraceMerge", "Error allocating memory for %d trace records.", maxEvents );
+				exit( -1 );
+			}
+		}
+		event[nEvents].time = (double) record.ticks / (double) header->frequency;
+		event[nEvents].counter = record.counter;
+		event[nEvents].stage = record.stage;
+		event[nEvents].process = nProcesses;
+		nEvents++;
+	}
+	fclose( fp );
+	printf( "%s: %s (pid %lu)\n", filename, header->process, header->pid );
+	nProcesses++;
+
+}
+
+// Read all the .trc files in a directory.
+void ReadTraceDirectory( const char *directory ) {
+
+	char pattern[MAX_PATH], filename[MAX_PATH];
+	WIN32_FIND_DATAA found;
+	HANDLE search;
+	int length;
+
+	// Windows accepts '/' as a separator too, so this also works with the stand-ins of Portable/Windows.h.
+	length = _snprintf( pattern, sizeof( pattern ), "%s/*.trc", directory );
+	if ( length < 0 || length >= (int) sizeof( pattern ) ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "Path to the trace directory is too long:\n%s", directory );
+		exit( -1 );
+	}
+	search = FindFirstFileA( pattern, &found );
+	if ( search == INVALID_HANDLE_VALUE ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "No trace files found in %s.", directory );
+		exit( -1 );
+	}
+	do {
+		length = _snprintf( filename, sizeof( filename ), "%s/%s", directory, found.cFileName );
+		if ( length < 0 || length >= (int) sizeof( filename ) ) {
+			fMessageBox( MB_OK, "GripTraceMerge", "Path to the trace file is too long:\n%s/%s", directory, found.cFileName );
+			exit( -1 );
+		}
+		ReadTraceFile( filename );
+	} while ( FindNextFileA( search, &found ) );
+	FindClose( search );
+
+}
+
+int CompareEventTimes( const void *a, const void *b ) {
+	double ta = ((const TraceEvent *) a)->time;
+	double tb = ((const TraceEvent *) b)->time;
+	return( ta < tb ? -1 : ( ta > tb ? 1 : 0 ) );
+}
+
+int CompareLatencies( const void *a, const void *b ) {
+	double la = *((const double *) a);
+	double lb = *((const double *) b);
+	return( la < lb ? -1 : ( la > lb ? 1 : 0 ) );
+}
+
+static int NewPacket( unsigned long counter ) {
+	if ( nPackets >= maxPackets ) {
+		maxPackets = ( maxPackets ? 2 * maxPackets : 16384 );
+		packet = (PacketPath *) realloc( packet, maxPackets * sizeof( PacketPath ) );
+		if ( !packet ) {
+			fMessageBox( MB_OK, "GripTraceMerge", "Error allocating memory for %d packets.", maxPackets );
+			exit( -1 );
+		}
+	}
+	packet[nPackets].counter = counter;
+	for ( int stage = 0; stage < TRACE_STAGES; stage++ ) packet[nPackets].time[stage] = -1.0;
+	return( nPackets++ );
+}
+
+// Follow each packet through the stages.
+// TMCounter wraps around, so a record is attributed to the most recent packet with the same counter
+//  that has been seen at an earlier stage but not yet at this one. If there is none, as when
+//  the packets come from a real CLWS server that does not trace, the packet starts here.
+// A display record is attributed to all the packets read since the previous display.
+void FollowPackets( void ) {
+
+	static int latest[COUNTER_VALUES];
+	int *pending = NULL;
+	int n_pending = 0, max_pending = 0;
+	int i, earlier;
+
+	for ( i = 0; i < COUNTER_VALUES; i++ ) latest[i] = -1;
+
+	for ( i = 0; i < nEvents; i++ ) {
+
+		TraceEvent *e = &event[i];
+
+		if ( e->stage == TRACE_DISPLAY ) {
+			for ( int p = 0; p < n_pending; p++ ) packet[pending[p]].time[TRACE_DISPLAY] = e->time;
+			n_pending = 0;
+			continue;
+		}
+
+		int index = latest[e->counter % COUNTER_VALUES];
+		if ( index >= 0 && packet[index].time[e->stage] < 0.0 ) {
+			for ( earlier = 0; earlier < e->stage; earlier++ ) if ( packet[index].time[earlier] >= 0.0 ) break;
+			if ( earlier == e->stage ) index = -1;
+		}
+		else index = -1;
+		if ( index < 0 ) {
+			index = NewPacket( e->counter );
+			latest[e->counter % COUNTER_VALUES] = index;
+		}
+		packet[index].time[e->stage] = e->time;
+
+		if ( e->stage == TRACE_READ ) {
+			if ( n_pending >= max_pending ) {
+				max_pending = ( max_pending ? 2 * max_pending : 1024 );
+				pending = (int *) realloc( pending, max_pending * sizeof( int ) );
+				if ( !pending ) {
+					fMessageBox( MB_OK, "GripTraceMerge", "Error allocating memory." );
+					exit( -1 );
+				}
+			}
+			pending[n_pending++] = index;
+		}
+	}
+	free( pending );
+
+}
+
+// Report the distribution of the latencies between two stages, in milliseconds.
+// If from is negative, the latency is measured from the first stage at which each packet was seen.
+void ReportLatency( int from, int to, double *latency ) {
+
+	int n = 0;
+	int histogram[HISTOGRAM_BINS];
+	char label[64];
+	unsigned int bin;
+
+	for ( int p = 0; p < nPackets; p++ ) {
+		double start = -1.0;
+		if ( from >= 0 ) start = packet[p].time[from];
+		else for ( int stage = 0; stage < to && start < 0.0; stage++ ) start = packet[p].time[stage];
+		if ( start < 0.0 || packet[p].time[to] < 0.0 ) continue;
+		latency[n++] = 1000.0 * ( packet[p].time[to] - start );
+	}
+	if ( from >= 0 ) sprintf( label, "%s -> %s", GripTraceStageName[from], GripTraceStageName[to] );
+	else sprintf( label, "end to end -> %s", GripTraceStageName[to] );
+	if ( n == 0 ) {
+		printf( "%-28s  no packets\n", label );
+		return;
+	}
+
+	qsort( latency, n, sizeof( double ), CompareLatencies );
+	printf( "%-28s %8d  p50 %9.3f  p90 %9.3f  p99 %9.3f  max %9.3f ms\n", label, n,
+		latency[ n / 2 ], latency[ (int) ( 0.90 * ( n - 1 ) ) ], latency[ (int) ( 0.99 * ( n - 1 ) ) ], latency[ n - 1 ] );
+
+	for ( bin = 0; bin < HISTOGRAM_BINS; bin++ ) histogram[bin] = 0;
+	for ( int i = 0; i < n; i++ ) {
+		for ( bin = 0; bin < HISTOGRAM_BINS - 1; bin++ ) if ( latency[i] < histogramLimit[bin] ) break;
+		histogram[bin]++;
+	}
+	for ( bin = 0; bin < HISTOGRAM_BINS; bin++ ) {
+		if ( !histogram[bin] ) continue;
+		if ( bin < HISTOGRAM_BINS - 1 ) printf( "    < %7.1f ms %8d ", histogramLimit[bin], histogram[bin] );
+		else printf( "   >= %7.1f ms %8d ", histogramLimit[bin - 1], histogram[bin] );
+		for ( int star = 0; star < ( 50 * histogram[bin] + n - 1 ) / n; star++ ) printf( "*" );
+		printf( "\n" );
+	}
+
+}
+
+// Write the trace in the Chrome trace event format.
+// Each process gets a row with an instant event for each of its records, and the path of
+//  each packet from one stage to the next is drawn as asynchronous spans in a 'Packets' row.
+void WriteChromeTrace( const char *filename ) {
+
+	FILE *fp;
+	double origin;
+	int i;
+
+	fp = fopen( filename, "w" );
+	if ( !fp ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "Error opening %s for writing.", filename );
+		exit( -1 );
+	}
+	origin = ( nEvents > 0 ? event[0].time : 0.0 );
+
+	fprintf( fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	fprintf( fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Packets\"}}" );
+	for ( i = 0; i < nProcesses; i++ ) {
+		fprintf( fp, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"tid\":0,\"args\":{\"name\":\"%s\"}}",
+			processHeader[i].pid, processHeader[i].process );
+	}
+	for ( i = 0; i < nEvents; i++ ) {
+		fprintf( fp, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%lu,\"tid\":0,\"ts\":%.3f,\"args\":{\"TMCounter\":%lu}}",
+			GripTraceStageName[event[i].stage], processHeader[event[i].process].pid,
+			1000000.0 * ( event[i].time - origin ), event[i].counter );
+	}
+	for ( int p = 0; p < nPackets; p++ ) {
+		int from = -1;
+		for ( int stage = 0; stage < TRACE_STAGES; stage++ ) {
+			if ( packet[p].time[stage] < 0.0 ) continue;
+			if ( from >= 0 ) {
+				fprintf( fp, ",\n{\"name\":\"%s -> %s\",\"cat\":\"packet\",\"ph\":\"b\",\"id\":%d,\"pid\":0,\"tid\":0,\"ts\":%.3f,\"args\":{\"TMCounter\":%lu}}",
+					GripTraceStageName[from], GripTraceStageName[stage], p, 1000000.0 * ( packet[p].time[from] - origin ), packet[p].counter );
+				fprintf( fp, ",\n{\"name\":\"%s -> %s\",\"cat\":\"packet\",\"ph\":\"e\",\"id\":%d,\"pid\":0,\"tid\":0,\"ts\":%.3f}",
+					GripTraceStageName[from], GripTraceStageName[stage], p, 1000000.0 * ( packet[p].time[stage] - origin ) );
+			}
+			from = stage;
+		}
+	}
+	fprintf( fp, "\n]}\n" );
+	fclose( fp );
+	printf( "\nChrome trace written to %s.\n", filename );
+
+}
+
+int _tmain( int argc, char **argv )
+{
+	const char *json_filename = NULL;
+	double *latency;
+
+	for ( int arg = 1; arg < argc; arg++ ) {
+		if ( !strncmp( argv[arg], "-json=", strlen( "-json=" ) ) ) json_filename = argv[arg] + strlen( "-json=" );
+		else if ( GetFileAttributesA( argv[arg] ) != INVALID_FILE_ATTRIBUTES && ( GetFileAttributesA( argv[arg] ) & FILE_ATTRIBUTE_DIRECTORY ) ) ReadTraceDirectory( argv[arg] );
+		else ReadTraceFile( argv[arg] );
+	}
+	if ( nProcesses == 0 ) {
+		printf( "Usage: GripTraceMerge [-json=trace.json] <directory or .trc files> ...\n" );
+		return( 1 );
+	}
+
+	// Put the records of all the processes into a single time line and follow the packets.
+	qsort( event, nEvents, sizeof( TraceEvent ), CompareEventTimes );
+	FollowPackets();
+	printf( "\n%d records, %d packets.\n\n", nEvents, nPackets );
+
+	latency = (double *) malloc( ( nPackets + 1 ) * sizeof( double ) );
+	if ( !latency ) {
+		fMessageBox( MB_OK, "GripTraceMerge", "Error allocating memory for %d latencies.", nPackets );
+		exit( -1 );
+	}
+	for ( int stage = 1; stage < TRACE_STAGES; stage++ ) ReportLatency( stage - 1, stage, latency );
+	ReportLatency( -1, TRACE_DISPLAY, latency );
+	free( latency );
+
+	if ( json_filename ) WriteChromeTrace( json_filename );
+
+	return 0;
+}
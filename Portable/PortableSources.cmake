@@ -0,0 +1,45 @@
+###
+### PortableSources.cmake (GripMMI)
+###
+### The sources are written for Visual C++ and use backslashes in their #include paths,
+###  which gcc takes as part of the file name. portable_sources() copies the sources and
+###  headers of a directory into the build tree with the backslashes of the #include
+###  lines turned into slashes, and returns the paths of the copies of the sources.
+### The tree itself is left as it is. The copies are only rewritten when a source
+###  changes, so that an edit recompiles only what depends on it.
+
+set( PORTABLE_SOURCE_DIR ${CMAKE_BINARY_DIR}/portable )
+
+function( portable_copy source copy )
+	file( READ ${source} content )
+	string( REGEX MATCHALL "#[ \t]*include[ \t]*[<\"][^>\"\r\n]*[>\"]" includes "${content}" )
+	if( includes )
+		list( REMOVE_DUPLICATES includes )
+	endif()
+	foreach( include ${includes} )
+		string( FIND "${include}" "\\" backslash )
+		if( NOT backslash EQUAL -1 )
+			string( REPLACE "\\" "/" fixed "${include}" )
+			string( REPLACE "${include}" "${fixed}" content "${content}" )
+		endif()
+	endforeach()
+	file( WRITE ${copy}.tmp "${content}" )
+	configure_file( ${copy}.tmp ${copy} COPYONLY )
+	file( REMOVE ${copy}.tmp )
+	set_property( DIRECTORY ${CMAKE_SOURCE_DIR} APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${source} )
+endfunction()
+
+# portable_sources( <variable> <directory> <source> ... )
+# All the headers of the directory are copied as well, since the sources may include any of them.
+function( portable_sources variable directory )
+	file( GLOB headers RELATIVE ${CMAKE_SOURCE_DIR}/${directory} ${CMAKE_SOURCE_DIR}/${directory}/*.h )
+	foreach( header ${headers} )
+		portable_copy( ${CMAKE_SOURCE_DIR}/${directory}/${header} ${PORTABLE_SOURCE_DIR}/${directory}/${header} )
+	endforeach()
+	set( copies )
+	foreach( source ${ARGN} )
+		portable_copy( ${CMAKE_SOURCE_DIR}/${directory}/${source} ${PORTABLE_SOURCE_DIR}/${directory}/${source} )
+		list( APPEND copies ${PORTABLE_SOURCE_DIR}/${directory}/${source} )
+	endforeach()
+	set( ${variable} ${copies} PARENT_SCOPE )
+endfunction()
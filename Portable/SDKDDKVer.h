@@ -0,0 +1,3 @@
+#pragma once
+
+// Stand-in for the Windows SDK version header included by targetver.h. There is nothing to select on Linux.
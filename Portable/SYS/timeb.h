@@ -0,0 +1,25 @@
+//
+// Stand-in for the Visual C++ time header on Linux. The sources include it as SYS\timeb.h.
+// See Windows.h.
+//
+
+#pragma once
+
+#include <time.h>
+
+struct __timeb32 {
+	int				time;		// Seconds since midnight Jan. 1 1970 UTC.
+	unsigned short	millitm;
+	short			timezone;
+	short			dstflag;
+};
+
+static inline int _ftime32_s( struct __timeb32 *timeptr ) {
+	struct timespec now;
+	clock_gettime( CLOCK_REALTIME, &now );
+	timeptr->time = (int) now.tv_sec;
+	timeptr->millitm = (unsigned short) ( now.tv_nsec / 1000000 );
+	timeptr->timezone = 0;
+	timeptr->dstflag = 0;
+	return( 0 );
+}
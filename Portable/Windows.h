@@ -0,0 +1,434 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                   Windows.h                                   */
+/*                                                                               */
+/*********************************************************************************/
+
+//
+// Stand-in for the Windows header when the Grip and Useful libraries are built on Linux.
+// It provides only what those libraries use, in terms of POSIX calls.
+// Put this directory on the include path of non-Windows builds only.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fnmatch.h>
+
+// Visual C++ built-in type. 'unsigned __int64' still works with a macro.
+#define __int64	long long
+// Calling conventions only matter on 32-bit Windows.
+#define __cdecl
+#define __stdcall
+#define WINAPI
+
+typedef int				BOOL;
+typedef unsigned char	BYTE;
+typedef unsigned short	WORD;
+typedef unsigned long	DWORD;
+typedef long			LONG;
+typedef void			*HANDLE;
+typedef const char		*PCSTR;
+typedef int				errno_t;
+
+#ifndef TRUE
+#define TRUE	1
+#define FALSE	0
+#endif
+
+#define MAX_PATH	260
+
+// Some of the stand-ins below ignore some of their parameters, as do some Windows callbacks.
+#define UNREFERENCED_PARAMETER( parameter )	( (void) ( parameter ) )
+
+// Message boxes are written to stderr. There is nobody to answer a question,
+//  so those that ask one get the answer that does not go ahead.
+#define MB_OK				0x00
+#define MB_OKCANCEL			0x01
+#define MB_ABORTRETRYIGNORE	0x02
+#define MB_YESNOCANCEL		0x03
+#define MB_YESNO			0x04
+#define MB_RETRYCANCEL		0x05
+#define MB_ICONERROR		0x10
+#define MB_ICONQUESTION		0x20
+#define MB_ICONEXCLAMATION	0x30
+#define MB_ICONWARNING		0x30
+#define MB_ICONINFORMATION	0x40
+
+#define IDOK		1
+#define IDCANCEL	2
+#define IDABORT		3
+#define IDRETRY		4
+#define IDIGNORE	5
+#define IDYES		6
+#define IDNO		7
+
+static inline int MessageBox( void *owner, const char *text, const char *caption, unsigned int type ) {
+	UNREFERENCED_PARAMETER( owner );
+	fprintf( stderr, "%s: %s\n", caption, text );
+	switch ( type & 0x0f ) {
+	case MB_OK: return( IDOK );
+	case MB_ABORTRETRYIGNORE: return( IDABORT );
+	case MB_YESNO: return( IDNO );
+	default: return( IDCANCEL );
+	}
+}
+
+// There is no debugger window to write to.
+static inline void OutputDebugString( const char *message ) {
+	UNREFERENCED_PARAMETER( message );
+}
+
+static inline void Sleep( DWORD milliseconds ) {
+	usleep( (useconds_t) milliseconds * 1000 );
+}
+
+// The performance counter counts nanoseconds of the monotonic clock.
+typedef union {
+	long long QuadPart;
+} LARGE_INTEGER;
+
+static inline BOOL QueryPerformanceFrequency( LARGE_INTEGER *frequency ) {
+	frequency->QuadPart = 1000000000LL;
+	return( TRUE );
+}
+static inline BOOL QueryPerformanceCounter( LARGE_INTEGER *count ) {
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	count->QuadPart = (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+	return( TRUE );
+}
+
+static inline DWORD GetCurrentProcessId( void ) {
+	return( (DWORD) getpid() );
+}
+
+static inline DWORD GetLastError( void ) {
+	return( (DWORD) errno );
+}
+
+#define ZeroMemory( destination, length )	memset( ( destination ), 0, ( length ) )
+
+// Kernel objects. Files, file mappings, threads and events are all HANDLEs to Windows,
+//  so the object says which one it is and holds the POSIX file descriptor, thread or condition.
+#define PORTABLE_FILE		1
+#define PORTABLE_MAPPING	2
+#define PORTABLE_THREAD		3
+#define PORTABLE_EVENT		4
+
+typedef struct {
+	int				type;
+	int				fd;
+	pthread_t		thread;
+	BOOL			joined;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	condition;
+	BOOL			signaled;
+} PortableObject;
+
+#define INVALID_HANDLE_VALUE	( (HANDLE) -1 )
+
+static inline HANDLE PortableCreateObject( int type, int fd ) {
+	PortableObject *object = (PortableObject *) calloc( 1, sizeof( PortableObject ) );
+	if ( !object ) return( NULL );
+	object->type = type;
+	object->fd = fd;
+	return( (HANDLE) object );
+}
+
+static inline BOOL CloseHandle( HANDLE handle ) {
+	PortableObject *object = (PortableObject *) handle;
+	if ( !object || handle == INVALID_HANDLE_VALUE ) return( FALSE );
+	if ( object->type == PORTABLE_THREAD && !object->joined ) pthread_detach( object->thread );
+	else if ( object->type == PORTABLE_EVENT ) {
+		pthread_cond_destroy( &object->condition );
+		pthread_mutex_destroy( &object->mutex );
+	}
+	else if ( object->type != PORTABLE_THREAD ) close( object->fd );
+	free( object );
+	return( TRUE );
+}
+
+#define INFINITE		0xFFFFFFFF
+#define WAIT_OBJECT_0	0
+#define WAIT_FAILED		0xFFFFFFFF
+
+// Only events that reset themselves are supported, without a name.
+static inline HANDLE CreateEventA( void *security, BOOL manual_reset, BOOL initial_state, const char *name ) {
+	PortableObject *object;
+	UNREFERENCED_PARAMETER( security );
+	if ( manual_reset || name ) return( NULL );
+	object = (PortableObject *) PortableCreateObject( PORTABLE_EVENT, -1 );
+	if ( !object ) return( NULL );
+	pthread_mutex_init( &object->mutex, NULL );
+	pthread_cond_init( &object->condition, NULL );
+	object->signaled = initial_state;
+	return( (HANDLE) object );
+}
+#define CreateEvent	CreateEventA
+
+static inline BOOL SetEvent( HANDLE handle ) {
+	PortableObject *object = (PortableObject *) handle;
+	if ( !object || object->type != PORTABLE_EVENT ) return( FALSE );
+	pthread_mutex_lock( &object->mutex );
+	object->signaled = TRUE;
+	pthread_cond_signal( &object->condition );
+	pthread_mutex_unlock( &object->mutex );
+	return( TRUE );
+}
+
+// Only waiting for a thread to finish or for an event is supported, and only without a time limit.
+static inline DWORD WaitForSingleObject( HANDLE handle, DWORD milliseconds ) {
+	PortableObject *object = (PortableObject *) handle;
+	if ( !object || milliseconds != INFINITE ) return( WAIT_FAILED );
+	if ( object->type == PORTABLE_EVENT ) {
+		pthread_mutex_lock( &object->mutex );
+		while ( !object->signaled ) pthread_cond_wait( &object->condition, &object->mutex );
+		// The event resets itself as it lets one waiting thread go.
+		object->signaled = FALSE;
+		pthread_mutex_unlock( &object->mutex );
+		return( WAIT_OBJECT_0 );
+	}
+	if ( object->type != PORTABLE_THREAD ) return( WAIT_FAILED );
+	if ( !object->joined && pthread_join( object->thread, NULL ) ) return( WAIT_FAILED );
+	object->joined = TRUE;
+	return( WAIT_OBJECT_0 );
+}
+
+// Files, for the memory mapping of files.
+#define GENERIC_READ				0x80000000
+#define GENERIC_WRITE				0x40000000
+#define FILE_SHARE_READ				0x01
+#define FILE_SHARE_WRITE			0x02
+#define CREATE_NEW					1
+#define CREATE_ALWAYS				2
+#define OPEN_EXISTING				3
+#define OPEN_ALWAYS					4
+#define TRUNCATE_EXISTING			5
+#define FILE_ATTRIBUTE_NORMAL		0x80
+#define FILE_FLAG_SEQUENTIAL_SCAN	0x08000000
+
+// Files are not locked on Linux, so the sharing mode is ignored.
+static inline HANDLE CreateFileA( const char *filename, DWORD access, DWORD share, void *security, DWORD disposition, DWORD flags, HANDLE template_file ) {
+	int oflag = ( access & GENERIC_WRITE ? ( access & GENERIC_READ ? O_RDWR : O_WRONLY ) : O_RDONLY );
+	HANDLE handle;
+	int fd;
+	UNREFERENCED_PARAMETER( share );
+	UNREFERENCED_PARAMETER( security );
+	UNREFERENCED_PARAMETER( flags );
+	UNREFERENCED_PARAMETER( template_file );
+	switch ( disposition ) {
+	case CREATE_NEW: oflag |= O_CREAT | O_EXCL; break;
+	case CREATE_ALWAYS: oflag |= O_CREAT | O_TRUNC; break;
+	case OPEN_ALWAYS: oflag |= O_CREAT; break;
+	case TRUNCATE_EXISTING: oflag |= O_TRUNC; break;
+	}
+	fd = open( filename, oflag, 0644 );
+	if ( fd < 0 ) return( INVALID_HANDLE_VALUE );
+	handle = PortableCreateObject( PORTABLE_FILE, fd );
+	if ( !handle ) {
+		close( fd );
+		return( INVALID_HANDLE_VALUE );
+	}
+	return( handle );
+}
+
+static inline BOOL GetFileSizeEx( HANDLE file, LARGE_INTEGER *size ) {
+	struct stat file_stat;
+	if ( file == INVALID_HANDLE_VALUE || fstat( ( (PortableObject *) file )->fd, &file_stat ) ) return( FALSE );
+	size->QuadPart = (long long) file_stat.st_size;
+	return( TRUE );
+}
+
+static inline DWORD GetFileSize( HANDLE file, DWORD *high ) {
+	LARGE_INTEGER size;
+	if ( !GetFileSizeEx( file, &size ) ) return( 0xFFFFFFFF );
+	if ( high ) *high = (DWORD) ( size.QuadPart >> 32 );
+	return( (DWORD) ( size.QuadPart & 0xFFFFFFFF ) );
+}
+
+#define PAGE_READONLY	0x02
+#define PAGE_READWRITE	0x04
+#define FILE_MAP_WRITE	0x02
+#define FILE_MAP_READ	0x04
+
+// As on Windows, a mapping for writing makes the file as big as the mapping.
+static inline HANDLE CreateFileMappingA( HANDLE file, void *security, DWORD protect, DWORD size_high, DWORD size_low, const char *name ) {
+	long long size = ( (long long) size_high << 32 ) | size_low;
+	LARGE_INTEGER file_size;
+	HANDLE mapping;
+	int fd;
+	UNREFERENCED_PARAMETER( security );
+	UNREFERENCED_PARAMETER( name );
+	if ( !GetFileSizeEx( file, &file_size ) ) return( NULL );
+	if ( protect == PAGE_READWRITE && size > file_size.QuadPart && ftruncate( ( (PortableObject *) file )->fd, (off_t) size ) ) return( NULL );
+	fd = dup( ( (PortableObject *) file )->fd );
+	if ( fd < 0 ) return( NULL );
+	mapping = PortableCreateObject( PORTABLE_MAPPING, fd );
+	if ( !mapping ) close( fd );
+	return( mapping );
+}
+
+// munmap() needs the length of the view, so the views that are open are remembered here.
+// Each source file has its own list, so a view has to be unmapped in the file that mapped it.
+#define PORTABLE_MAX_VIEWS	16
+static struct {
+	void	*address;
+	size_t	length;
+} portableView[PORTABLE_MAX_VIEWS];
+
+static inline void *MapViewOfFile( HANDLE mapping, DWORD access, DWORD offset_high, DWORD offset_low, size_t bytes ) {
+	off_t offset = (off_t) ( ( (long long) offset_high << 32 ) | offset_low );
+	struct stat file_stat;
+	void *address;
+	int i;
+	if ( !mapping || fstat( ( (PortableObject *) mapping )->fd, &file_stat ) ) return( NULL );
+	// Zero bytes means the rest of the file.
+	if ( bytes == 0 ) bytes = (size_t) ( file_stat.st_size - offset );
+	for ( i = 0; i < PORTABLE_MAX_VIEWS && portableView[i].address; i++ );
+	if ( i >= PORTABLE_MAX_VIEWS || bytes == 0 ) return( NULL );
+	address = mmap( NULL, bytes, ( access & FILE_MAP_WRITE ? PROT_READ | PROT_WRITE : PROT_READ ), MAP_SHARED, ( (PortableObject *) mapping )->fd, offset );
+	if ( address == MAP_FAILED ) return( NULL );
+	portableView[i].address = address;
+	portableView[i].length = bytes;
+	return( address );
+}
+
+static inline BOOL UnmapViewOfFile( const void *address ) {
+	for ( int i = 0; i < PORTABLE_MAX_VIEWS; i++ ) {
+		if ( portableView[i].address == address ) {
+			munmap( portableView[i].address, portableView[i].length );
+			portableView[i].address = NULL;
+			return( TRUE );
+		}
+	}
+	return( FALSE );
+}
+
+// Directory searches. The pattern may only have wildcards in its last component,
+//  which is matched with fnmatch().
+#define FILE_ATTRIBUTE_DIRECTORY	0x10
+#define INVALID_FILE_ATTRIBUTES		0xFFFFFFFF
+
+typedef struct {
+	DWORD	dwFileAttributes;
+	char	cFileName[MAX_PATH];
+} WIN32_FIND_DATAA;
+
+typedef struct {
+	DIR		*directory;
+	char	pattern[MAX_PATH];
+} PortableSearch;
+
+static inline DWORD GetFileAttributesA( const char *filename ) {
+	struct stat file_stat;
+	if ( stat( filename, &file_stat ) ) return( INVALID_FILE_ATTRIBUTES );
+	return( S_ISDIR( file_stat.st_mode ) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL );
+}
+
+static inline BOOL FindNextFileA( HANDLE handle, WIN32_FIND_DATAA *found ) {
+	PortableSearch *search = (PortableSearch *) handle;
+	struct dirent *entry;
+	while ( ( entry = readdir( search->directory ) ) ) {
+		if ( fnmatch( search->pattern, entry->d_name, 0 ) ) continue;
+		snprintf( found->cFileName, sizeof( found->cFileName ), "%s", entry->d_name );
+		found->dwFileAttributes = ( entry->d_type == DT_DIR ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL );
+		return( TRUE );
+	}
+	return( FALSE );
+}
+
+static inline BOOL FindClose( HANDLE handle ) {
+	PortableSearch *search = (PortableSearch *) handle;
+	if ( !search || handle == INVALID_HANDLE_VALUE ) return( FALSE );
+	closedir( search->directory );
+	free( search );
+	return( TRUE );
+}
+
+static inline HANDLE FindFirstFileA( const char *pattern, WIN32_FIND_DATAA *found ) {
+	const char *name = strrchr( pattern, '/' );
+	char directory[MAX_PATH];
+	PortableSearch *search;
+	if ( !name ) snprintf( directory, sizeof( directory ), "." );
+	else if ( name == pattern ) snprintf( directory, sizeof( directory ), "/" );
+	else snprintf( directory, sizeof( directory ), "%.*s", (int) ( name - pattern ), pattern );
+	name = ( name ? name + 1 : pattern );
+	search = (PortableSearch *) calloc( 1, sizeof( PortableSearch ) );
+	if ( !search ) return( INVALID_HANDLE_VALUE );
+	snprintf( search->pattern, sizeof( search->pattern ), "%s", name );
+	search->directory = opendir( directory );
+	if ( !search->directory ) {
+		free( search );
+		return( INVALID_HANDLE_VALUE );
+	}
+	if ( !FindNextFileA( (HANDLE) search, found ) ) {
+		FindClose( (HANDLE) search );
+		return( INVALID_HANDLE_VALUE );
+	}
+	return( (HANDLE) search );
+}
+
+// Critical sections, which like those of Windows can be entered again by the thread that holds them.
+typedef pthread_mutex_t	CRITICAL_SECTION;
+
+static inline void InitializeCriticalSection( CRITICAL_SECTION *section ) {
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init( &attributes );
+	pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+	pthread_mutex_init( section, &attributes );
+	pthread_mutexattr_destroy( &attributes );
+}
+static inline void EnterCriticalSection( CRITICAL_SECTION *section ) {
+	pthread_mutex_lock( section );
+}
+static inline void LeaveCriticalSection( CRITICAL_SECTION *section ) {
+	pthread_mutex_unlock( section );
+}
+static inline void DeleteCriticalSection( CRITICAL_SECTION *section ) {
+	pthread_mutex_destroy( section );
+}
+
+static inline LONG InterlockedIncrement( volatile LONG *target ) {
+	return( __sync_add_and_fetch( target, 1 ) );
+}
+static inline LONG InterlockedExchange( volatile LONG *target, LONG value ) {
+	__sync_synchronize();
+	return( __sync_lock_test_and_set( target, value ) );
+}
+static inline LONG InterlockedCompareExchange( volatile LONG *target, LONG exchange, LONG comparand ) {
+	return( __sync_val_compare_and_swap( target, comparand, exchange ) );
+}
+#define MemoryBarrier()	__sync_synchronize()
+
+// Only the number of processors is filled in.
+typedef struct {
+	DWORD	dwNumberOfProcessors;
+} SYSTEM_INFO;
+static inline void GetSystemInfo( SYSTEM_INFO *info ) {
+	long processors = sysconf( _SC_NPROCESSORS_ONLN );
+	info->dwNumberOfProcessors = ( processors > 0 ? (DWORD) processors : 1 );
+}
+
+#define _snprintf	snprintf
+#define _vsnprintf	vsnprintf
+#define _fseeki64	fseeko
+#define _ftelli64	ftello
+// snprintf() always terminates the string, which is what the size argument is for.
+#define sprintf_s	snprintf
+#define _strdup		strdup
+#define _stricmp	strcasecmp
+#define _strnicmp	strncasecmp
+#define _finite( x )	isfinite( x )
@@ -0,0 +1,14 @@
+//
+// Stand-in for the Visual C++ debug heap header on Linux. The debug heap is not available,
+//  so the checks that it does are left out. See Windows.h.
+//
+
+#pragma once
+
+#include <assert.h>
+
+#define _ASSERT( expression )	assert( expression )
+#define _ASSERTE( expression )	assert( expression )
+#define _CrtCheckMemory()		( 1 )
+#define _CrtDumpMemoryLeaks()	( 0 )
+#define _CrtSetDbgFlag( flag )	( 0 )
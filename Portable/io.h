@@ -0,0 +1,43 @@
+//
+// Stand-in for the Visual C++ low-level I/O header on Linux. See Windows.h.
+//
+
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+#define _O_RDONLY	O_RDONLY
+#define _O_WRONLY	O_WRONLY
+#define _O_RDWR		O_RDWR
+#define _O_CREAT	O_CREAT
+#define _O_TRUNC	O_TRUNC
+#define _O_APPEND	O_APPEND
+// There is no distinction between text and binary files.
+#define _O_BINARY	0
+#define _O_TEXT		0
+
+#define _S_IREAD	S_IRUSR
+#define _S_IWRITE	S_IWUSR
+
+#define _open	open
+#define _read	read
+#define _write	write
+#define _close	close
+#define _lseek	lseek
+
+// Files are not locked on Linux, so the sharing mode is ignored.
+static inline int _sopen( const char *filename, int flags, int share, int mode ) {
+	(void) share;
+	return( open( filename, flags, mode | S_IRGRP | S_IROTH ) );
+}
+
+static inline int _sopen_s( int *fd, const char *filename, int flags, int share, int mode ) {
+	*fd = _sopen( filename, flags, share, mode );
+	return( *fd < 0 ? errno : 0 );
+}
+
+// The 64-bit file status, which is the normal one on 64-bit Linux.
+#define _stat64	stat
@@ -0,0 +1,5 @@
+//
+// Stand-in for the Windows multimedia header on Linux. Nothing in it is used by the portable sources.
+//
+
+#pragma once
@@ -0,0 +1,42 @@
+//
+// Stand-in for the Visual C++ process header on Linux. Threads are POSIX threads. See Windows.h.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Windows.h>
+
+typedef struct {
+	unsigned	(*start)( void * );
+	void		*parameter;
+} PortableThreadStart;
+
+static inline void *PortableThread( void *parameter ) {
+	PortableThreadStart start = *( (PortableThreadStart *) parameter );
+	free( parameter );
+	return( (void *) (uintptr_t) start.start( start.parameter ) );
+}
+
+// The stack size and the flags are ignored. Threads always start running.
+static inline uintptr_t _beginthreadex( void *security, unsigned stack_size, unsigned (*start)( void * ), void *parameter, unsigned flags, unsigned *thread_id ) {
+	PortableThreadStart *thread_start = (PortableThreadStart *) malloc( sizeof( PortableThreadStart ) );
+	PortableObject *object = (PortableObject *) PortableCreateObject( PORTABLE_THREAD, -1 );
+	UNREFERENCED_PARAMETER( security );
+	UNREFERENCED_PARAMETER( stack_size );
+	UNREFERENCED_PARAMETER( flags );
+	if ( !thread_start || !object ) {
+		free( thread_start );
+		free( object );
+		return( 0 );
+	}
+	thread_start->start = start;
+	thread_start->parameter = parameter;
+	if ( pthread_create( &object->thread, NULL, PortableThread, thread_start ) ) {
+		free( thread_start );
+		free( object );
+		return( 0 );
+	}
+	if ( thread_id ) *thread_id = 0;
+	return( (uintptr_t) object );
+}
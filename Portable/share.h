@@ -0,0 +1,10 @@
+//
+// Stand-in for the Visual C++ file sharing header on Linux. See io.h.
+//
+
+#pragma once
+
+#define _SH_DENYRW	0x10
+#define _SH_DENYWR	0x20
+#define _SH_DENYRD	0x30
+#define _SH_DENYNO	0x40
@@ -0,0 +1,9 @@
+//
+// Stand-in for the Visual C++ generic text header on Linux. The sources only use single-byte text.
+//
+
+#pragma once
+
+typedef char	_TCHAR;
+#define _T( x )	x
+#define _tmain	main
@@ -0,0 +1,3 @@
+// Some of the sources spell it this way. See Windows.h.
+#pragma once
+#include "Windows.h"
@@ -0,0 +1,124 @@
+//
+// Stand-in for the Windows sockets header on Linux. Windows sockets are BSD sockets
+//  with a different name for a few things, so most of this is a matter of renaming.
+// See Windows.h.
+//
+
+#pragma once
+
+#include <Windows.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+typedef int	SOCKET;
+#define INVALID_SOCKET	( -1 )
+#define SOCKET_ERROR	( -1 )
+
+#define SD_RECEIVE	SHUT_RD
+#define SD_SEND		SHUT_WR
+#define SD_BOTH		SHUT_RDWR
+
+// Nothing needs to be started or cleaned up.
+typedef struct {
+	WORD	wVersion;
+	WORD	wHighVersion;
+} WSADATA;
+#define MAKEWORD( low, high )	( (WORD) ( ( (BYTE) ( low ) ) | ( ( (WORD) ( (BYTE) ( high ) ) ) << 8 ) ) )
+
+static inline int WSAStartup( WORD version, WSADATA *data ) {
+	data->wVersion = data->wHighVersion = version;
+	return( 0 );
+}
+static inline int WSACleanup( void ) {
+	return( 0 );
+}
+static inline int closesocket( SOCKET s ) {
+	return( close( s ) );
+}
+
+// The error codes are those of errno. A send or receive that times out fails with EAGAIN.
+static inline int WSAGetLastError( void ) {
+	return( errno );
+}
+#define WSAETIMEDOUT	EAGAIN
+#define WSAECONNRESET	ECONNRESET
+#define WSAEWOULDBLOCK	EWOULDBLOCK
+
+// A send to a socket that the other end has closed fails on Windows, but raises SIGPIPE on Linux.
+static inline int PortableSend( SOCKET s, const char *buffer, int length, int flags ) {
+	return( (int) send( s, buffer, (size_t) length, flags | MSG_NOSIGNAL ) );
+}
+#define send	PortableSend
+
+// Windows gives the send and receive timeouts in milliseconds as a DWORD, POSIX as a timeval.
+static inline int PortableSetSocketOption( SOCKET s, int level, int name, const char *value, int length ) {
+	if ( level == SOL_SOCKET && ( name == SO_SNDTIMEO || name == SO_RCVTIMEO ) && length == sizeof( DWORD ) ) {
+		DWORD milliseconds = *( (const DWORD *) value );
+		struct timeval timeout;
+		timeout.tv_sec = milliseconds / 1000;
+		timeout.tv_usec = ( milliseconds % 1000 ) * 1000;
+		return( setsockopt( s, level, name, &timeout, sizeof( timeout ) ) );
+	}
+	return( setsockopt( s, level, name, value, (socklen_t) length ) );
+}
+#define setsockopt	PortableSetSocketOption
+
+// Gathered sends. Overlapped (asynchronous) sends are not supported.
+typedef struct {
+	unsigned long	len;
+	char			*buf;
+} WSABUF;
+
+#define PORTABLE_MAX_WSABUF	64
+
+static inline int WSASend( SOCKET s, WSABUF *buffers, DWORD count, DWORD *sent, DWORD flags, void *overlapped, void *completion ) {
+	struct iovec vector[PORTABLE_MAX_WSABUF];
+	struct msghdr message;
+	DWORD total = 0;
+	DWORD first = 0;
+	size_t offset = 0;
+	if ( overlapped || completion ) {
+		errno = EINVAL;
+		return( SOCKET_ERROR );
+	}
+	// Like a blocking WSASend(), we only return once everything is sent.
+	// sendmsg() may send only part of it, so go on from where it stopped.
+	while ( first < count ) {
+		DWORD n = 0;
+		ssize_t result;
+		for ( DWORD i = first; i < count && n < PORTABLE_MAX_WSABUF; i++, n++ ) {
+			vector[n].iov_base = buffers[i].buf + ( i == first ? offset : 0 );
+			vector[n].iov_len = buffers[i].len - ( i == first ? offset : 0 );
+		}
+		memset( &message, 0, sizeof( message ) );
+		message.msg_iov = vector;
+		message.msg_iovlen = n;
+		result = sendmsg( s, &message, (int) flags | MSG_NOSIGNAL );
+		if ( result < 0 ) return( SOCKET_ERROR );
+		total += (DWORD) result;
+		while ( result > 0 && first < count ) {
+			size_t left = buffers[first].len - offset;
+			if ( (size_t) result >= left ) {
+				result -= (ssize_t) left;
+				first++;
+				offset = 0;
+			}
+			else {
+				offset += (size_t) result;
+				result = 0;
+			}
+		}
+		// Skip empty buffers, so that we do not call sendmsg() with nothing to send.
+		while ( first < count && buffers[first].len == offset ) {
+			first++;
+			offset = 0;
+		}
+	}
+	if ( sent ) *sent = total;
+	return( 0 );
+}
@@ -0,0 +1,7 @@
+//
+// Stand-in for the Windows TCP/IP header on Linux. getaddrinfo() and the like come with winsock2.h.
+//
+
+#pragma once
+
+#include <winsock2.h>
@@ -457,6 +457,7 @@ void ViewAutoScaleInit( View view ) {
    * and the lower limit to the most positive, the first value seen
    * in the array will be taken as the initial min and max.
    */
+  ViewAutoScaleCount++;
   ViewSetYLimits( view, HUGE, - HUGE );
 }
 
@@ -648,6 +649,39 @@ void ViewAutoScaleAvailableDoubles ( View view, double *array,
 	
 }
 
+/***************************************************************************/
+
+/*
+ * Same as above, but only the samples within the list of runs are considered.
+ * There is no need to test each sample against an NA value.
+ */
+
+void ViewAutoScaleDoubleRuns ( View view, double *array, 
+			       ViewRun *run, int n_runs, unsigned size ) {
+					
+  register int i;
+  register double   *pt;
+	
+  double min, max;
+  int r;
+
+  min = view->user_bottom;
+  max = view->user_top;
+	
+  for ( r = 0; r < n_runs; r++ ) {
+    for (i = run[r].first; i <= run[r].last; i++) {
+
+      pt = (double *)(((char *) array) + i * size);
+      if ( *pt > max ) max = *pt;
+      if ( *pt < min ) min = *pt;
+
+    }
+  }
+	
+  ViewSetYLimits( view, min, max );
+	
+}
+
 /*****************************************************************************/
 
 /*
@@ -853,11 +887,12 @@ void ViewXYPlotDoubles (View view, double *xarray, double *yarray,
   register int i;
   register double	*xpt, *ypt;
 
+  if ( step < 1 ) step = 1;
   xpt = (double *)(((char *) xarray) + start * xsize);
   ypt = (double *)(((char *) yarray) + start * ysize);
   ViewMoveTo(view, *xpt, *ypt);
 
-  for (i = start; i <= end; i++) {
+  for (i = start; i <= end; i += step) {
 
     xpt = (double *)(((char *) xarray) + i * xsize);
     ypt = (double *)(((char *) yarray) + i * ysize);
@@ -971,6 +1006,81 @@ void ViewXYPlotClippedDoubles (View view, double *xarray, double *yarray,
   }
 }
 
+/***************************************************************************/
+
+/*
+ * Plot only the samples within each run of valid samples.
+ * Each run is drawn as a single connected trace, sub-sampled by step,
+ * but the last sample of a run is always included so that the trace
+ * ends where the data ends. Nothing is drawn between runs.
+ */
+
+void ViewXYPlotDoubleRuns (View view, double *xarray, double *yarray, 
+			   ViewRun *run, int n_runs, int step,
+			   unsigned xsize, unsigned ysize)
+{
+	
+  register int i;
+  register double   *xpt, *ypt;
+  int r;
+
+  if ( step < 1 ) step = 1;
+  for ( r = 0; r < n_runs; r++ ) {
+
+    if ( run[r].last <= run[r].first ) continue;
+    xpt = (double *)(((char *) xarray) + run[r].first * xsize);
+    ypt = (double *)(((char *) yarray) + run[r].first * ysize);
+    ViewMoveTo(view, *xpt, *ypt);
+
+    for ( i = run[r].first + step; i < run[r].last; i += step ) {
+      xpt = (double *)(((char *) xarray) + i * xsize);
+      ypt = (double *)(((char *) yarray) + i * ysize);
+      ViewLineTo(view, *xpt, *ypt);
+    }
+
+    xpt = (double *)(((char *) xarray) + run[r].last * xsize);
+    ypt = (double *)(((char *) yarray) + run[r].last * ysize);
+    ViewLineTo(view, *xpt, *ypt);
+
+  }
+}
+
+/*
+ * As above, but a segment is drawn only if both ends fall within the view.
+ */
+
+void ViewXYPlotClippedDoubleRuns (View view, double *xarray, double *yarray, 
+				  ViewRun *run, int n_runs, int step,
+				  unsigned xsize, unsigned ysize)
+{
+	
+  register int i;
+  register double   *xpt, *ypt;
+  int r, inside, previous_inside;
+
+  if ( step < 1 ) step = 1;
+  for ( r = 0; r < n_runs; r++ ) {
+
+    previous_inside = 0;
+    i = run[r].first;
+    while ( i <= run[r].last ) {
+      xpt = (double *)(((char *) xarray) + i * xsize);
+      ypt = (double *)(((char *) yarray) + i * ysize);
+      inside = ( *xpt >= view->user_left && *xpt <= view->user_right &&
+		 *ypt >= view->user_bottom && *ypt <= view->user_top );
+      if ( inside ) {
+	if ( previous_inside ) ViewLineTo(view, *xpt, *ypt);
+	else ViewMoveTo(view, *xpt, *ypt);
+      }
+      previous_inside = inside;
+      if ( i == run[r].last ) break;
+      i += step;
+      if ( i > run[r].last ) i = run[r].last;
+    }
+
+  }
+}
+
 /***************************************************************************/
 /*                              Scatter Plots                              */
 /***************************************************************************/
@@ -981,7 +1091,7 @@ void ViewScatterPlotInts (	View view, int symbol,
 				unsigned xsize, unsigned ysize)
 {
 
-  register  i;
+  register int i;
   register int	*xpt, *ypt;
 
   for (i = start; i <= end; i++) {
@@ -1078,3 +1188,34 @@ void ViewScatterPlotAvailableDoubles (View view, int symbol,
   }
 }
 
+
+/***************************************************************************/
+
+/*
+ * Scatter plot of the samples within each run of valid samples.
+ * A size of 0 may be given for one of the arrays to plot all the
+ * points at the same value, e.g. to show when a signal is available.
+ */
+
+void ViewScatterPlotDoubleRuns (View view, int symbol,
+				double *xarray, double *yarray, 
+				ViewRun *run, int n_runs, int step,
+				unsigned xsize, unsigned ysize )
+{
+
+  register int i;
+  register double	*xpt, *ypt;
+  int r;
+
+  if ( step < 1 ) step = 1;
+  for ( r = 0; r < n_runs; r++ ) {
+    for (i = run[r].first; i <= run[r].last; i += step ) {
+
+      xpt = (double *)(((char *) xarray) + i * xsize);
+      ypt = (double *)(((char *) yarray) + i * ysize);
+      ViewSymbol(view, *xpt, *ypt, symbol);
+
+    }
+  }
+}
+
@@ -40,35 +40,91 @@
 /*
  * This provide a dummy display to substitute when we don't have
  * a hardcopy device.
+ * Each routine has the type of the entries of struct _display that it fills.
  */
 
-void    _null_proc(); 
-int	_null_int_proc(); 
-
-float	_null_float_proc();
-
-double	_null_double_proc();
-
+local void _null_proc( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+local void _null_xy_proc( Display display, float x, float y ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+}
+local void _null_xyxy_proc( Display display, float x1, float y1, float x2, float y2 ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x1 );
+  UNREFERENCED_PARAMETER( y1 );
+  UNREFERENCED_PARAMETER( x2 );
+  UNREFERENCED_PARAMETER( y2 );
+}
+local void _null_circle_proc( Display display, float x, float y, float radius ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  UNREFERENCED_PARAMETER( radius );
+}
+local void _null_text_proc( Display display, char *string, float x, float y, double dir ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( string );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  UNREFERENCED_PARAMETER( dir );
+}
+local float _null_text_size_proc( Display display, char *string ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( string );
+  return( (float) 0.0 );
+}
+local void _null_int_proc( Display display, int value ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( value );
+}
+local void _null_rgb_proc( Display display, float r, float g, float b ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( r );
+  UNREFERENCED_PARAMETER( g );
+  UNREFERENCED_PARAMETER( b );
+}
+local void _null_pen_proc( Display display, float pen ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( pen );
+}
+local void _null_hardcopy_proc( Display display, char *filename ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( filename );
+}
+local int _null_input_proc( Display display, float *x, float *y ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  return( 0 );
+}
 
 struct _display _NullDisplay = {
   "NULL Display",
     0, 100, 0, 100,
-    _null_proc, _null_proc, _null_proc, _null_proc,
-    _null_proc, _null_float_proc, _null_float_proc,
-    _null_proc, _null_proc, _null_proc, 
-    _null_proc, _null_proc, _null_proc, _null_proc,
-    _null_proc, _null_proc, _null_proc, _null_proc, _null_proc,
-    _null_proc, _null_proc, _null_proc, _null_int_proc,
-    0, 0, 0, 0, 2, -1, -1, 0, 0, 0};
+    _null_xy_proc, _null_xyxy_proc, _null_xy_proc, _null_xy_proc,
+    _null_xy_proc, _null_xy_proc, _null_xy_proc,
+    _null_text_proc, _null_text_size_proc, _null_text_size_proc,
+    _null_xyxy_proc, _null_xyxy_proc,
+    _null_circle_proc, _null_circle_proc,
+    _null_proc, _null_xy_proc, _null_proc, _null_proc,
+    _null_proc, _null_xyxy_proc,
+    _null_int_proc, _null_int_proc, _null_int_proc, _null_rgb_proc, _null_int_proc,
+    _null_pen_proc,
+    _null_proc, _null_proc, _null_proc, _null_proc, _null_hardcopy_proc, _null_input_proc,
+    0, 0, 0, 0,					/* Pattern, ALU, Color, Black and White */
+    2,							/* Symbol Size (radius) */
+    -1, -1,						/* Desired Width and Height */
+    0, 0,						/* Desired Left and Top */
+    NULL, NULL, NO,				/* Redraw cache */
+    NULL,						/* Linked list next element */
+    NULL						/* No parameters */
+};
   
 Display NullDisplay = &_NullDisplay;
 
-void 	_null_proc () {}
-int 	_null_int_proc () { return( 0 ); }
-float	_null_float_proc () { return( (float) 0.0 ); }
-
-double	_null_double_proc () { return( 0.0 ); }
-
 
 /****************************************************************************/
 
@@ -94,10 +150,18 @@ Select default display at run time, if the machine has multiple
 displays and you want to be able to change on the run.
 */
 
+#ifdef HEADLESS_DISPLAY
+// Builds without a screen (see HeadlessDisplay.h) do not have the OglDisplay.
+extern Display	HeadlessDisplay;
+Display DefaultDisplay ( void ) {
+  return( HeadlessDisplay );  
+}
+#else
 extern Display	OglDisplay;
 Display DefaultDisplay ( void ) {
   return( OglDisplay );  
 }
+#endif
 
 /****************************************************************************/
 
@@ -119,7 +183,7 @@ Display CreateDisplay( Display model ) {
 
 	Display display;
 
-	display = malloc( sizeof( model ) );
+	display = malloc( sizeof( *display ) );
 	if ( ! display ) {
 		MessageBox( NULL, "Unable to create display.", "Display Error", MB_OK );
 		exit( -1 );
@@ -230,7 +294,8 @@ void DisplayLabel (Display display, char *string,
     
   }
   
-  strncpy( temp, string, sizeof( temp ) );
+  strncpy( temp, string, sizeof( temp ) - 1 );
+  temp[sizeof( temp ) - 1] = 0;
   start = end = temp;
   while ( *end ) {
     if ( *end == '\n' ) {
@@ -305,7 +370,7 @@ void DisplayTitle (Display display, char *string, float x, float y, double dir)
       break;
       
     default:
-      fprintf(stderr, "Unknown title x alignment code: %d\n", x);
+      fprintf(stderr, "Unknown title x alignment code: %d\n", (int) x);
       break;
       
     }
@@ -341,13 +406,14 @@ void DisplayTitle (Display display, char *string, float x, float y, double dir)
       break;
       
     default:
-      fprintf(stderr, "Unknown title y alignment code: %d\n", y);
+      fprintf(stderr, "Unknown title y alignment code: %d\n", (int) y);
       break;
       
     }
   }
   
-  strncpy( temp, string, sizeof( temp ) );
+  strncpy( temp, string, sizeof( temp ) - 1 );
+  temp[sizeof( temp ) - 1] = 0;
   start = end = temp;
   while ( *end ) {
     if ( *end == '\n' ) {
@@ -564,7 +630,8 @@ int  DisplayInput( Display display, float *x, float *y ) {
 
 void DisplaySetName( Display display, char *name ) {
   
-  strncpy( display->name, name, sizeof( display->name ) );
+  strncpy( display->name, name, sizeof( display->name ) - 1 );
+  display->name[sizeof( display->name ) - 1] = 0;
   
 }
 
@@ -628,7 +695,6 @@ void DisplayWalkCache ( Display input, Display output ) {
   int count = 0;
   int hold;
   int trace_on = NO;
-  int trace_count;
 
   DisplayCacheItem *item;
 
@@ -644,7 +710,6 @@ void DisplayWalkCache ( Display input, Display output ) {
     case point_token:
       Point( output, item->param.point.x, item->param.point.y );
       if ( peek( item->next ) == lineto_token ) {
-        trace_count = 0;
         StartTrace( output, item->param.point.x, item->param.point.y );
         trace_on = YES;
       }
@@ -146,7 +146,6 @@ extern	Display	NullDisplay;
 #define	StyleToPattern(style) style_to_pattern[style % STYLES]
 
 Display DefaultDisplay ( void );
-extern	Display PictDisplay;
 void DisplaySetName( Display display, char *name );
 	
 	
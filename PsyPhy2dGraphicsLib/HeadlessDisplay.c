@@ -0,0 +1,423 @@
+/****************************************************************************/
+/*                                                                          */
+/*                           HeadlessDisplay.c                              */
+/*                                                                          */
+/****************************************************************************/
+
+/*
+ * A display without a window. See HeadlessDisplay.h.
+ * All operations are carried out in pixel coordinates, as for an OglDisplay of the same size.
+ */
+
+// Disable warnings about unsafe functions.
+// We use the 'unsafe' versions to maintain source-code compatibility with Visual C++ 6
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "windows.h"
+
+#include "useful.h"
+#include "Graphics.h"
+#include "Displays.h"
+#include "HeadlessDisplay.h"
+#include "VectorDisplay.h"
+
+/* Same character size as the OglDisplay, so that layouts come out the same. */
+local double headless_font_height = 12;
+local double headless_font_width = 8;
+
+/***************************************************************************/
+
+// Create a static version of a HeadlessDisplay.
+HeadlessParams	_headless_params = {"Headless Display", 0.0, 0.0, 0, 0, 0, 0, 0};
+struct _display	_HeadlessDisplay = {
+  "Headless Display",
+    0, HEADLESS_DISPLAY_HEIGHT, HEADLESS_DISPLAY_WIDTH, 0,
+    HeadlessPoint, HeadlessLine, HeadlessMoveTo, HeadlessLineTo,
+
+    HeadlessStartTrace, HeadlessContinueTrace, HeadlessEndTrace,
+
+    HeadlessText, HeadlessTextWidth, HeadlessTextHeight,
+    HeadlessRectangle, HeadlessFilledRectangle,
+    HeadlessCircle, HeadlessFilledCircle,
+
+    HeadlessStartPolygon, 
+    HeadlessAddVertex, 
+    HeadlessOutlinePolygon, 
+    HeadlessFillPolygon,
+
+    HeadlessErase, HeadlessEraseRectangle,
+    HeadlessLineStyle, HeadlessLinePattern,
+    HeadlessColor, HeadlessColorRGB, HeadlessAlu, 
+    HeadlessPenSize,
+    HeadlessInit, HeadlessActivate, HeadlessSwap, HeadlessClose, HeadlessHardcopy, HeadlessInput,
+    SOLID,						/* Line Pattern */
+    SET,						/* ALU */
+    FOREGROUND,					/* Color */
+    FALSE,						/* Black and White */
+    3,							/* Symbol Size (radius) */
+    -1, -1,						/* Desired Width and Height */
+	0, 0,						/* Desired Left and Top */
+    NULL, NULL, NO,				/* Redraw cache */
+	NULL,						/* Linked list next element */
+    &_headless_params
+};
+Display		HeadlessDisplay = &_HeadlessDisplay;	// Pointer to the static HeadlessDisplay.
+Display		_headless_display_list = NULL;			// Pointer to a list of dynamic HeadlessDisplays.
+
+/***************************************************************************/
+
+Display CreateHeadlessDisplay( void ) {
+
+	HeadlessParams *params;
+	Display	  display;
+
+	// Allocate memory for an new instance.
+	params = malloc( sizeof( HeadlessParams ) );
+	if ( !params ) {
+		MessageBox( NULL, "Error allocating memory for HeadlessParams.", "HeadlessDisplay.c", MB_OK );
+		exit( -100 );
+	}
+	memset( params, 0, sizeof( *params ) );
+	params->name = "Dynamic HeadlessDisplay";
+	display = malloc( sizeof( *display ) );
+	if ( !display ) {
+		MessageBox( NULL, "Error allocating memory for Display.", "HeadlessDisplay.c", MB_OK );
+		exit( -101 );
+	}
+	// Add newly created instance to the list of HeadlessDisplays.
+	memcpy( display, HeadlessDisplay, sizeof( *display ) );
+	display->parameters = params;
+	display->next = _headless_display_list;
+	_headless_display_list = display;
+
+	return( display );
+
+}
+
+void DestroyHeadlessDisplays( void ) {
+
+	Display display = _headless_display_list;
+	Display display_to_kill;
+
+	while ( display ) {
+		HeadlessClose( display );
+		free( display->parameters );
+		display_to_kill = display;
+		display = display->next;
+		free( display_to_kill );
+	}
+
+}
+
+/***************************************************************************/
+
+void	HeadlessInit ( Display display ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+
+  int width, height;
+
+  if ( display->desired_width < 0 ) width = HEADLESS_DISPLAY_WIDTH;
+  else width = (int) display->desired_width;
+  if ( display->desired_height < 0 ) height = ( width * 3 ) / 4;
+  else height = (int) display->desired_height;
+
+  // Set the screen edges.
+  display->left = 0.0;
+  display->right = (float) width;
+  display->top = (float) height;
+  display->bottom = 0.0;
+
+  params->last_x = 0.0;
+  params->last_y = 0.0;
+  params->items = params->vertices = params->texts = 0;
+  params->erases = params->swaps = 0;
+
+  // There is nothing to see, so the redraw cache is where the drawing goes.
+  DisplayInitCache( display );
+
+}
+
+void HeadlessActivate( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+
+void HeadlessSwap ( Display display ) {
+	register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+	params->swaps++;
+}
+
+void HeadlessClose ( Display display ) {
+	DisplayFreeCache( display );
+}
+
+/***************************************************************************/
+
+// A hardcopy is an SVG or PDF file, according to the extension, made from what is in the redraw cache.
+void HeadlessHardcopy ( Display display, char *filename ) {
+  if ( VectorDisplayWriteCache( display, filename ) ) fprintf( stderr, "Error writing %s.\n", filename );
+}
+
+int	HeadlessInput( Display display, float *x, float *y ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  return( 0 );
+}
+
+/***************************************************************************/
+
+// Add an item to the redraw cache, if it is active, and count it.
+local DisplayCacheItem *headless_item( Display display, Token token ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item;
+
+  params->items++;
+  if ( !display->cache_active ) return( NULL );
+  item = DisplayInsertCacheItem( display );
+  item->token = token;
+  return( item );
+
+}
+
+void	HeadlessErase ( Display display ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+
+  params->erases++;
+  params->items = params->vertices = params->texts = 0;
+  if ( display->cache_active ) DisplayInitCache( display );
+
+}
+
+void	HeadlessEraseRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  DisplayCacheItem *item = headless_item( display, erase_rectangle_token );
+  if ( item ) {
+    item->param.line.x1 = x1;
+    item->param.line.y1 = y1;
+    item->param.line.x2 = x2;
+    item->param.line.y2 = y2;
+  }
+}
+
+void	HeadlessPoint ( Display display, float x, float y ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, point_token );
+
+  if ( item ) {
+    item->param.point.x = x;
+    item->param.point.y = y;
+  }
+  params->vertices++;
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+void	HeadlessLine ( Display display, float x1, float y1, float x2, float y2 ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, line_token );
+
+  if ( item ) {
+    item->param.line.x1 = x1;
+    item->param.line.y1 = y1;
+    item->param.line.x2 = x2;
+    item->param.line.y2 = y2;
+  }
+  params->vertices += 2;
+  params->last_x = x2;
+  params->last_y = y2;
+
+}
+
+void	HeadlessMoveTo ( Display display, float x, float y ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, moveto_token );
+
+  if ( item ) {
+    item->param.point.x = x;
+    item->param.point.y = y;
+  }
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+void	HeadlessLineTo ( Display display, float x, float y ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, lineto_token );
+
+  if ( item ) {
+    item->param.point.x = x;
+    item->param.point.y = y;
+  }
+  params->vertices++;
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+// Traces are cached as a move followed by lines, which is how DisplayWalkCache() finds them.
+void	HeadlessStartTrace ( Display display, float x, float y ) {
+  HeadlessMoveTo( display, x, y );
+}
+
+void	HeadlessContinueTrace ( Display display, float x, float y ) {
+  HeadlessLineTo( display, x, y );
+}
+
+void	HeadlessEndTrace ( Display display, float x, float y ) {
+  HeadlessLineTo( display, x, y );
+}
+
+/***************************************************************************/
+
+local void headless_rectangle( Display display, Token token, float x1, float y1, float x2, float y2 ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, token );
+
+  if ( item ) {
+    item->param.line.x1 = x1;
+    item->param.line.y1 = y1;
+    item->param.line.x2 = x2;
+    item->param.line.y2 = y2;
+  }
+  params->vertices += 4;
+
+}
+
+void	HeadlessRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  headless_rectangle( display, rectangle_token, x1, y1, x2, y2 );
+}
+
+void	HeadlessFilledRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  headless_rectangle( display, filled_rectangle_token, x1, y1, x2, y2 );
+}
+
+local void headless_circle( Display display, Token token, float x, float y, float radius ) {
+
+  DisplayCacheItem *item = headless_item( display, token );
+
+  if ( item ) {
+    item->param.circle.x = x;
+    item->param.circle.y = y;
+    item->param.circle.radius = radius;
+  }
+
+}
+
+void	HeadlessCircle ( Display display, float x, float y, float radius ) {
+  headless_circle( display, circle_token, x, y, radius );
+}
+
+void	HeadlessFilledCircle ( Display display, float x, float y, float radius ) {
+  headless_circle( display, filled_circle_token, x, y, radius );
+}
+
+void	HeadlessStartPolygon ( Display display ) {
+  headless_item( display, start_polygon_token );
+}
+
+void	HeadlessAddVertex ( Display display, float x, float y ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, add_vertex_token );
+
+  if ( item ) {
+    item->param.point.x = x;
+    item->param.point.y = y;
+  }
+  params->vertices++;
+
+}
+
+void	HeadlessOutlinePolygon ( Display display ) {
+  headless_item( display, outline_polygon_token );
+}
+
+void	HeadlessFillPolygon ( Display display ) {
+  headless_item( display, fill_polygon_token );
+}
+
+/***************************************************************************/
+
+void	HeadlessText ( Display display, char *string, float x, float y, double dir ) {
+
+  register HeadlessParams	*params = (HeadlessParams *) display->parameters;
+  DisplayCacheItem *item = headless_item( display, text_token );
+
+  if ( item ) {
+    item->param.text.x = x;
+    item->param.text.y = y;
+    item->param.text.dir = dir;
+    item->param.text.string = _strdup( string );
+  }
+  params->texts++;
+
+}
+
+// Same metrics as OglTextWidth() and OglTextHeight().
+float	HeadlessTextWidth ( Display display, char *string ) {
+
+  unsigned int i;
+  float add = 0.0, adjust = 0.25;
+  UNREFERENCED_PARAMETER( display );
+  for ( i = 0; i < strlen( string ); i++ ) {
+    if ( string[i] >= 'A' && string[i] <= 'Z' ) add += adjust;
+  }
+  return( (float) ( headless_font_width * strlen( string ) ) + add );
+
+}
+
+float	HeadlessTextHeight ( Display display, char *string ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( string );
+  return ( (float) headless_font_height );
+}
+
+/***************************************************************************/
+
+void	HeadlessAlu ( Display display, int alu ) {
+  DisplayCacheItem *item = headless_item( display, alu_token );
+  if ( item ) item->param.alu = alu;
+}
+
+// Line styles are not cached by the other displays either.
+void	HeadlessLineStyle ( Display display, int style ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( style );
+}
+
+void	HeadlessLinePattern ( Display display, int pattern ) {
+  DisplayCacheItem *item = headless_item( display, pattern_token );
+  if ( item ) item->param.pattern = pattern;
+}
+
+void	HeadlessPenSize ( Display display, float size ) {
+  DisplayCacheItem *item = headless_item( display, pen_token );
+  if ( item ) item->param.pen = (int) size;
+}
+
+void	HeadlessColor ( Display display, int color ) {
+  DisplayCacheItem *item = headless_item( display, color_token );
+  if ( item ) item->param.color = color;
+}
+
+void	HeadlessColorRGB ( Display display, float r, float g, float b ) {
+  DisplayCacheItem *item = headless_item( display, rgb_token );
+  if ( item ) {
+    item->param.rgb.r = r;
+    item->param.rgb.g = g;
+    item->param.rgb.b = b;
+  }
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                           HeadlessDisplay.h                               */
+/*                                                                           */
+/*****************************************************************************/
+
+/*
+ * A display without a window, for running the graphics on machines that have no screen.
+ * Everything that is drawn goes into the redraw cache of the display, from where it can be
+ * replayed into another display with DisplayWalkCache(), and the drawing operations are counted.
+ * Hardcopy() writes what is in the cache to an SVG or PDF file (see VectorDisplay.h).
+ */
+
+#ifndef	_HEADLESSDISPLAY_
+
+#include "Displays.h"
+#include "Graphics.h"
+
+#ifdef __cplusplus 
+extern "C" {
+#endif
+
+Display CreateHeadlessDisplay( void );
+void DestroyHeadlessDisplays( void );
+
+void	HeadlessInit( Display display );
+void	HeadlessActivate( Display display );
+void	HeadlessSwap ( Display display );
+void	HeadlessClose( Display display );
+void	HeadlessHardcopy ( Display display, char *filename );
+int		HeadlessInput( Display display, float *x, float *y );
+
+void	HeadlessPoint ( Display display, float x, float y );
+void	HeadlessLine ( Display display, float x1, float y1, float x2, float y2 );
+void	HeadlessMoveTo ( Display display, float x, float y );
+void	HeadlessLineTo ( Display display, float x, float y );
+void	HeadlessStartTrace ( Display display, float x, float y );
+void	HeadlessContinueTrace ( Display display, float x, float y );
+void	HeadlessEndTrace ( Display display, float x, float y );
+
+void	HeadlessText ( Display display, char *string, float x, float y, double dir );
+float	HeadlessTextWidth ( Display display, char *string );
+float	HeadlessTextHeight ( Display display, char *string );
+
+void	HeadlessRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	HeadlessFilledRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	HeadlessCircle ( Display display, float x, float y, float radius );
+void	HeadlessFilledCircle ( Display display, float x, float y, float radius );
+void	HeadlessStartPolygon ( Display display );
+void	HeadlessAddVertex ( Display display, float x, float y );
+void	HeadlessOutlinePolygon ( Display display );
+void	HeadlessFillPolygon ( Display display );
+void	HeadlessErase ( Display display );
+void	HeadlessEraseRectangle ( Display display, float x1, float y1, float x2, float y2 );
+
+void	HeadlessLineStyle ( Display display, int style );
+void	HeadlessLinePattern ( Display display, int pattern );
+void	HeadlessColor ( Display display, int color );
+void	HeadlessColorRGB ( Display display, float r, float g, float b );
+void	HeadlessAlu ( Display display, int alu );
+void	HeadlessPenSize ( Display display, float size );
+
+#ifdef __cplusplus 
+}
+#endif
+
+/* Same size as an OglDisplay that is not given one. */
+#define HEADLESS_DISPLAY_WIDTH	900
+#define HEADLESS_DISPLAY_HEIGHT	675
+
+typedef struct {
+
+	char	*name;
+
+	float	last_x;
+	float	last_y;
+
+	/* What has been drawn since the last erase. */
+	unsigned long	items;
+	unsigned long	vertices;
+	unsigned long	texts;
+	/* How many times the display has been erased and swapped. */
+	unsigned long	erases;
+	unsigned long	swaps;
+
+} HeadlessParams;
+
+extern Display	HeadlessDisplay;
+
+#define _HEADLESSDISPLAY_
+#endif
@@ -18,6 +18,7 @@
 #include "Graphics.h"
 #include "Displays.h"
 #include "OglDisplay.h"
+#include "VectorDisplay.h"
 
 #include "OglDisplayInterface.h"
 
@@ -73,9 +74,17 @@ void OglDisplayRedraw ( Display display ) {
 
 /***************************************************************************/
 
+// SVG and PDF files are written by replaying the redraw cache into a VectorDisplay.
+// Anything else gets an Adobe Illustrator file.
 void OglHardcopy ( Display display, char *filename ) {
 
   register OglParams	*params = (OglParams *) display->parameters;
+  size_t length = strlen( filename );
+
+  if ( length > 4 && ( !_stricmp( filename + length - 4, ".svg" ) || !_stricmp( filename + length - 4, ".pdf" ) ) ) {
+    if ( VectorDisplayWriteCache( display, filename ) ) fprintf( stderr, "Error writing %s.\n", filename );
+    return;
+  }
 
   params->cpy = fopen( filename, "w" );
 
@@ -135,8 +144,6 @@ void OglHardcopy ( Display display, char *filename ) {
   }
 }
 
-void OglHardcopyPict ( Display display ) {}
-
 /***************************************************************************/
 
 Display CreateOglDisplay( void ) {
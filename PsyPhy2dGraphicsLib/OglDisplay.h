@@ -20,7 +20,6 @@ void	OglSwap ( Display display );
 
 void	OglClose( Display display );
 void	OglHardcopy ( Display display, char *filename );
-void	OglHardcopyPict ( Display display );
 
 int		OglInput( Display display, float *x, float *y );
 void	OglPoint ( Display display, float x, float y);
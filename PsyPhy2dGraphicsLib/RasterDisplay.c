@@ -0,0 +1,868 @@
+/****************************************************************************/
+/*                                                                          */
+/*                           RasterDisplay.c                                */
+/*                                                                          */
+/****************************************************************************/
+
+/*
+ * A display that draws into an image in memory. See RasterDisplay.h.
+ * All operations are carried out in pixel coordinates, as for an OglDisplay of the same size,
+ * with the origin at the bottom left.
+ */
+
+// Disable warnings about unsafe functions.
+// We use the 'unsafe' versions to maintain source-code compatibility with Visual C++ 6
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "windows.h"
+
+#include "useful.h"
+#include "Graphics.h"
+#include "Displays.h"
+#include "RasterDisplay.h"
+
+/* Same character size as the OglDisplay, so that layouts come out the same. */
+local int raster_font_height = 12;
+local int raster_font_width = 8;
+
+/***************************************************************************/
+
+// Create a static version of a RasterDisplay.
+RasterParams	_raster_params = {"Raster Display", 0, 0, NULL, {0, 0, 0}, 0.0, 0.0, 0, {0.0}, {0.0}};
+struct _display	_RasterDisplay = {
+  "Raster Display",
+    0, RASTER_DISPLAY_HEIGHT, RASTER_DISPLAY_WIDTH, 0,
+    RasterPoint, RasterLine, RasterMoveTo, RasterLineTo,
+
+    RasterStartTrace, RasterContinueTrace, RasterEndTrace,
+
+    RasterText, RasterTextWidth, RasterTextHeight,
+    RasterRectangle, RasterFilledRectangle,
+    RasterCircle, RasterFilledCircle,
+
+    RasterStartPolygon,
+    RasterAddVertex,
+    RasterOutlinePolygon,
+    RasterFillPolygon,
+
+    RasterErase, RasterEraseRectangle,
+    RasterLineStyle, RasterLinePattern,
+    RasterColor, RasterColorRGB, RasterAlu,
+    RasterPenSize,
+    RasterInit, RasterActivate, RasterSwap, RasterClose, RasterHardcopy, RasterInput,
+    SOLID,						/* Line Pattern */
+    SET,						/* ALU */
+    FOREGROUND,					/* Color */
+    FALSE,						/* Black and White */
+    3,							/* Symbol Size (radius) */
+    -1, -1,						/* Desired Width and Height */
+	0, 0,						/* Desired Left and Top */
+    NULL, NULL, NO,				/* Redraw cache */
+	NULL,						/* Linked list next element */
+    &_raster_params
+};
+Display		RasterDisplay = &_RasterDisplay;	// Pointer to the static RasterDisplay.
+Display		_raster_display_list = NULL;		// Pointer to a list of dynamic RasterDisplays.
+
+/***************************************************************************/
+
+Display CreateRasterDisplay( void ) {
+
+	RasterParams *params;
+	Display	  display;
+
+	// Allocate memory for an new instance.
+	params = malloc( sizeof( RasterParams ) );
+	if ( !params ) {
+		MessageBox( NULL, "Error allocating memory for RasterParams.", "RasterDisplay.c", MB_OK );
+		exit( -100 );
+	}
+	memset( params, 0, sizeof( *params ) );
+	params->name = "Dynamic RasterDisplay";
+	display = malloc( sizeof( *display ) );
+	if ( !display ) {
+		MessageBox( NULL, "Error allocating memory for Display.", "RasterDisplay.c", MB_OK );
+		exit( -101 );
+	}
+	// Add newly created instance to the list of RasterDisplays.
+	memcpy( display, RasterDisplay, sizeof( *display ) );
+	display->parameters = params;
+	display->next = _raster_display_list;
+	_raster_display_list = display;
+
+	return( display );
+
+}
+
+void DestroyRasterDisplays( void ) {
+
+	Display display = _raster_display_list;
+	Display display_to_kill;
+
+	while ( display ) {
+		RasterClose( display );
+		free( display->parameters );
+		display_to_kill = display;
+		display = display->next;
+		free( display_to_kill );
+	}
+
+}
+
+/***************************************************************************/
+
+void	RasterInit ( Display display ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  int width, height;
+
+  if ( display->desired_width < 0 ) width = RASTER_DISPLAY_WIDTH;
+  else width = (int) display->desired_width;
+  if ( display->desired_height < 0 ) height = ( width * 3 ) / 4;
+  else height = (int) display->desired_height;
+
+  // The image is allocated once. Initializing the display again at the same size reuses it.
+  if ( !params->pixels || params->width != width || params->height != height ) {
+    free( params->pixels );
+    params->pixels = malloc( width * height * 3 );
+    if ( !params->pixels ) {
+      MessageBox( NULL, "Error allocating memory for the image.", "RasterDisplay.c", MB_OK );
+      exit( -102 );
+    }
+  }
+  params->width = width;
+  params->height = height;
+
+  // Set the screen edges.
+  display->left = 0.0;
+  display->right = (float) width;
+  display->top = (float) height;
+  display->bottom = 0.0;
+
+  params->last_x = 0.0;
+  params->last_y = 0.0;
+  params->vertices = 0;
+  params->rgb[0] = params->rgb[1] = params->rgb[2] = 0;
+
+  RasterErase( display );
+
+}
+
+void RasterActivate( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+
+// The image is always up to date.
+void RasterSwap ( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+
+void RasterClose ( Display display ) {
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  free( params->pixels );
+  params->pixels = NULL;
+}
+
+void RasterHardcopy ( Display display, char *filename ) {
+  if ( RasterWritePNG( display, filename ) ) fprintf( stderr, "Error writing %s.\n", filename );
+}
+
+int	RasterInput( Display display, float *x, float *y ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  return( 0 );
+}
+
+/***************************************************************************/
+
+// Set one pixel to the current color. Pixel coordinates start at the top left.
+#define raster_pixel( params, column, row ) \
+  if ( (column) >= 0 && (column) < (params)->width && (row) >= 0 && (row) < (params)->height ) { \
+    unsigned char *p = (params)->pixels + ( (row) * (params)->width + (column) ) * 3; \
+    p[0] = (params)->rgb[0]; p[1] = (params)->rgb[1]; p[2] = (params)->rgb[2]; \
+  }
+
+local int raster_column( RasterParams *params, float x ) {
+  UNREFERENCED_PARAMETER( params );
+  return( (int) floor( x + 0.5 ) );
+}
+
+local int raster_row( RasterParams *params, float y ) {
+  return( params->height - 1 - (int) floor( y + 0.5 ) );
+}
+
+// Fill a horizontal span of pixels, from column c1 to c2 inclusive.
+local void raster_span( RasterParams *params, int row, int c1, int c2 ) {
+
+  unsigned char *p;
+  int c;
+
+  if ( row < 0 || row >= params->height ) return;
+  if ( c1 > c2 ) { c = c1; c1 = c2; c2 = c; }
+  if ( c1 < 0 ) c1 = 0;
+  if ( c2 >= params->width ) c2 = params->width - 1;
+  p = params->pixels + ( row * params->width + c1 ) * 3;
+  for ( c = c1; c <= c2; c++, p += 3 ) {
+    p[0] = params->rgb[0];
+    p[1] = params->rgb[1];
+    p[2] = params->rgb[2];
+  }
+
+}
+
+// Clip the line to the image with the Liang-Barsky algorithm, so that lines that go far outside
+//  the image, which the clipped plots can produce, cost no more than the part that is seen.
+local int raster_clip( RasterParams *params, float *x1, float *y1, float *x2, float *y2 ) {
+
+  double t0 = 0.0, t1 = 1.0;
+  double dx = *x2 - *x1, dy = *y2 - *y1;
+  double p[4], q[4], r;
+  int i;
+
+  p[0] = -dx; q[0] = *x1 + 0.5;
+  p[1] =  dx; q[1] = params->width - 0.5 - *x1;
+  p[2] = -dy; q[2] = *y1 + 0.5;
+  p[3] =  dy; q[3] = params->height - 0.5 - *y1;
+  for ( i = 0; i < 4; i++ ) {
+    if ( p[i] == 0.0 ) {
+      if ( q[i] < 0.0 ) return( NO );
+    }
+    else {
+      r = q[i] / p[i];
+      if ( p[i] < 0.0 ) { if ( r > t1 ) return( NO ); if ( r > t0 ) t0 = r; }
+      else { if ( r < t0 ) return( NO ); if ( r < t1 ) t1 = r; }
+    }
+  }
+  *x2 = (float) ( *x1 + t1 * dx );
+  *y2 = (float) ( *y1 + t1 * dy );
+  *x1 = (float) ( *x1 + t0 * dx );
+  *y1 = (float) ( *y1 + t0 * dy );
+  return( YES );
+
+}
+
+// Bresenham's algorithm.
+local void raster_line( RasterParams *params, float x1, float y1, float x2, float y2 ) {
+
+  int c1, r1, c2, r2, dc, dr, sc, sr, error, e2;
+
+  if ( !raster_clip( params, &x1, &y1, &x2, &y2 ) ) return;
+  c1 = raster_column( params, x1 );
+  r1 = raster_row( params, y1 );
+  c2 = raster_column( params, x2 );
+  r2 = raster_row( params, y2 );
+
+  dc = abs( c2 - c1 );
+  dr = -abs( r2 - r1 );
+  sc = ( c1 < c2 ? 1 : -1 );
+  sr = ( r1 < r2 ? 1 : -1 );
+  error = dc + dr;
+  while ( 1 ) {
+    raster_pixel( params, c1, r1 );
+    if ( c1 == c2 && r1 == r2 ) break;
+    e2 = 2 * error;
+    if ( e2 >= dr ) { error += dr; c1 += sc; }
+    if ( e2 <= dc ) { error += dc; r1 += sr; }
+  }
+
+}
+
+/***************************************************************************/
+
+void	RasterErase ( Display display ) {
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  memset( params->pixels, 0xff, params->width * params->height * 3 );
+}
+
+void	RasterEraseRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  unsigned char hold[3];
+
+  memcpy( hold, params->rgb, sizeof( hold ) );
+  memset( params->rgb, 0xff, sizeof( params->rgb ) );
+  RasterFilledRectangle( display, x1, y1, x2, y2 );
+  memcpy( params->rgb, hold, sizeof( hold ) );
+
+}
+
+void	RasterPoint ( Display display, float x, float y ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  int column = raster_column( params, x );
+  int row = raster_row( params, y );
+
+  raster_pixel( params, column, row );
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+void	RasterLine ( Display display, float x1, float y1, float x2, float y2 ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  raster_line( params, x1, y1, x2, y2 );
+  params->last_x = x2;
+  params->last_y = y2;
+
+}
+
+void	RasterMoveTo ( Display display, float x, float y ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+void	RasterLineTo ( Display display, float x, float y ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  raster_line( params, params->last_x, params->last_y, x, y );
+  params->last_x = x;
+  params->last_y = y;
+
+}
+
+void	RasterStartTrace ( Display display, float x, float y ) {
+  RasterMoveTo( display, x, y );
+}
+
+void	RasterContinueTrace ( Display display, float x, float y ) {
+  RasterLineTo( display, x, y );
+}
+
+void	RasterEndTrace ( Display display, float x, float y ) {
+  RasterLineTo( display, x, y );
+}
+
+/***************************************************************************/
+
+void	RasterRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  raster_line( params, x1, y1, x1, y2 );
+  raster_line( params, x1, y2, x2, y2 );
+  raster_line( params, x2, y2, x2, y1 );
+  raster_line( params, x2, y1, x1, y1 );
+  params->last_x = x2;
+  params->last_y = y2;
+
+}
+
+void	RasterFilledRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  int c1 = raster_column( params, x1 );
+  int c2 = raster_column( params, x2 );
+  int r1 = raster_row( params, y1 );
+  int r2 = raster_row( params, y2 );
+  int r;
+
+  if ( r1 > r2 ) { r = r1; r1 = r2; r2 = r; }
+  if ( r1 < 0 ) r1 = 0;
+  if ( r2 >= params->height ) r2 = params->height - 1;
+  for ( r = r1; r <= r2; r++ ) raster_span( params, r, c1, c2 );
+  params->last_x = x2;
+  params->last_y = y2;
+
+}
+
+// Midpoint circle algorithm. Filled circles are drawn as spans between the symmetric points.
+local void raster_circle( RasterParams *params, float x, float y, float radius, int filled ) {
+
+  int cc = raster_column( params, x );
+  int cr = raster_row( params, y );
+  int dx = (int) floor( radius + 0.5 );
+  int dy = 0;
+  int error = 1 - dx;
+
+  while ( dx >= dy ) {
+    if ( filled ) {
+      raster_span( params, cr + dy, cc - dx, cc + dx );
+      raster_span( params, cr - dy, cc - dx, cc + dx );
+      raster_span( params, cr + dx, cc - dy, cc + dy );
+      raster_span( params, cr - dx, cc - dy, cc + dy );
+    }
+    else {
+      raster_pixel( params, cc + dx, cr + dy );
+      raster_pixel( params, cc - dx, cr + dy );
+      raster_pixel( params, cc + dx, cr - dy );
+      raster_pixel( params, cc - dx, cr - dy );
+      raster_pixel( params, cc + dy, cr + dx );
+      raster_pixel( params, cc - dy, cr + dx );
+      raster_pixel( params, cc + dy, cr - dx );
+      raster_pixel( params, cc - dy, cr - dx );
+    }
+    dy++;
+    if ( error < 0 ) error += 2 * dy + 1;
+    else {
+      dx--;
+      error += 2 * ( dy - dx ) + 1;
+    }
+  }
+
+}
+
+void	RasterCircle ( Display display, float x, float y, float radius ) {
+  raster_circle( (RasterParams *) display->parameters, x, y, radius, NO );
+}
+
+void	RasterFilledCircle ( Display display, float x, float y, float radius ) {
+  raster_circle( (RasterParams *) display->parameters, x, y, radius, YES );
+}
+
+void	RasterStartPolygon ( Display display ) {
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  params->vertices = 0;
+}
+
+// Vertices beyond RASTER_MAX_VERTICES are ignored.
+void	RasterAddVertex ( Display display, float x, float y ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+
+  if ( params->vertices >= RASTER_MAX_VERTICES ) return;
+  params->vertex_x[params->vertices] = x;
+  params->vertex_y[params->vertices] = y;
+  params->vertices++;
+
+}
+
+void	RasterOutlinePolygon ( Display display ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  int i, j;
+
+  for ( i = 0; i < params->vertices; i++ ) {
+    j = ( i + 1 ) % params->vertices;
+    raster_line( params, params->vertex_x[i], params->vertex_y[i], params->vertex_x[j], params->vertex_y[j] );
+  }
+
+}
+
+// Even-odd scanline fill at the center of each row of pixels.
+void	RasterFillPolygon ( Display display ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  float crossing[RASTER_MAX_VERTICES], hold, y;
+  float ymin, ymax;
+  int i, j, k, n, row, top_row, bottom_row;
+
+  if ( params->vertices < 3 ) return;
+  ymin = ymax = params->vertex_y[0];
+  for ( i = 1; i < params->vertices; i++ ) {
+    if ( params->vertex_y[i] < ymin ) ymin = params->vertex_y[i];
+    if ( params->vertex_y[i] > ymax ) ymax = params->vertex_y[i];
+  }
+  top_row = raster_row( params, ymax );
+  bottom_row = raster_row( params, ymin );
+  if ( top_row < 0 ) top_row = 0;
+  if ( bottom_row >= params->height ) bottom_row = params->height - 1;
+
+  for ( row = top_row; row <= bottom_row; row++ ) {
+    y = (float) ( params->height - 1 - row );
+    n = 0;
+    for ( i = 0; i < params->vertices; i++ ) {
+      float y1 = params->vertex_y[i];
+      float y2 = params->vertex_y[( i + 1 ) % params->vertices];
+      float x1 = params->vertex_x[i];
+      float x2 = params->vertex_x[( i + 1 ) % params->vertices];
+      if ( ( y1 <= y && y2 > y ) || ( y2 <= y && y1 > y ) ) {
+        crossing[n++] = x1 + ( y - y1 ) * ( x2 - x1 ) / ( y2 - y1 );
+      }
+    }
+    // There are only a few crossings, so an insertion sort will do.
+    for ( j = 1; j < n; j++ ) {
+      hold = crossing[j];
+      for ( k = j; k > 0 && crossing[k - 1] > hold; k-- ) crossing[k] = crossing[k - 1];
+      crossing[k] = hold;
+    }
+    for ( j = 0; j + 1 < n; j += 2 ) {
+      raster_span( params, row, raster_column( params, crossing[j] ), raster_column( params, crossing[j + 1] ) );
+    }
+  }
+
+}
+
+/***************************************************************************/
+
+// The printable ASCII characters, from ' ' to '~', in 5 columns of 7 pixels.
+// The lowest bit of each column is the top row.
+local unsigned char raster_font[95][5] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5f, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7f, 0x14, 0x7f, 0x14 },
+  { 0x24, 0x2a, 0x7f, 0x2a, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 },
+  { 0x00, 0x1c, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1c, 0x00 }, { 0x08, 0x2a, 0x1c, 0x2a, 0x08 }, { 0x08, 0x08, 0x3e, 0x08, 0x08 },
+  { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 },
+  { 0x3e, 0x51, 0x49, 0x45, 0x3e }, { 0x00, 0x42, 0x7f, 0x40, 0x00 }, { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4b, 0x31 },
+  { 0x18, 0x14, 0x12, 0x7f, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3c, 0x4a, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+  { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1e }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 },
+  { 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 },
+  { 0x32, 0x49, 0x79, 0x41, 0x3e }, { 0x7e, 0x11, 0x11, 0x11, 0x7e }, { 0x7f, 0x49, 0x49, 0x49, 0x36 }, { 0x3e, 0x41, 0x41, 0x41, 0x22 },
+  { 0x7f, 0x41, 0x41, 0x22, 0x1c }, { 0x7f, 0x49, 0x49, 0x49, 0x41 }, { 0x7f, 0x09, 0x09, 0x09, 0x01 }, { 0x3e, 0x41, 0x49, 0x49, 0x7a },
+  { 0x7f, 0x08, 0x08, 0x08, 0x7f }, { 0x00, 0x41, 0x7f, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3f, 0x01 }, { 0x7f, 0x08, 0x14, 0x22, 0x41 },
+  { 0x7f, 0x40, 0x40, 0x40, 0x40 }, { 0x7f, 0x02, 0x0c, 0x02, 0x7f }, { 0x7f, 0x04, 0x08, 0x10, 0x7f }, { 0x3e, 0x41, 0x41, 0x41, 0x3e },
+  { 0x7f, 0x09, 0x09, 0x09, 0x06 }, { 0x3e, 0x41, 0x51, 0x21, 0x5e }, { 0x7f, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 },
+  { 0x01, 0x01, 0x7f, 0x01, 0x01 }, { 0x3f, 0x40, 0x40, 0x40, 0x3f }, { 0x1f, 0x20, 0x40, 0x20, 0x1f }, { 0x3f, 0x40, 0x38, 0x40, 0x3f },
+  { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x07, 0x08, 0x70, 0x08, 0x07 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7f, 0x41, 0x41, 0x00 },
+  { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7f, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 },
+  { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 }, { 0x7f, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 },
+  { 0x38, 0x44, 0x44, 0x48, 0x7f }, { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7e, 0x09, 0x01, 0x02 }, { 0x0c, 0x52, 0x52, 0x52, 0x3e },
+  { 0x7f, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7d, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3d, 0x00 }, { 0x7f, 0x10, 0x28, 0x44, 0x00 },
+  { 0x00, 0x41, 0x7f, 0x40, 0x00 }, { 0x7c, 0x04, 0x18, 0x04, 0x78 }, { 0x7c, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 },
+  { 0x7c, 0x14, 0x14, 0x14, 0x08 }, { 0x08, 0x14, 0x14, 0x18, 0x7c }, { 0x7c, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 },
+  { 0x04, 0x3f, 0x44, 0x40, 0x20 }, { 0x3c, 0x40, 0x40, 0x20, 0x7c }, { 0x1c, 0x20, 0x40, 0x20, 0x1c }, { 0x3c, 0x40, 0x30, 0x40, 0x3c },
+  { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0c, 0x50, 0x50, 0x50, 0x3c }, { 0x44, 0x64, 0x54, 0x4c, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 },
+  { 0x00, 0x00, 0x7f, 0x00, 0x00 }, { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x08, 0x04, 0x08, 0x10, 0x08 }
+};
+
+// The text starts at (x, y), with y at the bottom of the characters, as for glprintf().
+// The direction is ignored, as it is by the OglDisplay.
+void	RasterText ( Display display, char *string, float x, float y, double dir ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  int left = raster_column( params, x );
+  int bottom = raster_row( params, y );
+  int column, row;
+  unsigned char *glyph;
+  char *c;
+
+  UNREFERENCED_PARAMETER( dir );
+
+  for ( c = string; *c; c++, left += raster_font_width ) {
+    if ( *c < ' ' || *c > '~' ) continue;
+    glyph = raster_font[*c - ' '];
+    for ( column = 0; column < 5; column++ ) {
+      for ( row = 0; row < 7; row++ ) {
+        if ( glyph[column] & ( 0x01 << row ) ) raster_pixel( params, left + 1 + column, bottom - 6 + row );
+      }
+    }
+  }
+
+}
+
+// Same metrics as OglTextWidth() and OglTextHeight().
+float	RasterTextWidth ( Display display, char *string ) {
+
+  unsigned int i;
+  float add = 0.0, adjust = 0.25;
+  UNREFERENCED_PARAMETER( display );
+  for ( i = 0; i < strlen( string ); i++ ) {
+    if ( string[i] >= 'A' && string[i] <= 'Z' ) add += adjust;
+  }
+  return( (float) ( raster_font_width * strlen( string ) ) + add );
+
+}
+
+float	RasterTextHeight ( Display display, char *string ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( string );
+  return ( (float) raster_font_height );
+}
+
+/***************************************************************************/
+
+// Same colors as the OglDisplay.
+local float raster_color_table[][3] = {
+  { 0, 0, 0 },	/* Black	*/
+  { 1, 0, 0 },	/* Red		*/
+  { 0, 1, 0 },	/* Green	*/
+  { 1, 1, 0 },	/* Yellow	*/
+  { 0, 0, 1 },	/* Blue		*/
+  { 1, 0, 1 },	/* Magenta	*/
+  { 0, 1, 1 },	/* Cyan		*/
+  { 1, 1, 1 },	/* White	*/
+  { .125, .125, .125 },	/* Grey1	*/
+  { .25, .25, .25 },	/* Grey2	*/
+  { .375, .375, .375 },	/* Grey3	*/
+  { .5,.5, .5 },		/* Grey4	*/
+  { .625, .625, .625 },	/* Grey5	*/
+  { .75, .75, .75 },	/* Grey6	*/
+  { .875, .875, .875 },	/* Grey7	*/
+  { 1.0, 1.0, 1.0 },	/* Grey8	*/
+  { 0, 0, 0 },   /* TRANSPARENT */
+};
+
+void	RasterColor ( Display display, int color ) {
+  if ( color < 0 || color > TRANSPARENT_COLOR ) color = FOREGROUND;
+  RasterColorRGB( display, raster_color_table[color][0], raster_color_table[color][1], raster_color_table[color][2] );
+}
+
+void	RasterColorRGB ( Display display, float r, float g, float b ) {
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  params->rgb[0] = (unsigned char) ( r * 255.0 + 0.5 );
+  params->rgb[1] = (unsigned char) ( g * 255.0 + 0.5 );
+  params->rgb[2] = (unsigned char) ( b * 255.0 + 0.5 );
+}
+
+void	RasterAlu ( Display display, int alu ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( alu );
+}
+void	RasterLineStyle ( Display display, int style ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( style );
+}
+void	RasterLinePattern ( Display display, int pattern ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( pattern );
+}
+void	RasterPenSize ( Display display, float size ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( size );
+}
+
+/***************************************************************************/
+
+/*
+ * PNG output.
+ * Each row is written with the 'Up' filter, so that the background and the rows that repeat
+ * the one above come out as runs of zeros, and deflated into a single block with the fixed
+ * Huffman codes, using only matches at a distance of 1 or 3 bytes (the previous pixel).
+ * This is nowhere near as small as zlib would make it, but plots are mostly background and
+ * the files are small enough, and the encoder needs neither zlib nor much time.
+ */
+
+#define PNG_IDAT_BYTES	65536
+#define PNG_MAX_MATCH	258
+#define PNG_ADLER_BLOCK	5552
+
+typedef struct {
+  FILE			*fp;
+  int			error;
+  unsigned char	buffer[PNG_IDAT_BYTES];
+  unsigned long	count;
+  unsigned long	bits;
+  int			nbits;
+  unsigned long	adler_a;
+  unsigned long	adler_b;
+} PngStream;
+
+local unsigned long png_crc_table[256];
+local int png_crc_ready = NO;
+
+local unsigned long png_crc( unsigned long crc, const unsigned char *data, unsigned long length ) {
+
+  unsigned long i, c;
+  int k;
+
+  if ( !png_crc_ready ) {
+    for ( i = 0; i < 256; i++ ) {
+      c = i;
+      for ( k = 0; k < 8; k++ ) c = ( c & 1 ? 0xedb88320UL ^ ( c >> 1 ) : c >> 1 );
+      png_crc_table[i] = c;
+    }
+    png_crc_ready = YES;
+  }
+  for ( i = 0; i < length; i++ ) crc = png_crc_table[( crc ^ data[i] ) & 0xff] ^ ( crc >> 8 );
+  return( crc );
+
+}
+
+local void png_ulong( unsigned char *bytes, unsigned long value ) {
+  bytes[0] = (unsigned char) ( value >> 24 );
+  bytes[1] = (unsigned char) ( value >> 16 );
+  bytes[2] = (unsigned char) ( value >> 8 );
+  bytes[3] = (unsigned char) value;
+}
+
+local void png_chunk( PngStream *png, const char *type, const unsigned char *data, unsigned long length ) {
+
+  unsigned char bytes[4];
+  unsigned long crc;
+
+  png_ulong( bytes, length );
+  if ( fwrite( bytes, 1, 4, png->fp ) != 4 ) png->error = YES;
+  if ( fwrite( type, 1, 4, png->fp ) != 4 ) png->error = YES;
+  if ( length > 0 && fwrite( data, 1, length, png->fp ) != length ) png->error = YES;
+  crc = png_crc( 0xffffffffUL, (const unsigned char *) type, 4 );
+  crc = png_crc( crc, data, length ) ^ 0xffffffffUL;
+  png_ulong( bytes, crc );
+  if ( fwrite( bytes, 1, 4, png->fp ) != 4 ) png->error = YES;
+
+}
+
+// The compressed data can be split over as many IDAT chunks as we like.
+local void png_byte( PngStream *png, unsigned char byte ) {
+  png->buffer[png->count++] = byte;
+  if ( png->count == PNG_IDAT_BYTES ) {
+    png_chunk( png, "IDAT", png->buffer, png->count );
+    png->count = 0;
+  }
+}
+
+// Deflate packs the bits starting from the least significant.
+local void png_bits( PngStream *png, unsigned long value, int n ) {
+  png->bits |= value << png->nbits;
+  png->nbits += n;
+  while ( png->nbits >= 8 ) {
+    png_byte( png, (unsigned char) ( png->bits & 0xff ) );
+    png->bits >>= 8;
+    png->nbits -= 8;
+  }
+}
+
+// ... except for the Huffman codes, which start from the most significant.
+local void png_code( PngStream *png, unsigned long code, int n ) {
+  unsigned long reversed = 0;
+  int i;
+  for ( i = 0; i < n; i++ ) reversed |= ( ( code >> i ) & 0x01 ) << ( n - 1 - i );
+  png_bits( png, reversed, n );
+}
+
+// Fixed Huffman code of a literal, length or end-of-block symbol.
+// The codes are reversed once, the first time they are needed.
+local unsigned long png_symbol_code[288];
+local int png_symbol_bits[288];
+local int png_symbols_ready = NO;
+
+local void png_symbol( PngStream *png, int symbol ) {
+
+  unsigned long code;
+  int s, n, i;
+
+  if ( !png_symbols_ready ) {
+    for ( s = 0; s < 288; s++ ) {
+      if ( s < 144 ) { code = 0x30 + s; n = 8; }
+      else if ( s < 256 ) { code = 0x190 + s - 144; n = 9; }
+      else if ( s < 280 ) { code = s - 256; n = 7; }
+      else { code = 0xc0 + s - 280; n = 8; }
+      png_symbol_code[s] = 0;
+      for ( i = 0; i < n; i++ ) png_symbol_code[s] |= ( ( code >> i ) & 0x01 ) << ( n - 1 - i );
+      png_symbol_bits[s] = n;
+    }
+    png_symbols_ready = YES;
+  }
+  png_bits( png, png_symbol_code[symbol], png_symbol_bits[symbol] );
+
+}
+
+local int png_length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+local int png_length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// Distances 1 to 4 have the codes 0 to 3 and no extra bits.
+local void png_match( PngStream *png, int length, int distance ) {
+  int i = 28;
+  while ( png_length_base[i] > length ) i--;
+  png_symbol( png, 257 + i );
+  if ( png_length_extra[i] ) png_bits( png, length - png_length_base[i], png_length_extra[i] );
+  png_code( png, distance - 1, 5 );
+}
+
+local void png_deflate( PngStream *png, const unsigned char *data, int length ) {
+
+  int i, n, best, best_distance, distance;
+
+  // The sums cannot overflow within PNG_ADLER_BLOCK bytes, so the modulo is taken only once per block.
+  for ( i = 0; i < length; i += n ) {
+    n = ( length - i < PNG_ADLER_BLOCK ? length - i : PNG_ADLER_BLOCK );
+    for ( best = 0; best < n; best++ ) {
+      png->adler_a += data[i + best];
+      png->adler_b += png->adler_a;
+    }
+    png->adler_a %= 65521;
+    png->adler_b %= 65521;
+  }
+
+  i = 0;
+  while ( i < length ) {
+    best = 0;
+    best_distance = 0;
+    // A run of the longest match at distance 1 cannot be bettered, so the background goes quickly.
+    for ( distance = 1; distance <= 3 && best < PNG_MAX_MATCH; distance += 2 ) {
+      if ( i < distance ) continue;
+      for ( n = 0; i + n < length && n < PNG_MAX_MATCH && data[i + n] == data[i + n - distance]; n++ );
+      if ( n > best ) {
+        best = n;
+        best_distance = distance;
+      }
+    }
+    if ( best >= 3 ) {
+      png_match( png, best, best_distance );
+      i += best;
+    }
+    else png_symbol( png, data[i++] );
+  }
+
+}
+
+int RasterWritePNG( Display display, const char *filename ) {
+
+  register RasterParams	*params = (RasterParams *) display->parameters;
+  static unsigned char signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+  unsigned char header[13];
+  unsigned char *row, *pixel, *above;
+  int stride = params->width * 3;
+  int r, i;
+  PngStream *png;
+
+  png = malloc( sizeof( PngStream ) );
+  row = malloc( stride + 1 );
+  if ( !png || !row ) {
+    free( png );
+    free( row );
+    return( -1 );
+  }
+  png->fp = fopen( filename, "wb" );
+  if ( !png->fp ) {
+    free( png );
+    free( row );
+    return( -1 );
+  }
+  png->error = NO;
+  png->count = 0;
+  png->bits = 0;
+  png->nbits = 0;
+  png->adler_a = 1;
+  png->adler_b = 0;
+
+  if ( fwrite( signature, 1, sizeof( signature ), png->fp ) != sizeof( signature ) ) png->error = YES;
+  png_ulong( header, params->width );
+  png_ulong( header + 4, params->height );
+  header[8] = 8;		/* Bits per sample */
+  header[9] = 2;		/* RGB */
+  header[10] = 0;		/* Deflate */
+  header[11] = 0;		/* Adaptive filtering */
+  header[12] = 0;		/* Not interlaced */
+  png_chunk( png, "IHDR", header, sizeof( header ) );
+
+  /* zlib header, then a single final block with the fixed codes. */
+  png_byte( png, 0x78 );
+  png_byte( png, 0x01 );
+  png_bits( png, 1, 1 );
+  png_bits( png, 1, 2 );
+  for ( r = 0; r < params->height; r++ ) {
+    pixel = params->pixels + r * stride;
+    above = pixel - stride;
+    row[0] = 2;		/* Up */
+    if ( r == 0 ) memcpy( row + 1, pixel, stride );
+    else for ( i = 0; i < stride; i++ ) row[i + 1] = (unsigned char) ( pixel[i] - above[i] );
+    png_deflate( png, row, stride + 1 );
+  }
+  png_symbol( png, 256 );
+  if ( png->nbits > 0 ) png_bits( png, 0, 8 - png->nbits );
+  png_byte( png, (unsigned char) ( png->adler_b >> 8 ) );
+  png_byte( png, (unsigned char) png->adler_b );
+  png_byte( png, (unsigned char) ( png->adler_a >> 8 ) );
+  png_byte( png, (unsigned char) png->adler_a );
+  if ( png->count > 0 ) png_chunk( png, "IDAT", png->buffer, png->count );
+  png_chunk( png, "IEND", NULL, 0 );
+
+  if ( fclose( png->fp ) ) png->error = YES;
+  r = ( png->error ? -1 : 0 );
+  free( png );
+  free( row );
+  return( r );
+
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                           RasterDisplay.h                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+/*
+ * A display that draws into an image in memory, without a window or OpenGL,
+ * and writes the image to a PNG file on Hardcopy().
+ * Text is drawn with a built-in 5x7 font in the same 8x12 cell as the OglDisplay.
+ * Lines are one pixel wide and line patterns and the XOR alu are not supported.
+ * Nothing is cached, so the memory used does not depend on how much is drawn.
+ */
+
+#ifndef	_RASTERDISPLAY_
+
+#include "Displays.h"
+#include "Graphics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+Display CreateRasterDisplay( void );
+void DestroyRasterDisplays( void );
+
+/* Write the image to a PNG file. Returns 0 on success and -1 if the file could not be written. */
+int		RasterWritePNG( Display display, const char *filename );
+
+void	RasterInit( Display display );
+void	RasterActivate( Display display );
+void	RasterSwap ( Display display );
+void	RasterClose( Display display );
+void	RasterHardcopy ( Display display, char *filename );
+int		RasterInput( Display display, float *x, float *y );
+
+void	RasterPoint ( Display display, float x, float y );
+void	RasterLine ( Display display, float x1, float y1, float x2, float y2 );
+void	RasterMoveTo ( Display display, float x, float y );
+void	RasterLineTo ( Display display, float x, float y );
+void	RasterStartTrace ( Display display, float x, float y );
+void	RasterContinueTrace ( Display display, float x, float y );
+void	RasterEndTrace ( Display display, float x, float y );
+
+void	RasterText ( Display display, char *string, float x, float y, double dir );
+float	RasterTextWidth ( Display display, char *string );
+float	RasterTextHeight ( Display display, char *string );
+
+void	RasterRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	RasterFilledRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	RasterCircle ( Display display, float x, float y, float radius );
+void	RasterFilledCircle ( Display display, float x, float y, float radius );
+void	RasterStartPolygon ( Display display );
+void	RasterAddVertex ( Display display, float x, float y );
+void	RasterOutlinePolygon ( Display display );
+void	RasterFillPolygon ( Display display );
+void	RasterErase ( Display display );
+void	RasterEraseRectangle ( Display display, float x1, float y1, float x2, float y2 );
+
+void	RasterLineStyle ( Display display, int style );
+void	RasterLinePattern ( Display display, int pattern );
+void	RasterColor ( Display display, int color );
+void	RasterColorRGB ( Display display, float r, float g, float b );
+void	RasterAlu ( Display display, int alu );
+void	RasterPenSize ( Display display, float size );
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Same size as an OglDisplay that is not given one. */
+#define RASTER_DISPLAY_WIDTH	900
+#define RASTER_DISPLAY_HEIGHT	675
+/* Most vertices in a polygon. */
+#define RASTER_MAX_VERTICES		256
+
+typedef struct {
+
+	char	*name;
+
+	int		width;
+	int		height;
+	/* 3 bytes per pixel, red, green and blue, starting from the top row. */
+	unsigned char	*pixels;
+	unsigned char	rgb[3];
+
+	float	last_x;
+	float	last_y;
+
+	int		vertices;
+	float	vertex_x[RASTER_MAX_VERTICES];
+	float	vertex_y[RASTER_MAX_VERTICES];
+
+} RasterParams;
+
+extern Display	RasterDisplay;
+
+#define _RASTERDISPLAY_
+#endif
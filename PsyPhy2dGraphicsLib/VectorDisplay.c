@@ -0,0 +1,722 @@
+/****************************************************************************/
+/*                                                                          */
+/*                           VectorDisplay.c                                */
+/*                                                                          */
+/****************************************************************************/
+
+/*
+ * A display that writes SVG or PDF files. See VectorDisplay.h.
+ * All operations are carried out in pixel coordinates, as for an OglDisplay of the same size.
+ * A pixel is a point in the PDF file, so the page comes out at 72 dpi.
+ */
+
+// Disable warnings about unsafe functions.
+// We use the 'unsafe' versions to maintain source-code compatibility with Visual C++ 6
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "windows.h"
+
+#include "useful.h"
+#include "Graphics.h"
+#include "Displays.h"
+#include "VectorDisplay.h"
+
+/* Same character size as the OglDisplay, so that layouts come out the same. */
+local int vector_font_height = 12;
+local int vector_font_width = 8;
+
+/* What the path being written is, if there is one. */
+#define VECTOR_STROKED	1
+#define VECTOR_FILLED	2
+
+/***************************************************************************/
+
+// Create a static version of a VectorDisplay.
+VectorParams	_vector_params = {"Vector Display", 0, 0, NULL, VECTOR_SVG, 0, {0.0, 0.0, 0.0}, 0.0, 0, 0.0, 0.0, 0, 0.0, 0.0, 0, 0, {0}, 0};
+struct _display	_VectorDisplay = {
+  "Vector Display",
+    0, VECTOR_DISPLAY_HEIGHT, VECTOR_DISPLAY_WIDTH, 0,
+    VectorPoint, VectorLine, VectorMoveTo, VectorLineTo,
+
+    VectorStartTrace, VectorContinueTrace, VectorEndTrace,
+
+    VectorText, VectorTextWidth, VectorTextHeight,
+    VectorRectangle, VectorFilledRectangle,
+    VectorCircle, VectorFilledCircle,
+
+    VectorStartPolygon,
+    VectorAddVertex,
+    VectorOutlinePolygon,
+    VectorFillPolygon,
+
+    VectorErase, VectorEraseRectangle,
+    VectorLineStyle, VectorLinePattern,
+    VectorColor, VectorColorRGB, VectorAlu,
+    VectorPenSize,
+    VectorInit, VectorActivate, VectorSwap, VectorClose, VectorHardcopy, VectorInput,
+    SOLID,						/* Line Pattern */
+    SET,						/* ALU */
+    FOREGROUND,					/* Color */
+    FALSE,						/* Black and White */
+    3,							/* Symbol Size (radius) */
+    -1, -1,						/* Desired Width and Height */
+	0, 0,						/* Desired Left and Top */
+    NULL, NULL, NO,				/* Redraw cache */
+	NULL,						/* Linked list next element */
+    &_vector_params
+};
+Display		VectorDisplay = &_VectorDisplay;	// Pointer to the static VectorDisplay.
+Display		_vector_display_list = NULL;		// Pointer to a list of dynamic VectorDisplays.
+
+/***************************************************************************/
+
+Display CreateVectorDisplay( void ) {
+
+	VectorParams *params;
+	Display	  display;
+
+	// Allocate memory for an new instance.
+	params = malloc( sizeof( VectorParams ) );
+	if ( !params ) {
+		MessageBox( NULL, "Error allocating memory for VectorParams.", "VectorDisplay.c", MB_OK );
+		exit( -100 );
+	}
+	memset( params, 0, sizeof( *params ) );
+	params->name = "Dynamic VectorDisplay";
+	display = malloc( sizeof( *display ) );
+	if ( !display ) {
+		MessageBox( NULL, "Error allocating memory for Display.", "VectorDisplay.c", MB_OK );
+		exit( -101 );
+	}
+	// Add newly created instance to the list of VectorDisplays.
+	memcpy( display, VectorDisplay, sizeof( *display ) );
+	display->parameters = params;
+	display->next = _vector_display_list;
+	_vector_display_list = display;
+
+	return( display );
+
+}
+
+void DestroyVectorDisplays( void ) {
+
+	Display display = _vector_display_list;
+	Display display_to_kill;
+
+	while ( display ) {
+		VectorClose( display );
+		free( display->parameters );
+		display_to_kill = display;
+		display = display->next;
+		free( display_to_kill );
+	}
+
+}
+
+/***************************************************************************/
+
+// Coordinates are written to a tenth of a pixel, without the trailing zeros.
+local char *vector_number( char *buffer, double value ) {
+
+  long tenths = (long) floor( value * 10.0 + 0.5 );
+  long whole = labs( tenths ) / 10;
+  int fraction = (int) ( labs( tenths ) % 10 );
+
+  if ( fraction ) sprintf( buffer, "%s%ld.%d", ( tenths < 0 ? "-" : "" ), whole, fraction );
+  else sprintf( buffer, "%s%ld", ( tenths < 0 && whole ? "-" : "" ), whole );
+  return( buffer );
+
+}
+
+// SVG has y going down the page, PDF has it going up as we do.
+local double vector_y( VectorParams *params, double y ) {
+  return( params->format == VECTOR_SVG ? params->height - y : y );
+}
+
+// The dashes of each line pattern, in pixels.
+local char *vector_dashes[] = {
+  "",				/* SOLID */
+  "6 3",			/* DASH */
+  "1 3",			/* DOT */
+  "6 3 1 3",		/* DASH_DOT */
+  "6 3 1 3 1 3",	/* DASH_DOT_DOT */
+  "12 4",			/* LONG_DASH */
+  "12 3 3 3",		/* CENTER_DASH */
+  "12 3 3 3 3 3"	/* CENTER_DASH_DASH */
+};
+
+local void vector_svg_color( VectorParams *params, char *color ) {
+  sprintf( color, "#%02x%02x%02x",
+    (int) ( params->rgb[0] * 255.0 + 0.5 ), (int) ( params->rgb[1] * 255.0 + 0.5 ), (int) ( params->rgb[2] * 255.0 + 0.5 ) );
+}
+
+// The attributes of an SVG element that is outlined.
+local void vector_svg_stroke( VectorParams *params ) {
+
+  char color[16], width[32];
+
+  vector_svg_color( params, color );
+  fprintf( params->fp, " fill=\"none\" stroke=\"%s\"", color );
+  if ( params->pen != 1.0 ) fprintf( params->fp, " stroke-width=\"%s\"", vector_number( width, params->pen ) );
+  if ( params->pattern > SOLID ) fprintf( params->fp, " stroke-dasharray=\"%s\"", vector_dashes[params->pattern] );
+
+}
+
+// The attributes of an SVG element that is filled.
+local void vector_svg_fill( VectorParams *params ) {
+  char color[16];
+  vector_svg_color( params, color );
+  fprintf( params->fp, " fill=\"%s\"", color );
+}
+
+// Set the PDF colors, pen and pattern to the current ones.
+local void vector_pdf_state( VectorParams *params ) {
+
+  char width[32];
+
+  fprintf( params->fp, "%.3f %.3f %.3f RG %.3f %.3f %.3f rg %s w [%s] 0 d\n",
+    params->rgb[0], params->rgb[1], params->rgb[2],
+    params->rgb[0], params->rgb[1], params->rgb[2],
+    vector_number( width, params->pen ), vector_dashes[params->pattern] );
+
+}
+
+// Write a point of a path, either moving to it or drawing a line to it.
+local void vector_path_point( VectorParams *params, int line, double x, double y ) {
+
+  char nx[32], ny[32];
+
+  vector_number( nx, x );
+  vector_number( ny, vector_y( params, y ) );
+  if ( params->format == VECTOR_SVG ) fprintf( params->fp, "%c%s %s", ( line ? 'L' : 'M' ), nx, ny );
+  else fprintf( params->fp, "%s %s %c\n", nx, ny, ( line ? 'l' : 'm' ) );
+
+}
+
+// Finish the path that is being written, if there is one.
+// This is done before anything is drawn that is not part of it, and when the drawing state changes.
+local void vector_end_path( VectorParams *params ) {
+
+  if ( !params->in_path ) return;
+  if ( params->format == VECTOR_SVG ) {
+    fputc( '"', params->fp );
+    if ( params->in_path == VECTOR_FILLED ) vector_svg_fill( params );
+    else vector_svg_stroke( params );
+    fprintf( params->fp, "/>\n" );
+  }
+  else fprintf( params->fp, "%s\n", ( params->in_path == VECTOR_FILLED ? "f" : "S" ) );
+  params->in_path = NO;
+
+}
+
+// Add a line from the current point to the path, starting a new path if need be.
+// A move is only written if the line does not start where the path ends.
+local void vector_line_to( VectorParams *params, float x, float y ) {
+
+  if ( params->in_path != VECTOR_STROKED ) {
+    vector_end_path( params );
+    if ( params->format == VECTOR_SVG ) fprintf( params->fp, "<path d=\"" );
+    params->in_path = VECTOR_STROKED;
+    vector_path_point( params, NO, params->last_x, params->last_y );
+  }
+  else if ( params->path_x != params->last_x || params->path_y != params->last_y ) {
+    vector_path_point( params, NO, params->last_x, params->last_y );
+  }
+  vector_path_point( params, YES, x, y );
+  params->path_x = params->last_x = x;
+  params->path_y = params->last_y = y;
+
+}
+
+/***************************************************************************/
+
+int VectorDisplayOpen( Display display, const char *filename ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  size_t length = strlen( filename );
+
+  if ( params->fp ) VectorDisplayClose( display );
+
+  if ( length > 4 && !_stricmp( filename + length - 4, ".pdf" ) ) params->format = VECTOR_PDF;
+  else params->format = VECTOR_SVG;
+  // Binary, so that the offsets in the PDF file are right.
+  params->fp = fopen( filename, "wb" );
+  if ( !params->fp ) {
+    fprintf( stderr, "Error opening %s for writing.\n", filename );
+    return( -1 );
+  }
+  params->error = NO;
+  params->in_path = NO;
+  params->in_polygon = NO;
+
+  if ( params->format == VECTOR_SVG ) {
+    fprintf( params->fp, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\" font-family=\"monospace\" font-size=\"%d\">\n",
+      params->width, params->height, params->width, params->height, vector_font_height );
+  }
+  else {
+    // A single page. The length of its contents is an object of its own, written after them.
+    fprintf( params->fp, "%%PDF-1.4\n" );
+    params->pdf_offset[1] = ftell( params->fp );
+    fprintf( params->fp, "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n" );
+    params->pdf_offset[2] = ftell( params->fp );
+    fprintf( params->fp, "2 0 obj\n<< /Type /Pages /Kids [ 3 0 R ] /Count 1 >>\nendobj\n" );
+    params->pdf_offset[3] = ftell( params->fp );
+    fprintf( params->fp, "3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 %d %d ] /Contents 4 0 R /Resources << /Font << /F1 6 0 R >> >> >>\nendobj\n",
+      params->width, params->height );
+    params->pdf_offset[4] = ftell( params->fp );
+    fprintf( params->fp, "4 0 obj\n<< /Length 5 0 R >>\nstream\n" );
+    params->pdf_stream_start = ftell( params->fp );
+    fprintf( params->fp, "1 J 1 j\n" );
+    vector_pdf_state( params );
+  }
+  return( 0 );
+
+}
+
+int VectorDisplayClose( Display display ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  long length, xref;
+  int i;
+
+  if ( !params->fp ) return( 0 );
+  vector_end_path( params );
+
+  if ( params->format == VECTOR_SVG ) fprintf( params->fp, "</svg>\n" );
+  else {
+    length = ftell( params->fp ) - params->pdf_stream_start;
+    fprintf( params->fp, "endstream\nendobj\n" );
+    params->pdf_offset[5] = ftell( params->fp );
+    fprintf( params->fp, "5 0 obj\n%ld\nendobj\n", length );
+    params->pdf_offset[6] = ftell( params->fp );
+    fprintf( params->fp, "6 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont /Courier >>\nendobj\n" );
+    xref = ftell( params->fp );
+    // Each entry of the cross-reference table has to be exactly 20 bytes long.
+    fprintf( params->fp, "xref\n0 %d\n0000000000 65535 f \n", VECTOR_PDF_OBJECTS );
+    for ( i = 1; i < VECTOR_PDF_OBJECTS; i++ ) fprintf( params->fp, "%010ld 00000 n \n", params->pdf_offset[i] );
+    fprintf( params->fp, "trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%ld\n%%%%EOF\n", VECTOR_PDF_OBJECTS, xref );
+  }
+
+  if ( ferror( params->fp ) ) params->error = YES;
+  if ( fclose( params->fp ) ) params->error = YES;
+  params->fp = NULL;
+  return( params->error ? -1 : 0 );
+
+}
+
+// Hardcopies of the other displays replay their redraw caches into a VectorDisplay, which
+//  is only created the first time that it is needed.
+int VectorDisplayWriteCache( Display display, const char *filename ) {
+
+  static Display writer = NULL;
+
+  if ( !writer ) writer = CreateVectorDisplay();
+  DisplaySetSizePixels( writer, (int) ( display->right - display->left ), (int) ( display->top - display->bottom ) );
+  DisplayInit( writer );
+  if ( VectorDisplayOpen( writer, filename ) ) return( -1 );
+  DisplayWalkCache( display, writer );
+  return( VectorDisplayClose( writer ) );
+
+}
+
+/***************************************************************************/
+
+void	VectorInit ( Display display ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( display->desired_width < 0 ) params->width = VECTOR_DISPLAY_WIDTH;
+  else params->width = (int) display->desired_width;
+  if ( display->desired_height < 0 ) params->height = ( params->width * 3 ) / 4;
+  else params->height = (int) display->desired_height;
+
+  // Set the screen edges.
+  display->left = 0.0;
+  display->right = (float) params->width;
+  display->top = (float) params->height;
+  display->bottom = 0.0;
+
+  params->last_x = 0.0;
+  params->last_y = 0.0;
+  params->rgb[0] = params->rgb[1] = params->rgb[2] = 0.0;
+  params->pen = 1.0;
+  params->pattern = SOLID;
+
+}
+
+void VectorActivate( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+
+void VectorSwap ( Display display ) {
+  UNREFERENCED_PARAMETER( display );
+}
+
+void VectorClose ( Display display ) {
+  VectorDisplayClose( display );
+}
+
+// The file has been written as the drawing was done. It only remains to finish it.
+void VectorHardcopy ( Display display, char *filename ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( !params->fp ) fprintf( stderr, "VectorHardcopy(): %s was not opened with VectorDisplayOpen().\n", filename );
+  else if ( VectorDisplayClose( display ) ) fprintf( stderr, "Error writing %s.\n", filename );
+
+}
+
+int	VectorInput( Display display, float *x, float *y ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( x );
+  UNREFERENCED_PARAMETER( y );
+  return( 0 );
+}
+
+/***************************************************************************/
+
+// Filled rectangles of the same color go into a single filled path, as lines go into a stroked one.
+local void vector_filled_rectangle( VectorParams *params, float x1, float y1, float x2, float y2 ) {
+
+  char x[32], y[32], w[32], h[32];
+
+  if ( params->in_path != VECTOR_FILLED ) {
+    vector_end_path( params );
+    if ( params->format == VECTOR_SVG ) fprintf( params->fp, "<path d=\"" );
+    params->in_path = VECTOR_FILLED;
+  }
+  vector_number( x, min( x1, x2 ) );
+  vector_number( w, fabs( x2 - x1 ) );
+  vector_number( h, fabs( y2 - y1 ) );
+  if ( params->format == VECTOR_SVG ) {
+    vector_number( y, params->height - max( y1, y2 ) );
+    fprintf( params->fp, "M%s %sh%sv%sh-%sz", x, y, w, h, w );
+  }
+  else {
+    vector_number( y, min( y1, y2 ) );
+    fprintf( params->fp, "%s %s %s %s re\n", x, y, w, h );
+  }
+
+}
+
+// Paint the rectangle white and go back to the current color.
+local void vector_white_rectangle( VectorParams *params, float x1, float y1, float x2, float y2 ) {
+
+  char x[32], y[32], w[32], h[32];
+
+  vector_end_path( params );
+  vector_number( x, min( x1, x2 ) );
+  vector_number( w, fabs( x2 - x1 ) );
+  vector_number( h, fabs( y2 - y1 ) );
+  if ( params->format == VECTOR_SVG ) {
+    vector_number( y, params->height - max( y1, y2 ) );
+    fprintf( params->fp, "<rect x=\"%s\" y=\"%s\" width=\"%s\" height=\"%s\" fill=\"#ffffff\"/>\n", x, y, w, h );
+  }
+  else {
+    vector_number( y, min( y1, y2 ) );
+    fprintf( params->fp, "1 1 1 rg %s %s %s %s re f %.3f %.3f %.3f rg\n", x, y, w, h, params->rgb[0], params->rgb[1], params->rgb[2] );
+  }
+
+}
+
+void	VectorErase ( Display display ) {
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  if ( !params->fp ) return;
+  vector_white_rectangle( params, 0.0, 0.0, (float) params->width, (float) params->height );
+}
+
+void	VectorEraseRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  if ( !params->fp ) return;
+  vector_white_rectangle( params, x1, y1, x2, y2 );
+}
+
+// A point is a filled square one pixel wide.
+void	VectorPoint ( Display display, float x, float y ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  params->last_x = x;
+  params->last_y = y;
+  if ( !params->fp ) return;
+  vector_filled_rectangle( params, x, y, x + 1.0f, y + 1.0f );
+
+}
+
+void	VectorLine ( Display display, float x1, float y1, float x2, float y2 ) {
+  VectorMoveTo( display, x1, y1 );
+  VectorLineTo( display, x2, y2 );
+}
+
+// Nothing is written for a move. It is written with the next line, if that does not continue the path.
+void	VectorMoveTo ( Display display, float x, float y ) {
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  params->last_x = x;
+  params->last_y = y;
+}
+
+void	VectorLineTo ( Display display, float x, float y ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( !params->fp ) {
+    params->last_x = x;
+    params->last_y = y;
+  }
+  else vector_line_to( params, x, y );
+
+}
+
+void	VectorStartTrace ( Display display, float x, float y ) {
+  VectorMoveTo( display, x, y );
+}
+
+void	VectorContinueTrace ( Display display, float x, float y ) {
+  VectorLineTo( display, x, y );
+}
+
+void	VectorEndTrace ( Display display, float x, float y ) {
+  VectorLineTo( display, x, y );
+}
+
+/***************************************************************************/
+
+// Outlines go into the path like any other lines.
+void	VectorRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  VectorMoveTo( display, x1, y1 );
+  VectorLineTo( display, x1, y2 );
+  VectorLineTo( display, x2, y2 );
+  VectorLineTo( display, x2, y1 );
+  VectorLineTo( display, x1, y1 );
+}
+
+void	VectorFilledRectangle ( Display display, float x1, float y1, float x2, float y2 ) {
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  if ( !params->fp ) return;
+  vector_filled_rectangle( params, x1, y1, x2, y2 );
+}
+
+local void vector_circle( VectorParams *params, float x, float y, float radius, int filled ) {
+
+  // Distance of the control points of the Bezier curves that make up a quarter circle.
+  double k = 0.5523 * radius;
+  char cx[32], cy[32], r[32];
+
+  if ( !params->fp ) return;
+  vector_end_path( params );
+  if ( params->format == VECTOR_SVG ) {
+    vector_number( cx, x );
+    vector_number( cy, params->height - y );
+    vector_number( r, radius );
+    fprintf( params->fp, "<circle cx=\"%s\" cy=\"%s\" r=\"%s\"", cx, cy, r );
+    if ( filled ) vector_svg_fill( params );
+    else vector_svg_stroke( params );
+    fprintf( params->fp, "/>\n" );
+  }
+  else {
+    fprintf( params->fp, "%.1f %.1f m\n", x + radius, y );
+    fprintf( params->fp, "%.1f %.1f %.1f %.1f %.1f %.1f c\n", x + radius, y + k, x + k, y + radius, x, y + radius );
+    fprintf( params->fp, "%.1f %.1f %.1f %.1f %.1f %.1f c\n", x - k, y + radius, x - radius, y + k, x - radius, y );
+    fprintf( params->fp, "%.1f %.1f %.1f %.1f %.1f %.1f c\n", x - radius, y - k, x - k, y - radius, x, y - radius );
+    fprintf( params->fp, "%.1f %.1f %.1f %.1f %.1f %.1f c\n", x + k, y - radius, x + radius, y - k, x + radius, y );
+    fprintf( params->fp, "%s\n", ( filled ? "f" : "S" ) );
+  }
+
+}
+
+void	VectorCircle ( Display display, float x, float y, float radius ) {
+  vector_circle( (VectorParams *) display->parameters, x, y, radius, NO );
+}
+
+void	VectorFilledCircle ( Display display, float x, float y, float radius ) {
+  vector_circle( (VectorParams *) display->parameters, x, y, radius, YES );
+}
+
+// The vertices are written as they are added. Whether the polygon is outlined or filled
+//  goes at the end, which both formats allow.
+void	VectorStartPolygon ( Display display ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( !params->fp ) return;
+  vector_end_path( params );
+  if ( params->format == VECTOR_SVG ) fprintf( params->fp, "<polygon points=\"" );
+  params->in_polygon = YES;
+  params->vertices = 0;
+
+}
+
+void	VectorAddVertex ( Display display, float x, float y ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  char nx[32], ny[32];
+
+  if ( !params->fp || !params->in_polygon ) return;
+  if ( params->format == VECTOR_SVG ) {
+    fprintf( params->fp, "%s%s,%s", ( params->vertices ? " " : "" ), vector_number( nx, x ), vector_number( ny, params->height - y ) );
+  }
+  else vector_path_point( params, params->vertices > 0, x, y );
+  params->vertices++;
+
+}
+
+local void vector_end_polygon( VectorParams *params, int filled ) {
+
+  if ( !params->fp || !params->in_polygon ) return;
+  if ( params->format == VECTOR_SVG ) {
+    fputc( '"', params->fp );
+    if ( filled ) vector_svg_fill( params );
+    else vector_svg_stroke( params );
+    fprintf( params->fp, "/>\n" );
+  }
+  else if ( params->vertices > 0 ) fprintf( params->fp, "%s\n", ( filled ? "f" : "h S" ) );
+  params->in_polygon = NO;
+
+}
+
+void	VectorOutlinePolygon ( Display display ) {
+  vector_end_polygon( (VectorParams *) display->parameters, NO );
+}
+
+void	VectorFillPolygon ( Display display ) {
+  vector_end_polygon( (VectorParams *) display->parameters, YES );
+}
+
+/***************************************************************************/
+
+// The text starts at (x, y), with y at the bottom of the characters, as for glprintf().
+// The direction is ignored, as it is by the OglDisplay.
+void	VectorText ( Display display, char *string, float x, float y, double dir ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+  char nx[32], ny[32];
+  char *c;
+
+  UNREFERENCED_PARAMETER( dir );
+
+  if ( !params->fp ) return;
+  vector_end_path( params );
+  vector_number( nx, x );
+  vector_number( ny, vector_y( params, y ) );
+  if ( params->format == VECTOR_SVG ) {
+    fprintf( params->fp, "<text x=\"%s\" y=\"%s\"", nx, ny );
+    vector_svg_fill( params );
+    fputc( '>', params->fp );
+    for ( c = string; *c; c++ ) {
+      if ( *c == '<' ) fputs( "&lt;", params->fp );
+      else if ( *c == '>' ) fputs( "&gt;", params->fp );
+      else if ( *c == '&' ) fputs( "&amp;", params->fp );
+      else fputc( *c, params->fp );
+    }
+    fprintf( params->fp, "</text>\n" );
+  }
+  else {
+    fprintf( params->fp, "BT /F1 %d Tf %s %s Td (", vector_font_height, nx, ny );
+    for ( c = string; *c; c++ ) {
+      if ( *c == '(' || *c == ')' || *c == '\\' ) fputc( '\\', params->fp );
+      fputc( *c, params->fp );
+    }
+    fprintf( params->fp, ") Tj ET\n" );
+  }
+
+}
+
+// Same metrics as OglTextWidth() and OglTextHeight().
+float	VectorTextWidth ( Display display, char *string ) {
+
+  unsigned int i;
+  float add = 0.0, adjust = 0.25;
+  UNREFERENCED_PARAMETER( display );
+  for ( i = 0; i < strlen( string ); i++ ) {
+    if ( string[i] >= 'A' && string[i] <= 'Z' ) add += adjust;
+  }
+  return( (float) ( vector_font_width * strlen( string ) ) + add );
+
+}
+
+float	VectorTextHeight ( Display display, char *string ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( string );
+  return ( (float) vector_font_height );
+}
+
+/***************************************************************************/
+
+// Same colors as the OglDisplay.
+local float vector_color_table[][3] = {
+  { 0, 0, 0 },	/* Black	*/
+  { 1, 0, 0 },	/* Red		*/
+  { 0, 1, 0 },	/* Green	*/
+  { 1, 1, 0 },	/* Yellow	*/
+  { 0, 0, 1 },	/* Blue		*/
+  { 1, 0, 1 },	/* Magenta	*/
+  { 0, 1, 1 },	/* Cyan		*/
+  { 1, 1, 1 },	/* White	*/
+  { .125, .125, .125 },	/* Grey1	*/
+  { .25, .25, .25 },	/* Grey2	*/
+  { .375, .375, .375 },	/* Grey3	*/
+  { .5,.5, .5 },		/* Grey4	*/
+  { .625, .625, .625 },	/* Grey5	*/
+  { .75, .75, .75 },	/* Grey6	*/
+  { .875, .875, .875 },	/* Grey7	*/
+  { 1.0, 1.0, 1.0 },	/* Grey8	*/
+  { 0, 0, 0 },   /* TRANSPARENT */
+};
+
+void	VectorColor ( Display display, int color ) {
+  if ( color < 0 || color > TRANSPARENT_COLOR ) color = FOREGROUND;
+  VectorColorRGB( display, vector_color_table[color][0], vector_color_table[color][1], vector_color_table[color][2] );
+}
+
+// A change of color, pen or pattern ends the path, since a path is drawn all in one style.
+void	VectorColorRGB ( Display display, float r, float g, float b ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( r == params->rgb[0] && g == params->rgb[1] && b == params->rgb[2] ) return;
+  if ( params->fp ) vector_end_path( params );
+  params->rgb[0] = r;
+  params->rgb[1] = g;
+  params->rgb[2] = b;
+  if ( params->fp && params->format == VECTOR_PDF ) vector_pdf_state( params );
+
+}
+
+void	VectorPenSize ( Display display, float size ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( size <= 0.0 ) size = 1.0;
+  if ( size == params->pen ) return;
+  if ( params->fp ) vector_end_path( params );
+  params->pen = size;
+  if ( params->fp && params->format == VECTOR_PDF ) vector_pdf_state( params );
+
+}
+
+void	VectorLinePattern ( Display display, int pattern ) {
+
+  register VectorParams	*params = (VectorParams *) display->parameters;
+
+  if ( pattern < SOLID || pattern > CENTER_DASH_DASH ) pattern = SOLID;
+  if ( pattern == params->pattern ) return;
+  if ( params->fp ) vector_end_path( params );
+  params->pattern = pattern;
+  if ( params->fp && params->format == VECTOR_PDF ) vector_pdf_state( params );
+
+}
+
+// There is no XOR on paper.
+void	VectorAlu ( Display display, int alu ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( alu );
+}
+void	VectorLineStyle ( Display display, int style ) {
+  UNREFERENCED_PARAMETER( display );
+  UNREFERENCED_PARAMETER( style );
+}
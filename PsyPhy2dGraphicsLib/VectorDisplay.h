@@ -0,0 +1,125 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                           VectorDisplay.h                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+/*
+ * A display that writes what is drawn to an SVG or PDF file as it is drawn.
+ * Nothing is cached, so the memory used does not depend on how much is drawn.
+ * Consecutive lines drawn in the same color, pen and pattern are written as a single path,
+ * and so are consecutive filled rectangles of the same color.
+ *
+ * VectorDisplayOpen() starts a file. The format is given by the extension: .pdf for PDF
+ * and anything else for SVG. Hardcopy() or VectorDisplayClose() finishes the file.
+ * What is drawn while no file is open goes nowhere.
+ * Erasing paints over what is there, since what has been written cannot be taken back.
+ */
+
+#ifndef	_VECTORDISPLAY_
+
+#include <stdio.h>
+
+#include "Displays.h"
+#include "Graphics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+Display CreateVectorDisplay( void );
+void DestroyVectorDisplays( void );
+
+/* Start and finish a file. Both return 0 on success and -1 if the file could not be written. */
+int		VectorDisplayOpen( Display display, const char *filename );
+int		VectorDisplayClose( Display display );
+
+/* Replay the redraw cache of another display into a file of the same size. */
+int		VectorDisplayWriteCache( Display display, const char *filename );
+
+void	VectorInit( Display display );
+void	VectorActivate( Display display );
+void	VectorSwap ( Display display );
+void	VectorClose( Display display );
+void	VectorHardcopy ( Display display, char *filename );
+int		VectorInput( Display display, float *x, float *y );
+
+void	VectorPoint ( Display display, float x, float y );
+void	VectorLine ( Display display, float x1, float y1, float x2, float y2 );
+void	VectorMoveTo ( Display display, float x, float y );
+void	VectorLineTo ( Display display, float x, float y );
+void	VectorStartTrace ( Display display, float x, float y );
+void	VectorContinueTrace ( Display display, float x, float y );
+void	VectorEndTrace ( Display display, float x, float y );
+
+void	VectorText ( Display display, char *string, float x, float y, double dir );
+float	VectorTextWidth ( Display display, char *string );
+float	VectorTextHeight ( Display display, char *string );
+
+void	VectorRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	VectorFilledRectangle ( Display display, float x1, float y1, float x2, float y2 );
+void	VectorCircle ( Display display, float x, float y, float radius );
+void	VectorFilledCircle ( Display display, float x, float y, float radius );
+void	VectorStartPolygon ( Display display );
+void	VectorAddVertex ( Display display, float x, float y );
+void	VectorOutlinePolygon ( Display display );
+void	VectorFillPolygon ( Display display );
+void	VectorErase ( Display display );
+void	VectorEraseRectangle ( Display display, float x1, float y1, float x2, float y2 );
+
+void	VectorLineStyle ( Display display, int style );
+void	VectorLinePattern ( Display display, int pattern );
+void	VectorColor ( Display display, int color );
+void	VectorColorRGB ( Display display, float r, float g, float b );
+void	VectorAlu ( Display display, int alu );
+void	VectorPenSize ( Display display, float size );
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Same size as an OglDisplay that is not given one. */
+#define VECTOR_DISPLAY_WIDTH	900
+#define VECTOR_DISPLAY_HEIGHT	675
+
+typedef enum { VECTOR_SVG, VECTOR_PDF } VectorFormat;
+
+/* Number of objects in the PDF file, counting the free object 0. */
+#define VECTOR_PDF_OBJECTS	7
+
+typedef struct {
+
+	char	*name;
+
+	int		width;
+	int		height;
+
+	FILE			*fp;
+	VectorFormat	format;
+	int				error;
+
+	/* Current drawing state. */
+	float	rgb[3];
+	float	pen;
+	int		pattern;
+
+	/* The current point, and what the path being written is and where it ends. */
+	float	last_x;
+	float	last_y;
+	int		in_path;
+	float	path_x;
+	float	path_y;
+
+	int		in_polygon;
+	int		vertices;
+
+	/* Where the PDF objects and the page contents start in the file. */
+	long	pdf_offset[VECTOR_PDF_OBJECTS];
+	long	pdf_stream_start;
+
+} VectorParams;
+
+extern Display	VectorDisplay;
+
+#define _VECTORDISPLAY_
+#endif
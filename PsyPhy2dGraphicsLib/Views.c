@@ -25,6 +25,9 @@
 
 View _view_destroy_list = NULL;
 
+unsigned long ViewVertexCount = 0;
+unsigned long ViewAutoScaleCount = 0;
+
 /****************************************************************************/
 
 View CreateView (Display display) {
@@ -261,12 +264,12 @@ void ViewCenterZeroY( View view ) {
 
 void ViewMakeSquare (View view) {
 	
-	register	center, width, height, new_width, new_height;
+	register int	center, width, height, new_width, new_height;
 	
 	if (fabs(view->x_factor) > fabs(view->y_factor)) {
 		
 		center = (view->display_left + view->display_right) / 2;
-		width = abs(view->display_right - view->display_left);
+		width = (int) fabs(view->display_right - view->display_left);
 		new_width = fabs(view->y_factor / view->x_factor * (double) width); 
 		
 		if (view->display->right > view->display->left)
@@ -281,7 +284,7 @@ void ViewMakeSquare (View view) {
 	else {
 		
 		center = (view->display_bottom + view->display_top) / 2;
-		height = abs(view->display_bottom - view->display_top);
+		height = (int) fabs(view->display_bottom - view->display_top);
 		new_height = fabs(view->x_factor / view->y_factor * (double) height);
 		
 		if (view->display->bottom > view->display->top)
@@ -302,6 +305,7 @@ void ViewMakeSquare (View view) {
 
 void ViewPoint (View view, double x, double y) {
 	
+	ViewVertexCount++;
 	Point(view->display, UserToDisplayX(view, x), UserToDisplayY(view, y));
 	
 }
@@ -310,6 +314,7 @@ void ViewPoint (View view, double x, double y) {
 
 void ViewSymbol( View view, double x, double y, int symbol ) {
 	
+	ViewVertexCount++;
 	DisplaySymbol( view->display, 
 		UserToDisplayX(view, x), UserToDisplayY(view, y), symbol );
 	
@@ -319,6 +324,7 @@ void ViewSymbol( View view, double x, double y, int symbol ) {
 
 void ViewMoveTo (View view, double x, double y)	{
 	
+	ViewVertexCount++;
 	Moveto(view->display, UserToDisplayX(view, x), UserToDisplayY(view, y));
 	
 }
@@ -327,6 +333,7 @@ void ViewMoveTo (View view, double x, double y)	{
 
 void ViewLineTo (View view, double x, double y)	{
 	
+	ViewVertexCount++;
 	Lineto(view->display, UserToDisplayX(view, x), UserToDisplayY(view, y));
 	
 }
@@ -476,7 +483,7 @@ void ViewFilledCircle (View view, double x, double y, double radius ) {
 	
 	FilledCircle(view->display,
 	       UserToDisplayX(view, x), UserToDisplayY(view, y),
-		   abs( UserToDisplayX(view, radius ) - UserToDisplayX(view, 0.0)) );
+		   abs( (int) ( UserToDisplayX(view, radius ) - UserToDisplayX(view, 0.0) ) ) );
 	
 }
 
@@ -487,7 +494,7 @@ void ViewCircle (View view, double x, double y, double radius ) {
 	Circle(view->display,
 		UserToDisplayX(view, x), 
 		UserToDisplayY(view, y),
-		abs( UserToDisplayX(view, radius ) - UserToDisplayX(view, 0.0)) );
+		abs( (int) ( UserToDisplayX(view, radius ) - UserToDisplayX(view, 0.0) ) ) );
 	
 }
 
@@ -501,6 +508,7 @@ void ViewStartPolygon ( View view ) {
 
 void ViewAddVertex ( View view, double x, double y ) {
 	
+	ViewVertexCount++;
 	AddVertex( view->display, UserToDisplayX( view, x ),
 		UserToDisplayY( view, y ) );
 	
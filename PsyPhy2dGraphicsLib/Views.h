@@ -54,6 +54,16 @@ typedef struct _view {
 	
 } *View;
 
+/*
+ * A run of consecutive valid samples, from index first to index last inclusive.
+ * The ...Runs() array routines plot only the samples within a list of runs,
+ * so that the caller does not have to mark invalid samples with an NA value.
+ */
+typedef struct {
+  int first;
+  int last;
+} ViewRun;
+
 #define UserToDisplayX(v,x) 	(v->display_left + \
 				 (float)((x - v->user_left) * v->x_factor))
 #define UserToDisplayY(v,y)	(v->display_bottom + \
@@ -138,6 +148,12 @@ void ViewVerticalLine( View view, double x );
 void ViewHorizontalLine( View view, double y );
 void ViewXTick( View view, double x );
 
+// Running counts of the points, line and polygon vertices and symbols that have been
+//  sent to the displays, and of the times that autoscaling was started with ViewAutoScaleInit().
+// The application can read them to see how much drawing it is doing.
+extern unsigned long ViewVertexCount;
+extern unsigned long ViewAutoScaleCount;
+
 void ViewPoint (View view, double x, double y);
 void ViewMoveTo (View view, double x, double y);
 void ViewLineTo (View view, double x, double y);
@@ -193,6 +209,7 @@ void ViewAutoScaleAvailableFloats ( View view, float *array, int start,  int end
 void ViewAutoScaleDoubles ( View view, double *array, int start, int end, unsigned size );
 void ViewAutoScaleAvailableDoubles ( View view, double *array, int start, int end, unsigned size, double NA );
 void ViewAutoScaleMostDoubles ( View view, double *array, int start, int end, unsigned size, double NA, double exclude );
+void ViewAutoScaleDoubleRuns ( View view, double *array, ViewRun *run, int n_runs, unsigned size );
 
 void ViewAutoScaleExpand( View view, double fraction );
 void ViewAutoScaleSetInterval( View view, double interval );
@@ -242,6 +259,12 @@ void ViewXYPlotClippedDoubles (View view, double *xarray, double *yarray,
 				 int start, int end, int step,
 				 unsigned xsize, unsigned ysize, 
 				 double na);
+void ViewXYPlotDoubleRuns (View view, double *xarray, double *yarray, 
+			   ViewRun *run, int n_runs, int step,
+			   unsigned xsize, unsigned ysize);
+void ViewXYPlotClippedDoubleRuns (View view, double *xarray, double *yarray, 
+				  ViewRun *run, int n_runs, int step,
+				  unsigned xsize, unsigned ysize);
 						   
 void ViewScatterPlotFloats (View view, int symbol,  
 			    float *xarray, float *yarray, 
@@ -268,6 +291,10 @@ void ViewScatterPlotAvailableDoubles (View view, int symbol,
 				     int start, int end, int step,
 				     unsigned xsize, unsigned ysize,
 				     double NA );
+void ViewScatterPlotDoubleRuns (View view, int symbol,
+				double *xarray, double *yarray, 
+				ViewRun *run, int n_runs, int step,
+				unsigned xsize, unsigned ysize );
 
 #ifdef __cplusplus
 }
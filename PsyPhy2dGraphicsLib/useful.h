@@ -83,7 +83,10 @@ extern "C"
 #endif
 
 void *ealloc( size_t size );
+#ifdef _MSC_VER
+// The GNU math.h declares a function of the same name.
 local unsigned long __nan = 0x7ff7ffff;
+#endif
 
 int open_pc ( char *filename, int flags );
 FILE *fopen_pc ( char *filename, char *flags );
@@ -1,59 +1,90 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "useful.h"
+#include "Useful.h"
 
 #include "ParseCommaDelimitedLine.h"
 
-static char return_tokens[PARSER_BUFFERS][1024];
+// Buffers for ParseCommaDelimitedLine(), which grow to fit the longest line seen.
+static char *return_tokens[PARSER_BUFFERS];
+static size_t return_size[PARSER_BUFFERS];
 static int circular = 0;
 
-int ParseCommaDelimitedLine ( char *tokens[MAX_TOKENS], const char *line ) {
-
+// Split a line into tokens where it is, in a single pass. The tokens point into the line,
+//  which is modified: the separators and the trailing white space become nulls and the
+//  escaped commas are moved down to plain commas as they are met. Empty fields are skipped.
+//  The parsing stops at a token that starts with '#', at a blank field and after MAX_TOKENS - 1
+//  tokens. Nothing static is used, so that files can be parsed in parallel.
+int ParseCommaDelimitedLineInPlace ( char *tokens[MAX_TOKENS], char *line ) {
 
-	char *tkn, *chr;
-	unsigned int	 n = 0, i, j;
+	char *read = line, *write, *end;
+	int n = 0, more = 1;
 
-	if ( strlen( line ) > sizeof( return_tokens[circular] ) ) {
-		fprintf( stderr, "Line too long.\n%s\n", line );
-		exit( -1 );
-	}
-
-	// Copy and replace escapted commas with semicolons. 
-	for ( i = 0, chr = return_tokens[circular]; i < strlen( line ); i++ ) {
-		if ( line[i] == '\\' && line[i+1] == ',' ) {
-			*chr++ = ';';
-			i++;
+	while ( more && n < MAX_TOKENS - 1 ) {
+		/* Skip empty fields, then the white space at the start of the field. */
+		while ( *read == ',' ) read++;
+		while ( iswhite( *read ) && *read ) read++;
+		/* Break out if we have hit a comment, a blank field or the end of the line. */
+		if ( *read == '#' || *read == ',' || *read == 0 ) break;
+		/* Record this as a valid token and move it down over the escapes, noting where its last non-white character ends. */
+		tokens[n++] = write = end = read;
+		while ( *read && *read != ',' ) {
+			if ( read[0] == '\\' && read[1] == ',' ) {
+				*write++ = ',';
+				read += 2;
+				end = write;
+			}
+			else if ( iswhite( *read ) ) *write++ = *read++;
+			else {
+				*write++ = *read++;
+				end = write;
+			}
 		}
-		else  *chr++ = line[i];
-	}
-	*chr = 0;
-	
-	tkn = strtok( return_tokens[circular], "," );
-	while ( tkn && n < MAX_TOKENS - 1 ) {
-		/* Skip to first non-white character. */
-		while ( iswhite( *tkn ) && *tkn ) tkn++;
-		/* Strip off any trailing whitespace. */
-		chr = tkn + strlen( tkn );
-		while ( iswhite( *chr ) && chr >= tkn ) *chr-- = 0;
-		/* Break out if we have hit a comment or the end of the line. */
-		if ( *tkn == '#' || *tkn == 0 ) break;
-		/* Record this as a valid token. */
-		tokens[n++] = tkn;
-		/* Parse for the next one. */
-		tkn = strtok( NULL, "," );
+		/* Step over the separator before the null can land on it. */
+		more = ( *read == ',' );
+		if ( more ) read++;
+		*end = 0;
 	}
 
 	/* Last token shall be a null pointer by definition. */
 	tokens[n] = NULL;
-	// Convert semicolons back to commas.
-	for ( i = 0; i < n; i++ ) {
-		for ( j = 0; j < strlen( tokens[i] ); j++ ) if ( tokens[i][j] == ';' ) tokens[i][j] = ',';
+	return( n );
+}
+
+// The same for a line that is not to be modified. The tokens are built in the buffer, which
+//  has to be at least one byte longer than the line. Returns -1 if the buffer is too small.
+int ParseCommaDelimitedLineBuffer ( char *tokens[MAX_TOKENS], const char *line, char *buffer, size_t size ) {
+
+	size_t length = strlen( line );
+
+	if ( length >= size ) {
+		tokens[0] = NULL;
+		return( -1 );
 	}
+	memcpy( buffer, line, length + 1 );
+	return( ParseCommaDelimitedLineInPlace( tokens, buffer ) );
+}
+
+// The tokens are built in one of PARSER_BUFFERS static buffers that are used in turn,
+//  so they remain valid over that many calls. Not for use by more than one thread.
+int ParseCommaDelimitedLine ( char *tokens[MAX_TOKENS], const char *line ) {
+
+	int n;
+	size_t length = strlen( line );
+
+	if ( length >= return_size[circular] ) {
+		char *buffer = (char *) realloc( return_tokens[circular], length + 1 );
+		if ( !buffer ) {
+			fprintf( stderr, "Error allocating memory to parse a line.\n%s\n", line );
+			exit( -1 );
+		}
+		return_tokens[circular] = buffer;
+		return_size[circular] = length + 1;
+	}
+	n = ParseCommaDelimitedLineBuffer( tokens, line, return_tokens[circular], return_size[circular] );
 
 	/* Next time around use a different buffer for the strings. */
 	circular = ( circular + 1 ) % PARSER_BUFFERS;
 
 	return( n );
 }
-
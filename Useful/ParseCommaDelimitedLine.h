@@ -12,6 +12,8 @@ extern "C" {
 #endif
 
 int ParseCommaDelimitedLine ( char *tokens[MAX_TOKENS], const char *line );
+int ParseCommaDelimitedLineInPlace ( char *tokens[MAX_TOKENS], char *line );
+int ParseCommaDelimitedLineBuffer ( char *tokens[MAX_TOKENS], const char *line, char *buffer, size_t size );
 
 #ifdef __cplusplus
 }
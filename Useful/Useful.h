@@ -26,4 +26,13 @@ typedef double Matrix3x3[3][3];
 
 #define Pi	M_PI
 
-#define UNDEFINED		-1
\ No newline at end of file
+#define UNDEFINED		-1
+
+// printf formats for 64-bit integers. Visual C++ has no <inttypes.h> before VS2013.
+#include <stdint.h>
+#if defined(_MSC_VER) && _MSC_VER < 1800
+#define PRId64	"I64d"
+#define PRIu64	"I64u"
+#else
+#include <inttypes.h>
+#endif
\ No newline at end of file
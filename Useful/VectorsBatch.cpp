@@ -0,0 +1,382 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                 VectorsBatch.cpp                              */
+/*                                                                               */
+/*********************************************************************************/
+
+// SSE2 implementation of batch vector and quaternion operations.
+// Copyright (c) 2015 PsyPhy Consulting. All rights reserved.
+
+// Each operation is written once as a template on a small 'traits' class that
+//  wraps the SSE2 intrinsics for either 2 doubles or 4 floats at a time.
+// The tail of each array (fewer samples than fit in a register) is copied into
+//  a padded buffer and processed in the same way, so that every sample goes
+//  through exactly the same arithmetic.
+
+#include <math.h>
+#include <emmintrin.h>
+
+#include "Useful.h"
+#include "VectorsBatch.h"
+
+/***********************************************************************************/
+
+class BatchDouble {
+public:
+	typedef double	Scalar;
+	typedef __m128d	Vector;
+	enum { width = 2 };
+
+	static Vector Load( const double *p, int count, double pad ) {
+		if ( count == width ) return( _mm_loadu_pd( p ) );
+		double tmp[width];
+		for ( int i = 0; i < width; i++ ) tmp[i] = ( i < count ? p[i] : pad );
+		return( _mm_loadu_pd( tmp ) );
+	}
+	static void Store( double *p, Vector v, int count ) {
+		if ( count == width ) _mm_storeu_pd( p, v );
+		else {
+			double tmp[width];
+			_mm_storeu_pd( tmp, v );
+			for ( int i = 0; i < count; i++ ) p[i] = tmp[i];
+		}
+	}
+	static Scalar Sum( Vector v ) {
+		double tmp[width];
+		_mm_storeu_pd( tmp, v );
+		return( tmp[0] + tmp[1] );
+	}
+
+	static Vector Set( double s ) { return( _mm_set1_pd( s ) ); }
+	static Vector Add( Vector a, Vector b ) { return( _mm_add_pd( a, b ) ); }
+	static Vector Sub( Vector a, Vector b ) { return( _mm_sub_pd( a, b ) ); }
+	static Vector Mul( Vector a, Vector b ) { return( _mm_mul_pd( a, b ) ); }
+	static Vector Div( Vector a, Vector b ) { return( _mm_div_pd( a, b ) ); }
+	static Vector Sqrt( Vector a ) { return( _mm_sqrt_pd( a ) ); }
+	static Vector Min( Vector a, Vector b ) { return( _mm_min_pd( a, b ) ); }
+	static Vector Max( Vector a, Vector b ) { return( _mm_max_pd( a, b ) ); }
+	static Vector And( Vector a, Vector b ) { return( _mm_and_pd( a, b ) ); }
+	static Vector AndNot( Vector a, Vector b ) { return( _mm_andnot_pd( a, b ) ); }
+	static Vector Or( Vector a, Vector b ) { return( _mm_or_pd( a, b ) ); }
+	static Vector CmpGT( Vector a, Vector b ) { return( _mm_cmpgt_pd( a, b ) ); }
+	static Vector CmpLT( Vector a, Vector b ) { return( _mm_cmplt_pd( a, b ) ); }
+	static Vector CmpUnord( Vector a, Vector b ) { return( _mm_cmpunord_pd( a, b ) ); }
+	static Vector Zero( void ) { return( _mm_setzero_pd() ); }
+	static Vector Tiny( void ) { return( _mm_set1_pd( 2.2250738585072014e-308 ) ); }
+
+	// Arctangent of |z| <= 0.66, after the Cephes library.
+	static double AtanReduce( void ) { return( 0.66 ); }
+	static Vector AtanSmall( Vector z ) {
+		Vector z2 = Mul( z, z );
+		Vector p = Set( -8.750608600031904122785E-1 );
+		p = Add( Mul( p, z2 ), Set( -1.615753718733365076637E1 ) );
+		p = Add( Mul( p, z2 ), Set( -7.500855792314704667340E1 ) );
+		p = Add( Mul( p, z2 ), Set( -1.228866684490136173410E2 ) );
+		p = Add( Mul( p, z2 ), Set( -6.485021904942025371773E1 ) );
+		Vector q = Add( z2, Set( 2.485846490142306297962E1 ) );
+		q = Add( Mul( q, z2 ), Set( 1.650270098316988542046E2 ) );
+		q = Add( Mul( q, z2 ), Set( 4.328810604912902668951E2 ) );
+		q = Add( Mul( q, z2 ), Set( 4.853903996359136964868E2 ) );
+		q = Add( Mul( q, z2 ), Set( 1.945506571482613964425E2 ) );
+		return( Add( z, Mul( Mul( z, z2 ), Div( p, q ) ) ) );
+	}
+};
+
+class BatchFloat {
+public:
+	typedef float	Scalar;
+	typedef __m128	Vector;
+	enum { width = 4 };
+
+	static Vector Load( const float *p, int count, float pad ) {
+		if ( count == width ) return( _mm_loadu_ps( p ) );
+		float tmp[width];
+		for ( int i = 0; i < width; i++ ) tmp[i] = ( i < count ? p[i] : pad );
+		return( _mm_loadu_ps( tmp ) );
+	}
+	static void Store( float *p, Vector v, int count ) {
+		if ( count == width ) _mm_storeu_ps( p, v );
+		else {
+			float tmp[width];
+			_mm_storeu_ps( tmp, v );
+			for ( int i = 0; i < count; i++ ) p[i] = tmp[i];
+		}
+	}
+	static Scalar Sum( Vector v ) {
+		float tmp[width];
+		_mm_storeu_ps( tmp, v );
+		return( tmp[0] + tmp[1] + tmp[2] + tmp[3] );
+	}
+
+	static Vector Set( double s ) { return( _mm_set1_ps( (float) s ) ); }
+	static Vector Add( Vector a, Vector b ) { return( _mm_add_ps( a, b ) ); }
+	static Vector Sub( Vector a, Vector b ) { return( _mm_sub_ps( a, b ) ); }
+	static Vector Mul( Vector a, Vector b ) { return( _mm_mul_ps( a, b ) ); }
+	static Vector Div( Vector a, Vector b ) { return( _mm_div_ps( a, b ) ); }
+	static Vector Sqrt( Vector a ) { return( _mm_sqrt_ps( a ) ); }
+	static Vector Min( Vector a, Vector b ) { return( _mm_min_ps( a, b ) ); }
+	static Vector Max( Vector a, Vector b ) { return( _mm_max_ps( a, b ) ); }
+	static Vector And( Vector a, Vector b ) { return( _mm_and_ps( a, b ) ); }
+	static Vector AndNot( Vector a, Vector b ) { return( _mm_andnot_ps( a, b ) ); }
+	static Vector Or( Vector a, Vector b ) { return( _mm_or_ps( a, b ) ); }
+	static Vector CmpGT( Vector a, Vector b ) { return( _mm_cmpgt_ps( a, b ) ); }
+	static Vector CmpLT( Vector a, Vector b ) { return( _mm_cmplt_ps( a, b ) ); }
+	static Vector CmpUnord( Vector a, Vector b ) { return( _mm_cmpunord_ps( a, b ) ); }
+	static Vector Zero( void ) { return( _mm_setzero_ps() ); }
+	static Vector Tiny( void ) { return( _mm_set1_ps( 1.17549435e-38f ) ); }
+
+	// Arctangent of |z| <= tan( pi / 8 ), after the Cephes library.
+	static double AtanReduce( void ) { return( 0.4142135623730950 ); }
+	static Vector AtanSmall( Vector z ) {
+		Vector z2 = Mul( z, z );
+		Vector p = Set( 8.05374449538e-2 );
+		p = Add( Mul( p, z2 ), Set( -1.38776856032E-1 ) );
+		p = Add( Mul( p, z2 ), Set( 1.99777106478E-1 ) );
+		p = Add( Mul( p, z2 ), Set( -3.33329491539E-1 ) );
+		return( Add( z, Mul( Mul( p, z2 ), z ) ) );
+	}
+};
+
+/***********************************************************************************/
+
+// Choose between a and b according to a comparison mask.
+template <class S> static inline typename S::Vector Select( typename S::Vector mask, typename S::Vector a, typename S::Vector b ) {
+	return( S::Or( S::And( mask, a ), S::AndNot( mask, b ) ) );
+}
+
+// Four-quadrant arctangent. There is no SSE instruction for this, so we reduce
+//  the argument to a small range and evaluate a rational approximation, then
+//  map the result back to the correct quadrant. Agrees with atan2() to within
+//  the precision of the type. NaN inputs give NaN outputs.
+template <class S> static inline typename S::Vector Atan2( typename S::Vector y, typename S::Vector x ) {
+
+	typedef typename S::Vector V;
+
+	V sign_bit = S::Set( -0.0 );
+	V ax = S::AndNot( sign_bit, x );
+	V ay = S::AndNot( sign_bit, y );
+
+	// Work with the ratio of the smaller to the larger, which lies in [0, 1].
+	// If both are zero the ratio comes out as zero, as for atan2( 0, 0 ).
+	V a = S::Div( S::Min( ax, ay ), S::Max( S::Max( ax, ay ), S::Tiny() ) );
+
+	// Reduce the range further using atan( a ) = pi/4 + atan( ( a - 1 ) / ( a + 1 ) ).
+	V one = S::Set( 1.0 );
+	V reduce = S::CmpGT( a, S::Set( S::AtanReduce() ) );
+	V z = Select<S>( reduce, S::Div( S::Sub( a, one ), S::Add( a, one ) ), a );
+	V r = S::Add( S::AtanSmall( z ), S::And( reduce, S::Set( Pi / 4.0 ) ) );
+
+	// Undo the swap of x and y, then move into the left half plane if needed.
+	r = Select<S>( S::CmpGT( ay, ax ), S::Sub( S::Set( Pi / 2.0 ), r ), r );
+	r = Select<S>( S::CmpLT( x, S::Zero() ), S::Sub( S::Set( Pi ), r ), r );
+
+	// Give it the sign of y. The all-ones mask for NaN is itself a NaN.
+	r = S::Or( r, S::And( y, sign_bit ) );
+	return( S::Or( r, S::CmpUnord( x, y ) ) );
+
+}
+
+/***********************************************************************************/
+
+template <class S> static void QuaternionToCannonicalRotations( VectorColumns<typename S::Scalar> r, QuaternionColumns<typename S::Scalar> q, int n ) {
+
+	typedef typename S::Vector V;
+	V one = S::Set( 1.0 );
+	V two = S::Set( 2.0 );
+
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		V x = S::Load( q.x + i, k, 0.0 );
+		V y = S::Load( q.y + i, k, 0.0 );
+		V z = S::Load( q.z + i, k, 0.0 );
+		V m = S::Load( q.m + i, k, 1.0 );
+		V xx = S::Mul( x, x );
+		V yy = S::Mul( y, y );
+		V zz = S::Mul( z, z );
+		S::Store( r.x + i, Atan2<S>( S::Mul( two, S::Add( S::Mul( m, x ), S::Mul( y, z ) ) ), S::Sub( one, S::Add( xx, yy ) ) ), k );
+		S::Store( r.y + i, Atan2<S>( S::Mul( two, S::Add( S::Mul( m, y ), S::Mul( x, z ) ) ), S::Sub( one, S::Add( yy, zz ) ) ), k );
+		S::Store( r.z + i, Atan2<S>( S::Mul( two, S::Add( S::Mul( m, z ), S::Mul( x, y ) ) ), S::Sub( one, S::Add( xx, zz ) ) ), k );
+	}
+}
+
+template <class S> static void NormalizeQuaternions( QuaternionColumns<typename S::Scalar> q, int n ) {
+
+	typedef typename S::Vector V;
+
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		V x = S::Load( q.x + i, k, 0.0 );
+		V y = S::Load( q.y + i, k, 0.0 );
+		V z = S::Load( q.z + i, k, 0.0 );
+		V m = S::Load( q.m + i, k, 1.0 );
+		V norm = S::Sqrt( S::Add( S::Add( S::Mul( m, m ), S::Mul( x, x ) ), S::Add( S::Mul( y, y ), S::Mul( z, z ) ) ) );
+		S::Store( q.x + i, S::Div( x, norm ), k );
+		S::Store( q.y + i, S::Div( y, norm ), k );
+		S::Store( q.z + i, S::Div( z, norm ), k );
+		S::Store( q.m + i, S::Div( m, norm ), k );
+	}
+}
+
+template <class S> static void MultiplyQuaternions( QuaternionColumns<typename S::Scalar> result, QuaternionColumns<typename S::Scalar> q1, QuaternionColumns<typename S::Scalar> q2, int n ) {
+
+	typedef typename S::Vector V;
+
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		V x1 = S::Load( q1.x + i, k, 0.0 );
+		V y1 = S::Load( q1.y + i, k, 0.0 );
+		V z1 = S::Load( q1.z + i, k, 0.0 );
+		V m1 = S::Load( q1.m + i, k, 1.0 );
+		V x2 = S::Load( q2.x + i, k, 0.0 );
+		V y2 = S::Load( q2.y + i, k, 0.0 );
+		V z2 = S::Load( q2.z + i, k, 0.0 );
+		V m2 = S::Load( q2.m + i, k, 1.0 );
+		// All four components are computed before storing, in case result is one of the inputs.
+		V m = S::Sub( S::Sub( S::Mul( m1, m2 ), S::Mul( x1, x2 ) ), S::Add( S::Mul( y1, y2 ), S::Mul( z1, z2 ) ) );
+		V x = S::Sub( S::Add( S::Add( S::Mul( m1, x2 ), S::Mul( x1, m2 ) ), S::Mul( y1, z2 ) ), S::Mul( z1, y2 ) );
+		V y = S::Add( S::Add( S::Sub( S::Mul( m1, y2 ), S::Mul( x1, z2 ) ), S::Mul( y1, m2 ) ), S::Mul( z1, x2 ) );
+		V z = S::Add( S::Sub( S::Add( S::Mul( m1, z2 ), S::Mul( x1, y2 ) ), S::Mul( y1, x2 ) ), S::Mul( z1, m2 ) );
+		S::Store( result.x + i, x, k );
+		S::Store( result.y + i, y, k );
+		S::Store( result.z + i, z, k );
+		S::Store( result.m + i, m, k );
+	}
+}
+
+template <class S> static void AddVectors( VectorColumns<typename S::Scalar> result, VectorColumns<typename S::Scalar> a, VectorColumns<typename S::Scalar> b, int n ) {
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		S::Store( result.x + i, S::Add( S::Load( a.x + i, k, 0.0 ), S::Load( b.x + i, k, 0.0 ) ), k );
+		S::Store( result.y + i, S::Add( S::Load( a.y + i, k, 0.0 ), S::Load( b.y + i, k, 0.0 ) ), k );
+		S::Store( result.z + i, S::Add( S::Load( a.z + i, k, 0.0 ), S::Load( b.z + i, k, 0.0 ) ), k );
+	}
+}
+
+template <class S> static void SubtractVectors( VectorColumns<typename S::Scalar> result, VectorColumns<typename S::Scalar> a, VectorColumns<typename S::Scalar> b, int n ) {
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		S::Store( result.x + i, S::Sub( S::Load( a.x + i, k, 0.0 ), S::Load( b.x + i, k, 0.0 ) ), k );
+		S::Store( result.y + i, S::Sub( S::Load( a.y + i, k, 0.0 ), S::Load( b.y + i, k, 0.0 ) ), k );
+		S::Store( result.z + i, S::Sub( S::Load( a.z + i, k, 0.0 ), S::Load( b.z + i, k, 0.0 ) ), k );
+	}
+}
+
+template <class S> static void ScaleVectors( VectorColumns<typename S::Scalar> result, VectorColumns<typename S::Scalar> a, typename S::Scalar scaling, int n ) {
+	typename S::Vector s = S::Set( scaling );
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		S::Store( result.x + i, S::Mul( S::Load( a.x + i, k, 0.0 ), s ), k );
+		S::Store( result.y + i, S::Mul( S::Load( a.y + i, k, 0.0 ), s ), k );
+		S::Store( result.z + i, S::Mul( S::Load( a.z + i, k, 0.0 ), s ), k );
+	}
+}
+
+// Rotating v by q as q v q* works out to ( m^2 - u.u ) v + 2 ( u.v ) u + 2 m ( u x v ),
+//  where u is the vector part of q and m the scalar part. This holds even if q is
+//  not a unit quaternion, so the result is the same as for VectorsMixin::RotateVector().
+template <class S> static void RotateVectors( VectorColumns<typename S::Scalar> result, const typename S::Scalar q[4], VectorColumns<typename S::Scalar> v, int n ) {
+
+	typedef typename S::Vector V;
+
+	V ux = S::Set( q[X] );
+	V uy = S::Set( q[Y] );
+	V uz = S::Set( q[Z] );
+	V two = S::Set( 2.0 );
+	V two_m = S::Set( 2.0 * q[M] );
+	V scale = S::Set( q[M] * q[M] - ( q[X] * q[X] + q[Y] * q[Y] + q[Z] * q[Z] ) );
+
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		V vx = S::Load( v.x + i, k, 0.0 );
+		V vy = S::Load( v.y + i, k, 0.0 );
+		V vz = S::Load( v.z + i, k, 0.0 );
+		V dot2 = S::Mul( two, S::Add( S::Add( S::Mul( ux, vx ), S::Mul( uy, vy ) ), S::Mul( uz, vz ) ) );
+		V cx = S::Sub( S::Mul( uy, vz ), S::Mul( uz, vy ) );
+		V cy = S::Sub( S::Mul( uz, vx ), S::Mul( ux, vz ) );
+		V cz = S::Sub( S::Mul( ux, vy ), S::Mul( uy, vx ) );
+		S::Store( result.x + i, S::Add( S::Add( S::Mul( scale, vx ), S::Mul( dot2, ux ) ), S::Mul( two_m, cx ) ), k );
+		S::Store( result.y + i, S::Add( S::Add( S::Mul( scale, vy ), S::Mul( dot2, uy ) ), S::Mul( two_m, cy ) ), k );
+		S::Store( result.z + i, S::Add( S::Add( S::Mul( scale, vz ), S::Mul( dot2, uz ) ), S::Mul( two_m, cz ) ), k );
+	}
+}
+
+template <class S> static void Centroid( typename S::Scalar centroid[3], VectorColumns<typename S::Scalar> v, int n ) {
+
+	typedef typename S::Vector V;
+
+	V sx = S::Zero();
+	V sy = S::Zero();
+	V sz = S::Zero();
+	for ( int i = 0; i < n; i += S::width ) {
+		int k = ( n - i < S::width ? n - i : S::width );
+		sx = S::Add( sx, S::Load( v.x + i, k, 0.0 ) );
+		sy = S::Add( sy, S::Load( v.y + i, k, 0.0 ) );
+		sz = S::Add( sz, S::Load( v.z + i, k, 0.0 ) );
+	}
+	if ( n > 0 ) {
+		centroid[X] = S::Sum( sx ) / n;
+		centroid[Y] = S::Sum( sy ) / n;
+		centroid[Z] = S::Sum( sz ) / n;
+	}
+	else centroid[X] = centroid[Y] = centroid[Z] = 0.0;
+}
+
+/***********************************************************************************/
+
+// The specializations just select the traits class for the type.
+
+template <> void BatchQuaternionToCannonicalRotations<float>( VectorColumns<float> rotations, QuaternionColumns<float> q, int n ) {
+	QuaternionToCannonicalRotations<BatchFloat>( rotations, q, n );
+}
+template <> void BatchQuaternionToCannonicalRotations<double>( VectorColumns<double> rotations, QuaternionColumns<double> q, int n ) {
+	QuaternionToCannonicalRotations<BatchDouble>( rotations, q, n );
+}
+
+template <> void BatchNormalizeQuaternions<float>( QuaternionColumns<float> q, int n ) {
+	NormalizeQuaternions<BatchFloat>( q, n );
+}
+template <> void BatchNormalizeQuaternions<double>( QuaternionColumns<double> q, int n ) {
+	NormalizeQuaternions<BatchDouble>( q, n );
+}
+
+template <> void BatchMultiplyQuaternions<float>( QuaternionColumns<float> result, QuaternionColumns<float> q1, QuaternionColumns<float> q2, int n ) {
+	MultiplyQuaternions<BatchFloat>( result, q1, q2, n );
+}
+template <> void BatchMultiplyQuaternions<double>( QuaternionColumns<double> result, QuaternionColumns<double> q1, QuaternionColumns<double> q2, int n ) {
+	MultiplyQuaternions<BatchDouble>( result, q1, q2, n );
+}
+
+template <> void BatchAddVectors<float>( VectorColumns<float> result, VectorColumns<float> a, VectorColumns<float> b, int n ) {
+	AddVectors<BatchFloat>( result, a, b, n );
+}
+template <> void BatchAddVectors<double>( VectorColumns<double> result, VectorColumns<double> a, VectorColumns<double> b, int n ) {
+	AddVectors<BatchDouble>( result, a, b, n );
+}
+
+template <> void BatchSubtractVectors<float>( VectorColumns<float> result, VectorColumns<float> a, VectorColumns<float> b, int n ) {
+	SubtractVectors<BatchFloat>( result, a, b, n );
+}
+template <> void BatchSubtractVectors<double>( VectorColumns<double> result, VectorColumns<double> a, VectorColumns<double> b, int n ) {
+	SubtractVectors<BatchDouble>( result, a, b, n );
+}
+
+template <> void BatchScaleVectors<float>( VectorColumns<float> result, VectorColumns<float> a, float scaling, int n ) {
+	ScaleVectors<BatchFloat>( result, a, scaling, n );
+}
+template <> void BatchScaleVectors<double>( VectorColumns<double> result, VectorColumns<double> a, double scaling, int n ) {
+	ScaleVectors<BatchDouble>( result, a, scaling, n );
+}
+
+template <> void BatchRotateVectors<float>( VectorColumns<float> result, const float q[4], VectorColumns<float> v, int n ) {
+	RotateVectors<BatchFloat>( result, q, v, n );
+}
+template <> void BatchRotateVectors<double>( VectorColumns<double> result, const double q[4], VectorColumns<double> v, int n ) {
+	RotateVectors<BatchDouble>( result, q, v, n );
+}
+
+template <> void BatchCentroid<float>( float centroid[3], VectorColumns<float> v, int n ) {
+	Centroid<BatchFloat>( centroid, v, n );
+}
+template <> void BatchCentroid<double>( double centroid[3], VectorColumns<double> v, int n ) {
+	Centroid<BatchDouble>( centroid, v, n );
+}
@@ -0,0 +1,66 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                   VectorsBatch.h                              */
+/*                                                                               */
+/*********************************************************************************/
+
+// Batch versions of some of the VectorsMixin routines.
+// When loading a long record of data, calling the VectorsMixin methods one sample at
+//  a time is slow. These routines process whole arrays of samples at once, using SSE2
+//  instructions to do several samples in parallel.
+// The data are held as structures of arrays (one array per component) rather than
+//  as arrays of Vector3 or Quaternion, so that the components line up in the SIMD registers.
+// The routines are specialized for float and double. There is no generic version.
+
+#pragma once
+
+#include "Useful.h"
+
+template <typename T> struct VectorColumns {
+	T *x;
+	T *y;
+	T *z;
+};
+
+template <typename T> struct QuaternionColumns {
+	T *x;
+	T *y;
+	T *z;
+	T *m;
+};
+
+// Same as VectorsMixin::QuaternionToCannonicalRotations() for each of n quaternions.
+template <typename T> void BatchQuaternionToCannonicalRotations( VectorColumns<T> rotations, QuaternionColumns<T> q, int n );
+
+// Quaternion operations, done in place for normalization.
+template <typename T> void BatchNormalizeQuaternions( QuaternionColumns<T> q, int n );
+template <typename T> void BatchMultiplyQuaternions( QuaternionColumns<T> result, QuaternionColumns<T> q1, QuaternionColumns<T> q2, int n );
+
+// Vector operations on columns. The result may be the same as one of the inputs.
+template <typename T> void BatchAddVectors( VectorColumns<T> result, VectorColumns<T> a, VectorColumns<T> b, int n );
+template <typename T> void BatchSubtractVectors( VectorColumns<T> result, VectorColumns<T> a, VectorColumns<T> b, int n );
+template <typename T> void BatchScaleVectors( VectorColumns<T> result, VectorColumns<T> a, T scaling, int n );
+
+// Rigid body support. Rotate n vectors by the same quaternion, given in the
+//  usual X, Y, Z, M order, and compute the centroid of n vectors.
+// Rotation gives the same result as VectorsMixin::RotateVector().
+template <typename T> void BatchRotateVectors( VectorColumns<T> result, const T q[4], VectorColumns<T> v, int n );
+template <typename T> void BatchCentroid( T centroid[3], VectorColumns<T> v, int n );
+
+// The specializations are implemented in VectorsBatch.cpp.
+template <> void BatchQuaternionToCannonicalRotations<float>( VectorColumns<float> rotations, QuaternionColumns<float> q, int n );
+template <> void BatchQuaternionToCannonicalRotations<double>( VectorColumns<double> rotations, QuaternionColumns<double> q, int n );
+template <> void BatchNormalizeQuaternions<float>( QuaternionColumns<float> q, int n );
+template <> void BatchNormalizeQuaternions<double>( QuaternionColumns<double> q, int n );
+template <> void BatchMultiplyQuaternions<float>( QuaternionColumns<float> result, QuaternionColumns<float> q1, QuaternionColumns<float> q2, int n );
+template <> void BatchMultiplyQuaternions<double>( QuaternionColumns<double> result, QuaternionColumns<double> q1, QuaternionColumns<double> q2, int n );
+template <> void BatchAddVectors<float>( VectorColumns<float> result, VectorColumns<float> a, VectorColumns<float> b, int n );
+template <> void BatchAddVectors<double>( VectorColumns<double> result, VectorColumns<double> a, VectorColumns<double> b, int n );
+template <> void BatchSubtractVectors<float>( VectorColumns<float> result, VectorColumns<float> a, VectorColumns<float> b, int n );
+template <> void BatchSubtractVectors<double>( VectorColumns<double> result, VectorColumns<double> a, VectorColumns<double> b, int n );
+template <> void BatchScaleVectors<float>( VectorColumns<float> result, VectorColumns<float> a, float scaling, int n );
+template <> void BatchScaleVectors<double>( VectorColumns<double> result, VectorColumns<double> a, double scaling, int n );
+template <> void BatchRotateVectors<float>( VectorColumns<float> result, const float q[4], VectorColumns<float> v, int n );
+template <> void BatchRotateVectors<double>( VectorColumns<double> result, const double q[4], VectorColumns<double> v, int n );
+template <> void BatchCentroid<float>( float centroid[3], VectorColumns<float> v, int n );
+template <> void BatchCentroid<double>( double centroid[3], VectorColumns<double> v, int n );
@@ -28,145 +28,6 @@ double VectorsMixin::ToDegrees( double radians ) { return( radians * 180.0 / pi
 double VectorsMixin::ToRadians( double degrees ) { return( degrees * pi / 180.0 ); }
 
 
-void VectorsMixin::CopyVector( Vector3 destination, const Vector3 source ){
-	destination[X] = source[X];
-	destination[Y] = source[Y];
-	destination[Z] = source[Z];
-}
-
-void VectorsMixin::CopyVector( Vector3f destination, const Vector3 source ){
-	destination[X] = (float) source[X];
-	destination[Y] = (float) source[Y];
-	destination[Z] = (float) source[Z];
-}
-
-void VectorsMixin::CopyVector( Vector3 destination, const Vector3f source ){
-	destination[X] = (double) source[X];
-	destination[Y] = (double) source[Y];
-	destination[Z] = (double) source[Z];
-}
-
-void VectorsMixin::CopyVector( Vector3f destination, const Vector3f source ){
-	destination[X] = source[X];
-	destination[Y] = source[Y];
-	destination[Z] = source[Z];
-}
-
-void VectorsMixin::CopyQuaternion( Quaternion destination, const Quaternion source ){
-	destination[X] = source[X];
-	destination[Y] = source[Y];
-	destination[Z] = source[Z];
-	destination[M] = source[M];
-}
-
-void VectorsMixin::AddVectors( Vector3 result, const Vector3f a, const Vector3f b ) {
-	result[X] = (double) ( a[X] + b[X] );
-	result[Y] = (double) ( a[Y] + b[Y] );
-	result[Z] = (double) ( a[Z] + b[Z] );
-} 
-
-void VectorsMixin::AddVectors( Vector3 result, const Vector3 a, const Vector3 b ) {
-	result[X] = a[X] + b[X];
-	result[Y] = a[Y] + b[Y];
-	result[Z] = a[Z] + b[Z];
-}
-
-void VectorsMixin::AddVectors( Vector3 result, const Vector3f a, const Vector3 b ) {
-	result[X] = (double) a[X] + b[X];
-	result[Y] = (double) a[Y] + b[Y];
-	result[Z] = (double) a[Z] + b[Z];
-}
-
-void VectorsMixin::AddVectors( Vector3 result, const Vector3 a, const Vector3f b ) {
-	result[X] = a[X] + (double) b[X];
-	result[Y] = a[Y] + (double) b[Y];
-	result[Z] = a[Z] + (double) b[Z];
-}
-
-void VectorsMixin::AddVectors( Vector3f result, const Vector3 a, const Vector3 b ) {
-	result[X] = (float) ( a[X] + b[X] );
-	result[Y] = (float) ( a[Y] + b[Y] );
-	result[Z] = (float) ( a[Z] + b[Z] );
-} 
-
-void VectorsMixin::AddVectors( Vector3f result, const Vector3f a, const Vector3f b ) {
-	result[X] = a[X] + b[X];
-	result[Y] = a[Y] + b[Y];
-	result[Z] = a[Z] + b[Z];
-}
-
-
-
-void VectorsMixin::SubtractVectors( Vector3 result, const Vector3 a, const Vector3 b ) {
-	result[X] = a[X] - b[X];
-	result[Y] = a[Y] - b[Y];
-	result[Z] = a[Z] - b[Z];
-}
-
-void VectorsMixin::SubtractVectors( Vector3 result, const Vector3f a, const Vector3f b ) {
-	result[X] = (double) ( a[X] - b[X] );
-	result[Y] = (double) ( a[Y] - b[Y] );
-	result[Z] = (double) ( a[Z] - b[Z] );
-}
-
-void VectorsMixin::SubtractVectors( Vector3 result, const Vector3f a, const Vector3 b ) {
-	result[X] = (double) a[X] - b[X];
-	result[Y] = (double) a[Y] - b[Y];
-	result[Z] = (double) a[Z] - b[Z];
-}
-
-void VectorsMixin::SubtractVectors( Vector3f result, const Vector3 a, const Vector3 b ) {
-	result[X] = (float) ( a[X] - b[X] );
-	result[Y] = (float) ( a[Y] - b[Y] );
-	result[Z] = (float) ( a[Z] - b[Z] );
-}
-
-void VectorsMixin::SubtractVectors( Vector3f result, const Vector3f a, const Vector3f b ) {
-	result[X] = a[X] - b[X];
-	result[Y] = a[Y] - b[Y];
-	result[Z] = a[Z] - b[Z];
-}
-
-
-
-void VectorsMixin::ScaleVector( Vector3 result, const Vector3 a, const double scaling ) {
-	result[X] = (float) a[X] * scaling;
-	result[Y] = (float) a[Y] * scaling;
-	result[Z] = (float) a[Z] * scaling;
-}
-
-void VectorsMixin::ScaleVector( Vector3f result, const Vector3 a, const double scaling ) {
-	result[X] = (float) ( a[X] * scaling );
-	result[Y] = (float) ( a[Y] * scaling );
-	result[Z] = (float) ( a[Z] * scaling );
-} 
-
-void VectorsMixin::ScaleVector( Vector3f result, const Vector3f a, const double scaling ) {
-	result[X] = (float) ( a[X] * scaling );
-	result[Y] = (float) ( a[Y] * scaling );
-	result[Z] = (float) ( a[Z] * scaling );
-} 
-
-
-double VectorsMixin::VectorNorm( const Vector3 vector ) {
-	return( sqrt( vector[X] * vector[X] + vector[Y] * vector[Y] + vector[Z] * vector[Z] ) );
-}
-
-void VectorsMixin::NormalizeVector( Vector3 v ) {
-	// Normalize a vector in place.
-	ScaleVector( v, v, 1.0 / VectorNorm(v) );
-}
-
-double VectorsMixin::DotProduct( const Vector3 v1, const Vector3 v2 ) {
-	return( v1[X] * v2[X] + v1[Y] * v2[Y] + v1[Z] * v2[Z] );
-}
-
-void VectorsMixin::ComputeCrossProduct( Vector3 result, const Vector3 v1, const Vector3 v2 ) {
-	result[X] = v1[Y] * v2[Z] - v1[Z] * v2[Y];
-	result[Y] = v1[Z] * v2[X] - v1[X] * v2[Z];
-	result[Z] = v1[X] * v2[Y] - v1[Y] * v2[X];
-}
-
 void VectorsMixin::CopyMatrix( Matrix3x3 destination, const Matrix3x3 source ){
 	for ( int i = 0; i < 3; i++ ) {
 		for ( int j = 0; j < 3; j++ ) {
@@ -224,44 +85,6 @@ void VectorsMixin::OrthonormalizeMatrix( Matrix3x3 result, Matrix3x3 m ) {
 
 }
 
-void VectorsMixin::MultiplyVector( Vector3 result, Vector3 v, const Matrix3x3 m ) {
-	// I represent vectors as row vectors so that a matrix is an array of rows.
-	// Therefore we normally do right multiplies.
-	for ( int i = 0; i < 3; i++ ) {
-		result[i] = 0.0;
-		for ( int j = 0; j < 3; j++ ) result[i] += v[j] * m[j][i];
-	}
-}
-
-void VectorsMixin::MultiplyVector( Vector3 result, Vector3f v, const Matrix3x3 m ) {
-	// I represent vectors as row vectors so that a matrix is an array of rows.
-	// Therefore we normally do right multiplies.
-	for ( int i = 0; i < 3; i++ ) {
-		result[i] = 0.0;
-		for ( int j = 0; j < 3; j++ ) result[i] += (double) v[j] * m[j][i];
-	}
-}
-
-void VectorsMixin::MultiplyVector( Vector3f result, Vector3f v, const Matrix3x3 m ) {
-	// I represent vectors as row vectors so that a matrix is an array of rows.
-	// Therefore we normally do right multiplies.
-	for ( int i = 0; i < 3; i++ ) {
-		result[i] = 0.0;
-		for ( int j = 0; j < 3; j++ ) result[i] += (float) ((double) v[j] * m[j][i]);
-	}
-}
-
-void VectorsMixin::MultiplyVector( Vector3f result, Vector3 v, const Matrix3x3 m ) {
-	// I represent vectors as row vectors so that a matrix is an array of rows.
-	// Therefore we normally do right multiplies.
-	for ( int i = 0; i < 3; i++ ) {
-		result[i] = 0.0;
-		for ( int j = 0; j < 3; j++ ) result[i] += (float) (v[j] * m[j][i]);
-	}
-}
-
-
-
 // Let left and right be matrices of N 3-element row vectors.
 // Compute transpose(left) * right, which is necessarily a 3x3 matrix
 void VectorsMixin::CrossVectors( Matrix3x3 result, const Vector3 left[], const Vector3 right[], int rows ) {
@@ -331,43 +154,6 @@ double VectorsMixin::InvertMatrix( Matrix3x3 result, const Matrix3x3 m ){
 
 /*************************************************************************************************/
 
-void VectorsMixin::NormalizeQuaternion( Quaternion q ) {
-	double norm = sqrt( q[M] * q[M] + q[X] * q[X] + q[Y] * q[Y] + q[Z] * q[Z] );
-	q[M] /= norm;
-	q[X] /= norm;
-	q[Y] /= norm;
-	q[Z] /= norm;
-}
-
-void VectorsMixin::MultiplyQuaternions( Quaternion result, const Quaternion q1, const Quaternion q2 ) {
-
-	result[M] = q1[M] * q2[M] - q1[X] * q2[X] - q1[Y] * q2[Y] - q1[Z] * q2[Z];
-	result[X] = q1[M] * q2[X] + q1[X] * q2[M] + q1[Y] * q2[Z] - q1[Z] * q2[Y];
-	result[Y] = q1[M] * q2[Y] - q1[X] * q2[Z] + q1[Y] * q2[M] + q1[Z] * q2[X];
-	result[Z] = q1[M] * q2[Z] + q1[X] * q2[Y] - q1[Y] * q2[X] + q1[Z] * q2[M];
-
-}
-
-void VectorsMixin::RotateVector( Vector3 result, const Quaternion q, const Vector3 v ) {
-
-	Quaternion vq;
-	Quaternion rq;
-	Quaternion interim;
-	Quaternion conjugate;
-
-	// Careful. I'm abusing CopyVector() here.
-	// I use it to copy the first 3 components and then I set the 4th.
-	vq[M] = 0.0;  CopyVector( vq, v );
-	// Now I am abusing ScaleVector to take the conjugate of q.
-	conjugate[M] = q[M]; ScaleVector( conjugate, q, -1.0 );
-	// To rotate a vector, compute qvq*.
-	MultiplyQuaternions( interim, q, vq );
-	MultiplyQuaternions( rq, interim, conjugate );
-	// Take just the vector part for the result.
-	CopyVector( result, rq );
-
-}
-
 void VectorsMixin::SetQuaternion( Quaternion result, double radians, const Vector3 axis ) {
 
 	// Compute the quaternion, making sure that the specified axis is a unit vector.
@@ -499,8 +285,6 @@ bool VectorsMixin::ComputeRigidBodyPose( Vector3 position, Quaternion orientatio
 
 	if (N > MAX_RIGID_BODY_MARKERS) N = MAX_RIGID_BODY_MARKERS;
 
-	bool valid = false;
-
 	// Need at least 1 marker if a default orientation is given, and
 	// at least 3 markers if no default orientation is given.
 
@@ -603,22 +387,22 @@ bool VectorsMixin::ComputeRigidBodyPose( Vector3 position, Quaternion orientatio
 	if ( N == 8 ) {
 		i = i;
 	}
-	// To compute the position (displacement) we first calculate the model 
-	// marker positions at the actual orientation, then we compute the 
-	// average difference between rotated model and actual to get the displacement.
-	CopyVector( position, zeroVector );
+	// To compute the position (displacement) we need the average difference between
+	// the actual marker positions and the model marker positions rotated to the actual
+	// orientation. Rotation is linear, so this is the same as the difference between
+	// the actual centroid and the rotated model centroid. That way we rotate only one 
+	// vector instead of one per marker.
+	Vector3 rotated_model;
+	CopyVector( model_centroid, zeroVector );
+	CopyVector( actual_centroid, zeroVector );
 	for ( i = 0; i < N; i++ ) {
-		Vector3 rotated_model;
-		Vector3 offset;
-
-		// Ideal position of the marker when rotated around zero.
-		RotateVector( rotated_model, orientation, model[i] );
-		// Difference between actual and rotated model.
-		SubtractVectors( offset, actual[i], rotated_model );
-		// Compute the sum on the way to computing the average.
-		AddVectors( position, position, offset );
+		AddVectors( model_centroid, model_centroid, model[i] );
+		AddVectors( actual_centroid, actual_centroid, actual[i] );
 	}
-	ScaleVector( position, position, 1.0 / (double) N );
+	ScaleVector( model_centroid, model_centroid, 1.0 / (double) N );
+	ScaleVector( actual_centroid, actual_centroid, 1.0 / (double) N );
+	RotateVector( rotated_model, orientation, model_centroid );
+	SubtractVectors( position, actual_centroid, rotated_model );
 
 	return( true );
 
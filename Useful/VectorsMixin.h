@@ -10,6 +10,7 @@
 #pragma once
 
 #include "Useful.h" 
+#include "VectorsTemplate.h"
 
 // I am also putting here support for calculations on 3D rigid bodies.
 // It should probably be a separate class, but I will deal with that later.
@@ -35,35 +36,23 @@ public:
 	double ToDegrees( double radians );
 	double ToRadians( double degrees );
 
-	void CopyVector( Vector3  destination, const Vector3  source );
-	void CopyVector( Vector3f  destination, const Vector3  source );
-	void CopyVector( Vector3  destination, const Vector3f source );
-	void CopyVector( Vector3f  destination, const Vector3f  source );
-
-	void CopyQuaternion( Quaternion destination, const Quaternion source );
-
-	void AddVectors( Vector3f result, const Vector3 a, const Vector3 b );
-	void AddVectors( Vector3f result, const Vector3f a, const Vector3f b );
-	void AddVectors( Vector3 result, const Vector3f a, const Vector3f b );
-	void AddVectors( Vector3 result, const Vector3 a, const Vector3 b );
-	void AddVectors( Vector3 result, const Vector3f a, const Vector3 b );
-	void AddVectors( Vector3 result, const Vector3 a, const Vector3f b );
-
-	void SubtractVectors( Vector3 result, const Vector3 a, const Vector3 b );
-	void SubtractVectors( Vector3f result, const Vector3 a, const Vector3 b );
-	void SubtractVectors( Vector3 result, const Vector3f a, const Vector3f b );
-	void SubtractVectors( Vector3 result, const Vector3f a, const Vector3 b );
-	void SubtractVectors( Vector3f result, const Vector3f a, const Vector3f b );
-
-	void ScaleVector( Vector3 result, const Vector3 a, const double scaling );
-	void ScaleVector( Vector3f result, const Vector3 a, const double scaling );
-	void ScaleVector( Vector3f result, const Vector3f a, const double scaling );
-
-	double VectorNorm( const Vector3 vector );
-	void   NormalizeVector( Vector3 v );
-	double DotProduct( const Vector3 v1, const Vector3 v2 );
+	// The elementary vector operations are inline wrappers around the templates in
+	//  VectorsTemplate.h, so that they get compiled into the loops that use them.
+	// The overloads are kept so that existing code sees the same set of signatures.
+
+	template <typename R, typename A> void CopyVector( R *destination, const A *source ) { CopyElements<3>( destination, source ); }
+
+	void CopyQuaternion( Quaternion destination, const Quaternion source ) { CopyElements<4>( destination, source ); }
+
+	template <typename R, typename A, typename B> void AddVectors( R *result, const A *a, const B *b ) { AddElements<3>( result, a, b ); }
+	template <typename R, typename A, typename B> void SubtractVectors( R *result, const A *a, const B *b ) { SubtractElements<3>( result, a, b ); }
+	template <typename R, typename A> void ScaleVector( R *result, const A *a, const double scaling ) { ScaleElements<3>( result, a, scaling ); }
+
+	double VectorNorm( const Vector3 vector ) { return( sqrt( DotElements<3>( vector, vector ) ) ); }
+	void   NormalizeVector( Vector3 v ) { ScaleElements<3>( v, v, 1.0 / VectorNorm( v ) ); }
+	double DotProduct( const Vector3 v1, const Vector3 v2 ) { return( DotElements<3>( v1, v2 ) ); }
 	double AngleBetween( const Quaternion q1, const Quaternion q2 );
-	void   ComputeCrossProduct( Vector3 result, const Vector3 v1, const Vector3 v2 );
+	void   ComputeCrossProduct( Vector3 result, const Vector3 v1, const Vector3 v2 ) { CrossElements( result, v1, v2 ); }
 
 	void CopyMatrix( Matrix3x3 destination, const Matrix3x3 source );
 	void CopyMatrix( float destination[3][3], const Matrix3x3 source );
@@ -75,20 +64,19 @@ public:
 	double InvertMatrix( Matrix3x3 result, const Matrix3x3 m );
 	void OrthonormalizeMatrix( Matrix3x3 result, Matrix3x3 m );
 
-	void MultiplyVector( Vector3 result, Vector3 v, const Matrix3x3 m );
-	void MultiplyVector( Vector3 result, Vector3f v, const Matrix3x3 m );
-	void MultiplyVector( Vector3f result, Vector3f v, const Matrix3x3 m );
-	void MultiplyVector( Vector3f result, Vector3 v, const Matrix3x3 m );
+	// I represent vectors as row vectors so that a matrix is an array of rows.
+	// Therefore we normally do right multiplies.
+	template <typename R, typename V> void MultiplyVector( R *result, const V *v, const Matrix3x3 m ) { MultiplyElements( result, v, m ); }
 
 	void CrossVectors( Matrix3x3 result, const Vector3 left[], const Vector3 right[], int rows );
 	void BestFitTransformation( Matrix3x3 result, const Vector3 input[], const Vector3 output[], int rows );
 		
 	void SetQuaternion( Quaternion result, double radians, const Vector3 axis );
 	void SetQuaterniond( Quaternion result, double degrees, const Vector3 axis );
-	void NormalizeQuaternion( Quaternion q );
-	void MultiplyQuaternions( Quaternion result, const Quaternion q1, const Quaternion q2 );
+	void NormalizeQuaternion( Quaternion q ) { ScaleElements<4>( q, q, 1.0 / sqrt( DotElements<4>( q, q ) ) ); }
+	void MultiplyQuaternions( Quaternion result, const Quaternion q1, const Quaternion q2 ) { MultiplyQuaternionElements( result, q1, q2 ); }
 
-	void RotateVector( Vector3 result, const Quaternion q, const Vector3 v );
+	void RotateVector( Vector3 result, const Quaternion q, const Vector3 v ) { RotateElements( result, q, v ); }
 	void MatrixToQuaternion( Quaternion result, Matrix3x3 m );
 
 	void QuaternionToCannonicalRotations( Vector3 rotations, Quaternion q );
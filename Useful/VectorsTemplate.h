@@ -0,0 +1,286 @@
+/*********************************************************************************/
+/*                                                                               */
+/*                                 VectorsTemplate.h                             */
+/*                                                                               */
+/*********************************************************************************/
+
+// Fixed-size vector and quaternion templates.
+// VectorsMixin was written with one hand-coded routine for each combination of
+//  Vector3 and Vector3f arguments, all compiled out-of-line in VectorsMixin.cpp.
+// Here the same operations are written once as templates on the element types,
+//  entirely in this header so that the compiler can inline them into the loops
+//  that call them. The VectorsMixin methods are now thin wrappers around these.
+
+// Mixed precision follows the usual C rules: the arithmetic is done in the wider
+//  of the two input types and the result is then converted to the output type.
+
+// Vectors are row vectors and quaternions are stored in X, Y, Z, M order,
+//  as elsewhere in this library.
+
+#pragma once
+
+#include <math.h>
+#include "Useful.h"
+
+// Compilers that support relaxed constexpr (C++14) can evaluate these at compile time.
+// Older compilers, including Visual C++ 2010, just get inline functions.
+#if ( defined(_MSC_VER) && _MSC_VER >= 1910 ) || ( !defined(_MSC_VER) && __cplusplus >= 201402L )
+#define VECTORS_CONSTEXPR constexpr
+#else
+#define VECTORS_CONSTEXPR inline
+#endif
+
+// The type of the result of arithmetic between an A and a B.
+template <typename A, typename B> struct VectorsPromote {
+	typedef decltype( A() + B() ) type;
+};
+
+/***********************************************************************************/
+
+// Operations on plain arrays, such as Vector3, Vector3f and Quaternion.
+// The arithmetic is done into temporaries, so the result may be one of the inputs.
+
+template <int N, typename R, typename A>
+VECTORS_CONSTEXPR void CopyElements( R *result, const A *a ) {
+	for ( int i = 0; i < N; i++ ) result[i] = (R) a[i];
+}
+
+template <int N, typename R, typename A, typename B>
+VECTORS_CONSTEXPR void AddElements( R *result, const A *a, const B *b ) {
+	for ( int i = 0; i < N; i++ ) result[i] = (R) ( a[i] + b[i] );
+}
+
+template <int N, typename R, typename A, typename B>
+VECTORS_CONSTEXPR void SubtractElements( R *result, const A *a, const B *b ) {
+	for ( int i = 0; i < N; i++ ) result[i] = (R) ( a[i] - b[i] );
+}
+
+template <int N, typename R, typename A, typename S>
+VECTORS_CONSTEXPR void ScaleElements( R *result, const A *a, const S scaling ) {
+	for ( int i = 0; i < N; i++ ) result[i] = (R) ( a[i] * scaling );
+}
+
+template <int N, typename A, typename B>
+VECTORS_CONSTEXPR typename VectorsPromote<A,B>::type DotElements( const A *a, const B *b ) {
+	typename VectorsPromote<A,B>::type sum = 0;
+	for ( int i = 0; i < N; i++ ) sum += a[i] * b[i];
+	return( sum );
+}
+
+template <typename R, typename A, typename B>
+VECTORS_CONSTEXPR void CrossElements( R *result, const A *a, const B *b ) {
+	typename VectorsPromote<A,B>::type x = a[Y] * b[Z] - a[Z] * b[Y];
+	typename VectorsPromote<A,B>::type y = a[Z] * b[X] - a[X] * b[Z];
+	typename VectorsPromote<A,B>::type z = a[X] * b[Y] - a[Y] * b[X];
+	result[X] = (R) x;
+	result[Y] = (R) y;
+	result[Z] = (R) z;
+}
+
+// Right multiply of a row vector by a 3x3 matrix.
+template <typename R, typename V, typename T>
+VECTORS_CONSTEXPR void MultiplyElements( R *result, const V *v, const T m[3][3] ) {
+	typename VectorsPromote<V,T>::type r[3] = { 0, 0, 0 };
+	for ( int i = 0; i < 3; i++ ) {
+		for ( int j = 0; j < 3; j++ ) r[i] += v[j] * m[j][i];
+	}
+	for ( int i = 0; i < 3; i++ ) result[i] = (R) r[i];
+}
+
+// Hamilton product, same as VectorsMixin::MultiplyQuaternions().
+template <typename R, typename A, typename B>
+VECTORS_CONSTEXPR void MultiplyQuaternionElements( R *result, const A *q1, const B *q2 ) {
+	typename VectorsPromote<A,B>::type m = q1[M] * q2[M] - q1[X] * q2[X] - q1[Y] * q2[Y] - q1[Z] * q2[Z];
+	typename VectorsPromote<A,B>::type x = q1[M] * q2[X] + q1[X] * q2[M] + q1[Y] * q2[Z] - q1[Z] * q2[Y];
+	typename VectorsPromote<A,B>::type y = q1[M] * q2[Y] - q1[X] * q2[Z] + q1[Y] * q2[M] + q1[Z] * q2[X];
+	typename VectorsPromote<A,B>::type z = q1[M] * q2[Z] + q1[X] * q2[Y] - q1[Y] * q2[X] + q1[Z] * q2[M];
+	result[X] = (R) x;
+	result[Y] = (R) y;
+	result[Z] = (R) z;
+	result[M] = (R) m;
+}
+
+// Rotation of v by q computed as q v q*, written out as
+//  ( m^2 - u.u ) v + 2 ( u.v ) u + 2 m ( u x v ) where u is the vector part of q.
+// Like VectorsMixin::RotateVector(), q need not be a unit quaternion.
+template <typename R, typename Q, typename V>
+VECTORS_CONSTEXPR void RotateElements( R *result, const Q *q, const V *v ) {
+	typedef typename VectorsPromote<Q,V>::type T;
+	T scale = q[M] * q[M] - ( q[X] * q[X] + q[Y] * q[Y] + q[Z] * q[Z] );
+	T dot2 = 2 * ( q[X] * v[X] + q[Y] * v[Y] + q[Z] * v[Z] );
+	T two_m = 2 * q[M];
+	T x = scale * v[X] + dot2 * q[X] + two_m * ( q[Y] * v[Z] - q[Z] * v[Y] );
+	T y = scale * v[Y] + dot2 * q[Y] + two_m * ( q[Z] * v[X] - q[X] * v[Z] );
+	T z = scale * v[Z] + dot2 * q[Z] + two_m * ( q[X] * v[Y] - q[Y] * v[X] );
+	result[X] = (R) x;
+	result[Y] = (R) y;
+	result[Z] = (R) z;
+}
+
+/***********************************************************************************/
+
+// Value types with operators, for new code.
+
+template <typename T, int N> struct Vec {
+
+	T e[N];
+
+	VECTORS_CONSTEXPR T &operator[]( int i ) { return( e[i] ); }
+	VECTORS_CONSTEXPR const T &operator[]( int i ) const { return( e[i] ); }
+
+	// Conversion from and to the plain arrays used elsewhere, and between precisions.
+	template <typename U> static VECTORS_CONSTEXPR Vec From( const U *a ) {
+		Vec r = {};
+		CopyElements<N>( r.e, a );
+		return( r );
+	}
+	template <typename U> VECTORS_CONSTEXPR void To( U *a ) const {
+		CopyElements<N>( a, e );
+	}
+	template <typename U> VECTORS_CONSTEXPR Vec<U,N> As( void ) const {
+		return( Vec<U,N>::From( e ) );
+	}
+
+	template <typename U> VECTORS_CONSTEXPR Vec &operator+=( const Vec<U,N> &b ) {
+		AddElements<N>( e, e, b.e );
+		return( *this );
+	}
+	template <typename U> VECTORS_CONSTEXPR Vec &operator-=( const Vec<U,N> &b ) {
+		SubtractElements<N>( e, e, b.e );
+		return( *this );
+	}
+	template <typename S> VECTORS_CONSTEXPR Vec &operator*=( const S s ) {
+		ScaleElements<N>( e, e, s );
+		return( *this );
+	}
+
+};
+
+typedef Vec<double,3>	Vec3d;
+typedef Vec<float,3>	Vec3f;
+
+template <typename A, typename B, int N>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<A,B>::type,N> operator+( const Vec<A,N> &a, const Vec<B,N> &b ) {
+	Vec<typename VectorsPromote<A,B>::type,N> r = {};
+	AddElements<N>( r.e, a.e, b.e );
+	return( r );
+}
+
+template <typename A, typename B, int N>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<A,B>::type,N> operator-( const Vec<A,N> &a, const Vec<B,N> &b ) {
+	Vec<typename VectorsPromote<A,B>::type,N> r = {};
+	SubtractElements<N>( r.e, a.e, b.e );
+	return( r );
+}
+
+template <typename T, int N>
+VECTORS_CONSTEXPR Vec<T,N> operator-( const Vec<T,N> &a ) {
+	Vec<T,N> r = {};
+	for ( int i = 0; i < N; i++ ) r.e[i] = - a.e[i];
+	return( r );
+}
+
+template <typename T, typename S, int N>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<T,S>::type,N> operator*( const Vec<T,N> &a, const S s ) {
+	Vec<typename VectorsPromote<T,S>::type,N> r = {};
+	ScaleElements<N>( r.e, a.e, s );
+	return( r );
+}
+
+template <typename T, typename S, int N>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<T,S>::type,N> operator*( const S s, const Vec<T,N> &a ) {
+	return( a * s );
+}
+
+template <typename T, typename S, int N>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<T,S>::type,N> operator/( const Vec<T,N> &a, const S s ) {
+	Vec<typename VectorsPromote<T,S>::type,N> r = {};
+	for ( int i = 0; i < N; i++ ) r.e[i] = a.e[i] / s;
+	return( r );
+}
+
+template <typename A, typename B, int N>
+VECTORS_CONSTEXPR typename VectorsPromote<A,B>::type Dot( const Vec<A,N> &a, const Vec<B,N> &b ) {
+	return( DotElements<N>( a.e, b.e ) );
+}
+
+template <typename A, typename B>
+VECTORS_CONSTEXPR Vec<typename VectorsPromote<A,B>::type,3> Cross( const Vec<A,3> &a, const Vec<B,3> &b ) {
+	Vec<typename VectorsPromote<A,B>::type,3> r = {};
+	CrossElements( r.e, a.e, b.e );
+	return( r );
+}
+
+// sqrt() is not constexpr, so neither are these.
+template <typename T, int N>
+inline T Norm( const Vec<T,N> &a ) {
+	return( (T) sqrt( DotElements<N>( a.e, a.e ) ) );
+}
+
+template <typename T, int N>
+inline Vec<T,N> Normalized( const Vec<T,N> &a ) {
+	return( a / Norm( a ) );
+}
+
+/***********************************************************************************/
+
+template <typename T> struct Quat {
+
+	// X, Y, Z, M order, the same as Quaternion.
+	T e[4];
+
+	VECTORS_CONSTEXPR T &operator[]( int i ) { return( e[i] ); }
+	VECTORS_CONSTEXPR const T &operator[]( int i ) const { return( e[i] ); }
+
+	static VECTORS_CONSTEXPR Quat Identity( void ) {
+		Quat r = { { 0, 0, 0, 1 } };
+		return( r );
+	}
+	template <typename U> static VECTORS_CONSTEXPR Quat From( const U *q ) {
+		Quat r = {};
+		CopyElements<4>( r.e, q );
+		return( r );
+	}
+	template <typename U> VECTORS_CONSTEXPR void To( U *q ) const {
+		CopyElements<4>( q, e );
+	}
+	template <typename U> VECTORS_CONSTEXPR Quat<U> As( void ) const {
+		return( Quat<U>::From( e ) );
+	}
+
+	VECTORS_CONSTEXPR Vec<T,3> Vector( void ) const {
+		return( Vec<T,3>::From( e ) );
+	}
+	VECTORS_CONSTEXPR Quat Conjugate( void ) const {
+		Quat r = { { - e[X], - e[Y], - e[Z], e[M] } };
+		return( r );
+	}
+	template <typename U> VECTORS_CONSTEXPR Vec<typename VectorsPromote<T,U>::type,3> Rotate( const Vec<U,3> &v ) const {
+		Vec<typename VectorsPromote<T,U>::type,3> r = {};
+		RotateElements( r.e, e, v.e );
+		return( r );
+	}
+
+};
+
+typedef Quat<double>	Quatd;
+typedef Quat<float>		Quatf;
+
+template <typename A, typename B>
+VECTORS_CONSTEXPR Quat<typename VectorsPromote<A,B>::type> operator*( const Quat<A> &q1, const Quat<B> &q2 ) {
+	Quat<typename VectorsPromote<A,B>::type> r = {};
+	MultiplyQuaternionElements( r.e, q1.e, q2.e );
+	return( r );
+}
+
+template <typename T>
+inline T Norm( const Quat<T> &q ) {
+	return( (T) sqrt( DotElements<4>( q.e, q.e ) ) );
+}
+
+template <typename T>
+inline Quat<T> Normalized( const Quat<T> &q ) {
+	T norm = Norm( q );
+	Quat<T> r = { { q.e[X] / norm, q.e[Y] / norm, q.e[Z] / norm, q.e[M] / norm } };
+	return( r );
+}
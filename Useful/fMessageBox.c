@@ -14,15 +14,13 @@
  
 int fMessageBox( int mb_type, const char *caption, const char *format, ... ) {
 	
-	int items;
-	
 	va_list args;
 	
 	// The character buffer is really long so that there is little chance of overrunning it.
 	char message[10240];
 	
 	va_start(args, format);
-	items = vsprintf(message, format, args);
+	vsprintf(message, format, args);
 	va_end(args);
 	
 	return( MessageBox( NULL, message, caption, mb_type ) );